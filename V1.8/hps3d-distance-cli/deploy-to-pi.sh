@@ -79,7 +79,7 @@ ssh $PI_USER@$PI_IP "mkdir -p $TEMP_DIR"
 
 # Copy files to Pi
 echo -e "${BLUE}📤 Copying files to Raspberry Pi...${NC}"
-scp hps3d_service lib/libHPS3D.so points.conf.example hps3d.service $PI_USER@$PI_IP:$TEMP_DIR/
+scp hps3d_service lib/libHPS3D.so points.conf.example hps3d.service hps3d.socket $PI_USER@$PI_IP:$TEMP_DIR/
 
 # Create installation script on Pi
 cat << 'EOF' > /tmp/pi_install.sh
@@ -128,7 +128,7 @@ if [ "$MQTT_BROKER" != "localhost" ]; then
 fi
 
 # Install systemd service
-sudo cp $TEMP_DIR/hps3d.service /etc/systemd/system/
+sudo cp $TEMP_DIR/hps3d.service $TEMP_DIR/hps3d.socket /etc/systemd/system/
 sudo systemctl daemon-reload
 
 # Set permissions for USB device
@@ -141,7 +141,7 @@ sudo udevadm control --reload-rules
 echo "✅ Installation complete!"
 echo ""
 echo "🚀 To start the service:"
-echo "   sudo systemctl enable --now hps3d"
+echo "   sudo systemctl enable --now hps3d.socket hps3d"
 echo ""
 echo "📊 To check status:"
 echo "   sudo systemctl status hps3d"
@@ -169,7 +169,7 @@ echo -e "${GREEN}🎉 Deployment Complete!${NC}"
 echo "=================================================="
 echo -e "${BLUE}Next steps:${NC}"
 echo "1. SSH to your Pi: ssh $PI_USER@$PI_IP"
-echo "2. Start the service: sudo systemctl enable --now hps3d"
+echo "2. Start the service: sudo systemctl enable --now hps3d.socket hps3d"
 echo "3. Check status: sudo systemctl status hps3d"
 echo ""
 echo -e "${BLUE}🧪 Test MQTT Integration:${NC}"
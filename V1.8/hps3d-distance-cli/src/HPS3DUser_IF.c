@@ -1,4 +1,5 @@
 #include "HPS3DUser_IF.h"
+#include "packet_parser.h"
 
 #ifdef _WIN32 /*windows*/
 #include <stdio.h>
@@ -136,7 +137,10 @@ HPS3D_StatusTypeDef HPS3D_SingleCapture(__IN int handle, __OUT HPS3D_EventType_t
 			case HPS3D_FULL_ROI_EVEN:
 			case HPS3D_FULL_DEPTH_EVEN:
 			case HPS3D_SIMPLE_DEPTH_EVEN:
-				dataLen = HPS3D_ConvertToMeasureData(ret_data, data, *type);
+				if (HPS3D_ConvertToMeasureDataChecked(ret_data, dataLen, data, *type) < 0)
+				{
+					ret = HPS3D_RET_PACKET_ERR;
+				}
 				break;
 			default:
 				ret = HPS3D_RET_PACKET_ERR;
@@ -156,150 +160,20 @@ HPS3D_StatusTypeDef HPS3D_SingleCapture(__IN int handle, __OUT HPS3D_EventType_t
 */
 int HPS3D_ConvertToMeasureData(__IN uint8_t *data, __OUT HPS3D_MeasureData_t *resultData, __IN HPS3D_EventType_t Type)
 {
-	int len = 0;
-	if (Type == HPS3D_SIMPLE_ROI_EVEN)
-	{
-		int num = (int)data[0];
-		int i = 0;
-		for (i = 0; i < num; i++)
-		{
-			resultData->simple_roi_data[i].roi_num = data[len++];
-			resultData->simple_roi_data[i].group_id = data[len++];
-			resultData->simple_roi_data[i].roi_id = data[len++];
-			resultData->simple_roi_data[i].threshold_state = data[len++];
-
-			resultData->simple_roi_data[i].distance_average = data[len++] << 8;
-			resultData->simple_roi_data[i].distance_average += data[len++];
-
-			resultData->simple_roi_data[i].distance_min = data[len++] << 8;
-			resultData->simple_roi_data[i].distance_min += data[len++];
-
-			resultData->simple_roi_data[i].saturation_count = data[len++] << 8;
-			resultData->simple_roi_data[i].saturation_count += data[len++];
-
-			resultData->simple_roi_data[i].frame_cnt = data[len++] << 24;
-			resultData->simple_roi_data[i].frame_cnt += data[len++] << 16;
-			resultData->simple_roi_data[i].frame_cnt += data[len++] << 8;
-			resultData->simple_roi_data[i].frame_cnt += data[len++];
-		}
-	}
-	else if (Type == HPS3D_FULL_ROI_EVEN)
-	{
-		int num = (int)data[0];
-		int i = 0;
-		for (i = 0; i < num; i++)
-		{
-			resultData->full_roi_data[i].roi_num = data[len++];
-			resultData->full_roi_data[i].group_id = data[len++];
-			resultData->full_roi_data[i].roi_id = data[len++];
-			resultData->full_roi_data[i].threshold_state = data[len++];
-
-			resultData->full_roi_data[i].left_top_x = data[len++] << 8;
-			resultData->full_roi_data[i].left_top_x += data[len++];
-			resultData->full_roi_data[i].left_top_y = data[len++] << 8;
-			resultData->full_roi_data[i].left_top_y += data[len++];
-			resultData->full_roi_data[i].right_bottom_x = data[len++] << 8;
-			resultData->full_roi_data[i].right_bottom_x += data[len++];
-			resultData->full_roi_data[i].right_bottom_y = data[len++] << 8;
-			resultData->full_roi_data[i].right_bottom_y += data[len++];
-
-			resultData->full_roi_data[i].distance_average = data[len++] << 8;
-			resultData->full_roi_data[i].distance_average += data[len++];
-			resultData->full_roi_data[i].distance_min = data[len++] << 8;
-			resultData->full_roi_data[i].distance_min += data[len++];
-			resultData->full_roi_data[i].saturation_count = data[len++] << 8;
-			resultData->full_roi_data[i].saturation_count += data[len++];
-
-			resultData->full_roi_data[i].pixel_number = data[len++] << 24;
-			resultData->full_roi_data[i].pixel_number += data[len++] << 16;
-			resultData->full_roi_data[i].pixel_number += data[len++] << 8;
-			resultData->full_roi_data[i].pixel_number += data[len++];
-
-			resultData->full_roi_data[i].frame_cnt = data[len++] << 24;
-			resultData->full_roi_data[i].frame_cnt += data[len++] << 16;
-			resultData->full_roi_data[i].frame_cnt += data[len++] << 8;
-			resultData->full_roi_data[i].frame_cnt += data[len++];
-
-			uint32_t j;
-			for (j = 0; j < resultData->full_roi_data[i].pixel_number; j++)
-			{
-				resultData->full_roi_data[i].distance[j] = data[len++] << 8;
-				resultData->full_roi_data[i].distance[j] += data[len++];
-			}
-
-			
-			
-		}
-	}
-	else if (Type == HPS3D_SIMPLE_DEPTH_EVEN)
-	{
-		resultData->simple_depth_data.distance_average = data[len++] << 8;
-		resultData->simple_depth_data.distance_average += data[len++];
-		resultData->simple_depth_data.distance_min = data[len++] << 8;
-		resultData->simple_depth_data.distance_min += data[len++];
-		resultData->simple_depth_data.saturation_count = data[len++] << 8;
-		resultData->simple_depth_data.saturation_count += data[len++];
-
-		resultData->simple_depth_data.frame_cnt = data[len++] << 24;
-		resultData->simple_depth_data.frame_cnt += data[len++] << 16;
-		resultData->simple_depth_data.frame_cnt += data[len++] << 8;
-		resultData->simple_depth_data.frame_cnt += data[len++];
-	}
-	else if (Type == HPS3D_FULL_DEPTH_EVEN)
-	{
-		resultData->full_depth_data.distance_average = data[len++] << 8;
-		resultData->full_depth_data.distance_average += data[len++];
-		resultData->full_depth_data.distance_min = data[len++] << 8;
-		resultData->full_depth_data.distance_min += data[len++];
-		resultData->full_depth_data.saturation_count = data[len++] << 8;
-		resultData->full_depth_data.saturation_count += data[len++];
-
-
-		resultData->full_depth_data.frame_cnt = data[len++] << 24;
-		resultData->full_depth_data.frame_cnt += data[len++] << 16;
-		resultData->full_depth_data.frame_cnt += data[len++] << 8;
-		resultData->full_depth_data.frame_cnt += data[len++];
-
-
-		resultData->full_depth_data.point_cloud_data.width  = data[len++] << 8;
-		resultData->full_depth_data.point_cloud_data.width += data[len++];
-		resultData->full_depth_data.point_cloud_data.height = data[len++] << 8;
-		resultData->full_depth_data.point_cloud_data.height += data[len++];
-		resultData->full_depth_data.point_cloud_data.points = data[len++] << 8;
-		resultData->full_depth_data.point_cloud_data.points += data[len++];
-
-		
-		int MAX_PIX_NUM = 9600;
-		int point_start = len + MAX_PIX_NUM * 2;
-		int x = 0, y = 0, z = 0;
-		int i = 0;
-		for (i = 0; i < MAX_PIX_NUM; i++)
-		{
-			resultData->full_depth_data.distance[i] = data[len++] << 8;
-			resultData->full_depth_data.distance[i] += data[len++];
-
-		    x = data[point_start++] << 24;
-			x += data[point_start++] << 16;
-			x += data[point_start++] << 8;
-			x += data[point_start++] << 0;
-
-			y = data[point_start++] << 24;
-			y += data[point_start++] << 16;
-			y += data[point_start++] << 8;
-			y += data[point_start++] << 0;
-
-			z = data[point_start++] << 24;
-			z += data[point_start++] << 16;
-			z += data[point_start++] << 8;
-			z += data[point_start++] << 0;
-			resultData->full_depth_data.point_cloud_data.point_data[i].x = (float)(x / 100.0);
-			resultData->full_depth_data.point_cloud_data.point_data[i].y = (float)(y / 100.0);
-			resultData->full_depth_data.point_cloud_data.point_data[i].z = (float)(z / 100.0);
-		}
+	return packet_decode(data, resultData, Type);
+}
 
-		len = len + 14 * MAX_PIX_NUM;
-	}
-	return len;
+/**
+* @brief	    Convert a measurement buffer with length check
+* @param        data    packet body as delivered by the SDK
+* @param        dataLen packet length in bytes
+* @see			HPS3D_ConvertToMeasureData
+* @note		    Layout is validated once against dataLen before decoding
+* @retval	    number of bytes decoded, -1 for corrupt/truncated packets
+*/
+int HPS3D_ConvertToMeasureDataChecked(__IN uint8_t *data, __IN int dataLen, __OUT HPS3D_MeasureData_t *resultData, __IN HPS3D_EventType_t Type)
+{
+	return packet_parse(data, dataLen, resultData, Type);
 }
 
 /**
@@ -260,6 +260,16 @@ HPS3D_StatusTypeDef	HPS3D_SingleCapture(__IN int handle, __OUT HPS3D_EventType_t
 */
 int HPS3D_ConvertToMeasureData(__IN uint8_t *data, __OUT HPS3D_MeasureData_t *resultData, __IN HPS3D_EventType_t Type);
 
+/**
+* @brief	    Convert a measurement buffer with length check
+* @param        data    packet body as delivered by the SDK
+* @param        dataLen packet length in bytes
+* @see			HPS3D_ConvertToMeasureData
+* @note		    Layout is validated once against dataLen before decoding
+* @retval	    number of bytes decoded, -1 for corrupt/truncated packets
+*/
+int HPS3D_ConvertToMeasureDataChecked(__IN uint8_t *data, __IN int dataLen, __OUT HPS3D_MeasureData_t *resultData, __IN HPS3D_EventType_t Type);
+
 /**
 * @brief	     注册回调函数
 * @param        eventHandle 自定义回调函数
@@ -0,0 +1,126 @@
+#ifndef ASYNC_WRITER_H
+#define ASYNC_WRITER_H
+
+#include <pthread.h>
+#include <semaphore.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/types.h>
+#include "frame_pool.h"
+#include "spsc_ring.h"
+
+/*
+ * Asynchrones Schreiben von Logs und Aufzeichnungen. Der Aufrufer holt einen
+ * Puffer aus dem Pool, füllt ihn und reicht ihn ein; geschrieben wird in
+ * einem eigenen Thread. Auf dem Aufruferpfad gibt es weder Syscalls auf die
+ * Datei noch fflush, nur eine Semaphore weckt den Schreib-Thread.
+ *
+ * Backends:
+ * - io_uring: der Speicherblock des Pools ist als ein fester Puffer
+ *   registriert (IORING_OP_WRITE_FIXED); ohne Registrierung IORING_OP_WRITE.
+ * - Thread: aufeinanderfolgende Puffer derselben Datei per pwritev.
+ * io_uring wird bei ASYNC_WRITER_AUTO versucht, sonst der Thread.
+ *
+ * Offsets werden im Schreib-Thread in Einreichungsreihenfolge vergeben,
+ * die Datei entsteht also in derselben Reihenfolge wie die Aufrufe.
+ *
+ * acquire/submit: ein Thread zur Zeit (der Aufrufer serialisiert, z.B. per
+ * Mutex). Der Pool gibt Puffer nur im Schreib-Thread zurück.
+ */
+
+#define ASYNC_WRITER_MAX_FILES 8
+#define ASYNC_WRITER_URING_DEPTH 64
+
+typedef enum {
+    ASYNC_WRITER_AUTO = 0,      // io_uring, sonst Thread
+    ASYNC_WRITER_THREAD,        // Immer pwritev-Thread
+} async_writer_mode_t;
+
+typedef enum {
+    ASYNC_BACKEND_NONE = 0,
+    ASYNC_BACKEND_URING,
+    ASYNC_BACKEND_URING_FIXED,
+    ASYNC_BACKEND_THREAD,
+} async_writer_backend_t;
+
+typedef struct {
+    int fd;                                 // -1 = frei
+    off_t offset;                           // Nächster Schreib-Offset (nur Schreib-Thread)
+} async_writer_file_t;
+
+// Ring-Zustand des io_uring-Backends (Kernel-Mappings)
+typedef struct {
+    int fd;
+    void *sq_map;
+    void *cq_map;
+    size_t sq_map_size;
+    size_t cq_map_size;
+    void *sqes;
+    size_t sqes_size;
+    _Atomic uint32_t *sq_head;
+    _Atomic uint32_t *sq_tail;
+    uint32_t *sq_mask;
+    uint32_t *sq_array;
+    _Atomic uint32_t *cq_head;
+    _Atomic uint32_t *cq_tail;
+    uint32_t *cq_mask;
+    void *cqes;
+    uint32_t entries;
+    uint32_t in_flight;
+} async_uring_t;
+
+typedef struct {
+    frame_pool_t own_pool;
+    frame_pool_t *pool;                     // own_pool oder vom Aufrufer
+    void **queue_slots;
+    spsc_ring_t queue;                      // Eingereichte Puffer
+    sem_t wake;
+    pthread_t thread;
+    int thread_started;
+    volatile _Atomic int stop;
+    async_writer_backend_t backend;
+    async_uring_t uring;
+    off_t *offsets;                         // io_uring: Offset je Pufferindex für kurze Schreibvorgänge
+    async_writer_file_t files[ASYNC_WRITER_MAX_FILES];
+
+    _Atomic uint64_t submitted;             // Eingereichte Puffer
+    _Atomic uint64_t completed;             // Geschriebene oder verworfene Puffer
+    _Atomic uint64_t bytes;
+    _Atomic uint32_t dropped;               // acquire() ohne freien Puffer
+    _Atomic uint32_t errors;                // Fehlgeschlagene Schreibvorgänge
+} async_writer_t;
+
+// pool == NULL: eigenen Pool mit buffers x buf_size anlegen. Ein fremder Pool
+// muss vom Aufrufer bis destroy() gehalten werden und gibt Puffer nur noch
+// über den Schreib-Thread zurück. Rückgabe 0 / -1
+int async_writer_init(async_writer_t *writer, frame_pool_t *pool, uint32_t buffers, int buf_size,
+                      async_writer_mode_t mode);
+
+// Ausstehende Puffer schreiben, Thread beenden, Dateien schließen, Pool freigeben
+void async_writer_destroy(async_writer_t *writer);
+
+// Datei öffnen (truncate = 0 hängt an). Rückgabe: Datei-ID für submit, -1 bei Fehler.
+// Nur vor dem ersten submit() auf diese ID aufrufen.
+int async_writer_open(async_writer_t *writer, const char *path, int truncate);
+
+// Datei schließen und ID freigeben. Nur aufrufen, wenn alle auf diese ID
+// eingereichten Puffer fertig sind (completed hat den Stand nach dem letzten
+// submit() erreicht). Rückgabe 0 / -1
+int async_writer_close(async_writer_t *writer, int file);
+
+// Freien Puffer holen; NULL (und dropped++) wenn alle unterwegs sind
+frame_buf_t *async_writer_acquire(async_writer_t *writer);
+
+// buf->len Bytes an die Datei anhängen; der Puffer gehört danach dem Writer.
+// Die Datei-ID wird im handle-Feld des Puffers mitgeführt.
+int async_writer_submit(async_writer_t *writer, int file, frame_buf_t *buf);
+
+// Kopie von data in Puffer der Poolgröße einreichen; Rückgabe: eingereichte Bytes, -1 ohne Puffer
+int async_writer_write(async_writer_t *writer, int file, const void *data, int len);
+
+// Warten bis alles bisher Eingereichte geschrieben ist; 0 / -1 bei Timeout
+int async_writer_flush(async_writer_t *writer, int timeout_ms);
+
+const char *async_writer_backend_name(async_writer_backend_t backend);
+
+#endif // ASYNC_WRITER_H
@@ -0,0 +1,149 @@
+/*
+ * Burst-Erfassung und pixelweises Zusammenführen mehrerer Frames
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "HPS3DUser_IF.h"
+#include "region.h"
+#include "burst.h"
+
+int burst_init(burst_buffer_t *burst, int capacity, int pixels) {
+    if (!burst || capacity <= 0 || capacity > BURST_MAX_FRAMES || pixels <= 0) {
+        return -1;
+    }
+
+    memset(burst, 0, sizeof(*burst));
+    burst->frames = malloc((size_t)capacity * pixels * sizeof(uint16_t));
+    burst->merged = malloc((size_t)pixels * sizeof(uint16_t));
+    burst->valid_count = malloc((size_t)pixels);
+    if (!burst->frames || !burst->merged || !burst->valid_count) {
+        burst_free(burst);
+        return -1;
+    }
+    burst->capacity = capacity;
+    burst->pixels = pixels;
+    return 0;
+}
+
+void burst_free(burst_buffer_t *burst) {
+    if (!burst) {
+        return;
+    }
+    free(burst->frames);
+    free(burst->merged);
+    free(burst->valid_count);
+    memset(burst, 0, sizeof(*burst));
+}
+
+// Mittelwert: branchfrei über die Frames, vektorisierbar über die Pixel
+static void merge_mean(burst_buffer_t *burst, int min_valid) {
+    const int pixels = burst->pixels;
+    for (int i = 0; i < pixels; i++) {
+        uint32_t sum = 0;
+        int count = 0;
+        uint16_t sentinel = HPS3D_INVALID_DATA;
+        for (int f = 0; f < burst->count; f++) {
+            uint16_t d = burst->frames[(long)f * pixels + i];
+            int valid = region_pixel_valid(d);
+            sum += valid ? d : 0;
+            count += valid;
+            sentinel = (!valid && d != 0) ? d : sentinel;
+        }
+        burst->valid_count[i] = (uint8_t)count;
+        burst->merged[i] = (count >= min_valid && count > 0)
+            ? (uint16_t)((sum + (uint32_t)count / 2) / (uint32_t)count)
+            : sentinel;
+    }
+}
+
+// Median: Sortieren durch Einfügen über höchstens BURST_MAX_FRAMES Werte
+static void merge_median(burst_buffer_t *burst, int min_valid) {
+    const int pixels = burst->pixels;
+    uint16_t samples[BURST_MAX_FRAMES];
+
+    for (int i = 0; i < pixels; i++) {
+        int count = 0;
+        uint16_t sentinel = HPS3D_INVALID_DATA;
+        for (int f = 0; f < burst->count; f++) {
+            uint16_t d = burst->frames[(long)f * pixels + i];
+            if (!region_pixel_valid(d)) {
+                sentinel = d ? d : sentinel;
+                continue;
+            }
+            int j = count++;
+            while (j > 0 && samples[j - 1] > d) {
+                samples[j] = samples[j - 1];
+                j--;
+            }
+            samples[j] = d;
+        }
+        burst->valid_count[i] = (uint8_t)count;
+        if (count >= min_valid && count > 0) {
+            burst->merged[i] = (count & 1) ? samples[count / 2]
+                : (uint16_t)(((uint32_t)samples[count / 2 - 1] + samples[count / 2] + 1) / 2);
+        } else {
+            burst->merged[i] = sentinel;
+        }
+    }
+}
+
+void burst_merge(burst_buffer_t *burst, burst_mode_t mode, int min_valid) {
+    if (!burst || burst->count == 0) {
+        return;
+    }
+    if (mode == BURST_MEDIAN) {
+        merge_median(burst, min_valid);
+    } else {
+        merge_mean(burst, min_valid);
+    }
+}
+
+void burst_region(const burst_buffer_t *burst, int stride, int x0, int y0, int w, int h,
+                  burst_region_t *out) {
+    region_stats_t stats;
+    memset(out, 0, sizeof(*out));
+
+    region_stats(burst->merged, stride, x0, y0, w, h, &stats);
+    out->valid_pixels = stats.count;
+    out->min = stats.count ? stats.min : 0.0f;
+    out->max = stats.max;
+    out->distance = stats.count ? (float)stats.sum / stats.count : 0.0f;
+
+    // Standardfehler über die Mittelwerte der einzelnen Frames
+    double sum = 0.0, sum_sq = 0.0;
+    int n = 0;
+    for (int f = 0; f < burst->count; f++) {
+        region_stats(burst->frames + (long)f * burst->pixels, stride, x0, y0, w, h, &stats);
+        if (stats.count == 0) {
+            continue;
+        }
+        double mean = (double)stats.sum / stats.count;
+        sum += mean;
+        sum_sq += mean * mean;
+        n++;
+    }
+    out->frames_used = n;
+    if (n > 1) {
+        double mean = sum / n;
+        double var = (sum_sq - n * mean * mean) / (n - 1);
+        out->std_error = (float)sqrt(var > 0.0 ? var / n : 0.0);
+    }
+}
+
+const char *burst_mode_name(burst_mode_t mode) {
+    return mode == BURST_MEDIAN ? "median" : "mean";
+}
+
+int burst_parse_mode(const char *name, int len, burst_mode_t *mode) {
+    if (len == 4 && strncmp(name, "mean", 4) == 0) {
+        *mode = BURST_MEAN;
+        return 0;
+    }
+    if (len == 6 && strncmp(name, "median", 6) == 0) {
+        *mode = BURST_MEDIAN;
+        return 0;
+    }
+    return -1;
+}
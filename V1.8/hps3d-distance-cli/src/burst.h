@@ -0,0 +1,66 @@
+#ifndef BURST_H
+#define BURST_H
+
+#include <stdint.h>
+
+/*
+ * Burst-Messung: N aufeinanderfolgende Frames in vorallokierte Ebenen
+ * erfassen und pixelweise zu einer Distanzebene zusammenführen.
+ */
+
+#define BURST_MAX_FRAMES 32
+#define BURST_DEFAULT_FRAMES 10
+
+typedef enum {
+    BURST_MEAN = 0,
+    BURST_MEDIAN
+} burst_mode_t;
+
+typedef struct {
+    uint16_t *frames;        // capacity Ebenen zu je pixels Werten
+    uint16_t *merged;        // Zusammengeführte Ebene
+    uint8_t *valid_count;    // Gültige Samples pro Pixel
+    int capacity;
+    int count;               // Erfasste Frames
+    int pixels;
+} burst_buffer_t;
+
+// Statistik über ein Rechteck der zusammengeführten Ebene
+typedef struct {
+    float distance;          // Mittel der zusammengeführten gültigen Pixel in mm
+    float std_error;         // Standardfehler aus der Streuung der Frame-Mittel in mm
+    float min, max;          // Über die zusammengeführte Ebene
+    int valid_pixels;        // Gültige Pixel der zusammengeführten Ebene
+    int frames_used;         // Frames mit mindestens einem gültigen Pixel im Bereich
+} burst_region_t;
+
+int burst_init(burst_buffer_t *burst, int capacity, int pixels);
+void burst_free(burst_buffer_t *burst);
+
+static inline void burst_reset(burst_buffer_t *burst) {
+    burst->count = 0;
+}
+
+// Nächste freie Ebene zum direkten Dekodieren; NULL wenn voll
+static inline uint16_t *burst_next_frame(burst_buffer_t *burst) {
+    return (burst->count < burst->capacity) ? burst->frames + (long)burst->count * burst->pixels : NULL;
+}
+
+static inline void burst_commit_frame(burst_buffer_t *burst) {
+    if (burst->count < burst->capacity) {
+        burst->count++;
+    }
+}
+
+// Pixelweise zusammenführen. Pixel mit weniger als min_valid gültigen
+// Samples erhalten den zuletzt gesehenen Sentinel (oder HPS3D_INVALID_DATA).
+void burst_merge(burst_buffer_t *burst, burst_mode_t mode, int min_valid);
+
+void burst_region(const burst_buffer_t *burst, int stride, int x0, int y0, int w, int h,
+                  burst_region_t *out);
+
+const char *burst_mode_name(burst_mode_t mode);
+// "mean" / "median"; Rückgabe 0 bei Erfolg, -1 bei unbekanntem Namen
+int burst_parse_mode(const char *name, int len, burst_mode_t *mode);
+
+#endif // BURST_H
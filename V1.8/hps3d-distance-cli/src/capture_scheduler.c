@@ -0,0 +1,268 @@
+/*
+ * Versetzte Aufnahmefenster für mehrere Sensoren an einem USB-Bus
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+#include "capture_scheduler.h"
+
+#define TRANSFER_MAX_US 1000000     // Ausreißer (Timeouts) begrenzen
+
+uint64_t capture_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+}
+
+static int map_bus(capture_sched_t *sched, const char *path) {
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (fd < 0) {
+        return -1;
+    }
+    struct stat st;
+    size_t size = sizeof(capture_bus_t);
+    // Neue Datei wird mit Nullen verlängert: alle Plätze frei, magic noch 0
+    if (fstat(fd, &st) != 0 || ((size_t)st.st_size < size && ftruncate(fd, (off_t)size) != 0)) {
+        close(fd);
+        return -1;
+    }
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return -1;
+    }
+    capture_bus_t *bus = map;
+
+    uint32_t expected = 0;
+    if (atomic_compare_exchange_strong(&bus->magic, &expected, CAPTURE_BUS_MAGIC)) {
+        bus->version = CAPTURE_BUS_VERSION;
+    } else if (expected != CAPTURE_BUS_MAGIC ||
+               (bus->version != 0 && bus->version != CAPTURE_BUS_VERSION)) {
+        munmap(map, size);
+        errno = EPROTO;
+        return -1;
+    }
+    sched->bus = bus;
+    sched->map_size = size;
+    return 0;
+}
+
+// Platz eines beendeten Prozesses darf übernommen werden
+static int slot_orphaned(int32_t pid) {
+    return pid > 0 && pid != (int32_t)getpid() && kill(pid, 0) != 0 && errno == ESRCH;
+}
+
+int capture_sched_attach(capture_sched_t *sched, const char *path, uint32_t guard_us) {
+    memset(sched, 0, sizeof(*sched));
+    sched->slot = -1;
+    sched->guard_us = guard_us ? guard_us : CAPTURE_DEFAULT_GUARD_US;
+    sched->transfer_us = CAPTURE_DEFAULT_TRANSFER_US;
+
+    if (path && path[0]) {
+        if (map_bus(sched, path) != 0) {
+            return -1;
+        }
+    } else {
+        sched->bus = &sched->local;
+    }
+
+    int32_t self = (int32_t)getpid();
+    for (int i = 0; i < CAPTURE_BUS_MAX_SLOTS; i++) {
+        capture_bus_slot_t *slot = &sched->bus->slots[i];
+        int32_t owner = atomic_load(&slot->pid);
+        if (owner != 0 && !slot_orphaned(owner)) {
+            continue;
+        }
+        if (atomic_compare_exchange_strong(&slot->pid, &owner, self)) {
+            atomic_store(&slot->transfer_us, CAPTURE_DEFAULT_TRANSFER_US);
+            atomic_store(&slot->interval_us, 0);
+            atomic_store(&slot->heartbeat_us, capture_now_us());
+            sched->slot = i;
+            return 0;
+        }
+    }
+
+    capture_sched_detach(sched);
+    errno = EBUSY;
+    return -1;
+}
+
+void capture_sched_detach(capture_sched_t *sched) {
+    if (!sched->bus) {
+        return;
+    }
+    if (sched->slot >= 0) {
+        int32_t self = (int32_t)getpid();
+        atomic_compare_exchange_strong(&sched->bus->slots[sched->slot].pid, &self, 0);
+        sched->slot = -1;
+    }
+    if (sched->map_size) {
+        munmap(sched->bus, sched->map_size);
+        sched->map_size = 0;
+    }
+    sched->bus = NULL;
+}
+
+void capture_bus_plan(const capture_bus_t *bus, int slot, uint64_t now_us, uint32_t guard_us,
+                      capture_plan_t *plan) {
+    uint64_t total = 0, offset = 0;
+    uint32_t max_interval = 0;
+    memset(plan, 0, sizeof(*plan));
+
+    for (int i = 0; i < CAPTURE_BUS_MAX_SLOTS; i++) {
+        const capture_bus_slot_t *s = &bus->slots[i];
+        if (atomic_load(&s->pid) == 0) {
+            continue;
+        }
+        uint32_t interval = atomic_load(&s->interval_us);
+        if (i != slot) {
+            // Ohne Herzschlag (Messung pausiert, Prozess hängt) gibt der Platz den Bus frei
+            uint64_t heartbeat = atomic_load(&s->heartbeat_us);
+            uint64_t stale = (uint64_t)interval * CAPTURE_STALE_CYCLES;
+            if (stale < CAPTURE_STALE_MIN_US) {
+                stale = CAPTURE_STALE_MIN_US;
+            }
+            if (heartbeat + stale < now_us) {
+                continue;
+            }
+        }
+        uint32_t window = atomic_load(&s->transfer_us) + guard_us;
+        if (i < slot) {
+            offset += window;
+        }
+        if (i == slot) {
+            plan->window_us = window;
+        }
+        total += window;
+        max_interval = interval > max_interval ? interval : max_interval;
+        plan->active++;
+    }
+
+    plan->cycle_us = (uint32_t)(total > max_interval ? total : max_interval);
+    if (plan->cycle_us == 0) {
+        plan->cycle_us = guard_us ? guard_us : 1;
+    }
+    plan->offset_us = (uint32_t)offset;
+}
+
+uint64_t capture_next_window(uint64_t after_us, uint64_t epoch_us, uint32_t cycle_us, uint32_t offset_us) {
+    uint64_t first = epoch_us + offset_us;
+    if (after_us <= first) {
+        return first;
+    }
+    uint64_t k = (after_us - first + cycle_us - 1) / cycle_us;
+    return first + k * cycle_us;
+}
+
+// Zeitachse konsistent lesen
+static void read_timeline(capture_bus_t *bus, uint32_t *cycle_us, uint64_t *epoch_us) {
+    uint32_t seq;
+    do {
+        seq = atomic_load(&bus->seq);
+        *cycle_us = atomic_load(&bus->cycle_us);
+        *epoch_us = atomic_load(&bus->epoch_us);
+    } while ((seq & 1) || seq != atomic_load(&bus->seq));
+}
+
+// Neuen Zyklus ab der nächsten Grenze der alten Zeitachse; verliert ein anderer
+// Sensor das Rennen, übernimmt er einfach dessen Ergebnis
+static void switch_timeline(capture_bus_t *bus, uint32_t cycle_us, uint64_t now_us) {
+    uint32_t seq = atomic_load(&bus->seq);
+    if ((seq & 1) || !atomic_compare_exchange_strong(&bus->seq, &seq, seq + 1)) {
+        return;
+    }
+    uint32_t old_cycle = atomic_load(&bus->cycle_us);
+    uint64_t epoch = now_us;
+    if (old_cycle) {
+        epoch = capture_next_window(now_us, atomic_load(&bus->epoch_us), old_cycle, 0);
+    }
+    atomic_store(&bus->cycle_us, cycle_us);
+    atomic_store(&bus->epoch_us, epoch);
+    atomic_store(&bus->seq, seq + 2);
+}
+
+uint64_t capture_sched_wait(capture_sched_t *sched, int interval_ms) {
+    capture_bus_slot_t *slot = &sched->bus->slots[sched->slot];
+    uint64_t now = capture_now_us();
+    atomic_store(&slot->interval_us, interval_ms > 0 ? (uint32_t)interval_ms * 1000 : 0);
+    atomic_store(&slot->heartbeat_us, now);
+
+    capture_bus_plan(sched->bus, sched->slot, now, sched->guard_us, &sched->plan);
+    uint32_t cycle;
+    read_timeline(sched->bus, &cycle, &sched->plan.epoch_us);
+    if (cycle != sched->plan.cycle_us) {
+        switch_timeline(sched->bus, sched->plan.cycle_us, now);
+        read_timeline(sched->bus, &cycle, &sched->plan.epoch_us);
+    }
+    // Bis alle die Umstellung gesehen haben, gilt der Zyklus aus der Tabelle
+    sched->plan.cycle_us = cycle;
+
+    // Dasselbe Fenster nie zweimal belegen
+    uint64_t after = now;
+    if (sched->next_us && after <= sched->next_us) {
+        after = sched->next_us + 1;
+    }
+    if (sched->next_us && now > sched->next_us + sched->plan.cycle_us) {
+        sched->late++;
+    }
+    uint64_t target = capture_next_window(after, sched->plan.epoch_us, sched->plan.cycle_us,
+                                          sched->plan.offset_us);
+    sched->next_us = target;
+
+    struct timespec ts = {
+        .tv_sec = (time_t)(target / 1000000),
+        .tv_nsec = (long)(target % 1000000) * 1000,
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR) {
+    }
+    return target;
+}
+
+void capture_sched_begin(capture_sched_t *sched) {
+    sched->begin_us = capture_now_us();
+}
+
+void capture_sched_end(capture_sched_t *sched, int ok) {
+    uint64_t now = capture_now_us();
+    if (ok) {
+        uint64_t duration = now - sched->begin_us;
+        capture_sched_record(sched, duration > TRANSFER_MAX_US ? TRANSFER_MAX_US : (uint32_t)duration);
+    } else {
+        sched->failed++;
+    }
+    atomic_store(&sched->bus->slots[sched->slot].heartbeat_us, now);
+}
+
+void capture_sched_record(capture_sched_t *sched, uint32_t duration_us) {
+    if (sched->frames == 0) {
+        sched->transfer_us = duration_us;
+        sched->transfer_dev_us = 0;
+    } else {
+        // Glättung wie bei der TCP-RTT: Mittel mit 1/8, Abweichung mit 1/4
+        int32_t err = (int32_t)duration_us - (int32_t)sched->transfer_us;
+        uint32_t abs_err = (uint32_t)(err < 0 ? -err : err);
+        sched->transfer_us = (uint32_t)((int32_t)sched->transfer_us + err / 8);
+        sched->transfer_dev_us = (uint32_t)((int32_t)sched->transfer_dev_us +
+                                            ((int32_t)abs_err - (int32_t)sched->transfer_dev_us) / 4);
+    }
+    sched->frames++;
+
+    // Fensterbedarf: Mittel plus zweifache Abweichung deckt die üblichen Ausreißer.
+    // Jede Änderung verschiebt den Plan aller Sensoren; daher gerastert, sofort
+    // wachsen, aber erst mit Abstand schrumpfen.
+    _Atomic uint32_t *published = &sched->bus->slots[sched->slot].transfer_us;
+    uint32_t need = sched->transfer_us + 2 * sched->transfer_dev_us;
+    need = (need + CAPTURE_WINDOW_STEP_US - 1) / CAPTURE_WINDOW_STEP_US * CAPTURE_WINDOW_STEP_US;
+    uint32_t current = atomic_load(published);
+    if (sched->frames == 1 || need > current || need + 2 * CAPTURE_WINDOW_STEP_US < current) {
+        atomic_store(published, need);
+    }
+}
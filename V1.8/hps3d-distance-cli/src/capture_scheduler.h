@@ -0,0 +1,113 @@
+#ifndef CAPTURE_SCHEDULER_H
+#define CAPTURE_SCHEDULER_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/types.h>
+
+/*
+ * Bus-Zeitplan für mehrere HPS3D-160U an einem USB-Controller. Jeder Sensor
+ * (ein Service-Prozess oder Thread) belegt einen Platz in einer gemeinsamen
+ * Tabelle (per mmap geteilte Datei, z.B. unter /dev/shm) und veröffentlicht
+ * dort seine gemessene Übertragungszeit. Alle Teilnehmer rechnen daraus
+ * denselben Plan auf der gemeinsamen Zeitachse (CLOCK_MONOTONIC):
+ *
+ *   Zyklus  = max(längstes gewünschtes Intervall, Summe aller Fenster)
+ *   Fenster = geglättete Übertragungszeit + Schutzabstand
+ *   Offset  = Summe der Fenster aller aktiven Plätze mit kleinerem Index
+ *
+ * Zyklus und Epoche (Beginn von Fenster 0) liegen selbst in der Tabelle. Ändert
+ * sich der Zyklus, stellt der erste Sensor, der es bemerkt, die Zeitachse zur
+ * nächsten Zyklusgrenze der alten Achse um; so springen die Phasen nicht
+ * auseinander, nur weil die Sensoren den Plan zu leicht verschiedenen
+ * Zeitpunkten neu berechnen.
+ *
+ * Die Übertragungszeiten werden bei jeder Aufnahme nachgeführt, damit passen
+ * sich die Offsets an, sobald ein Sensor länger braucht (mehr Last, anderer
+ * Modus). Plätze ohne Herzschlag oder mit beendetem Prozess zählen nicht mehr
+ * und werden beim nächsten attach() wiederverwendet.
+ *
+ * Zeiten in µs. Ein capture_sched_t gehört einem Thread.
+ */
+
+#define CAPTURE_BUS_MAX_SLOTS 8
+#define CAPTURE_BUS_MAGIC 0x48505342u        // "HPSB"
+#define CAPTURE_BUS_VERSION 1
+#define CAPTURE_DEFAULT_GUARD_US 2000
+#define CAPTURE_DEFAULT_TRANSFER_US 20000    // Startwert bis zur ersten Messung
+#define CAPTURE_WINDOW_STEP_US 500           // Raster der veröffentlichten Fenster
+#define CAPTURE_STALE_CYCLES 4               // Ohne Herzschlag so viele Zyklen: Platz inaktiv
+#define CAPTURE_STALE_MIN_US 2000000
+
+typedef struct {
+    _Atomic int32_t pid;                    // 0 = frei
+    _Atomic uint32_t transfer_us;           // Geglättete Übertragungszeit
+    _Atomic uint32_t interval_us;           // Gewünschter Zyklus dieses Sensors
+    _Atomic uint64_t heartbeat_us;          // Letztes Lebenszeichen
+} capture_bus_slot_t;
+
+typedef struct {
+    _Atomic uint32_t magic;
+    uint32_t version;
+    _Atomic uint32_t seq;                   // Seqlock für cycle/epoch (ungerade = Umstellung)
+    _Atomic uint32_t cycle_us;              // Gültiger Zyklus (0 = noch keiner)
+    _Atomic uint64_t epoch_us;              // Beginn eines Zyklus auf CLOCK_MONOTONIC
+    capture_bus_slot_t slots[CAPTURE_BUS_MAX_SLOTS];
+} capture_bus_t;
+
+typedef struct {
+    uint32_t cycle_us;
+    uint32_t offset_us;                     // Beginn des eigenen Fensters im Zyklus
+    uint32_t window_us;                     // Eigenes Fenster inkl. Schutzabstand
+    uint64_t epoch_us;                      // Zeitachse (nach capture_sched_wait)
+    int active;                             // Aktive Plätze inkl. eigenem
+} capture_plan_t;
+
+typedef struct {
+    capture_bus_t *bus;
+    capture_bus_t local;                    // Ohne Datei: privater Plan (ein Sensor)
+    size_t map_size;                        // > 0: bus ist ein mmap der Datei
+    int slot;
+    uint32_t guard_us;
+    capture_plan_t plan;
+    uint64_t next_us;                       // Geplanter Beginn des letzten Fensters
+    uint64_t begin_us;                      // Beginn der laufenden Aufnahme
+
+    // Statistik (nur der Besitzer-Thread schreibt)
+    uint32_t transfer_us;                   // Geglättete Übertragungszeit
+    uint32_t transfer_dev_us;               // Geglättete Abweichung davon (Jitter)
+    uint64_t frames;
+    uint32_t late;                          // Fenster verpasst, auf das nächste verschoben
+    uint32_t failed;                        // Aufnahmen mit Fehler
+} capture_sched_t;
+
+// Tabelle unter path öffnen bzw. anlegen und einen Platz belegen.
+// path == NULL: private Tabelle, der Zyklus ist dann einfach das Intervall.
+// Rückgabe 0, -1 bei Fehler oder wenn alle Plätze belegt sind
+int capture_sched_attach(capture_sched_t *sched, const char *path, uint32_t guard_us);
+
+// Platz freigeben und Tabelle schließen
+void capture_sched_detach(capture_sched_t *sched);
+
+// Plan für einen Platz aus der Tabelle berechnen (ohne Seiteneffekte)
+void capture_bus_plan(const capture_bus_t *bus, int slot, uint64_t now_us, uint32_t guard_us,
+                      capture_plan_t *plan);
+
+// Nächster Fensterbeginn ab after_us auf der Zeitachse epoch_us + k * cycle_us + offset_us
+uint64_t capture_next_window(uint64_t after_us, uint64_t epoch_us, uint32_t cycle_us, uint32_t offset_us);
+
+// Bis zum nächsten eigenen Fenster schlafen (interval_ms = gewünschtes Intervall).
+// Rückgabe: geplanter Beginn in µs
+uint64_t capture_sched_wait(capture_sched_t *sched, int interval_ms);
+
+// Aufnahme klammern: Übertragungszeit messen und veröffentlichen
+void capture_sched_begin(capture_sched_t *sched);
+void capture_sched_end(capture_sched_t *sched, int ok);
+
+// Gemessene Übertragungszeit einrechnen (von capture_sched_end, für Tests direkt)
+void capture_sched_record(capture_sched_t *sched, uint32_t duration_us);
+
+uint64_t capture_now_us(void);
+
+#endif // CAPTURE_SCHEDULER_H
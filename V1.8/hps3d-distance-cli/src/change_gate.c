@@ -0,0 +1,113 @@
+/*
+ * Änderungs-Gate auf Basis der Paket-Kopfwerte und einer Pixel-Stichprobe
+ */
+
+#include <string.h>
+#include "packet_parser.h"
+#include "region.h"
+#include "change_gate.h"
+
+void change_gate_init(change_gate_t *gate) {
+    memset(gate, 0, sizeof(*gate));
+    gate->use_samples = 1;
+    gate->tolerance_mm = CHANGE_GATE_DEFAULT_TOLERANCE_MM;
+    gate->tolerance_saturation = 0;
+    gate->max_skip = CHANGE_GATE_DEFAULT_MAX_SKIP;
+}
+
+static inline uint16_t rd16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t rd32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+static inline int within(uint16_t a, uint16_t b, uint16_t tolerance) {
+    return (a > b ? a - b : b - a) <= tolerance;
+}
+
+// 8x8 Raster gleichmäßig über die Distanzebene, direkt aus dem Big-Endian-Paket
+static void read_samples(const uint8_t *data, int pixels, int width, uint16_t *out) {
+    int height = pixels / width;
+    const uint8_t *dist = data + PACKET_FULL_DEPTH_HEADER;
+    for (int sy = 0; sy < 8; sy++) {
+        int y = (2 * sy + 1) * height / 16;
+        for (int sx = 0; sx < 8; sx++) {
+            int x = (2 * sx + 1) * width / 16;
+            out[sy * 8 + sx] = rd16(dist + 2 * (y * width + x));
+        }
+    }
+}
+
+// Gültigkeit muss übereinstimmen; gültige Pixel dürfen um die Toleranz abweichen
+static int samples_match(const uint16_t *a, const uint16_t *b, uint16_t tolerance) {
+    int mismatch = 0;
+    for (int i = 0; i < CHANGE_GATE_SAMPLES; i++) {
+        int va = region_pixel_valid(a[i]);
+        int vb = region_pixel_valid(b[i]);
+        mismatch |= (va != vb) | (va & vb & !within(a[i], b[i], tolerance)) | (!va & !vb & (a[i] != b[i]));
+    }
+    return !mismatch;
+}
+
+change_gate_result_t change_gate_check(change_gate_t *gate, const uint8_t *data, int len,
+                                       HPS3D_EventType_t type) {
+    if (!gate->enabled || type != HPS3D_FULL_DEPTH_EVEN || !data || len < PACKET_FULL_DEPTH_HEADER) {
+        return CHANGE_GATE_PASS;
+    }
+    gate->frames_seen++;
+
+    uint16_t avg = rd16(data);
+    uint16_t min = rd16(data + 2);
+    uint16_t saturation = rd16(data + 4);
+    uint32_t frame_cnt = rd32(data + 6);
+    int width = rd16(data + 10);
+    int height = rd16(data + 12);
+    if (width == 0 && height == 0) {
+        width = SENSOR_WIDTH;   // 0x0 = festes Sensor-Layout (wie im Parser)
+        height = SENSOR_HEIGHT;
+    }
+    int pixels = width * height;
+
+    // Stichprobe nur, wenn die Distanzebene vollständig im Paket liegt
+    uint16_t samples[CHANGE_GATE_SAMPLES];
+    int have_samples = gate->use_samples && width >= 16 && height >= 16 &&
+                       pixels <= HPS3D_MAX_PIXEL_NUMBER &&
+                       len >= PACKET_FULL_DEPTH_HEADER + 2 * pixels;
+    if (have_samples) {
+        read_samples(data, pixels, width, samples);
+    }
+
+    int unchanged = gate->have_reference &&
+                    gate->consecutive_skips < gate->max_skip &&
+                    within(avg, gate->avg, gate->tolerance_mm) &&
+                    within(min, gate->min, gate->tolerance_mm) &&
+                    within(saturation, gate->saturation, gate->tolerance_saturation);
+    if (unchanged && have_samples) {
+        unchanged = samples_match(samples, gate->samples, gate->tolerance_mm);
+    }
+    // Gleicher Zähler = dasselbe Paket noch einmal
+    if (gate->have_reference && frame_cnt == gate->frame_cnt && gate->consecutive_skips < gate->max_skip) {
+        unchanged = 1;
+    }
+
+    if (unchanged) {
+        gate->consecutive_skips++;
+        gate->frames_skipped++;
+        return CHANGE_GATE_SKIP;
+    }
+
+    gate->have_reference = 1;
+    gate->avg = avg;
+    gate->min = min;
+    gate->saturation = saturation;
+    gate->frame_cnt = frame_cnt;
+    if (have_samples) {
+        memcpy(gate->samples, samples, sizeof(samples));
+    } else {
+        memset(gate->samples, 0, sizeof(gate->samples));
+    }
+    gate->consecutive_skips = 0;
+    return CHANGE_GATE_PASS;
+}
@@ -0,0 +1,60 @@
+#ifndef CHANGE_GATE_H
+#define CHANGE_GATE_H
+
+#include <stdint.h>
+#include "HPS3DUser_IF.h"
+
+/*
+ * Frame-Gate vor dem Dekodieren: vergleicht die Kopfwerte eines Full-Depth-
+ * Pakets (distance_average, distance_min, saturation_count, frame_cnt) und
+ * optional eine dünne Pixel-Stichprobe direkt im Rohpaket mit dem zuletzt
+ * durchgelassenen Frame. Unveränderte Szenen werden ohne Dekodieren,
+ * Auswertung und Publish verworfen.
+ *
+ * Verglichen wird gegen den letzten durchgelassenen Frame (nicht den
+ * Vorgänger), damit sich langsame Drift aufsummiert und das Gate auslöst.
+ */
+
+#define CHANGE_GATE_SAMPLES 64          // Pixel der Stichprobe (8x8 Raster)
+
+#define CHANGE_GATE_DEFAULT_TOLERANCE_MM 20
+#define CHANGE_GATE_DEFAULT_MAX_SKIP 20  // Spätestens jeder 21. Frame geht durch
+
+typedef enum {
+    CHANGE_GATE_SKIP = 0,
+    CHANGE_GATE_PASS = 1
+} change_gate_result_t;
+
+typedef struct {
+    // Konfiguration
+    int enabled;
+    int use_samples;                    // Pixel-Stichprobe zusätzlich prüfen
+    uint16_t tolerance_mm;              // Erlaubte Abweichung für avg/min und Stichprobe
+    uint16_t tolerance_saturation;      // Erlaubte Änderung der Sättigungsanzahl
+    uint32_t max_skip;                  // Erzwingt nach so vielen Skips einen Durchlauf
+
+    // Referenz (letzter durchgelassener Frame)
+    int have_reference;
+    uint16_t avg, min, saturation;
+    uint32_t frame_cnt;
+    uint16_t samples[CHANGE_GATE_SAMPLES];
+    uint32_t consecutive_skips;
+
+    // Statistik
+    uint32_t frames_seen;
+    uint32_t frames_skipped;
+} change_gate_t;
+
+void change_gate_init(change_gate_t *gate);
+
+// Referenz verwerfen (z.B. nach Reconnect); Zähler bleiben erhalten
+static inline void change_gate_reset(change_gate_t *gate) {
+    gate->have_reference = 0;
+    gate->consecutive_skips = 0;
+}
+
+// Rohpaket prüfen; andere Pakettypen und kurze Pakete gehen immer durch
+change_gate_result_t change_gate_check(change_gate_t *gate, const uint8_t *data, int len,
+                                       HPS3D_EventType_t type);
+
+#endif // CHANGE_GATE_H
@@ -0,0 +1,215 @@
+/*
+ * Punktwolken-Analytik auf dem SoA-Layout
+ *
+ * Alle Kernel laufen über x[], y[], z[] als getrennte Ströme; die innere
+ * Schleife enthält keine Verzweigungen, Gültigkeit wird als Maske verrechnet.
+ */
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "cloud_analytics.h"
+
+int cloud_transform(const pointcloud_soa_t *in, const float m[12], pointcloud_soa_t *out) {
+    if (!in || !m || !out || in->count > out->capacity) {
+        return -1;
+    }
+
+    const float *ix = in->x, *iy = in->y, *iz = in->z;
+    float *ox = out->x, *oy = out->y, *oz = out->z;
+    for (uint32_t i = 0; i < in->count; i++) {
+        float x = ix[i], y = iy[i], z = iz[i];
+        int valid = pointcloud_point_valid(z);
+        float tx = m[0] * x + m[1] * y + m[2] * z + m[3];
+        float ty = m[4] * x + m[5] * y + m[6] * z + m[7];
+        float tz = m[8] * x + m[9] * y + m[10] * z + m[11];
+        ox[i] = valid ? tx : x;
+        oy[i] = valid ? ty : y;
+        oz[i] = valid ? tz : z;
+    }
+
+    out->count = in->count;
+    out->width = in->width;
+    out->height = in->height;
+    return 0;
+}
+
+int cloud_voxel_workspace_init(cloud_voxel_workspace_t *ws, uint32_t max_points) {
+    if (!ws || max_points == 0) {
+        return -1;
+    }
+
+    memset(ws, 0, sizeof(*ws));
+    // Füllgrad <= 50%, damit die Sondierungsketten kurz bleiben
+    uint32_t slots = 1;
+    while (slots < max_points * 2) {
+        slots <<= 1;
+    }
+
+    ws->keys = malloc((size_t)slots * 3 * sizeof(int32_t));
+    ws->sum = malloc((size_t)slots * 3 * sizeof(float));
+    ws->count = calloc(slots, sizeof(uint32_t));
+    ws->touched = malloc((size_t)max_points * sizeof(uint32_t));
+    if (!ws->keys || !ws->sum || !ws->count || !ws->touched) {
+        cloud_voxel_workspace_free(ws);
+        return -1;
+    }
+    ws->slots = slots;
+    ws->max_points = max_points;
+    return 0;
+}
+
+void cloud_voxel_workspace_free(cloud_voxel_workspace_t *ws) {
+    if (!ws) {
+        return;
+    }
+    free(ws->keys);
+    free(ws->sum);
+    free(ws->count);
+    free(ws->touched);
+    memset(ws, 0, sizeof(*ws));
+}
+
+static inline uint32_t voxel_hash(int32_t ix, int32_t iy, int32_t iz) {
+    return ((uint32_t)ix * 73856093u) ^ ((uint32_t)iy * 19349663u) ^ ((uint32_t)iz * 83492791u);
+}
+
+int cloud_voxel_downsample(const pointcloud_soa_t *in, float voxel_size,
+                           cloud_voxel_workspace_t *ws, pointcloud_soa_t *out) {
+    if (!in || !ws || !out || voxel_size <= 0.0f || in->count > ws->max_points) {
+        return -1;
+    }
+
+    const float inv = 1.0f / voxel_size;
+    const uint32_t mask = ws->slots - 1;
+    ws->used = 0;
+
+    for (uint32_t i = 0; i < in->count; i++) {
+        float x = in->x[i], y = in->y[i], z = in->z[i];
+        if (!pointcloud_point_valid(z)) {
+            continue;
+        }
+        int32_t kx = (int32_t)floorf(x * inv);
+        int32_t ky = (int32_t)floorf(y * inv);
+        int32_t kz = (int32_t)floorf(z * inv);
+
+        uint32_t slot = voxel_hash(kx, ky, kz) & mask;
+        for (;;) {
+            int32_t *key = &ws->keys[slot * 3];
+            if (ws->count[slot] == 0) {
+                key[0] = kx;
+                key[1] = ky;
+                key[2] = kz;
+                ws->sum[slot * 3] = 0.0f;
+                ws->sum[slot * 3 + 1] = 0.0f;
+                ws->sum[slot * 3 + 2] = 0.0f;
+                ws->touched[ws->used++] = slot;
+                break;
+            }
+            if (key[0] == kx && key[1] == ky && key[2] == kz) {
+                break;
+            }
+            slot = (slot + 1) & mask;
+        }
+
+        ws->sum[slot * 3] += x;
+        ws->sum[slot * 3 + 1] += y;
+        ws->sum[slot * 3 + 2] += z;
+        ws->count[slot]++;
+    }
+
+    if (ws->used > out->capacity) {
+        for (uint32_t v = 0; v < ws->used; v++) {
+            ws->count[ws->touched[v]] = 0;
+        }
+        return -1;
+    }
+
+    // Schwerpunkte ausgeben und nur die belegten Slots zurücksetzen
+    for (uint32_t v = 0; v < ws->used; v++) {
+        uint32_t slot = ws->touched[v];
+        float n = (float)ws->count[slot];
+        out->x[v] = ws->sum[slot * 3] / n;
+        out->y[v] = ws->sum[slot * 3 + 1] / n;
+        out->z[v] = ws->sum[slot * 3 + 2] / n;
+        ws->count[slot] = 0;
+    }
+
+    out->count = ws->used;
+    out->width = 0;
+    out->height = 0;
+    return (int)ws->used;
+}
+
+static inline uint32_t ransac_rng(uint32_t *state) {
+    uint32_t s = *state;
+    s ^= s << 13;
+    s ^= s >> 17;
+    s ^= s << 5;
+    *state = s;
+    return s;
+}
+
+// Inlier zählen: branchfrei, damit der Compiler die Schleife vektorisiert
+static uint32_t count_inliers(const pointcloud_soa_t *cloud, const cloud_plane_t *p, float threshold) {
+    const float *x = cloud->x, *y = cloud->y, *z = cloud->z;
+    uint32_t inliers = 0;
+    for (uint32_t i = 0; i < cloud->count; i++) {
+        float dist = fabsf(p->a * x[i] + p->b * y[i] + p->c * z[i] + p->d);
+        inliers += (uint32_t)((dist < threshold) & pointcloud_point_valid(z[i]));
+    }
+    return inliers;
+}
+
+int cloud_ransac_plane(const pointcloud_soa_t *cloud, int iterations, float threshold,
+                       uint32_t seed, cloud_plane_t *plane) {
+    if (!cloud || !plane || cloud->count < 3 || iterations <= 0) {
+        return -1;
+    }
+
+    uint32_t state = seed ? seed : 0x9e3779b9u;
+    uint32_t best = 0;
+    const int max_draws = 16;   // Versuche, um gültige Stichprobenpunkte zu finden
+
+    for (int it = 0; it < iterations; it++) {
+        uint32_t idx[3];
+        int found = 0;
+        for (int draw = 0; draw < max_draws && found < 3; draw++) {
+            uint32_t i = ransac_rng(&state) % cloud->count;
+            if (pointcloud_point_valid(cloud->z[i])) {
+                idx[found++] = i;
+            }
+        }
+        if (found < 3) {
+            continue;
+        }
+
+        float ux = cloud->x[idx[1]] - cloud->x[idx[0]];
+        float uy = cloud->y[idx[1]] - cloud->y[idx[0]];
+        float uz = cloud->z[idx[1]] - cloud->z[idx[0]];
+        float vx = cloud->x[idx[2]] - cloud->x[idx[0]];
+        float vy = cloud->y[idx[2]] - cloud->y[idx[0]];
+        float vz = cloud->z[idx[2]] - cloud->z[idx[0]];
+
+        cloud_plane_t p;
+        p.a = uy * vz - uz * vy;
+        p.b = uz * vx - ux * vz;
+        p.c = ux * vy - uy * vx;
+        float norm = sqrtf(p.a * p.a + p.b * p.b + p.c * p.c);
+        if (norm < 1e-6f) {
+            continue;  // Kollineare Stichprobe
+        }
+        p.a /= norm;
+        p.b /= norm;
+        p.c /= norm;
+        p.d = -(p.a * cloud->x[idx[0]] + p.b * cloud->y[idx[0]] + p.c * cloud->z[idx[0]]);
+
+        uint32_t inliers = count_inliers(cloud, &p, threshold);
+        if (inliers > best) {
+            best = inliers;
+            *plane = p;
+        }
+    }
+
+    return best >= 3 ? (int)best : -1;
+}
@@ -0,0 +1,40 @@
+#ifndef CLOUD_ANALYTICS_H
+#define CLOUD_ANALYTICS_H
+
+#include <stdint.h>
+#include "pointcloud.h"
+
+// Ebene a*x + b*y + c*z + d = 0 mit |(a,b,c)| = 1
+typedef struct {
+    float a, b, c, d;
+} cloud_plane_t;
+
+// Starre Transformation mit 3x4-Matrix (zeilenweise, R|t); in == out erlaubt.
+// Ungültige Punkte (z <= 0) werden unverändert übernommen.
+int cloud_transform(const pointcloud_soa_t *in, const float m[12], pointcloud_soa_t *out);
+
+// Arbeitsbereich für die Voxel-Reduktion (offene Adressierung, einmal allokiert)
+typedef struct {
+    int32_t *keys;          // 3 Voxel-Indizes pro Slot
+    float *sum;             // 3 Summen pro Slot
+    uint32_t *count;        // Punkte pro Slot (0 = frei)
+    uint32_t *touched;      // Belegte Slots in Einfügereihenfolge (max_points Einträge)
+    uint32_t slots;         // Zweierpotenz
+    uint32_t max_points;    // Obergrenze für in->count
+    uint32_t used;
+} cloud_voxel_workspace_t;
+
+int cloud_voxel_workspace_init(cloud_voxel_workspace_t *ws, uint32_t max_points);
+void cloud_voxel_workspace_free(cloud_voxel_workspace_t *ws);
+
+// Voxel-Reduktion auf Schwerpunkte; Ergebnis ist unorganisiert.
+// Rückgabe: Anzahl Ausgabepunkte, -1 bei Fehler oder mehr als max_points Punkten
+int cloud_voxel_downsample(const pointcloud_soa_t *in, float voxel_size,
+                           cloud_voxel_workspace_t *ws, pointcloud_soa_t *out);
+
+// RANSAC-Ebenenfit über gültige Punkte; seed macht das Ergebnis reproduzierbar.
+// Rückgabe: Anzahl Inlier der besten Ebene, -1 wenn keine Ebene gefunden
+int cloud_ransac_plane(const pointcloud_soa_t *cloud, int iterations, float threshold,
+                       uint32_t seed, cloud_plane_t *plane);
+
+#endif // CLOUD_ANALYTICS_H
@@ -0,0 +1,153 @@
+/*
+ * Tiefenhistogramm über Rechtecke der Distanzebene
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "depth_histogram.h"
+#include "region.h"
+
+int depth_hist_range_init(depth_hist_range_t *range, int bins, uint16_t min_mm, uint16_t max_mm) {
+    if (bins < 1 || bins > DEPTH_HIST_MAX_BINS || max_mm <= min_mm || max_mm - min_mm <= bins) {
+        return -1;
+    }
+    range->bins = bins;
+    range->min_mm = min_mm;
+    range->max_mm = max_mm;
+    // ceil(2^32 * bins / span) < 2^32, da bins < span. Für n < 2^16 ist der Fehler
+    // von n * scale / 2^32 kleiner als 2^-16 <= 1/span - jeder nicht ganzzahlige
+    // Rest von n * bins / span ist größer, die Klasse damit exakt floor(n * bins / span)
+    uint64_t span = (uint64_t)(max_mm - min_mm);
+    range->scale = (uint32_t)((((uint64_t)bins << 32) + span - 1) / span);
+    return 0;
+}
+
+void depth_hist_partial_clear(depth_hist_partial_t *partial, const depth_hist_range_t *range) {
+    for (int l = 0; l < DEPTH_HIST_LANES; l++) {
+        memset(partial->lanes[l], 0, (size_t)(range->bins + 3) * sizeof(partial->lanes[l][0]));
+    }
+}
+
+// Zählerindex je Pixel einer Zeile, ohne Sprünge (wird vektorisiert)
+static void bin_indices(uint16_t *KERNEL_RESTRICT idx, const uint16_t *KERNEL_RESTRICT d, int n,
+                        uint32_t min, uint32_t max, uint32_t scale, uint32_t bins) {
+    KERNEL_UNROLL(8)
+    for (int x = 0; x < n; x++) {
+        uint32_t v = d[x];
+        uint32_t b = (uint32_t)(((uint64_t)(v - min) * scale) >> 32);    // Für v < min wertlos, unten verworfen
+        uint32_t i = v < min ? 0 : v >= max ? bins + 1 : b + 1;
+        idx[x] = (uint16_t)(region_pixel_valid(d[x]) ? i : bins + 2);
+    }
+}
+
+void depth_hist_accumulate(depth_hist_partial_t *partial, const depth_hist_range_t *range, const uint16_t *distance,
+                           int stride, int x0, int y0, int w, int h) {
+    uint16_t idx[SENSOR_WIDTH];
+    for (int y = y0; y < y0 + h; y++) {
+        bin_indices(idx, distance + (long)y * stride + x0, w, range->min_mm, range->max_mm, range->scale,
+                    (uint32_t)range->bins);
+        int x = 0;
+        for (; x + DEPTH_HIST_LANES <= w; x += DEPTH_HIST_LANES) {
+            partial->lanes[0][idx[x]]++;
+            partial->lanes[1][idx[x + 1]]++;
+            partial->lanes[2][idx[x + 2]]++;
+            partial->lanes[3][idx[x + 3]]++;
+        }
+        for (; x < w; x++) {
+            partial->lanes[0][idx[x]]++;
+        }
+    }
+}
+
+void depth_hist_reset(depth_hist_t *hist, const depth_hist_range_t *range) {
+    memset(hist, 0, sizeof(*hist));
+    hist->bins = range->bins;
+    hist->min_mm = range->min_mm;
+    hist->max_mm = range->max_mm;
+}
+
+void depth_hist_merge(depth_hist_t *hist, const depth_hist_partial_t *partial) {
+    int bins = hist->bins;
+    for (int l = 0; l < DEPTH_HIST_LANES; l++) {
+        const uint32_t *lane = partial->lanes[l];
+        hist->below += lane[0];
+        for (int b = 0; b < bins; b++) {
+            hist->count[b] += lane[b + 1];
+        }
+        hist->above += lane[bins + 1];
+        hist->invalid += lane[bins + 2];
+    }
+}
+
+void depth_hist_compute(depth_hist_t *hist, depth_hist_partial_t *scratch, const depth_hist_range_t *range,
+                        const uint16_t *distance, int stride, int x0, int y0, int w, int h) {
+    depth_hist_partial_clear(scratch, range);
+    depth_hist_accumulate(scratch, range, distance, stride, x0, y0, w, h);
+    depth_hist_reset(hist, range);
+    depth_hist_merge(hist, scratch);
+}
+
+// Untere Grenze von Klasse k in mm (k = bins: max_mm)
+static uint16_t bin_edge(const depth_hist_t *hist, int k) {
+    uint32_t span = (uint32_t)(hist->max_mm - hist->min_mm);
+    return (uint16_t)(hist->min_mm + (span * (uint32_t)k + (uint32_t)hist->bins / 2) / (uint32_t)hist->bins);
+}
+
+int depth_hist_auto_range(const depth_hist_t *hist, float low_pct, float high_pct, uint16_t *lo_mm, uint16_t *hi_mm) {
+    uint64_t total = (uint64_t)hist->below + hist->above;
+    for (int b = 0; b < hist->bins; b++) {
+        total += hist->count[b];
+    }
+    if (total == 0) {
+        return -1;
+    }
+    double rank_lo = low_pct / 100.0 * (double)total;
+    double rank_hi = high_pct / 100.0 * (double)total;
+
+    // Erste Klasse, deren Summe den unteren Rang übersteigt, und erste, die den oberen erreicht
+    uint64_t cum = hist->below;
+    *lo_mm = hist->min_mm;
+    *hi_mm = hist->max_mm;
+    int lo_found = (double)cum > rank_lo;
+    if ((double)cum >= rank_hi && cum > 0) {
+        *hi_mm = hist->min_mm;
+        return 0;
+    }
+    for (int b = 0; b < hist->bins; b++) {
+        cum += hist->count[b];
+        if (!lo_found && (double)cum > rank_lo) {
+            *lo_mm = bin_edge(hist, b);
+            lo_found = 1;
+        }
+        if ((double)cum >= rank_hi) {
+            *hi_mm = bin_edge(hist, b + 1);
+            return 0;
+        }
+    }
+    // Beide Ränge liegen oberhalb des Bereichs
+    if (!lo_found) {
+        *lo_mm = hist->max_mm;
+    }
+    return 0;
+}
+
+int depth_hist_counts_json(const depth_hist_t *hist, char *out, size_t size) {
+    if (size < 3) {
+        return -1;
+    }
+    size_t pos = 0;
+    out[pos++] = '[';
+    for (int b = 0; b < hist->bins; b++) {
+        int n = snprintf(out + pos, size - pos, b ? ",%u" : "%u", hist->count[b]);
+        if (n < 0 || (size_t)n >= size - pos) {
+            return -1;
+        }
+        pos += (size_t)n;
+    }
+    if (pos + 2 > size) {
+        return -1;
+    }
+    out[pos++] = ']';
+    out[pos] = '\0';
+    return (int)pos;
+}
@@ -0,0 +1,74 @@
+#ifndef DEPTH_HISTOGRAM_H
+#define DEPTH_HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "sensor_geometry.h"
+
+/*
+ * Tiefenhistogramm über Rechtecke der Distanzebene
+ *
+ * bins gleich breite Klassen über [min_mm, max_mm); gültige Pixel darunter
+ * bzw. darüber zählen in below/above, ungültige (region_pixel_valid) in
+ * invalid. Die Klasse eines Pixels entsteht branchfrei per Festkomma-
+ * Multiplikation (exakt wie eine Ganzzahl-Division) über eine ganze Zeile
+ * (vektorisierbar). Gezählt wird in DEPTH_HIST_LANES verschränkte
+ * Teilhistogramme, damit aufeinanderfolgende Pixel derselben Klasse nicht
+ * auf denselben Zähler warten.
+ *
+ * Teilhistogramme lassen sich auch über Zeilenbänder getrennt füllen (z.B.
+ * je Thread) und mit depth_hist_merge() zusammenführen.
+ */
+
+#define DEPTH_HIST_MAX_BINS 256
+#define DEPTH_HIST_LANES 4
+
+typedef struct {
+    int bins;
+    uint16_t min_mm;
+    uint16_t max_mm;                    // Exklusiv
+    uint32_t scale;                     // bins / (max_mm - min_mm), 0.32 Festkomma
+} depth_hist_range_t;
+
+typedef struct {
+    // Index 0 = below, 1..bins = Klassen, bins+1 = above, bins+2 = ungültig
+    uint32_t lanes[DEPTH_HIST_LANES][DEPTH_HIST_MAX_BINS + 3];
+} depth_hist_partial_t;
+
+typedef struct {
+    int bins;
+    uint16_t min_mm;
+    uint16_t max_mm;
+    uint32_t count[DEPTH_HIST_MAX_BINS];
+    uint32_t below;
+    uint32_t above;
+    uint32_t invalid;
+} depth_hist_t;
+
+// Rückgabe 0, -1 wenn bins nicht in 1..DEPTH_HIST_MAX_BINS liegt oder eine
+// Klasse nicht breiter als 1 mm wäre
+int depth_hist_range_init(depth_hist_range_t *range, int bins, uint16_t min_mm, uint16_t max_mm);
+
+void depth_hist_partial_clear(depth_hist_partial_t *partial, const depth_hist_range_t *range);
+
+// Rechteck w x h ab (x0,y0) hinzuzählen; w <= SENSOR_WIDTH, Grenzen garantiert der Aufrufer
+void depth_hist_accumulate(depth_hist_partial_t *partial, const depth_hist_range_t *range, const uint16_t *distance,
+                           int stride, int x0, int y0, int w, int h);
+
+// Ergebnis leeren bzw. ein Teilhistogramm (alle Lanes) hinzuaddieren
+void depth_hist_reset(depth_hist_t *hist, const depth_hist_range_t *range);
+void depth_hist_merge(depth_hist_t *hist, const depth_hist_partial_t *partial);
+
+// Leeren, zählen und zusammenführen in einem Schritt; scratch wird überschrieben
+void depth_hist_compute(depth_hist_t *hist, depth_hist_partial_t *scratch, const depth_hist_range_t *range,
+                        const uint16_t *distance, int stride, int x0, int y0, int w, int h);
+
+// Bereich [lo_mm, hi_mm] zwischen den Perzentilen low_pct und high_pct der
+// gültigen Pixel, auf Klassengrenzen gerundet (für die Farbskala einer
+// Tiefenansicht). Rückgabe 0, -1 ohne gültige Pixel
+int depth_hist_auto_range(const depth_hist_t *hist, float low_pct, float high_pct, uint16_t *lo_mm, uint16_t *hi_mm);
+
+// Klassen als kompaktes JSON-Array "[n0,n1,...]"; Rückgabe Länge, -1 wenn out zu klein ist
+int depth_hist_counts_json(const depth_hist_t *hist, char *out, size_t size);
+
+#endif // DEPTH_HISTOGRAM_H
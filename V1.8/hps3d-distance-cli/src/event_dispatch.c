@@ -0,0 +1,224 @@
+/*
+ * Callback-Verteilung nach Handle mit lock-freier Übergabe an die Pipeline
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "event_dispatch.h"
+
+#define SLOT_CLAIMED (-2)               // Slot reserviert, Puffer werden gerade angelegt
+
+static event_device_t devices[EVENT_DISPATCH_MAX_DEVICES];
+static _Atomic uint32_t unrouted = 0;
+static int initialized = 0;
+static uint32_t pool_buffers;
+static int pool_buf_size;
+
+// Puffer eines Slots erst beim ersten attach() anlegen; sie bleiben bis shutdown()
+static int device_alloc(event_device_t *dev) {
+    if (dev->ready_slots) {
+        return 0;
+    }
+    if (frame_pool_init(&dev->pool, pool_buffers, pool_buf_size) != 0) {
+        return -1;
+    }
+    dev->ready_slots = calloc(dev->pool.count, sizeof(void *));
+    if (!dev->ready_slots ||
+        spsc_ring_init(&dev->ready, dev->ready_slots, dev->pool.count) != 0 ||
+        sem_init(&dev->ready_sem, 0, 0) != 0) {
+        frame_pool_destroy(&dev->pool);
+        free(dev->ready_slots);
+        dev->ready_slots = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+int event_dispatch_init(uint32_t buffers_per_device, int buf_size) {
+    if (initialized) {
+        return 0;
+    }
+    if (buffers_per_device == 0 || buf_size <= 0) {
+        return -1;
+    }
+
+    for (int i = 0; i < EVENT_DISPATCH_MAX_DEVICES; i++) {
+        memset(&devices[i], 0, sizeof(devices[i]));
+        atomic_init(&devices[i].handle, -1);
+    }
+    pool_buffers = buffers_per_device;
+    pool_buf_size = buf_size;
+    initialized = 1;
+    return 0;
+}
+
+void event_dispatch_shutdown(void) {
+    if (!initialized) {
+        return;
+    }
+    for (int i = 0; i < EVENT_DISPATCH_MAX_DEVICES; i++) {
+        atomic_store(&devices[i].handle, -1);
+        if (devices[i].ready_slots) {
+            sem_destroy(&devices[i].ready_sem);
+            free(devices[i].ready_slots);
+            frame_pool_destroy(&devices[i].pool);
+        }
+        memset(&devices[i], 0, sizeof(devices[i]));
+    }
+    initialized = 0;
+}
+
+static event_device_t *find_device(int handle) {
+    for (int i = 0; i < EVENT_DISPATCH_MAX_DEVICES; i++) {
+        if (atomic_load_explicit(&devices[i].handle, memory_order_acquire) == handle) {
+            return &devices[i];
+        }
+    }
+    return NULL;
+}
+
+// Läuft im SDK-Empfangsthread: nur kopieren, einreihen, signalisieren
+void event_dispatch_callback(int handle, int eventType, uint8_t *data, int dataLen, void *userPara) {
+    (void)userPara;
+
+    event_device_t *dev = (handle >= 0 && initialized) ? find_device(handle) : NULL;
+    if (!dev) {
+        atomic_fetch_add_explicit(&unrouted, 1, memory_order_relaxed);
+        return;
+    }
+
+    if ((HPS3D_EventType_t)eventType == HPS3D_DISCONNECT_EVEN) {
+        atomic_store_explicit(&dev->disconnected, 1, memory_order_release);
+    }
+
+    int len = (data && dataLen > 0) ? dataLen : 0;
+    if (len > dev->pool.buf_size) {
+        if ((HPS3D_EventType_t)eventType != HPS3D_SYS_EXCEPTION_EVEN) {
+            atomic_fetch_add_explicit(&dev->oversized, 1, memory_order_relaxed);
+            return;
+        }
+        len = dev->pool.buf_size;  // Fehlertext darf gekürzt werden
+    }
+
+    frame_buf_t *buf = frame_pool_acquire(&dev->pool);
+    if (!buf) {
+        atomic_fetch_add_explicit(&dev->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    if (len > 0) {
+        memcpy(buf->data, data, (size_t)len);
+    }
+    buf->len = len;
+    buf->handle = handle;
+    buf->event_type = eventType;
+    buf->seq = atomic_fetch_add_explicit(&dev->seq, 1, memory_order_relaxed);
+    clock_gettime(CLOCK_MONOTONIC, &buf->received);
+
+    // Ready-Ring hat so viele Slots wie der Pool Puffer - kann nicht überlaufen
+    spsc_ring_push(&dev->ready, buf);
+    atomic_fetch_add_explicit(&dev->received, 1, memory_order_relaxed);
+    sem_post(&dev->ready_sem);
+}
+
+event_device_t *event_dispatch_attach(int handle) {
+    if (!initialized || handle < 0) {
+        return NULL;
+    }
+
+    event_device_t *dev = find_device(handle);
+    if (dev) {
+        return dev;
+    }
+
+    for (int i = 0; i < EVENT_DISPATCH_MAX_DEVICES; i++) {
+        int expected = -1;
+        dev = &devices[i];
+        if (atomic_compare_exchange_strong(&dev->handle, &expected, SLOT_CLAIMED)) {
+            // Reservierter Slot ist für den Callback unsichtbar, bis das Handle gesetzt ist
+            if (device_alloc(dev) != 0) {
+                atomic_store(&dev->handle, -1);
+                return NULL;
+            }
+
+            // Reste eines vorherigen Handles verwerfen
+            frame_buf_t *stale;
+            while ((stale = event_dispatch_next(dev, 0)) != NULL) {
+                event_dispatch_release(dev, stale);
+            }
+            atomic_store(&dev->disconnected, 0);
+            atomic_store(&dev->seq, 0);
+            atomic_store(&dev->received, 0);
+            atomic_store(&dev->dropped, 0);
+            atomic_store(&dev->oversized, 0);
+            atomic_store_explicit(&dev->handle, handle, memory_order_release);
+            return dev;
+        }
+    }
+    return NULL;
+}
+
+void event_dispatch_detach(event_device_t *dev) {
+    if (!dev) {
+        return;
+    }
+    atomic_store_explicit(&dev->handle, -1, memory_order_release);
+
+    frame_buf_t *buf;
+    while ((buf = event_dispatch_next(dev, 0)) != NULL) {
+        event_dispatch_release(dev, buf);
+    }
+}
+
+frame_buf_t *event_dispatch_next(event_device_t *dev, int timeout_ms) {
+    if (!dev) {
+        return NULL;
+    }
+
+    int ret;
+    if (timeout_ms <= 0) {
+        ret = sem_trywait(&dev->ready_sem);
+    } else {
+        struct timespec deadline;
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+        while ((ret = sem_timedwait(&dev->ready_sem, &deadline)) != 0 && errno == EINTR) {
+            // Signal unterbrochen - weiter warten
+        }
+    }
+    if (ret != 0) {
+        return NULL;
+    }
+    return (frame_buf_t *)spsc_ring_pop(&dev->ready);
+}
+
+void event_dispatch_release(event_device_t *dev, frame_buf_t *buf) {
+    if (dev && buf) {
+        frame_pool_release(&dev->pool, buf);
+    }
+}
+
+int event_dispatch_take_disconnect(event_device_t *dev) {
+    return dev ? atomic_exchange(&dev->disconnected, 0) : 0;
+}
+
+void event_dispatch_get_stats(event_device_t *dev, event_dispatch_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
+    stats->unrouted = atomic_load_explicit(&unrouted, memory_order_relaxed);
+    if (!dev) {
+        return;
+    }
+    stats->received = atomic_load_explicit(&dev->received, memory_order_relaxed);
+    stats->dropped = atomic_load_explicit(&dev->dropped, memory_order_relaxed);
+    stats->oversized = atomic_load_explicit(&dev->oversized, memory_order_relaxed);
+    stats->queued = spsc_ring_count(&dev->ready);
+}
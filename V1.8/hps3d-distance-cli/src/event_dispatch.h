@@ -0,0 +1,68 @@
+#ifndef EVENT_DISPATCH_H
+#define EVENT_DISPATCH_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <semaphore.h>
+#include "HPS3DUser_IF.h"
+#include "frame_pool.h"
+
+/*
+ * Verteilt die globalen SDK-Callbacks (HPS3D_RegisterEventCallback kennt nur
+ * einen Callback und einen userPara) nach Handle auf Geräte-Kontexte.
+ *
+ * Der SDK-Empfangsthread kopiert das Paket nur in einen Puffer aus dem Pool
+ * des Geräts und reiht ihn in dessen lock-freie Warteschlange ein. Dekodieren
+ * und alles Weitere passiert im Pipeline-Thread des Geräts. Ist kein Puffer
+ * frei, wird das Paket verworfen und gezählt - der SDK-Thread wartet nie.
+ *
+ * Pro Gerät gilt: ein Produzent (SDK-Thread), ein Konsument (Pipeline).
+ */
+
+#define EVENT_DISPATCH_MAX_DEVICES 4
+#define EVENT_DISPATCH_BUFFERS 8       // Puffer pro Gerät (Zweierpotenz)
+
+typedef struct {
+    _Atomic int handle;                // -1 = Slot frei
+    frame_pool_t pool;
+    spsc_ring_t ready;                 // SDK-Thread -> Pipeline
+    void **ready_slots;
+    sem_t ready_sem;
+    _Atomic uint32_t seq;
+    _Atomic uint32_t received;         // Eingereihte Pakete
+    _Atomic uint32_t dropped;          // Kein freier Puffer
+    _Atomic uint32_t oversized;        // Paket größer als Puffer
+    _Atomic int disconnected;          // Geht nie verloren, auch ohne freien Puffer
+} event_device_t;
+
+typedef struct {
+    uint32_t received;
+    uint32_t dropped;
+    uint32_t oversized;
+    uint32_t queued;
+    uint32_t unrouted;                 // Pakete ohne zugeordnetes Gerät (global)
+} event_dispatch_stats_t;
+
+// Geräte-Slots einmalig vorbereiten; die Puffer eines Slots werden erst beim
+// ersten attach() angelegt. Rückgabe 0 / -1
+int event_dispatch_init(uint32_t buffers_per_device, int buf_size);
+void event_dispatch_shutdown(void);
+
+// Als Callback an HPS3D_RegisterEventCallback übergeben
+void event_dispatch_callback(int handle, int eventType, uint8_t *data, int dataLen, void *userPara);
+
+// Handle einem freien Slot zuordnen (vor StartCapture); NULL wenn alle belegt
+// oder die Puffer nicht angelegt werden konnten
+event_device_t *event_dispatch_attach(int handle);
+// Slot freigeben (nach StopCapture/CloseDevice); liegengebliebene Pakete gehen zurück in den Pool
+void event_dispatch_detach(event_device_t *dev);
+
+// Nächstes Paket oder NULL nach timeout_ms (0 = nicht warten)
+frame_buf_t *event_dispatch_next(event_device_t *dev, int timeout_ms);
+void event_dispatch_release(event_device_t *dev, frame_buf_t *buf);
+
+// Liefert 1 einmalig nach einem Disconnect-Event
+int event_dispatch_take_disconnect(event_device_t *dev);
+void event_dispatch_get_stats(event_device_t *dev, event_dispatch_stats_t *stats);
+
+#endif // EVENT_DISPATCH_H
@@ -0,0 +1,57 @@
+/*
+ * Vorallokierte Paketpuffer mit lock-freier Freiliste
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <string.h>
+#include "frame_pool.h"
+
+#define FRAME_POOL_ALIGN 64
+
+int frame_pool_init(frame_pool_t *pool, uint32_t count, int buf_size) {
+    if (!pool || count == 0 || buf_size <= 0) {
+        return -1;
+    }
+
+    memset(pool, 0, sizeof(*pool));
+    uint32_t slots = 1;
+    while (slots < count) {
+        slots <<= 1;
+    }
+
+    // Puffer auf Cache-Lines ausrichten, damit Decoder-Kernel ausgerichtet lesen
+    size_t stride = ((size_t)buf_size + FRAME_POOL_ALIGN - 1) / FRAME_POOL_ALIGN * FRAME_POOL_ALIGN;
+    void *block = NULL;
+    if (posix_memalign(&block, FRAME_POOL_ALIGN, stride * slots) != 0) {
+        return -1;
+    }
+    pool->storage = block;
+    pool->bufs = calloc(slots, sizeof(frame_buf_t));
+    pool->free_slots = calloc(slots, sizeof(void *));
+    if (!pool->bufs || !pool->free_slots ||
+        spsc_ring_init(&pool->free_ring, pool->free_slots, slots) != 0) {
+        frame_pool_destroy(pool);
+        return -1;
+    }
+
+    pool->count = slots;
+    pool->buf_size = buf_size;
+    for (uint32_t i = 0; i < slots; i++) {
+        pool->bufs[i].data = pool->storage + i * stride;
+        pool->bufs[i].capacity = buf_size;
+        spsc_ring_push(&pool->free_ring, &pool->bufs[i]);
+    }
+    return 0;
+}
+
+void frame_pool_destroy(frame_pool_t *pool) {
+    if (!pool) {
+        return;
+    }
+    free(pool->storage);
+    free(pool->bufs);
+    free(pool->free_slots);
+    memset(pool, 0, sizeof(*pool));
+}
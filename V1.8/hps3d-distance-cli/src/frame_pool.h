@@ -0,0 +1,51 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <stdint.h>
+#include <time.h>
+#include "spsc_ring.h"
+
+// Ein Rohpaket wie vom SDK geliefert, plus Metadaten
+typedef struct {
+    uint8_t *data;            // Zeigt in den Speicherblock des Pools
+    int len;                  // Belegte Bytes
+    int capacity;             // Größe des Puffers
+    int handle;               // Geräte-Handle der Quelle
+    int event_type;           // HPS3D_EventType_t
+    uint32_t seq;             // Laufende Nummer pro Gerät
+    struct timespec received; // CLOCK_MONOTONIC beim Eintreffen
+} frame_buf_t;
+
+/*
+ * Fester Satz vorallokierter Paketpuffer. Die Freiliste ist ein SPSC-Ring:
+ * genau ein Thread holt Puffer (acquire), genau ein Thread gibt sie zurück
+ * (release). Im Betrieb wird nichts allokiert.
+ */
+typedef struct {
+    frame_buf_t *bufs;
+    uint8_t *storage;
+    void **free_slots;
+    spsc_ring_t free_ring;
+    uint32_t count;
+    int buf_size;
+} frame_pool_t;
+
+// count wird auf die nächste Zweierpotenz aufgerundet; Rückgabe 0 / -1
+int frame_pool_init(frame_pool_t *pool, uint32_t count, int buf_size);
+void frame_pool_destroy(frame_pool_t *pool);
+
+// Nicht blockierend; NULL wenn alle Puffer in Benutzung sind
+static inline frame_buf_t *frame_pool_acquire(frame_pool_t *pool) {
+    return (frame_buf_t *)spsc_ring_pop(&pool->free_ring);
+}
+
+static inline void frame_pool_release(frame_pool_t *pool, frame_buf_t *buf) {
+    buf->len = 0;
+    spsc_ring_push(&pool->free_ring, buf);  // Kann nicht voll sein: nur eigene Puffer
+}
+
+static inline uint32_t frame_pool_available(frame_pool_t *pool) {
+    return spsc_ring_count(&pool->free_ring);
+}
+
+#endif // FRAME_POOL_H
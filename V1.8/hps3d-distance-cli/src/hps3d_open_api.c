@@ -0,0 +1,497 @@
+/*
+ * Offene Implementierung der HPS3DAPI_* Schnittstelle (HPS3DBase_IF.h) über
+ * serial_transport. Experimentell und kein Ersatz für libHPS3D: das
+ * Leitungsformat ist das eigene aus serial_transport.h, ein echtes Gerät
+ * versteht es nicht. Nur Tests und pty-Emulator bauen die Datei mit
+ * -DHPS3D_OPEN_TRANSPORT; der Dienst linkt weiterhin libHPS3D.
+ *
+ * Pro Gerät ein Lesethread: Messdaten-Frames gehen direkt aus dem Pool-Puffer
+ * an den registrierten Callback, Antworten auf Befehle an den wartenden
+ * Aufrufer. Befehle eines Geräts laufen nacheinander (write_mutex).
+ * Nur USB/seriell; die Ethernet-Funktionen melden HPS3D_RET_ERROR.
+ */
+
+#ifdef HPS3D_OPEN_TRANSPORT
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "HPS3DUser_IF.h"
+#include "packet_parser.h"
+#include "serial_transport.h"
+
+#define OPEN_MAX_DEVICES 4
+#define OPEN_POOL_BUFFERS 4            // Im Bau, Einzelmessung, Reserve
+#define OPEN_REPLY_TIMEOUT_MS 1000
+#define OPEN_POLL_MS 100               // Wie oft der Lesethread nach stop schaut
+#define OPEN_REPLY_MAX 128
+#define OPEN_SETTINGS_FIELDS 16        // HPS3D_DeviceSettings_t als int32/float BE
+#define OPEN_SDK_VERSION "HPS3D open serial transport 1.0"
+
+typedef struct {
+    int used;
+    int handle;
+    int fd;
+    _Atomic int connected;
+    _Atomic int started;
+    _Atomic int stop;
+    pthread_t reader_tid;
+    frame_pool_t pool;
+    wire_reader_t reader;
+
+    pthread_mutex_t write_mutex;       // Ein Befehl zur Zeit
+    pthread_mutex_t mutex;             // Übergabe der Antwort
+    pthread_cond_t cond;
+    int wait_cmd;                      // Erwartete Antwort, -1 = keine
+    int reply_ready;
+    int reply_status;
+    uint8_t reply[OPEN_REPLY_MAX];
+    int reply_len;
+    frame_buf_t *single;               // Letzte Einzelmessung, gültig bis zur nächsten
+
+    char version[OPEN_REPLY_MAX];
+    char serial[OPEN_REPLY_MAX];
+} open_device_t;
+
+static open_device_t devices[OPEN_MAX_DEVICES];
+static pthread_mutex_t devices_mutex = PTHREAD_MUTEX_INITIALIZER;
+static HPS3DAPI_EVENT_CALLBACK _Atomic event_callback;
+static void *_Atomic event_user;
+
+static open_device_t *device_for(int handle) {
+    if (handle < 0 || handle >= OPEN_MAX_DEVICES || !devices[handle].used) {
+        return NULL;
+    }
+    return &devices[handle];
+}
+
+static void notify(int handle, int type, uint8_t *data, int len) {
+    HPS3DAPI_EVENT_CALLBACK cb = atomic_load(&event_callback);
+    if (cb) {
+        cb(handle, type, data, len, atomic_load(&event_user));
+    }
+}
+
+// Frame verteilen; läuft im Lesethread, der als einziger Puffer holt und zurückgibt
+static void dispatch(open_device_t *dev, frame_buf_t *buf) {
+    const wire_framing_t *f = dev->reader.framing;
+    uint8_t cmd = wire_frame_cmd(f, buf);
+    int len = wire_frame_payload_len(f, buf);
+
+    if (cmd == WIRE_CMD_DATA) {
+        notify(dev->handle, buf->event_type, wire_frame_payload(f, buf), len);
+        frame_pool_release(&dev->pool, buf);
+        return;
+    }
+
+    pthread_mutex_lock(&dev->mutex);
+    if (cmd != dev->wait_cmd || dev->reply_ready) {
+        pthread_mutex_unlock(&dev->mutex);
+        frame_pool_release(&dev->pool, buf);  // Verspätete oder unerwartete Antwort
+        return;
+    }
+    dev->reply_status = wire_frame_status(f, buf);
+    if (cmd == WIRE_CMD_SINGLE) {
+        // Kein Umkopieren: der Aufrufer liest direkt aus dem Pool-Puffer
+        if (dev->single) {
+            frame_pool_release(&dev->pool, dev->single);
+        }
+        dev->single = buf;
+        buf = NULL;
+    } else {
+        dev->reply_len = len < OPEN_REPLY_MAX ? len : OPEN_REPLY_MAX;
+        memcpy(dev->reply, wire_frame_payload(f, buf), (size_t)dev->reply_len);
+    }
+    dev->reply_ready = 1;
+    pthread_cond_signal(&dev->cond);
+    pthread_mutex_unlock(&dev->mutex);
+    if (buf) {
+        frame_pool_release(&dev->pool, buf);
+    }
+}
+
+static void *reader_thread(void *arg) {
+    open_device_t *dev = arg;
+    struct pollfd pfd = {.fd = dev->fd, .events = POLLIN};
+
+    while (!atomic_load(&dev->stop)) {
+        if (poll(&pfd, 1, OPEN_POLL_MS) < 0 && errno != EINTR) {
+            break;
+        }
+        int ret;
+        frame_buf_t *buf;
+        while ((ret = wire_reader_poll(&dev->reader, &buf)) == 1) {
+            dispatch(dev, buf);
+        }
+        if (ret < 0) {
+            break;
+        }
+    }
+
+    if (!atomic_load(&dev->stop)) {
+        // Verbindung verloren: Wartende wecken, Anwendung informieren
+        atomic_store(&dev->connected, 0);
+        atomic_store(&dev->started, 0);
+        pthread_mutex_lock(&dev->mutex);
+        pthread_cond_broadcast(&dev->cond);
+        pthread_mutex_unlock(&dev->mutex);
+        notify(dev->handle, HPS3D_DISCONNECT_EVEN, NULL, 0);
+    }
+    return NULL;
+}
+
+// Befehl senden und auf die Antwort mit gleichem cmd warten
+static int transact(open_device_t *dev, uint8_t cmd, const void *payload, uint32_t len) {
+    if (!atomic_load(&dev->connected)) {
+        return HPS3D_RET_CONNECT_FAILED;
+    }
+    pthread_mutex_lock(&dev->write_mutex);
+    pthread_mutex_lock(&dev->mutex);
+    dev->wait_cmd = cmd;
+    dev->reply_ready = 0;
+    pthread_mutex_unlock(&dev->mutex);
+
+    int ret = HPS3D_RET_OK;
+    if (wire_write_frame(dev->fd, dev->reader.framing, cmd, 0, payload, len, OPEN_REPLY_TIMEOUT_MS) != 0) {
+        ret = HPS3D_RET_WRITE_ERR;
+    }
+
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += OPEN_REPLY_TIMEOUT_MS / 1000;
+    deadline.tv_nsec += (OPEN_REPLY_TIMEOUT_MS % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    pthread_mutex_lock(&dev->mutex);
+    while (ret == HPS3D_RET_OK && !dev->reply_ready && atomic_load(&dev->connected)) {
+        if (pthread_cond_timedwait(&dev->cond, &dev->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    if (ret == HPS3D_RET_OK) {
+        ret = !dev->reply_ready ? HPS3D_RET_READ_ERR :
+              dev->reply_status == WIRE_STATUS_OK || cmd == WIRE_CMD_SINGLE ? HPS3D_RET_OK : HPS3D_RET_ERROR;
+    }
+    dev->wait_cmd = -1;
+    pthread_mutex_unlock(&dev->mutex);
+    pthread_mutex_unlock(&dev->write_mutex);
+    return ret;
+}
+
+static int command_u8(int handle, uint8_t cmd, uint8_t value) {
+    open_device_t *dev = device_for(handle);
+    return dev ? transact(dev, cmd, &value, 1) : HPS3D_RET_ERROR;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+// Textantwort (Version, Seriennummer) in out übernehmen
+static void reply_text(open_device_t *dev, char *out) {
+    int len = dev->reply_len < OPEN_REPLY_MAX - 1 ? dev->reply_len : OPEN_REPLY_MAX - 1;
+    memcpy(out, dev->reply, (size_t)len);
+    out[len] = '\0';
+}
+
+static void release_device(open_device_t *dev) {
+    if (dev->single) {
+        frame_pool_release(&dev->pool, dev->single);
+        dev->single = NULL;
+    }
+    wire_reader_reset(&dev->reader);
+    frame_pool_destroy(&dev->pool);
+    close(dev->fd);
+    pthread_cond_destroy(&dev->cond);
+    pthread_mutex_destroy(&dev->mutex);
+    pthread_mutex_destroy(&dev->write_mutex);
+    pthread_mutex_lock(&devices_mutex);
+    dev->used = 0;
+    pthread_mutex_unlock(&devices_mutex);
+}
+
+int HPS3DAPI_USBConnectDevice(char *portName, int *deviceHandler) {
+    if (!portName || !deviceHandler) {
+        return HPS3D_RET_ERROR;
+    }
+    pthread_mutex_lock(&devices_mutex);
+    open_device_t *dev = NULL;
+    for (int i = 0; i < OPEN_MAX_DEVICES && !dev; i++) {
+        if (!devices[i].used) {
+            dev = &devices[i];
+            memset(dev, 0, sizeof(*dev));
+            dev->used = 1;
+            dev->handle = i;
+        }
+    }
+    pthread_mutex_unlock(&devices_mutex);
+    if (!dev) {
+        return HPS3D_RET_BUSY;
+    }
+
+    const wire_framing_t *framing = &WIRE_FRAMING_DEFAULT;
+    dev->fd = serial_open_low_latency(portName);
+    if (dev->fd < 0 ||
+        frame_pool_init(&dev->pool, OPEN_POOL_BUFFERS,
+                        framing->header_len + PACKET_MAX_SIZE + framing->trailer_len) != 0) {
+        if (dev->fd >= 0) {
+            close(dev->fd);
+        }
+        pthread_mutex_lock(&devices_mutex);
+        dev->used = 0;
+        pthread_mutex_unlock(&devices_mutex);
+        return HPS3D_RET_CONNECT_FAILED;
+    }
+    wire_reader_init(&dev->reader, dev->fd, framing, &dev->pool);
+    pthread_mutex_init(&dev->write_mutex, NULL);
+    pthread_mutex_init(&dev->mutex, NULL);
+    pthread_cond_init(&dev->cond, NULL);
+    dev->wait_cmd = -1;
+    atomic_store(&dev->connected, 1);
+
+    if (pthread_create(&dev->reader_tid, NULL, reader_thread, dev) != 0) {
+        release_device(dev);
+        return HPS3D_RET_CREAT_PTHREAD_ERR;
+    }
+    // Das Gerät muss antworten, sonst ist es keins (oder das falsche Protokoll)
+    if (transact(dev, WIRE_CMD_HELLO, NULL, 0) != HPS3D_RET_OK) {
+        atomic_store(&dev->stop, 1);
+        pthread_join(dev->reader_tid, NULL);
+        release_device(dev);
+        return HPS3D_RET_CONNECT_FAILED;
+    }
+    reply_text(dev, dev->version);
+    *deviceHandler = dev->handle;
+    return HPS3D_RET_OK;
+}
+
+int HPS3DAPI_EthernetConnectDevice(char *controllerIp, uint16_t controllerPort, int *deviceHandler) {
+    (void)controllerIp;
+    (void)controllerPort;
+    (void)deviceHandler;
+    return HPS3D_RET_ERROR;
+}
+
+int HPS3DAPI_EthernetReconnectDevice(int deviceHandler) {
+    (void)deviceHandler;
+    return HPS3D_RET_ERROR;
+}
+
+int HPS3DAPI_SetEthernetKeepAlive(int handle, int keepTime_ms) {
+    (void)handle;
+    (void)keepTime_ms;
+    return HPS3D_RET_ERROR;
+}
+
+int HPS3DAPI_CloseDevice(int handle) {
+    open_device_t *dev = device_for(handle);
+    if (!dev) {
+        return HPS3D_RET_ERROR;
+    }
+    if (atomic_load(&dev->started)) {
+        transact(dev, WIRE_CMD_STOP, NULL, 0);
+    }
+    atomic_store(&dev->stop, 1);
+    pthread_join(dev->reader_tid, NULL);
+    atomic_store(&dev->connected, 0);
+    release_device(dev);
+    return HPS3D_RET_OK;
+}
+
+int HPS3DAPI_IsConnect(int handle) {
+    open_device_t *dev = device_for(handle);
+    return dev && atomic_load(&dev->connected) ? 1 : 0;
+}
+
+int HPS3DAPI_IsStart(int handle) {
+    open_device_t *dev = device_for(handle);
+    return dev && atomic_load(&dev->started) ? 1 : 0;
+}
+
+int HPS3DAPI_StartCapture(int handle) {
+    open_device_t *dev = device_for(handle);
+    if (!dev) {
+        return HPS3D_RET_ERROR;
+    }
+    int ret = transact(dev, WIRE_CMD_START, NULL, 0);
+    if (ret == HPS3D_RET_OK) {
+        atomic_store(&dev->started, 1);
+    }
+    return ret;
+}
+
+int HPS3DAPI_StopCapture(int handle) {
+    open_device_t *dev = device_for(handle);
+    if (!dev) {
+        return HPS3D_RET_ERROR;
+    }
+    int ret = transact(dev, WIRE_CMD_STOP, NULL, 0);
+    if (ret == HPS3D_RET_OK) {
+        atomic_store(&dev->started, 0);
+    }
+    return ret;
+}
+
+int HPS3DAPI_SingleCapture(int handle, int *type, uint8_t **data, int *dataLen) {
+    open_device_t *dev = device_for(handle);
+    if (!dev || !type || !data || !dataLen) {
+        return HPS3D_RET_ERROR;
+    }
+    if (atomic_load(&dev->started)) {
+        return HPS3D_RET_BUSY;  // Im Dauerbetrieb kommen die Frames über den Callback
+    }
+    int ret = transact(dev, WIRE_CMD_SINGLE, NULL, 0);
+    if (ret != HPS3D_RET_OK) {
+        return ret;
+    }
+    // dev->single ändert erst die nächste Einzelmessung dieses Handles
+    const wire_framing_t *f = dev->reader.framing;
+    *type = dev->single->event_type;
+    *data = wire_frame_payload(f, dev->single);
+    *dataLen = wire_frame_payload_len(f, dev->single);
+    return HPS3D_RET_OK;
+}
+
+int HPS3DAPI_RegisterEventCallback(HPS3DAPI_EVENT_CALLBACK eventHandle, void *userPara) {
+    atomic_store(&event_user, userPara);
+    atomic_store(&event_callback, eventHandle);
+    return HPS3D_RET_OK;
+}
+
+int HPS3DAPI_UnregisterEventCallback(void) {
+    atomic_store(&event_callback, NULL);
+    return HPS3D_RET_OK;
+}
+
+const uint8_t *HPS3DAPI_GetDeviceVersion(int handle) {
+    open_device_t *dev = device_for(handle);
+    return (const uint8_t *)(dev ? dev->version : "");
+}
+
+const uint8_t *HPS3DAPI_GetSDKVersion(void) {
+    return (const uint8_t *)OPEN_SDK_VERSION;
+}
+
+const uint8_t *HPS3DAPI_GetSerialNumber(int handle) {
+    open_device_t *dev = device_for(handle);
+    if (!dev) {
+        return (const uint8_t *)"";
+    }
+    if (!dev->serial[0] && transact(dev, WIRE_CMD_SERIAL, NULL, 0) == HPS3D_RET_OK) {
+        reply_text(dev, dev->serial);
+    }
+    return (const uint8_t *)dev->serial;
+}
+
+int HPS3DAPI_SetDeviceUserID(int handle, uint8_t userID) {
+    return command_u8(handle, WIRE_CMD_USER_ID, userID);
+}
+
+int HPS3DAPI_SetROIGroupID(int handle, uint8_t groupID) {
+    return command_u8(handle, WIRE_CMD_ROI_GROUP, groupID);
+}
+
+int HPS3DAPI_SetMultiCameraCode(int handle, uint8_t CameraCode) {
+    return command_u8(handle, WIRE_CMD_CAMERA_CODE, CameraCode);
+}
+
+int HPS3DAPI_ExportSettings(int handle, uint8_t *settings) {
+    open_device_t *dev = device_for(handle);
+    if (!dev || !settings) {
+        return HPS3D_RET_ERROR;
+    }
+    int ret = transact(dev, WIRE_CMD_EXPORT, NULL, 0);
+    if (ret != HPS3D_RET_OK) {
+        return ret;
+    }
+    if (dev->reply_len < OPEN_SETTINGS_FIELDS * 4) {
+        return HPS3D_RET_PACKET_ERR;
+    }
+    // Feldweise statt memcpy: unabhängig von Layout und Byte-Reihenfolge des Hosts
+    HPS3D_DeviceSettings_t *s = (HPS3D_DeviceSettings_t *)settings;
+    const uint8_t *p = dev->reply;
+    uint32_t k_bits = get32(p + 32);
+    s->user_id = (int32_t)get32(p);
+    s->max_resolution_X = (int32_t)get32(p + 4);
+    s->max_resolution_Y = (int32_t)get32(p + 8);
+    s->max_roi_group_number = (int32_t)get32(p + 12);
+    s->max_roi_number = (int32_t)get32(p + 16);
+    s->max_threshold_number = (int32_t)get32(p + 20);
+    s->max_multiCamera_code = (int32_t)get32(p + 24);
+    s->dist_filter_enable = (int32_t)get32(p + 28);
+    memcpy(&s->dist_filter_K, &k_bits, sizeof(float));
+    s->smooth_filter_type = (int32_t)get32(p + 36);
+    s->smooth_filter_args = (int32_t)get32(p + 40);
+    s->cur_group_id = (int32_t)get32(p + 44);
+    s->cur_multiCamera_code = (int32_t)get32(p + 48);
+    s->dist_offset = (int32_t)get32(p + 52);
+    s->optical_path_calibration = (int32_t)get32(p + 56);
+    s->edge_filter_enable = (int32_t)get32(p + 60);
+    return HPS3D_RET_OK;
+}
+
+int HPS3DAPI_SaveSettings(int handle) {
+    open_device_t *dev = device_for(handle);
+    return dev ? transact(dev, WIRE_CMD_SAVE, NULL, 0) : HPS3D_RET_ERROR;
+}
+
+int HPS3DAPI_SetDistanceFilterConf(int handle, int enable, float K) {
+    open_device_t *dev = device_for(handle);
+    if (!dev) {
+        return HPS3D_RET_ERROR;
+    }
+    uint8_t payload[5];
+    uint32_t k_bits;
+    memcpy(&k_bits, &K, sizeof(k_bits));
+    payload[0] = (uint8_t)(enable != 0);
+    put32(payload + 1, k_bits);
+    return transact(dev, WIRE_CMD_DISTANCE_FILTER, payload, sizeof(payload));
+}
+
+int HPS3DAPI_SetSmoothFilterConf(int handle, int type, int args) {
+    open_device_t *dev = device_for(handle);
+    if (!dev) {
+        return HPS3D_RET_ERROR;
+    }
+    uint8_t payload[5];
+    payload[0] = (uint8_t)type;
+    put32(payload + 1, (uint32_t)args);
+    return transact(dev, WIRE_CMD_SMOOTH_FILTER, payload, sizeof(payload));
+}
+
+int HPS3DAPI_SetDistanceOffset(int handle, int16_t offset) {
+    open_device_t *dev = device_for(handle);
+    if (!dev) {
+        return HPS3D_RET_ERROR;
+    }
+    uint8_t payload[2] = {(uint8_t)((uint16_t)offset >> 8), (uint8_t)offset};
+    return transact(dev, WIRE_CMD_DISTANCE_OFFSET, payload, sizeof(payload));
+}
+
+int HPS3DAPI_SetOpticalPathCalibration(int handle, int enbale) {
+    return command_u8(handle, WIRE_CMD_OPTICAL_PATH, (uint8_t)(enbale != 0));
+}
+
+int HPS3DAPI_SetEdgeFilterEnable(int handle, int enbale) {
+    return command_u8(handle, WIRE_CMD_EDGE_FILTER, (uint8_t)(enbale != 0));
+}
+
+#endif // HPS3D_OPEN_TRANSPORT
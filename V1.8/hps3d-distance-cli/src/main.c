@@ -42,6 +42,29 @@
 #else
     #include "HPS3DUser_IF.h"
 #endif
+#include "sensor_geometry.h"
+#include "region.h"
+#include "packet_parser.h"
+#include "event_dispatch.h"
+#include "burst.h"
+#include "change_gate.h"
+#include "roi_stats.h"
+#include "roi_scheduler.h"
+#include "threshold_alarm.h"
+#include "systemd_notify.h"
+#include "thermal_governor.h"
+#include "async_writer.h"
+#include "serialize.h"
+#include "capture_scheduler.h"
+#include "trigger_capture.h"
+#include "pixel_health.h"
+#include "pixel_correction.h"
+#include "optical_path.h"
+#include "pointcloud.h"
+#include "cloud_analytics.h"
+#include "pointcloud2.h"
+#include "region_minmax.h"
+#include "depth_histogram.h"
 
 // Forward declarations
 static int init_lidar(void);
@@ -51,6 +74,7 @@ static int measure_points(void);
 static char* create_json_output(void);
 static void cleanup(void);
 static void cleanup_lidar_resources(void);
+static int measure_interval_ms(void);
 static int check_connection_health(void);
 static int reconnect_lidar_with_backoff(void);
 static void enter_power_save_mode(void);
@@ -64,7 +88,7 @@ void* http_server_thread(void* arg);
 void mqtt_message_callback(struct mosquitto *mosq, void *userdata, const struct mosquitto_message *message);
 
 // Konfiguration
-#define MAX_POINTS 4
+#define MAX_POINTS 128     // Bis zu 16 ROI-Gruppen x 8 ROIs; Standard sind 4 Punkte
 #define AREA_SIZE 5        // 5x5 Pixel Messbereich
 #define AREA_OFFSET 2      // (5-1)/2 für zentrierten Bereich
 #define DEFAULT_MIN_VALID_PIXELS 6  // Standard: 25% der Pixel (6 von 25)
@@ -74,11 +98,23 @@ void mqtt_message_callback(struct mosquitto *mosq, void *userdata, const struct
 #define PID_FILE "/var/run/hps3d_service.pid"
 #define DEFAULT_DEBUG_FILE "/var/log/hps3d/debug.log"
 #define DEFAULT_DEBUG_ENABLED 1  // Debug standardmäßig aktiviert
+#define DEBUG_RAW_POINTS 4       // Rohdaten-Dump pro Punkt nur bis zu so vielen Punkten (oder debug=2)
+#define LOG_BUFFERS 256         // Log-Zeilen, die gleichzeitig auf die Platte warten können
+#define LOG_LINE_SIZE 512       // Längere Zeilen werden gekürzt
+#define LOG_FLUSH_TIMEOUT_MS 1000
 #define USB_PORT "/dev/ttyACM0"
+#define STREAM_WAIT_MS 200      // Max. Wartezeit auf ein frisches Paket aus dem Callback-Stream
+#define STARTUP_FRAME_WAIT_MS 3000  // Wartezeit auf den ersten Frame nach dem Öffnen beim Start
+#define TRIGGER_DEFAULT_POST_FRAMES 30  // Nachlauf einer Trigger-Aufnahme
+#define TRIGGER_MAX_FRAMES 256          // Obergrenze für Vor- und Nachlauf
+#define TRIGGER_DEFAULT_DIR "/var/lib/hps3d/triggers"
+#define PIXEL_MASK_DEFAULT_FILE "/var/lib/hps3d/pixel_mask.bin"
+#define PIXEL_CORRECTION_DEFAULT_FILE "/var/lib/hps3d/pixel_correction.bin"
+#define POINTCLOUD2_DEFAULT_SHM "/dev/shm/hps3d_pointcloud2"
 
 // HTTP Server Konfiguration
 #define HTTP_PORT 8080
-#define HTTP_RESPONSE "HTTP/1.1 200 OK\r\nContent-Length: %zu\r\nContent-Type: application/json\r\n\r\n%s"
+#define HTTP_RESPONSE "HTTP/1.1 200 OK\r\nContent-Length: %zu\r\nContent-Type: %s\r\n\r\n"  // Body folgt getrennt
 
 // MQTT Konfiguration
 #define MQTT_HOST "localhost"
@@ -86,39 +122,187 @@ void mqtt_message_callback(struct mosquitto *mosq, void *userdata, const struct
 #define MQTT_TOPIC "hps3d/measurements"
 #define MQTT_CONTROL_TOPIC "hps3d/control"
 #define MQTT_POINTCLOUD_TOPIC "hps3d/pointcloud"  // Neues Topic für Punktwolke
+#define MQTT_POINTCLOUD2_TOPIC "hps3d/pointcloud2"  // Binär, PointCloud2-Layout (pointcloud2.h)
 #define MQTT_RECONNECT_DELAY 5  // Sekunden zwischen Reconnect-Versuchen
+#define MQTT_BURST_TOPIC "hps3d/measurements/burst"  // Ergebnis von "burst"-Befehlen
+#define MQTT_ZONES_TOPIC "hps3d/zones"  // Min/Max je minmax_zone, aus der Sparse-Table
+#define MQTT_HISTOGRAM_TOPIC "hps3d/histogram"  // Tiefenhistogramm je Frame und je Zone
+#define MQTT_ALARM_TOPIC "hps3d/alarms"  // Flanken der Geräte-Schwellwerte, direkt aus dem SDK-Thread
+#define BURST_TIMEOUT_MS 10000  // Max. Wartezeit des HTTP-Clients auf ein Burst-Ergebnis
+#define POINT_JSON_SIZE 384  // Obergrenze pro Messpunkt im JSON
+#define BURST_RESULT_SIZE (512 + MAX_POINTS * POINT_JSON_SIZE)
 
 // Messpunkt Definition
 typedef struct {
-    int x, y;           // Pixel-Koordinaten im 160x60 Array
+    int x, y;           // Pixel-Koordinaten im SENSOR_WIDTH x SENSOR_HEIGHT Array
     float distance;     // Gemessene Durchschnittsdistanz in mm
     float min_distance; // Minimale Distanz im Messbereich
     float max_distance; // Maximale Distanz im Messbereich
     int valid_pixels;   // Anzahl gültiger Pixel im Messbereich
+    float range;        // Mittlere Schrägentfernung in mm (nur optical_path=host)
     uint32_t timestamp; // Zeitstempel der letzten Messung
+    uint64_t updated_ms; // Monotone Zeit der letzten Aktualisierung (0 = nie)
     char name[16];      // Name des Messpunkts (reduziert von 32 auf 16)
+    int group;          // ROI-Gruppe im ROI-Modus (-1 = roi_group)
+    int priority;       // Gewicht für den Prioritäts-Zeitplan
     struct {
         unsigned int valid : 1;  // Messung gültig (als Bitfeld)
     } flags;
 } MeasurePoint;
 
+// 5x5 Regions-Kernel mit fester Zeilenbreite: region_stats_area()
+DEFINE_REGION_KERNEL(area, SENSOR_WIDTH, AREA_SIZE, AREA_SIZE)
+
 // Globale Variablen am Anfang der Datei
 static volatile int running = 1;
 static pthread_mutex_t data_mutex = PTHREAD_MUTEX_INITIALIZER;
 static pthread_mutex_t debug_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int g_handle = -1;
 static HPS3D_MeasureData_t g_measureData = {0};
+static event_device_t *g_device = NULL;  // Callback-Warteschlange für g_handle
 static struct mosquitto *mosq = NULL;
 static int http_socket = -1;
 static volatile _Atomic int measurement_active = 0;
-static volatile _Atomic int pointcloud_requested = 0;
+static volatile _Atomic int pointcloud_requested = 0;  // pointcloud_state_t
 static volatile _Atomic int mqtt_connected = 0;
 static volatile _Atomic int device_connected = 0;
 static volatile _Atomic int connection_retries = 0;
 static volatile _Atomic int power_save_mode = 0;
+static volatile _Atomic uint32_t frames_skipped = 0;     // Vom Änderungs-Gate verworfene Frames
+static volatile _Atomic uint32_t points_generation = 0;  // Zählt jede neue Auswertung der Messpunkte
+static change_gate_t g_gate;           // Nur im Mess-Thread benutzt (Konfiguration beim Start)
+static int roi_mode = 0;               // 1 = Geräte-ROIs (HPS3D_FULL_ROI_EVEN) statt Vollbild auswerten
+static int roi_group = 0;              // Standard-ROI-Gruppe für Zonen ohne eigene Gruppe (0-15)
+static float roi_outlier_k = ROI_DEFAULT_OUTLIER_K;
+static roi_scheduler_t g_roi_sched;    // Gruppenwechsel im ROI-Modus (nur Mess-Thread)
+static roi_sched_policy_t roi_policy = ROI_SCHED_ROUND_ROBIN;
+static int roi_dwell_ms = MEASURE_INTERVAL_MS;  // Messintervall pro Gruppe bei mehreren Gruppen
+static int num_points = 4;             // Anzahl konfigurierter Messpunkte
+static threshold_tracker_t g_alarms;   // Nur im SDK-Empfangsthread gescannt
+static int alarms_enabled = 0;         // Schwellwert-Flanken sofort publizieren
+static int alarm_qos = 0;
+static volatile _Atomic uint32_t alarms_dropped = 0;  // Ohne MQTT-Verbindung verlorene Alarme
+static thermal_governor_t g_thermal;   // Nur im Mess-Thread aktualisiert
+static char thermal_zone[256] = "";    // Temperaturdatei, leer = Governor aus
+static int thermal_enabled = 1;
+static volatile _Atomic int thermal_level = THERMAL_NORMAL;
+static volatile _Atomic int thermal_temp_mc = 0;   // 0 = noch nicht gemessen
+static char usb_port[64] = USB_PORT;
+static int http_port = HTTP_PORT;
+static char capture_bus_path[128] = "";  // Gemeinsamer Bus-Zeitplan, leer = freilaufend mit Stream
+static int capture_guard_us = CAPTURE_DEFAULT_GUARD_US;
+static capture_sched_t g_capture;      // Nur im Mess-Thread
+static int capture_scheduled = 0;      // Einzelaufnahmen in versetzten Fenstern statt Stream
+static volatile _Atomic uint32_t capture_cycle_us = 0;      // Für /status aus dem Mess-Thread
+static volatile _Atomic uint32_t capture_offset_us = 0;
+static volatile _Atomic uint32_t capture_transfer_us = 0;
+static volatile _Atomic uint32_t capture_jitter_us = 0;
+static volatile _Atomic uint32_t capture_late = 0;
+static trigger_capture_t g_trigger;    // push/poll nur im Mess-Thread, Auslöser aus allen Threads
+static int trigger_enabled = 0;
+static int trigger_pre_frames = 0;     // Vorlauf in Frames, 0 = Aufzeichnung aus
+static int trigger_post_frames = TRIGGER_DEFAULT_POST_FRAMES;
+static int trigger_on_alarm = 1;       // Alarmflanken (aktiv) lösen eine Aufnahme aus
+static char trigger_dir[128] = TRIGGER_DEFAULT_DIR;
+static pixel_health_t g_pixels;        // Unter data_mutex (Mess-Thread schreibt, HTTP liest)
+static int pixel_health_enabled = 1;   // Tote/eingefrorene Pixel erkennen und maskieren
+static int pixel_health_every = PIXEL_HEALTH_DEFAULT_EVERY;
+static int pixel_health_window = PIXEL_HEALTH_DEFAULT_WINDOW;
+static char pixel_mask_file[128] = PIXEL_MASK_DEFAULT_FILE;
+static pixel_correction_t g_correction;  // Nach dem Start nur gelesen
+static int pixel_correction_enabled = 0;
+static char pixel_correction_file[128] = "";  // Leer = keine Korrektur
+static optical_path_t g_optical;        // Kosinus-Tabelle, nach dem Start nur gelesen
+static int optical_path_host = 0;       // Senkrechtentfernung auf dem Host statt im Gerät
+static float optical_fov_h = OPTICAL_PATH_DEFAULT_FOV_H;
+static float optical_fov_v = OPTICAL_PATH_DEFAULT_FOV_V;
+static uint16_t g_range[SENSOR_PIXELS];  // Schrägentfernung des letzten Full-Depth-Frames (data_mutex)
+static int pointcloud2_mqtt = 0;        // Jeden Full-Depth-Frame binär auf MQTT_POINTCLOUD2_TOPIC
+static int pointcloud2_shm = 0;         // ... und/oder in die Shared-Memory-Datei
+static char pointcloud2_shm_path[128] = POINTCLOUD2_DEFAULT_SHM;
+static char pointcloud2_frame_id[32] = "hps3d";
+static pc2_frame_t g_pc2;               // Unter data_mutex, eine Nachricht je Frame
+static pointcloud_soa_t g_cloud;        // Full-Depth-Punkte als x[]/y[]/z[] (data_mutex), nur mit PointCloud2
+static float pointcloud2_pose[12];      // Montage-Transformation R|t (mm), zeilenweise
+static int pointcloud2_posed = 0;       // pointcloud2_transform= gesetzt
+static pc2_shm_t *g_pc2_shm = NULL;
+static _Atomic uint32_t pointcloud2_frames;
+static output_profile_t g_profiles[OUTPUT_PROFILE_MAX];  // output_profile= in Konfigurationsreihenfolge
+static int num_profiles = 0;
+static struct {
+    char payload[BURST_RESULT_SIZE];
+    int len;                            // 0 = noch kein Schnappschuss
+} g_profile_out[OUTPUT_PROFILE_MAX];    // Unter profile_mutex
+static pthread_mutex_t profile_mutex = PTHREAD_MUTEX_INITIALIZER;
+#define MINMAX_MAX_ZONES 256
+static int minmax_index = 0;            // Sparse-Table je Full-Depth-Frame (auch ohne Zonen, für /zones?rect=)
+static region_minmax_t g_minmax;        // 1,8 MB, nur mit minmax_index beschrieben (data_mutex)
+static struct {
+    int x0, y0, w, h;
+} minmax_zones[MINMAX_MAX_ZONES];
+static int num_zones = 0;
+static uint16_t zone_min[MINMAX_MAX_ZONES];  // Letzter Frame, unter data_mutex
+static uint16_t zone_max[MINMAX_MAX_ZONES];
+static uint32_t minmax_frames = 0;      // Unter data_mutex
+static int depth_histogram = 0;         // depth_histogram=<klassen>,<min_mm>,<max_mm>
+static depth_hist_range_t g_hist_range;
+static float hist_auto_low = -1.0f;     // Perzentile für "range", < 0 = aus
+static float hist_auto_high = 100.0f;
+static depth_hist_partial_t g_hist_scratch;  // Unter data_mutex
+static depth_hist_t g_hist_frame;       // Unter data_mutex
+static depth_hist_t *g_hist_zones = NULL;    // Je minmax_zone, aus setup_depth_histogram
+static uint32_t histogram_frames = 0;   // Unter data_mutex
+static char *g_hist_json = NULL;        // MQTT-Nutzlast, nur output_thread
+static size_t hist_json_size = 0;
+
+// Bereitschaft der Subsysteme in ms seit Start von main(), -1 = noch nicht bereit.
+// Die Subsysteme starten unabhängig voneinander, keines wartet auf das LIDAR.
+static struct {
+    uint64_t t0_ms;
+    _Atomic int64_t config_ms;
+    _Atomic int64_t http_ms;
+    _Atomic int64_t mqtt_ms;
+    _Atomic int64_t lidar_ms;
+    _Atomic int64_t first_frame_ms;
+} startup = {
+    .config_ms = -1, .http_ms = -1, .mqtt_ms = -1, .lidar_ms = -1, .first_frame_ms = -1
+};
+static uint64_t watchdog_interval_ms = 0;  // systemd-Watchdog, 0 = nicht aktiv
 int debug_enabled = DEFAULT_DEBUG_ENABLED;
 static int min_valid_pixels = DEFAULT_MIN_VALID_PIXELS;
 static FILE* debug_file = NULL;  // Globale debug_file Variable
+static async_writer_t g_log_writer;    // Asynchrones Debug-Log, ersetzt debug_file nach load_config
+static int log_file = -1;              // Datei-ID im Writer, -1 = stdio (debug_file)
+
+// Punktwolken-Anforderung: MQTT stellt sie ein, der Mess-Thread misst, der Output-Thread publiziert
+typedef enum {
+    POINTCLOUD_IDLE = 0,
+    POINTCLOUD_PENDING,
+    POINTCLOUD_READY
+} pointcloud_state_t;
+
+// Burst-Anforderung: MQTT/HTTP stellen sie ein, der Mess-Thread führt sie aus
+typedef enum {
+    BURST_IDLE = 0,
+    BURST_PENDING,
+    BURST_RUNNING,
+    BURST_DONE
+} burst_state_t;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t done;
+    burst_state_t state;
+    int frames;
+    burst_mode_t mode;
+    int reply_mqtt;                    // Ergebnis publizieren statt an wartenden HTTP-Client
+    char result[BURST_RESULT_SIZE];
+} burst_ctl = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER,
+    .state = BURST_IDLE
+};
+static burst_buffer_t g_burst;         // Erst beim ersten Burst allokiert
 
 // Globale Messpunkte mit korrekter Initialisierung
 static MeasurePoint points[MAX_POINTS] = {
@@ -127,6 +311,7 @@ static MeasurePoint points[MAX_POINTS] = {
         .distance = 0.0, .min_distance = 0.0, .max_distance = 0.0,
         .valid_pixels = 0, .timestamp = 0,
         .name = "point_1",
+        .group = -1, .priority = 1,
         .flags = {.valid = 0}
     },
     {
@@ -134,6 +319,7 @@ static MeasurePoint points[MAX_POINTS] = {
         .distance = 0.0, .min_distance = 0.0, .max_distance = 0.0,
         .valid_pixels = 0, .timestamp = 0,
         .name = "point_2",
+        .group = -1, .priority = 1,
         .flags = {.valid = 0}
     },
     {
@@ -141,6 +327,7 @@ static MeasurePoint points[MAX_POINTS] = {
         .distance = 0.0, .min_distance = 0.0, .max_distance = 0.0,
         .valid_pixels = 0, .timestamp = 0,
         .name = "point_3",
+        .group = -1, .priority = 1,
         .flags = {.valid = 0}
     },
     {
@@ -148,6 +335,7 @@ static MeasurePoint points[MAX_POINTS] = {
         .distance = 0.0, .min_distance = 0.0, .max_distance = 0.0,
         .valid_pixels = 0, .timestamp = 0,
         .name = "point_4",
+        .group = -1, .priority = 1,
         .flags = {.valid = 0}
     }
 };
@@ -161,6 +349,32 @@ void debug_print(const char* format, ...) {
         fprintf(stderr, "ERROR: Debug mutex lock failed\n");
         return;
     }
+
+    time_t now = time(NULL);
+    char timestamp[26];
+    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", localtime(&now));
+
+    // Normalfall: Zeile direkt in einen Pool-Puffer formatieren, geschrieben wird im
+    // Writer-Thread. Ist der Pool leer, geht die Zeile verloren statt zu blockieren.
+    if (log_file >= 0) {
+        frame_buf_t *buf = async_writer_acquire(&g_log_writer);
+        if (buf) {
+            char *line = (char *)buf->data;
+            int pos = snprintf(line, (size_t)buf->capacity, "[%s] ", timestamp);
+            va_list args;
+            va_start(args, format);
+            pos += vsnprintf(line + pos, (size_t)(buf->capacity - pos), format, args);
+            va_end(args);
+            if (pos >= buf->capacity) {
+                pos = buf->capacity;
+                line[pos - 1] = '\n';  // Gekürzte Zeile trotzdem abschließen
+            }
+            buf->len = pos;
+            async_writer_submit(&g_log_writer, log_file, buf);
+        }
+        pthread_mutex_unlock(&debug_mutex);
+        return;
+    }
     
     // Beim ersten Aufruf Debug-File öffnen
     if (!debug_file) {
@@ -173,16 +387,14 @@ void debug_print(const char* format, ...) {
             pthread_mutex_unlock(&debug_mutex);
             return;
         }
-        debug_print("Debug-Logging initialisiert\n");
+        // Direkt schreiben: ein rekursiver debug_print() würde am eigenen Mutex hängen
+        fprintf(debug_file, "Debug-Logging initialisiert\n");
     }
 
     va_list args;
     va_start(args, format);
     
-    // In Debug-Datei schreiben
-    time_t now = time(NULL);
-    char timestamp[26];
-    strftime(timestamp, sizeof(timestamp), "%Y-%m-%d %H:%M:%S", localtime(&now));
+    // Vor load_config bzw. ohne Writer: synchron über stdio
     fprintf(debug_file, "[%s] ", timestamp);
     vfprintf(debug_file, format, args);
     fflush(debug_file);
@@ -192,29 +404,268 @@ void debug_print(const char* format, ...) {
     pthread_mutex_unlock(&debug_mutex);
 }
 
-// Event Callback für HPS3D
-static void EventCallBackFunc(int handle, int eventType, uint8_t *data, int dataLen, void *userPara) {
-    (void)handle;    // Ungenutzte Parameter markieren
-    (void)dataLen;
-    (void)userPara;
-    
-    HPS3D_EventType_t event = (HPS3D_EventType_t)eventType;
-    switch (event) {
+// Status-Events aus der Callback-Warteschlange (läuft im Mess-Thread, nicht im SDK-Thread)
+static void handle_status_event(const frame_buf_t *buf) {
+    switch ((HPS3D_EventType_t)buf->event_type) {
         case HPS3D_DISCONNECT_EVEN:
-            printf("WARNUNG: HPS3D-160 getrennt, versuche Wiederverbindung...\n");
-            // reconnect_needed = true; // This variable is removed
+            debug_print("WARNUNG: HPS3D-160 getrennt, versuche Wiederverbindung...\n");
             break;
         case HPS3D_SYS_EXCEPTION_EVEN:
-            if (data) {
-                printf("WARNUNG: System Exception: %s\n", (char*)data);
+            if (buf->len > 0) {
+                debug_print("WARNUNG: System Exception: %.*s\n", buf->len, (const char*)buf->data);
             } else {
-                printf("WARNUNG: System Exception (keine Details verfügbar)\n");
+                debug_print("WARNUNG: System Exception (keine Details verfügbar)\n");
             }
             break;
         default:
-            printf("WARNUNG: Unbekanntes Event: %d\n", eventType);
+            debug_print("WARNUNG: Unbekanntes Event: %d\n", buf->event_type);
+            break;
+    }
+}
+
+static int is_measure_event(int event_type) {
+    switch ((HPS3D_EventType_t)event_type) {
+        case HPS3D_SIMPLE_ROI_EVEN:
+        case HPS3D_FULL_ROI_EVEN:
+        case HPS3D_FULL_DEPTH_EVEN:
+        case HPS3D_SIMPLE_DEPTH_EVEN:
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+// Gehaltenes Paket aus dem Vorlauf-Ring an die Callback-Verteilung zurückgeben
+static void release_dispatch_frame(frame_buf_t *buf, void *user) {
+    (void)user;
+    event_dispatch_release(g_device, buf);
+}
+
+// Ausgewertetes oder übersprungenes Paket abgeben: bei aktiver Trigger-Aufzeichnung
+// wandern Messpakete in den Vorlauf-Ring (ohne Kopie), sonst zurück in den Pool
+static void retire_frame(frame_buf_t *buf) {
+    if (trigger_enabled && is_measure_event(buf->event_type)) {
+        trigger_capture_push(&g_trigger, buf);
+    } else {
+        event_dispatch_release(g_device, buf);
+    }
+}
+
+// Neuestes Messpaket aus der Warteschlange holen; ältere Pakete gehen
+// sofort zurück in den Pool, Status-Events werden dabei protokolliert.
+static frame_buf_t *take_latest_frame(int timeout_ms) {
+    frame_buf_t *latest = NULL;
+    frame_buf_t *buf;
+    int wait_ms = 0;
+
+    for (;;) {
+        buf = event_dispatch_next(g_device, wait_ms);
+        if (!buf) {
+            if (wait_ms > 0 || timeout_ms <= 0) {
+                break;
+            }
+            wait_ms = timeout_ms;  // Rückstand abgearbeitet - auf ein frisches Paket warten
+            continue;
+        }
+        if (!is_measure_event(buf->event_type)) {
+            handle_status_event(buf);
+            event_dispatch_release(g_device, buf);
+            continue;
+        }
+        if (latest) {
+            retire_frame(latest);
+        }
+        latest = buf;
+        if (wait_ms > 0) {
+            break;  // Frisches Paket nach dem Warten erhalten
+        }
+    }
+    return latest;
+}
+
+// Monotone Zeit in ms für Alter und Zeitplan
+static uint64_t monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+// Erstes Bereitwerden eines Subsystems festhalten; spätere Aufrufe kosten nur einen Load
+static void startup_mark(_Atomic int64_t *slot, const char *name) {
+    if (atomic_load_explicit(slot, memory_order_relaxed) >= 0) {
+        return;
+    }
+    int64_t expected = -1;
+    int64_t elapsed = (int64_t)(monotonic_ms() - startup.t0_ms);
+    if (atomic_compare_exchange_strong(slot, &expected, elapsed)) {
+        debug_print("Start: %s bereit nach %lld ms\n", name, (long long)elapsed);
+    }
+}
+
+// Erster gültiger Frame: erst jetzt gilt der Dienst gegenüber systemd als bereit
+static void mark_first_frame(void) {
+    if (atomic_load_explicit(&startup.first_frame_ms, memory_order_relaxed) >= 0) {
+        return;
+    }
+    startup_mark(&startup.first_frame_ms, "Erster Frame");
+    systemd_notify("READY=1\nSTATUS=Messdaten werden empfangen");
+}
+
+// Herzschlag der Mess-Pipeline: jeder Durchlauf der Mess-Schleife füttert den
+// systemd-Watchdog (höchstens zweimal pro Intervall). Hängt die Schleife, bleibt er aus.
+static void pipeline_heartbeat(void) {
+    static uint64_t last_ms = 0;
+    if (!watchdog_interval_ms) {
+        return;
+    }
+    uint64_t now_ms = monotonic_ms();
+    if (now_ms - last_ms >= watchdog_interval_ms / 2) {
+        last_ms = now_ms;
+        systemd_notify("WATCHDOG=1");
+    }
+}
+
+// Auf das erste gültige Paket aus dem Stream warten (nach dem Öffnen beim Start,
+// auch wenn noch keine Messung aktiv ist)
+static void probe_first_frame(int timeout_ms) {
+    if (capture_scheduled) {
+        // Kein Stream: eine Einzelaufnahme im eigenen Fenster
+        HPS3D_EventType_t event_type;
+        capture_sched_wait(&g_capture, measure_interval_ms());
+        pthread_mutex_lock(&data_mutex);
+        capture_sched_begin(&g_capture);
+        int ok = HPS3D_SingleCapture(g_handle, &event_type, &g_measureData) == HPS3D_RET_OK;
+        capture_sched_end(&g_capture, ok);
+        pthread_mutex_unlock(&data_mutex);
+        if (ok) {
+            mark_first_frame();
+        }
+        return;
+    }
+    if (!g_device) {
+        return;
+    }
+    frame_buf_t *frame = take_latest_frame(timeout_ms);
+    if (frame) {
+        if (packet_validate(frame->data, frame->len, (HPS3D_EventType_t)frame->event_type) >= 0) {
+            mark_first_frame();
+        }
+        retire_frame(frame);
+    }
+}
+
+// Nächste ROI-Gruppe laut Zeitplan am Gerät aktivieren (nur Mess-Thread)
+static void roi_select_next_group(void) {
+    int group = roi_sched_next(&g_roi_sched, monotonic_ms());
+    if (group < 0 || group == g_roi_sched.current) {
+        return;
+    }
+    if (HPS3D_SetROIGroupID(g_handle, (uint8_t)group) != HPS3D_RET_OK) {
+        debug_print("WARNUNG: ROI-Gruppe %d konnte nicht gesetzt werden\n", group);
+        return;
+    }
+    g_roi_sched.current = group;
+}
+
+// Temperatur im Abstand von temp_check_interval prüfen und die Laststufe anpassen (Mess-Thread)
+static void thermal_check(void) {
+    static uint64_t next_check_ms = 0;
+    if (!thermal_zone[0]) {
+        return;
+    }
+    uint64_t now = monotonic_ms();
+    if (now < next_check_ms) {
+        return;
+    }
+    next_check_ms = now + (uint64_t)g_thermal.config.interval_s * 1000;
+
+    int32_t temp_mc;
+    if (thermal_read_mc(thermal_zone, &temp_mc) != 0) {
+        return;
+    }
+    thermal_level_t before = g_thermal.level;
+    thermal_level_t level = thermal_governor_update(&g_thermal, temp_mc);
+    atomic_store(&thermal_temp_mc, temp_mc);
+    if (level != before) {
+        debug_print("Thermik: %.1f°C - Stufe %s -> %s\n", temp_mc / 1000.0,
+                    thermal_level_name(before), thermal_level_name(level));
+        atomic_store(&thermal_level, level);
+    }
+}
+
+// Zeitplan-Kennzahlen für /status übernehmen (nur Mess-Thread)
+static void capture_publish_stats(void) {
+    atomic_store(&capture_cycle_us, g_capture.plan.cycle_us);
+    atomic_store(&capture_offset_us, g_capture.plan.offset_us);
+    atomic_store(&capture_transfer_us, g_capture.transfer_us);
+    atomic_store(&capture_jitter_us, g_capture.transfer_dev_us);
+    atomic_store(&capture_late, g_capture.late);
+}
+
+// Messintervall unter Berücksichtigung der thermischen Stufe
+static int measure_interval_ms(void) {
+    int interval = roi_mode && g_roi_sched.count > 1 ? roi_dwell_ms : MEASURE_INTERVAL_MS;
+    if (atomic_load(&thermal_level) >= THERMAL_REDUCED_RATE) {
+        interval *= g_thermal.config.rate_factor;
+    }
+    return interval;
+}
+
+// Messpause mit Trigger-Aufzeichnung: statt zu schlafen jedes eintreffende Paket
+// in den Vorlauf-Ring übernehmen, damit eine Aufnahme den Verlauf lückenlos enthält
+static void record_wait(int wait_ms) {
+    uint64_t deadline = monotonic_ms() + (uint64_t)wait_ms;
+    uint64_t now;
+    while (running && (now = monotonic_ms()) < deadline) {
+        frame_buf_t *buf = g_device ? event_dispatch_next(g_device, (int)(deadline - now)) : NULL;
+        if (!buf) {
+            if (!g_device) {
+                usleep((useconds_t)(deadline - now) * 1000);
+            }
             break;
+        }
+        if (!is_measure_event(buf->event_type)) {
+            handle_status_event(buf);
+        }
+        retire_frame(buf);
+    }
+    trigger_capture_poll(&g_trigger);
+}
+
+// Schwellwert-Flanke publizieren (SDK-Empfangsthread): kleines festes Format,
+// kein Umweg über den Output-Thread und den Messdaten-JSON
+static void publish_alarm(const threshold_alarm_t *alarm, void *user) {
+    (void)user;
+    if (alarm->active && trigger_enabled && trigger_on_alarm &&
+        trigger_capture_request(&g_trigger, TRIGGER_SOURCE_ALARM, alarm->roi_id) == 0) {
+        debug_print("Trigger-Aufnahme durch Alarm (Gruppe %u, ROI %u)\n", alarm->group, alarm->roi_id);
+    }
+    if (!mosq || !atomic_load(&mqtt_connected)) {
+        atomic_fetch_add(&alarms_dropped, 1);
+        return;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    char payload[192];
+    int len = snprintf(payload, sizeof(payload),
+        "{\"group\":%u,\"roi\":%u,\"threshold\":%u,\"active\":%s,"
+        "\"distance_avg_mm\":%u,\"distance_min_mm\":%u,\"frame\":%u,\"ts_ms\":%lld}",
+        alarm->group, alarm->roi_id, alarm->threshold, alarm->active ? "true" : "false",
+        alarm->distance_average, alarm->distance_min, alarm->frame_cnt,
+        (long long)now.tv_sec * 1000 + now.tv_nsec / 1000000);
+
+    if (mosquitto_publish(mosq, NULL, MQTT_ALARM_TOPIC, len, payload, alarm_qos, false) != MOSQ_ERR_SUCCESS) {
+        atomic_fetch_add(&alarms_dropped, 1);
+    }
+}
+
+// SDK-Callback: Alarme vor dem Kopieren in die Warteschlange auswerten
+static void sdk_event_callback(int handle, int eventType, uint8_t *data, int dataLen, void *userPara) {
+    if (alarms_enabled) {
+        threshold_tracker_scan(&g_alarms, eventType, data, dataLen, publish_alarm, NULL);
     }
+    event_dispatch_callback(handle, eventType, data, dataLen, userPara);
 }
 
 // Signal Handler
@@ -224,13 +675,24 @@ void signal_handler(int sig) {
     
     // Sofort alle Messungen stoppen
     atomic_store(&measurement_active, 0);
-    atomic_store(&pointcloud_requested, 0);
+    atomic_store(&pointcloud_requested, POINTCLOUD_IDLE);
     
     // Warte nicht auf Threads in Signal Handler
     // Cleanup wird im Hauptprogramm durchgeführt
 }
 
 
+// Filter und Korrekturen des Geräts - gleich für Betrieb und Kalibrierung
+static void configure_device_filters(void) {
+    // Weniger aggressive Filtereinstellungen
+    HPS3D_SetDistanceFilterConf(g_handle, false, 0.1f);
+    HPS3D_SetSmoothFilterConf(g_handle, HPS3D_SMOOTH_FILTER_DISABLE, 0);
+    HPS3D_SetEdgeFilterEnable(g_handle, false);
+    
+    // Optische Wegkorrektur: im Gerät, oder auf dem Host (dann liefert das Gerät Rohwerte)
+    HPS3D_SetOpticalPathCalibration(g_handle, !optical_path_host);
+}
+
 // LIDAR initialisieren
 int init_lidar() {
     HPS3D_StatusTypeDef ret;
@@ -247,14 +709,17 @@ int init_lidar() {
     debug_print("Messdatenstruktur initialisiert\n");
 
     // Callback registrieren
-    ret = HPS3D_RegisterEventCallback(EventCallBackFunc, NULL);
+    ret = HPS3D_RegisterEventCallback(sdk_event_callback, NULL);
     if (ret != HPS3D_RET_OK) {
         debug_print("FEHLER: Callback-Registrierung fehlgeschlagen\n");
         return -1;
     }
 
+    // Alarmzustände der alten Sitzung vergessen (noch kein Gerät, kein Callback aktiv)
+    threshold_tracker_reset(&g_alarms);
+
     // USB Verbindung aufbauen
-    ret = HPS3D_USBConnectDevice(USB_PORT, &g_handle);
+    ret = HPS3D_USBConnectDevice(usb_port, &g_handle);
     if (ret != HPS3D_RET_OK) {
         debug_print("FEHLER: Verbindung zu HPS3D-160 fehlgeschlagen (%d)\n", ret);
         return -1;
@@ -262,22 +727,54 @@ int init_lidar() {
 
     debug_print("LIDAR verbunden: %s\n", HPS3D_GetDeviceVersion(g_handle));
 
-    // Weniger aggressive Filtereinstellungen
-    HPS3D_SetDistanceFilterConf(g_handle, false, 0.1f);
-    HPS3D_SetSmoothFilterConf(g_handle, HPS3D_SMOOTH_FILTER_DISABLE, 0);
-    HPS3D_SetEdgeFilterEnable(g_handle, false);
-    
-    // Optische Wegkorrektur aktivieren für genauere Messungen
-    HPS3D_SetOpticalPathCalibration(g_handle, true);
+    // Callbacks dieses Handles in die eigene Warteschlange leiten
+    g_device = event_dispatch_attach(g_handle);
+    if (!g_device) {
+        debug_print("WARNUNG: Kein freier Dispatch-Slot - nur Einzelmessungen\n");
+    }
+
+    configure_device_filters();
+
+    // Gerätegrenzen für Schwellwert-Alarme und ROI-Zeitplan
+    HPS3D_DeviceSettings_t settings;
+    bool have_settings = (roi_mode || alarms_enabled) &&
+                         HPS3D_ExportSettings(g_handle, &settings) == HPS3D_RET_OK;
+    if (have_settings && alarms_enabled) {
+        threshold_tracker_init(&g_alarms, settings.max_threshold_number);
+        debug_print("Schwellwert-Alarme aktiv (%d Schwellen pro ROI)\n", settings.max_threshold_number);
+    }
+
+    // ROI-Modus: die ROI-Rechtecke müssen vorab auf dem Gerät hinterlegt sein. Die
+    // Setter HE201_ApiSetROIRegion/-Enable/SelectROIGroup exportiert die Bibliothek
+    // zwar, sie erwarten aber den SDK-internen Gerätekontext statt des Handles;
+    // über HPS3DAPI lassen sich nur die Gruppen laut Zeitplan wählen.
+    if (roi_mode) {
+        g_roi_sched.current = -1;  // Gruppe am Gerät nach Reconnect unbekannt
+        if (have_settings) {
+            int removed = roi_sched_limit(&g_roi_sched, settings.max_roi_group_number);
+            if (removed > 0) {
+                debug_print("WARNUNG: %d ROI-Gruppen über der Gerätegrenze (%d) - Zonen darin werden nicht gemessen\n",
+                            removed, settings.max_roi_group_number);
+            }
+            debug_print("ROI-Modus: %d Gruppen im Zeitplan (Gerät: max. %d ROIs pro Gruppe, %d Gruppen)\n",
+                        g_roi_sched.count, settings.max_roi_number, settings.max_roi_group_number);
+        }
+        roi_select_next_group();
+    }
 
-    // Messung starten
-    ret = HPS3D_StartCapture(g_handle);
+    // Messung starten - im Bus-Zeitplan kein Dauerstream, der Bus gehört
+    // außerhalb der eigenen Fenster den anderen Sensoren
+    ret = capture_scheduled ? HPS3D_RET_OK : HPS3D_StartCapture(g_handle);
     if (ret != HPS3D_RET_OK) {
         debug_print("FEHLER: Messung konnte nicht gestartet werden\n");
         return -1;
     }
 
+    // Neue Verbindung: Gate-Referenz stammt von der alten Sitzung
+    change_gate_reset(&g_gate);
+
     debug_print("LIDAR initialisiert und gestartet\n");
+    startup_mark(&startup.lidar_ms, "LIDAR");
     atomic_store(&device_connected, 1);
     atomic_store(&connection_retries, 0);
     return 0;
@@ -298,6 +795,18 @@ void cleanup_lidar_resources(void) {
         
         g_handle = -1;
     }
+
+    if (g_device) {
+        if (trigger_enabled) {
+            trigger_capture_drop_all(&g_trigger);  // Gehaltene Pakete gehören zum Pool des Geräts
+        }
+        event_dispatch_stats_t stats;
+        event_dispatch_get_stats(g_device, &stats);
+        debug_print("Callback-Statistik: %u empfangen, %u verworfen, %u zu groß, %u ohne Gerät\n",
+                    stats.received, stats.dropped, stats.oversized, stats.unrouted);
+        event_dispatch_detach(g_device);
+        g_device = NULL;
+    }
     
     // Messdatenstruktur bereinigen
     HPS3D_MeasureDataFree(&g_measureData);
@@ -313,8 +822,8 @@ int check_connection_health(void) {
         return 0; // Nicht verbunden
     }
     
-    // Prüfe ob Gerät noch verbunden ist
-    if (!HPS3D_IsConnect(g_handle)) {
+    // Disconnect-Event aus dem Callback oder Verbindungsabfrage
+    if (event_dispatch_take_disconnect(g_device) || !HPS3D_IsConnect(g_handle)) {
         debug_print("WARNUNG: LIDAR-Verbindung verloren\n");
         atomic_store(&device_connected, 0);
         return 0;
@@ -376,103 +885,385 @@ void exit_power_save_mode(void) {
     debug_print("Power-Save-Modus deaktiviert\n");
 }
 
-// Einzelne Messung durchführen
+// Gate hat den Frame als unverändert erkannt: gültige Punkte bleiben bestätigt
+static void confirm_points(void) {
+    uint64_t now_ms = monotonic_ms();
+    pthread_mutex_lock(&data_mutex);
+    for (int i = 0; i < num_points; i++) {
+        if (points[i].flags.valid) {
+            points[i].timestamp = time(NULL);
+            points[i].updated_ms = now_ms;
+        }
+    }
+    pthread_mutex_unlock(&data_mutex);
+}
+
+// Messpunkte aus der Distanzebene in g_measureData auswerten (data_mutex gehalten)
+static void evaluate_points(void) {
+    atomic_fetch_add(&points_generation, 1);
+    const depth_row_t *rows = (const depth_row_t *)g_measureData.full_depth_data.distance;
+    // Bei vielen Zonen nur eine Zusammenfassung pro Frame statt ~40 Zeilen pro Punkt
+    int dump_raw = debug_enabled >= 2 || num_points <= DEBUG_RAW_POINTS;
+    int valid_points = 0;
+    for (int i = 0; i < num_points; i++) {
+        int x0 = points[i].x - AREA_OFFSET;
+        int y0 = points[i].y - AREA_OFFSET;
+        region_stats_t stats;
+
+        // 5x5 Bereich um den Punkt messen
+        region_stats_area(rows, x0, y0, &stats);
+
+        float sum_distance = (float)stats.sum;
+        int valid_count = stats.count;
+        float min_distance = stats.min;
+        float max_distance = stats.max;
+
+        if (dump_raw) {
+            // Debug: Array für Rohdaten
+            uint16_t raw_values[AREA_SIZE * AREA_SIZE];
+            for (int dy = 0; dy < AREA_SIZE; dy++) {
+                for (int dx = 0; dx < AREA_SIZE; dx++) {
+                    raw_values[dy * AREA_SIZE + dx] = rows[y0 + dy][x0 + dx];
+                }
+            }
+
+            // Debug: Ausgabe der Rohdaten für jeden Punkt
+            debug_print("\n----------------------------------------\n");
+            debug_print("DEBUG Point %s Raw Values (Timestamp: %ld):\n", 
+                       points[i].name, time(NULL));
+            for (int y = 0; y < AREA_SIZE; y++) {
+                debug_print("  ");
+                for (int x = 0; x < AREA_SIZE; x++) {
+                    debug_print("%5d ", raw_values[y * AREA_SIZE + x]);
+                }
+                debug_print("\n");
+            }
+            debug_print("Valid pixels: %d/%d\n", valid_count, AREA_SIZE * AREA_SIZE);
+            debug_print("Min distance: %.1f mm\n", min_distance);
+            debug_print("Max distance: %.1f mm\n", max_distance);
+            if (valid_count > 0) {
+                debug_print("Average distance: %.1f mm\n", sum_distance / valid_count);
+            }
+            debug_print("----------------------------------------\n");
+        }
+        
+        // Messung ist gültig wenn mindestens die konfigurierte Anzahl Pixel gültig sind
+        if (valid_count >= min_valid_pixels) {
+            points[i].distance = sum_distance / valid_count;
+            points[i].min_distance = min_distance;
+            points[i].max_distance = max_distance;
+            points[i].valid_pixels = valid_count;
+            if (optical_path_host) {
+                // Gleicher Bereich in der Rohwert-Ebene
+                region_stats_t raw;
+                region_stats_area((const depth_row_t *)g_range, x0, y0, &raw);
+                points[i].range = raw.count ? (float)raw.sum / raw.count : 0.0f;
+            }
+            points[i].flags.valid = 1; // Update bitfield
+            points[i].timestamp = time(NULL); // Update timestamp
+            points[i].updated_ms = monotonic_ms();
+            valid_points++;
+            
+            if (dump_raw) {
+                debug_print("Messung gültig: %d/%d Pixel (min: %d)\n", 
+                          valid_count, AREA_SIZE * AREA_SIZE, min_valid_pixels);
+            }
+        } else {
+            points[i].flags.valid = 0; // Update bitfield
+            points[i].valid_pixels = valid_count;
+            
+            if (dump_raw) {
+                debug_print("Messung ungültig: %d/%d Pixel (min: %d)\n", 
+                          valid_count, AREA_SIZE * AREA_SIZE, min_valid_pixels);
+            }
+        }
+    }
+    if (!dump_raw) {
+        debug_print("Messpunkte: %d/%d gültig (Rohdaten pro Punkt mit debug=2)\n", valid_points, num_points);
+    }
+}
+
+// Messpunkte aus Full-ROI-Paketen auswerten (data_mutex gehalten).
+// Nur die Zonen der Gruppe des Pakets werden aktualisiert, alle anderen
+// behalten ihren letzten Wert und altern. Jeder Punkt nimmt die erste
+// Geräte-ROI, deren Rechteck ihn enthält.
+static void evaluate_roi_points(void) {
+    static uint16_t scratch[HPS3D_MAX_PIXEL_NUMBER];
+    const HPS3D_FullRoiData_t *rois = g_measureData.full_roi_data;
+    int roi_num = rois[0].roi_num;
+    int group = rois[0].group_id;
+    uint64_t now_ms = monotonic_ms();
+    if (roi_num > HPS3D_MAX_ROI_NUMBER) {
+        roi_num = HPS3D_MAX_ROI_NUMBER;
+    }
+
+    atomic_fetch_add(&points_generation, 1);
+    roi_sched_mark(&g_roi_sched, group, now_ms);
+    for (int i = 0; i < num_points; i++) {
+        if (points[i].group != group) {
+            continue;
+        }
+        const HPS3D_FullRoiData_t *roi = NULL;
+        for (int r = 0; r < roi_num && !roi; r++) {
+            roi = roi_contains(&rois[r], points[i].x, points[i].y) ? &rois[r] : NULL;
+        }
+        if (!roi) {
+            points[i].flags.valid = 0;
+            points[i].valid_pixels = 0;
+            debug_print("Punkt %s liegt in keiner ROI der Gruppe %d\n", points[i].name, group);
+            continue;
+        }
+
+        roi_robust_t stats;
+        roi_robust_stats(roi->distance, roi->pixel_number, roi_outlier_k, scratch, &stats);
+        debug_print("Punkt %s: ROI %d (%d,%d)-(%d,%d), %d/%u gültig, Median %.1f mm, MAD %.1f mm, %d Ausreißer\n",
+                    points[i].name, roi->roi_id, roi->left_top_x, roi->left_top_y,
+                    roi->right_bottom_x, roi->right_bottom_y, stats.valid, roi->pixel_number,
+                    stats.median, stats.mad, stats.valid - stats.inliers);
+
+        if (stats.inliers >= min_valid_pixels) {
+            points[i].distance = stats.mean;
+            points[i].min_distance = stats.min;
+            points[i].max_distance = stats.max;
+            points[i].valid_pixels = stats.inliers;
+            points[i].flags.valid = 1;
+            points[i].timestamp = time(NULL);
+            points[i].updated_ms = now_ms;
+        } else {
+            points[i].flags.valid = 0;
+            points[i].valid_pixels = stats.inliers;
+        }
+    }
+}
+
+// Tote und eingefrorene Pixel aus den korrigierten Full-Depth-Werten lernen (Maske bei
+// Änderung speichern) und bekannte Defekte in Distanzebene, Punktwolke und Geräte-ROIs
+// ungültig machen, bevor Regionen oder Ausgaben den Frame sehen (data_mutex gehalten)
+static void mask_bad_pixels(HPS3D_EventType_t event_type) {
+    if (!pixel_health_enabled) {
+        return;
+    }
+    if (event_type == HPS3D_FULL_DEPTH_EVEN) {
+        HPS3D_DepthData_t *depth = &g_measureData.full_depth_data;
+        // Ab no_analytics ruht das Lernen, die gespeicherte Maske gilt weiter
+        if (atomic_load(&thermal_level) < THERMAL_NO_ANALYTICS && pixel_health_update(&g_pixels, depth->distance)) {
+            debug_print("Pixelmaske geändert: %u maskiert (%u tot, %u eingefroren)\n",
+                        g_pixels.bad_count, g_pixels.dead, g_pixels.stuck);
+            if (pixel_mask_file[0] && pixel_health_save(&g_pixels, pixel_mask_file) != 0) {
+                debug_print("WARNUNG: Pixelmaske %s nicht gespeichert (%s)\n", pixel_mask_file, strerror(errno));
+            }
+        }
+        pixel_health_apply(&g_pixels, depth->distance, depth->point_cloud_data.point_data);
+    } else if (event_type == HPS3D_FULL_ROI_EVEN && g_pixels.bad_count) {
+        HPS3D_FullRoiData_t *rois = g_measureData.full_roi_data;
+        int roi_num = rois[0].roi_num < HPS3D_MAX_ROI_NUMBER ? rois[0].roi_num : HPS3D_MAX_ROI_NUMBER;
+        for (int r = 0; r < roi_num; r++) {
+            pixel_health_apply_roi(&g_pixels, &rois[r]);
+        }
+    }
+}
+
+// Rohwerte als Schrägentfernung behalten, Distanzebene senkrecht machen (erster Schritt nach dem Dekodieren)
+static void split_optical_path(HPS3D_EventType_t event_type) {
+    if (!optical_path_host) {
+        return;
+    }
+    if (event_type == HPS3D_FULL_DEPTH_EVEN) {
+        optical_path_split(&g_optical, g_measureData.full_depth_data.distance, g_range);
+    } else if (event_type == HPS3D_FULL_ROI_EVEN) {
+        HPS3D_FullRoiData_t *rois = g_measureData.full_roi_data;
+        int roi_num = rois[0].roi_num < HPS3D_MAX_ROI_NUMBER ? rois[0].roi_num : HPS3D_MAX_ROI_NUMBER;
+        for (int r = 0; r < roi_num; r++) {
+            optical_path_perpendicular_roi(&g_optical, &rois[r]);
+        }
+    }
+}
+
+// Festes Muster je Pixel aus der Kalibrierdatei herausrechnen
+static void correct_pixels(HPS3D_EventType_t event_type) {
+    if (!pixel_correction_enabled) {
+        return;
+    }
+    if (event_type == HPS3D_FULL_DEPTH_EVEN) {
+        pixel_correction_apply(&g_correction, g_measureData.full_depth_data.distance);
+    } else if (event_type == HPS3D_FULL_ROI_EVEN) {
+        HPS3D_FullRoiData_t *rois = g_measureData.full_roi_data;
+        int roi_num = rois[0].roi_num < HPS3D_MAX_ROI_NUMBER ? rois[0].roi_num : HPS3D_MAX_ROI_NUMBER;
+        for (int r = 0; r < roi_num; r++) {
+            pixel_correction_apply_roi(&g_correction, &rois[r]);
+        }
+    }
+}
+
+// Korrigierte Wolke einmal ins PointCloud2-Layout schreiben und an alle Ziele geben
+// (ab Stufe no_pointcloud ausgesetzt, wie die JSON-Punktwolke)
+static void publish_pointcloud2(HPS3D_EventType_t event_type) {
+    if ((!pointcloud2_mqtt && !g_pc2_shm) || event_type != HPS3D_FULL_DEPTH_EVEN ||
+        atomic_load(&thermal_level) >= THERMAL_NO_POINTCLOUD) {
+        return;
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    uint32_t seq = atomic_fetch_add(&pointcloud2_frames, 1) + 1;
+    if (pointcloud2_posed) {
+        cloud_transform(&g_cloud, pointcloud2_pose, &g_cloud);
+    }
+    pointcloud2_fill(&g_pc2, &g_cloud, g_measureData.full_depth_data.distance, seq,
+                     (int64_t)now.tv_sec * 1000000000LL + now.tv_nsec);
+    if (g_pc2_shm) {
+        pointcloud2_shm_publish(g_pc2_shm, &g_pc2);
+    }
+    if (pointcloud2_mqtt && mosq && atomic_load(&mqtt_connected)) {
+        int rc = mosquitto_publish(mosq, NULL, MQTT_POINTCLOUD2_TOPIC, (int)sizeof(g_pc2), &g_pc2, 0, false);
+        if (rc != MOSQ_ERR_SUCCESS) {
+            debug_print("PointCloud2-Publish fehlgeschlagen: %d\n", rc);
+        }
+    }
+}
+
+// Min/Max-Tabelle über die maskierte Distanzebene, danach alle Zonen mit je einer O(1)-Abfrage.
+// Ab no_analytics kein Neuaufbau: Tabelle und Zonen bleiben auf dem letzten Frame (minmax_frames)
+static void evaluate_zones(HPS3D_EventType_t event_type) {
+    if (!minmax_index || event_type != HPS3D_FULL_DEPTH_EVEN ||
+        atomic_load(&thermal_level) >= THERMAL_NO_ANALYTICS) {
+        return;
+    }
+    region_minmax_build(&g_minmax, g_measureData.full_depth_data.distance);
+    for (int z = 0; z < num_zones; z++) {
+        region_minmax_query(&g_minmax, minmax_zones[z].x0, minmax_zones[z].y0, minmax_zones[z].w, minmax_zones[z].h,
+                            &zone_min[z], &zone_max[z]);
+    }
+    minmax_frames++;
+}
+
+// Tiefenverteilung des ganzen Frames und jeder Zone (ab no_analytics ausgesetzt)
+static void evaluate_histograms(HPS3D_EventType_t event_type) {
+    if (!depth_histogram || event_type != HPS3D_FULL_DEPTH_EVEN ||
+        atomic_load(&thermal_level) >= THERMAL_NO_ANALYTICS) {
+        return;
+    }
+    const uint16_t *distance = g_measureData.full_depth_data.distance;
+    depth_hist_compute(&g_hist_frame, &g_hist_scratch, &g_hist_range, distance, SENSOR_WIDTH,
+                       0, 0, SENSOR_WIDTH, SENSOR_HEIGHT);
+    for (int z = 0; g_hist_zones && z < num_zones; z++) {
+        depth_hist_compute(&g_hist_zones[z], &g_hist_scratch, &g_hist_range, distance, SENSOR_WIDTH,
+                           minmax_zones[z].x0, minmax_zones[z].y0, minmax_zones[z].w, minmax_zones[z].h);
+    }
+    histogram_frames++;
+}
+
+// ROI-Modus: eine Gruppe ohne Rechteck auf dem Gerät liefert Tiefen- statt
+// ROI-Pakete (bzw. ROI-Pakete ohne ROI). Einmal je Gruppe warnen
+static void check_roi_group(HPS3D_EventType_t event_type) {
+    static uint32_t warned;             // Bit je Gruppe 0-15
+    if (!roi_mode) {
+        return;
+    }
+    int group = -1;
+    if (event_type == HPS3D_FULL_ROI_EVEN && g_measureData.full_roi_data[0].roi_num == 0) {
+        group = g_measureData.full_roi_data[0].group_id;
+    } else if (event_type == HPS3D_FULL_DEPTH_EVEN || event_type == HPS3D_SIMPLE_DEPTH_EVEN) {
+        group = g_roi_sched.current;    // Zuletzt gewählte Gruppe
+    }
+    if (group < 0 || group > 15 || (warned & (1u << group))) {
+        return;
+    }
+    warned |= 1u << group;
+    debug_print("WARNUNG: ROI-Gruppe %d hat auf dem Gerät kein ROI-Rechteck - Rechtecke vorab mit dem "
+                "Hersteller-Tool einrichten und speichern; bis dahin gilt das Vollbild\n", group);
+}
+
+// Ausgewertetes Paket in g_measureData je nach Typ auf die Messpunkte anwenden (data_mutex gehalten)
+static void evaluate_measurement(HPS3D_EventType_t event_type) {
+    check_roi_group(event_type);
+    split_optical_path(event_type);
+    correct_pixels(event_type);
+    mask_bad_pixels(event_type);
+    publish_pointcloud2(event_type);
+    evaluate_zones(event_type);
+    evaluate_histograms(event_type);
+    if (event_type == HPS3D_FULL_DEPTH_EVEN) {
+        evaluate_points();
+    } else if (event_type == HPS3D_FULL_ROI_EVEN) {
+        evaluate_roi_points();
+    }
+    mark_first_frame();
+}
+
+// Messpaket nach g_measureData dekodieren (data_mutex gehalten). Mit PointCloud2-Ausgabe
+// gehen die Full-Depth-Punkte direkt in die SoA-Wolke statt ins SDK-Array
+static int decode_frame(const frame_buf_t *frame) {
+    if (g_cloud.x && frame->event_type == HPS3D_FULL_DEPTH_EVEN) {
+        return packet_parse_full_depth_soa(frame->data, frame->len, &g_measureData.full_depth_data, &g_cloud);
+    }
+    return HPS3D_ConvertToMeasureDataChecked(frame->data, frame->len, &g_measureData,
+                                             (HPS3D_EventType_t)frame->event_type);
+}
+
+// Einzelne Messung durchführen. Nur im Mess-Thread: einziger Verbraucher der
+// Paket-Warteschlange, des Änderungs-Gates und des Trigger-Vorlaufs
 int measure_points() {
     if (!HPS3D_IsConnect(g_handle)) {
         debug_print("FEHLER: LIDAR nicht verbunden\n");
         return -1;
     }
 
+    // Bevorzugt das neueste Paket aus dem Callback-Stream auswerten
+    if (g_device && !capture_scheduled) {
+        frame_buf_t *frame = take_latest_frame(STREAM_WAIT_MS);
+        if (frame && change_gate_check(&g_gate, frame->data, frame->len,
+                                       (HPS3D_EventType_t)frame->event_type) == CHANGE_GATE_SKIP) {
+            // Szene unverändert: kein Dekodieren, keine Auswertung, kein Publish
+            retire_frame(frame);
+            atomic_store(&frames_skipped, g_gate.frames_skipped);
+            confirm_points();
+            return 0;
+        }
+        if (frame) {
+            pthread_mutex_lock(&data_mutex);
+            int len = decode_frame(frame);
+            if (len >= 0) {
+                evaluate_measurement((HPS3D_EventType_t)frame->event_type);
+            }
+            pthread_mutex_unlock(&data_mutex);
+            retire_frame(frame);
+
+            if (len >= 0) {
+                return 0;
+            }
+            debug_print("WARNUNG: Ungültiges Paket im Stream (%d Bytes) - Einzelmessung\n", frame->len);
+        }
+    }
+
     // Add delay before measurement to ensure sensor is ready
-    usleep(50000);  // 50ms pause before measurement
+    // (im Bus-Zeitplan hat das Warten auf das eigene Fenster diese Rolle)
+    if (!capture_scheduled) {
+        usleep(50000);  // 50ms pause before measurement
+    }
 
     // Try measurement up to 3 times
     for (int retry = 0; retry < 3; retry++) {
         HPS3D_EventType_t event_type;
+        if (capture_scheduled) {
+            capture_sched_begin(&g_capture);
+        }
         HPS3D_StatusTypeDef ret = HPS3D_SingleCapture(g_handle, &event_type, &g_measureData);
+        if (capture_scheduled) {
+            capture_sched_end(&g_capture, ret == HPS3D_RET_OK);
+            capture_publish_stats();
+        }
         
         if (ret == HPS3D_RET_OK) {
             pthread_mutex_lock(&data_mutex);
             
-            // Alle 4 Punkte messen
-            if (event_type == HPS3D_FULL_DEPTH_EVEN) {
-                for (int i = 0; i < MAX_POINTS; i++) {
-                    int center_x = points[i].x;
-                    int center_y = points[i].y;
-                    float sum_distance = 0;
-                    int valid_count = 0;
-                    float min_distance = 65000;
-                    float max_distance = 0;
-                    
-                    // Debug: Array für Rohdaten
-                    uint16_t raw_values[AREA_SIZE * AREA_SIZE];
-                    int raw_idx = 0;
-                    
-                    // 5x5 Bereich um den Punkt messen
-                    for (int dy = -AREA_OFFSET; dy <= AREA_OFFSET; dy++) {
-                        for (int dx = -AREA_OFFSET; dx <= AREA_OFFSET; dx++) {
-                            int x = center_x + dx;
-                            int y = center_y + dy;
-                            int pixel_index = y * 160 + x;
-                            
-                            uint16_t distance_raw = g_measureData.full_depth_data.distance[pixel_index];
-                            raw_values[raw_idx++] = distance_raw;
-                            
-                            // Erweiterte Gültigkeitsprüfung
-                            if (distance_raw > 0 && distance_raw < 65000 && 
-                                distance_raw != HPS3D_LOW_AMPLITUDE && 
-                                distance_raw != HPS3D_SATURATION && 
-                                distance_raw != HPS3D_ADC_OVERFLOW && 
-                                distance_raw != HPS3D_INVALID_DATA) {
-                                
-                                sum_distance += distance_raw;
-                                valid_count++;
-                                
-                                if (distance_raw < min_distance) min_distance = distance_raw;
-                                if (distance_raw > max_distance) max_distance = distance_raw;
-                            }
-                        }
-                    }
-                    
-                    // Debug: Ausgabe der Rohdaten für jeden Punkt
-                    debug_print("\n----------------------------------------\n");
-                    debug_print("DEBUG Point %s Raw Values (Timestamp: %ld):\n", 
-                               points[i].name, time(NULL));
-                    for (int y = 0; y < AREA_SIZE; y++) {
-                        debug_print("  ");
-                        for (int x = 0; x < AREA_SIZE; x++) {
-                            debug_print("%5d ", raw_values[y * AREA_SIZE + x]);
-                        }
-                        debug_print("\n");
-                    }
-                    debug_print("Valid pixels: %d/%d\n", valid_count, AREA_SIZE * AREA_SIZE);
-                    debug_print("Min distance: %.1f mm\n", min_distance);
-                    debug_print("Max distance: %.1f mm\n", max_distance);
-                    if (valid_count > 0) {
-                        debug_print("Average distance: %.1f mm\n", sum_distance / valid_count);
-                    }
-                    debug_print("----------------------------------------\n");
-                    
-                    // Messung ist gültig wenn mindestens die konfigurierte Anzahl Pixel gültig sind
-                    if (valid_count >= min_valid_pixels) {
-                        points[i].distance = sum_distance / valid_count;
-                        points[i].min_distance = min_distance;
-                        points[i].max_distance = max_distance;
-                        points[i].valid_pixels = valid_count;
-                        points[i].flags.valid = 1; // Update bitfield
-                        points[i].timestamp = time(NULL); // Update timestamp
-                        
-                        debug_print("Messung gültig: %d/%d Pixel (min: %d)\n", 
-                                  valid_count, AREA_SIZE * AREA_SIZE, min_valid_pixels);
-                    } else {
-                        points[i].flags.valid = 0; // Update bitfield
-                        points[i].valid_pixels = valid_count;
-                        
-                        debug_print("Messung ungültig: %d/%d Pixel (min: %d)\n", 
-                                  valid_count, AREA_SIZE * AREA_SIZE, min_valid_pixels);
-                    }
-                }
+            // Das SDK dekodiert nur ins AoS-Array
+            if (g_cloud.x && event_type == HPS3D_FULL_DEPTH_EVEN) {
+                pointcloud_aos_to_soa(g_measureData.full_depth_data.point_cloud_data.point_data, SENSOR_PIXELS,
+                                      &g_cloud);
             }
+
+            // Alle 4 Punkte messen
+            evaluate_measurement(event_type);
             
             pthread_mutex_unlock(&data_mutex);
             return 0;
@@ -487,7 +1278,7 @@ int measure_points() {
             HPS3D_StopCapture(g_handle);
             usleep(100000);  // 100ms Pause vor Reconnect
             
-            ret = HPS3D_StartCapture(g_handle);
+            ret = capture_scheduled ? HPS3D_RET_OK : HPS3D_StartCapture(g_handle);
             if (ret != HPS3D_RET_OK) {
                 debug_print("FEHLER: Reconnect fehlgeschlagen\n");
                 return -1;
@@ -506,27 +1297,40 @@ int measure_points() {
 
 // JSON String für Output erstellen
 char* create_json_output() {
-    static char json_buffer[4096];
+    static char json_buffer[512 + MAX_POINTS * POINT_JSON_SIZE];
+    const size_t size = sizeof(json_buffer);
+    uint64_t now_ms = monotonic_ms();
     pthread_mutex_lock(&data_mutex);
     
-    snprintf(json_buffer, sizeof(json_buffer),
+    int pos = snprintf(json_buffer, size,
         "{"
         "\"timestamp\": %ld,"
         "\"active\": %s,"
         "\"device_connected\": %s,"
         "\"power_save_mode\": %s,"
         "\"connection_retries\": %d,"
+        "\"frames_skipped\": %u,"
         "\"measurements\": {",
         time(NULL),
         atomic_load(&measurement_active) ? "true" : "false",
         atomic_load(&device_connected) ? "true" : "false",
         atomic_load(&power_save_mode) ? "true" : "false",
-        atomic_load(&connection_retries)
+        atomic_load(&connection_retries),
+        atomic_load(&frames_skipped)
     );
     
-    for (int i = 0; i < MAX_POINTS; i++) {
-        char point_json[512];
-        snprintf(point_json, sizeof(point_json),
+    for (int i = 0; i < num_points && pos < (int)size; i++) {
+        // Alter in ms seit der letzten Aktualisierung, -1 = noch nie gemessen
+        long age_ms = points[i].updated_ms ? (long)(now_ms - points[i].updated_ms) : -1;
+        char group_json[32] = "";
+        if (roi_mode) {
+            snprintf(group_json, sizeof(group_json), "\"roi_group\": %d,", points[i].group);
+        }
+        char range_json[32] = "";
+        if (optical_path_host && !roi_mode) {
+            snprintf(range_json, sizeof(range_json), "\"range_mm\": %.1f,", points[i].range);
+        }
+        pos += snprintf(json_buffer + pos, size - pos,
             "\"%s\": {"
             "\"distance_mm\": %.1f,"
             "\"distance_m\": %.3f,"
@@ -535,6 +1339,8 @@ char* create_json_output() {
             "\"valid_pixels\": %d,"
             "\"valid\": %s,"
             "\"age_seconds\": %ld,"
+            "\"age_ms\": %ld,"
+            "%s%s"
             "\"coordinates\": {\"x\": %d, \"y\": %d}"
             "}%s",
             points[i].name,
@@ -545,23 +1351,156 @@ char* create_json_output() {
             points[i].valid_pixels,
             points[i].flags.valid ? "true" : "false",
             time(NULL) - points[i].timestamp,
+            age_ms,
+            group_json,
+            range_json,
             points[i].x, points[i].y,
-            (i < MAX_POINTS-1) ? "," : ""
+            (i < num_points-1) ? "," : ""
         );
-        strcat(json_buffer, point_json);
     }
     
-    strcat(json_buffer, "}}");
+    if (pos < (int)size) {
+        snprintf(json_buffer + pos, size - pos, "}}");
+    }
     pthread_mutex_unlock(&data_mutex);
     
     return json_buffer;
 }
 
+static int find_output_profile(const char *name, size_t len) {
+    for (int p = 0; p < num_profiles; p++) {
+        if (strlen(g_profiles[p].name) == len && strncmp(g_profiles[p].name, name, len) == 0) {
+            return p;
+        }
+    }
+    return -1;
+}
+
+// Messpunkte für die Ausgabeprofile kopieren. *available: Felder, die in der
+// aktuellen Betriebsart Werte haben (range_mm/roi_group wie in create_json_output)
+static int snapshot_out_points(out_point_t *out, uint32_t *available) {
+    uint64_t now_ms = monotonic_ms();
+    pthread_mutex_lock(&data_mutex);
+    *available = OUT_FIELD_ALL;
+    if (!roi_mode) {
+        *available &= ~(uint32_t)OUT_FIELD_ROI_GROUP;
+    }
+    if (!optical_path_host || roi_mode) {
+        *available &= ~(uint32_t)OUT_FIELD_RANGE_MM;
+    }
+    for (int i = 0; i < num_points; i++) {
+        out_point_t *o = &out[i];
+        memcpy(o->name, points[i].name, sizeof(o->name));
+        o->distance_mm = points[i].distance;
+        o->min_mm = points[i].min_distance;
+        o->max_mm = points[i].max_distance;
+        o->range_mm = points[i].range;
+        o->valid_pixels = points[i].valid_pixels;
+        o->valid = points[i].flags.valid;
+        o->age_ms = points[i].updated_ms ? (long)(now_ms - points[i].updated_ms) : -1;
+        o->x = points[i].x;
+        o->y = points[i].y;
+        o->group = points[i].group;
+    }
+    int count = num_points;
+    pthread_mutex_unlock(&data_mutex);
+    return count;
+}
+
+// Zonen kompakt als [min, max] in Konfigurationsreihenfolge; [0, 0] = kein gültiges Pixel
+static int create_zones_json(char *out, size_t size) {
+    pthread_mutex_lock(&data_mutex);
+    int pos = snprintf(out, size, "{\"frame\": %u, \"zones\": [", minmax_frames);
+    for (int z = 0; z < num_zones && pos < (int)size; z++) {
+        int valid = zone_max[z] != 0;
+        pos += snprintf(out + pos, size - pos, "%s[%u,%u]", z ? "," : "", valid ? zone_min[z] : 0u, zone_max[z]);
+    }
+    pthread_mutex_unlock(&data_mutex);
+    if (pos < (int)size) {
+        pos += snprintf(out + pos, size - pos, "]}");
+    }
+    return pos < (int)size ? pos : -1;
+}
+
+// Histogramm kompakt: Klassen als Array, Zonen (nur Klassen) in Konfigurationsreihenfolge.
+// zone >= 0: nur diese Zone. Rückgabe Länge, -1 wenn out zu klein ist
+static int create_histogram_json(char *out, size_t size, int zone) {
+    pthread_mutex_lock(&data_mutex);
+    const depth_hist_t *hist = zone >= 0 ? &g_hist_zones[zone] : &g_hist_frame;
+    int pos = snprintf(out, size, "{\"frame\": %u, \"bins\": %d, \"min_mm\": %u, \"max_mm\": %u, ",
+                       histogram_frames, g_hist_range.bins, g_hist_range.min_mm, g_hist_range.max_mm);
+    if (zone >= 0 && pos < (int)size) {
+        pos += snprintf(out + pos, size - pos, "\"zone\": %d, ", zone);
+    }
+    if (pos < (int)size) {
+        pos += snprintf(out + pos, size - pos, "\"histogram\": ");
+    }
+    int len = pos < (int)size ? depth_hist_counts_json(hist, out + pos, size - pos) : -1;
+    pos = len < 0 ? (int)size : pos + len;
+    if (pos < (int)size) {
+        pos += snprintf(out + pos, size - pos, ", \"below\": %u, \"above\": %u, \"invalid\": %u",
+                        hist->below, hist->above, hist->invalid);
+    }
+    uint16_t lo, hi;
+    if (hist_auto_low >= 0.0f && pos < (int)size &&
+        depth_hist_auto_range(hist, hist_auto_low, hist_auto_high, &lo, &hi) == 0) {
+        pos += snprintf(out + pos, size - pos, ", \"range\": [%u, %u]", lo, hi);
+    }
+    if (zone < 0 && g_hist_zones && num_zones && pos < (int)size) {
+        pos += snprintf(out + pos, size - pos, ", \"zones\": [");
+        for (int z = 0; z < num_zones && pos < (int)size; z++) {
+            if (z) {
+                pos += snprintf(out + pos, size - pos, ",");
+            }
+            len = pos < (int)size ? depth_hist_counts_json(&g_hist_zones[z], out + pos, size - pos) : -1;
+            pos = len < 0 ? (int)size : pos + len;
+        }
+        if (pos < (int)size) {
+            pos += snprintf(out + pos, size - pos, "]");
+        }
+    }
+    pthread_mutex_unlock(&data_mutex);
+    if (pos < (int)size) {
+        pos += snprintf(out + pos, size - pos, "}");
+    }
+    return pos < (int)size ? pos : -1;
+}
+
+// Jedes Ausgabeprofil einmal je Schnappschuss kodieren; HTTP liefert die
+// zwischengespeicherte Nutzlast, MQTT bekommt sie auf dem Profil-Topic
+static void publish_output_profiles(void) {
+    static out_point_t snapshot[MAX_POINTS];
+    if (num_profiles == 0) {
+        return;
+    }
+    uint32_t available;
+    int count = snapshot_out_points(snapshot, &available);
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    int64_t timestamp_ms = (int64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+
+    for (int p = 0; p < num_profiles; p++) {
+        output_profile_t profile = g_profiles[p];
+        profile.fields &= available;
+        pthread_mutex_lock(&profile_mutex);
+        int len = serialize_points(&profile, snapshot, count, timestamp_ms,
+                                   g_profile_out[p].payload, sizeof(g_profile_out[p].payload));
+        g_profile_out[p].len = len > 0 ? len : 0;
+        if (len < 0) {
+            debug_print("WARNUNG: Ausgabeprofil %s zu groß für den Puffer\n", profile.name);
+        } else if (profile.topic[0] && mosq && atomic_load(&mqtt_connected)) {
+            int rc = mosquitto_publish(mosq, NULL, profile.topic, len, g_profile_out[p].payload, 0, false);
+            if (rc != MOSQ_ERR_SUCCESS) {
+                debug_print("MQTT Publish für Profil %s fehlgeschlagen: %d\n", profile.name, rc);
+            }
+        }
+        pthread_mutex_unlock(&profile_mutex);
+    }
+}
+
 // JSON String für Punktwolke erstellen
 char* create_pointcloud_json() {
-    static char json_buffer[160*60*50];  // Mehr Speicher für JSON
-    int buffer_pos = 0;
-    int remaining = sizeof(json_buffer);
+    static char json_buffer[SENSOR_PIXELS*50];  // Mehr Speicher für JSON
     
     pthread_mutex_lock(&data_mutex);
     
@@ -574,58 +1513,274 @@ char* create_pointcloud_json() {
         return NULL;
     }
     
-    // Header schreiben
-    buffer_pos += snprintf(json_buffer + buffer_pos, remaining,
-        "{\"timestamp\":%ld,\"width\":%d,\"height\":%d,\"data\":[",
-        time(NULL), 160, 60);
-    remaining = sizeof(json_buffer) - buffer_pos;
-    
     int valid_points = 0;
-    // Alle Pixel durchgehen
-    for (int y = 0; y < 60 && remaining > 0; y++) {
-        for (int x = 0; x < 160 && remaining > 0; x++) {
-            int pixel_index = y * 160 + x;
-            uint16_t distance = g_measureData.full_depth_data.distance[pixel_index];
-            
-            // Nur gültige Werte senden
-            if (distance > 0 && distance < 65000 && 
-                distance != HPS3D_LOW_AMPLITUDE && 
-                distance != HPS3D_SATURATION && 
-                distance != HPS3D_ADC_OVERFLOW && 
-                distance != HPS3D_INVALID_DATA) {
-                
-                // Komma hinzufügen wenn nicht erster Punkt
-                if (valid_points > 0) {
-                    buffer_pos += snprintf(json_buffer + buffer_pos, remaining, ",");
-                    remaining = sizeof(json_buffer) - buffer_pos;
-                }
-                
-                // Punkt hinzufügen
-                buffer_pos += snprintf(json_buffer + buffer_pos, remaining,
-                    "{\"x\":%d,\"y\":%d,\"d\":%d}",
-                    x, y, distance);
-                remaining = sizeof(json_buffer) - buffer_pos;
-                valid_points++;
-            }
-        }
+    if (serialize_cloud_json(g_measureData.full_depth_data.distance, optical_path_host ? g_range : NULL,
+                             SENSOR_WIDTH, SENSOR_HEIGHT,
+                             time(NULL), json_buffer, sizeof(json_buffer), &valid_points) < 0) {
+        debug_print("FEHLER: Punktwolken-JSON passt nicht in den Puffer\n");
+        pthread_mutex_unlock(&data_mutex);
+        return NULL;
     }
     
-    // JSON abschließen
-    buffer_pos += snprintf(json_buffer + buffer_pos, remaining, "]}");
-    
     debug_print("Punktwolken-JSON erstellt mit %d gültigen Punkten\n", valid_points);
     
     pthread_mutex_unlock(&data_mutex);
     return json_buffer;
 }
 
+// N aufeinanderfolgende Frames erfassen, zusammenführen und als JSON ausgeben.
+// Läuft im Mess-Thread; Rückgabe 0 bei Erfolg, -1 bei Fehler (out enthält dann den Fehler)
+static int capture_burst(int frames, burst_mode_t mode, char *out, size_t out_size) {
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if (!g_burst.frames && burst_init(&g_burst, BURST_MAX_FRAMES, SENSOR_PIXELS) != 0) {
+        snprintf(out, out_size, "{\"error\": \"burst buffer allocation failed\"}");
+        return -1;
+    }
+    burst_reset(&g_burst);
+
+    // Rückstand verwerfen - der Burst soll nur frische, aufeinanderfolgende Frames enthalten
+    if (g_device) {
+        frame_buf_t *stale;
+        while ((stale = event_dispatch_next(g_device, 0)) != NULL) {
+            if (!is_measure_event(stale->event_type)) {
+                handle_status_event(stale);
+            }
+            retire_frame(stale);
+        }
+    }
+
+    // Gleiche Zielpuffer wie g_measureData, nur die Distanzebene zeigt in den Burst-Slot
+    HPS3D_MeasureData_t target = g_measureData;
+    int attempts = 0;
+    while (g_burst.count < frames && attempts++ < frames * 3 && running) {
+        target.full_depth_data.distance = burst_next_frame(&g_burst);
+        int ok = 0;
+
+        frame_buf_t *buf = NULL;
+        if (capture_scheduled) {
+            // Im Bus-Zeitplan läuft kein Stream: jeder Frame in einem eigenen Fenster
+            capture_sched_wait(&g_capture, measure_interval_ms());
+        } else if (g_device) {
+            buf = event_dispatch_next(g_device, STREAM_WAIT_MS);
+        }
+        pthread_mutex_lock(&data_mutex);
+        if (buf) {
+            ok = buf->event_type == HPS3D_FULL_DEPTH_EVEN &&
+                 HPS3D_ConvertToMeasureDataChecked(buf->data, buf->len, &target, HPS3D_FULL_DEPTH_EVEN) >= 0;
+        } else {
+            // Kein Stream - Einzelmessung
+            HPS3D_EventType_t event_type;
+            if (capture_scheduled) {
+                capture_sched_begin(&g_capture);
+            }
+            ok = HPS3D_SingleCapture(g_handle, &event_type, &target) == HPS3D_RET_OK;
+            if (capture_scheduled) {
+                capture_sched_end(&g_capture, ok);
+                capture_publish_stats();
+            }
+            ok = ok && event_type == HPS3D_FULL_DEPTH_EVEN;
+        }
+        if (ok && optical_path_host) {
+            optical_path_perpendicular(&g_optical, target.full_depth_data.distance);
+        }
+        if (ok && pixel_correction_enabled) {
+            pixel_correction_apply(&g_correction, target.full_depth_data.distance);
+        }
+        if (ok && pixel_health_enabled) {
+            pixel_health_apply(&g_pixels, target.full_depth_data.distance, NULL);
+        }
+        pthread_mutex_unlock(&data_mutex);
+
+        if (buf) {
+            if (!is_measure_event(buf->event_type)) {
+                handle_status_event(buf);
+            }
+            retire_frame(buf);
+        }
+        if (ok) {
+            burst_commit_frame(&g_burst);
+        }
+    }
+
+    if (g_burst.count == 0) {
+        snprintf(out, out_size, "{\"error\": \"no frames captured\"}");
+        return -1;
+    }
+
+    // Pixel gilt nur, wenn er in mindestens der Hälfte der Frames gültig war
+    burst_merge(&g_burst, mode, (g_burst.count + 1) / 2);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    long duration_ms = (end.tv_sec - start.tv_sec) * 1000 + (end.tv_nsec - start.tv_nsec) / 1000000;
+
+    int pos = snprintf(out, out_size,
+        "{\"timestamp\": %ld, \"burst\": {\"frames\": %d, \"requested\": %d, "
+        "\"mode\": \"%s\", \"duration_ms\": %ld}, \"measurements\": {",
+        time(NULL), g_burst.count, frames, burst_mode_name(mode), duration_ms);
+
+    for (int i = 0; i < num_points && pos < (int)out_size; i++) {
+        burst_region_t region;
+        burst_region(&g_burst, SENSOR_WIDTH, points[i].x - AREA_OFFSET, points[i].y - AREA_OFFSET,
+                     AREA_SIZE, AREA_SIZE, &region);
+        pos += snprintf(out + pos, out_size - pos,
+            "\"%s\": {"
+            "\"distance_mm\": %.2f,"
+            "\"std_error_mm\": %.2f,"
+            "\"min_distance_mm\": %.1f,"
+            "\"max_distance_mm\": %.1f,"
+            "\"valid_pixels\": %d,"
+            "\"frames_used\": %d,"
+            "\"valid\": %s,"
+            "\"coordinates\": {\"x\": %d, \"y\": %d}"
+            "}%s",
+            points[i].name, region.distance, region.std_error, region.min, region.max,
+            region.valid_pixels, region.frames_used,
+            region.valid_pixels >= min_valid_pixels ? "true" : "false",
+            points[i].x, points[i].y,
+            (i < num_points-1) ? "," : "");
+    }
+    if (pos < (int)out_size) {
+        snprintf(out + pos, out_size - pos, "}}");
+    }
+
+    debug_print("Burst abgeschlossen: %d/%d Frames (%s) in %ld ms\n",
+                g_burst.count, frames, burst_mode_name(mode), duration_ms);
+    return 0;
+}
+
+// Burst anfordern; -1 wenn bereits einer läuft, -2 wenn thermisch gesperrt
+static int request_burst(int frames, burst_mode_t mode, int reply_mqtt) {
+    if (atomic_load(&thermal_level) >= THERMAL_NO_ANALYTICS) {
+        return -2;
+    }
+    int ret = -1;
+    pthread_mutex_lock(&burst_ctl.lock);
+    if (burst_ctl.state == BURST_IDLE) {
+        burst_ctl.frames = frames;
+        burst_ctl.mode = mode;
+        burst_ctl.reply_mqtt = reply_mqtt;
+        burst_ctl.state = BURST_PENDING;
+        ret = 0;
+    }
+    pthread_mutex_unlock(&burst_ctl.lock);
+    return ret;
+}
+
+// Anstehenden Burst im Mess-Thread ausführen (device_ready = LIDAR aktiv und verbunden)
+static void service_burst_request(bool device_ready) {
+    pthread_mutex_lock(&burst_ctl.lock);
+    if (burst_ctl.state != BURST_PENDING) {
+        pthread_mutex_unlock(&burst_ctl.lock);
+        return;
+    }
+    int frames = burst_ctl.frames;
+    burst_mode_t mode = burst_ctl.mode;
+    burst_ctl.state = BURST_RUNNING;
+    pthread_mutex_unlock(&burst_ctl.lock);
+
+    // Ergebnis außerhalb des Locks erzeugen, der Puffer gehört bis BURST_DONE dem Mess-Thread
+    if (device_ready) {
+        capture_burst(frames, mode, burst_ctl.result, sizeof(burst_ctl.result));
+    } else {
+        snprintf(burst_ctl.result, sizeof(burst_ctl.result), "{\"error\": \"measurement inactive\"}");
+    }
+
+    // reply_mqtt erst jetzt lesen: ein HTTP-Client mit Timeout leitet das Ergebnis auf MQTT um
+    pthread_mutex_lock(&burst_ctl.lock);
+    int reply_mqtt = burst_ctl.reply_mqtt;
+    pthread_mutex_unlock(&burst_ctl.lock);
+
+    if (reply_mqtt && mosq && atomic_load(&mqtt_connected)) {
+        int rc = mosquitto_publish(mosq, NULL, MQTT_BURST_TOPIC, strlen(burst_ctl.result),
+                                   burst_ctl.result, 0, false);
+        if (rc != MOSQ_ERR_SUCCESS) {
+            debug_print("FEHLER: Burst-Publish fehlgeschlagen: %d\n", rc);
+        }
+    }
+
+    pthread_mutex_lock(&burst_ctl.lock);
+    burst_ctl.state = reply_mqtt ? BURST_IDLE : BURST_DONE;
+    pthread_cond_broadcast(&burst_ctl.done);
+    pthread_mutex_unlock(&burst_ctl.lock);
+}
+
+// Auf das Ergebnis eines per HTTP angeforderten Bursts warten
+static int wait_burst_result(char *out, size_t out_size) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += BURST_TIMEOUT_MS / 1000;
+
+    int ret = 0;
+    pthread_mutex_lock(&burst_ctl.lock);
+    while ((burst_ctl.state == BURST_PENDING || burst_ctl.state == BURST_RUNNING) && ret == 0) {
+        ret = pthread_cond_timedwait(&burst_ctl.done, &burst_ctl.lock, &deadline);
+    }
+    if (burst_ctl.state == BURST_DONE) {
+        snprintf(out, out_size, "%s", burst_ctl.result);
+        burst_ctl.state = BURST_IDLE;
+        ret = 0;
+    } else {
+        // Zeitüberschreitung: noch nicht begonnen -> zurückziehen, sonst Ergebnis per MQTT
+        if (burst_ctl.state == BURST_PENDING) {
+            burst_ctl.state = BURST_IDLE;
+        } else {
+            burst_ctl.reply_mqtt = 1;
+        }
+        snprintf(out, out_size, "{\"error\": \"burst timeout\"}");
+        ret = -1;
+    }
+    pthread_mutex_unlock(&burst_ctl.lock);
+    return ret;
+}
+
+// "burst[:N[:mean|median]]" bzw. HTTP-Query "n=N&mode=..." auswerten
+static void parse_burst_args(const char *args, int *frames, burst_mode_t *mode) {
+    *frames = BURST_DEFAULT_FRAMES;
+    *mode = BURST_MEAN;
+    if (!args) {
+        return;
+    }
+
+    const char *n = strstr(args, "n=");
+    const char *m = strstr(args, "mode=");
+    if (n || m) {
+        if (n) {
+            *frames = atoi(n + 2);
+        }
+        if (m) {
+            m += 5;
+            burst_parse_mode(m, (int)strcspn(m, "& \r\n"), mode);
+        }
+    } else if (*args == ':') {
+        char *end;
+        *frames = (int)strtol(args + 1, &end, 10);
+        if (*end == ':') {
+            burst_parse_mode(end + 1, (int)strlen(end + 1), mode);
+        }
+    }
+
+    if (*frames < 1) {
+        *frames = BURST_DEFAULT_FRAMES;
+    }
+    if (*frames > BURST_MAX_FRAMES) {
+        *frames = BURST_MAX_FRAMES;
+    }
+}
+
 // Output-Thread
 void* output_thread(void* arg) {
     (void)arg;  // Ungenutzte Parameter markieren
+    uint32_t published_generation = 0;
     
     while (running) {
+        // Mit aktivem Gate nur nach einer neuen Auswertung publizieren
+        uint32_t generation = atomic_load(&points_generation);
+        bool unchanged = g_gate.enabled && generation == published_generation;
+
         // Normale Messpunkte ausgeben wenn aktiv
-        if (atomic_load(&measurement_active)) {
+        if (atomic_load(&measurement_active) && !unchanged) {
+            published_generation = generation;
             debug_print("Erstelle Messdaten-JSON...\n");
             char* json_output = create_json_output();
             
@@ -642,38 +1797,47 @@ void* output_thread(void* arg) {
                     debug_print("Messdaten erfolgreich gesendet\n");
                 }
             }
+            publish_output_profiles();
+            if (num_zones && mosq && atomic_load(&mqtt_connected) &&
+                atomic_load(&thermal_level) < THERMAL_NO_ANALYTICS) {
+                static char zones_json[64 + MINMAX_MAX_ZONES * 16];
+                int len = create_zones_json(zones_json, sizeof(zones_json));
+                if (len > 0) {
+                    mosquitto_publish(mosq, NULL, MQTT_ZONES_TOPIC, len, zones_json, 0, false);
+                }
+            }
+            if (g_hist_json && mosq && atomic_load(&mqtt_connected) &&
+                atomic_load(&thermal_level) < THERMAL_NO_ANALYTICS) {
+                int len = create_histogram_json(g_hist_json, hist_json_size, -1);
+                if (len > 0) {
+                    mosquitto_publish(mosq, NULL, MQTT_HISTOGRAM_TOPIC, len, g_hist_json, 0, false);
+                }
+            }
         }
         
-        // Punktwolke bei Anforderung senden
-        if (atomic_load(&pointcloud_requested)) {
-            debug_print("Punktwolke angefordert, erfasse Daten...\n");
-            
-            // Prüfe ob LIDAR verbunden
-            if (!HPS3D_IsConnect(g_handle)) {
-                debug_print("FEHLER: LIDAR nicht verbunden für Punktwolke\n");
-                atomic_store(&pointcloud_requested, 0);
-                continue;
-            }
-            
-            // Stelle sicher, dass wir aktuelle Daten haben
-            if (measure_points() == 0) {
-                char* cloud_json = create_pointcloud_json();
-                if (cloud_json && mosq && atomic_load(&mqtt_connected)) {
-                    debug_print("Sende Punktwolken-Daten...\n");
-                    int rc = mosquitto_publish(mosq, NULL, MQTT_POINTCLOUD_TOPIC, 
-                                    strlen(cloud_json), cloud_json, 0, false);
-                    if (rc != MOSQ_ERR_SUCCESS) {
-                        debug_print("FEHLER: Punktwolken-Publish fehlgeschlagen: %d\n", rc);
-                    } else {
-                        debug_print("Punktwolke erfolgreich gesendet\n");
-                    }
+        // Punktwolke senden, sobald der Mess-Thread die angeforderte Messung geliefert hat
+        if (atomic_load(&pointcloud_requested) != POINTCLOUD_IDLE &&
+            atomic_load(&thermal_level) >= THERMAL_NO_POINTCLOUD) {
+            debug_print("WARNUNG: Punktwolke verworfen - thermische Stufe %s\n",
+                        thermal_level_name((thermal_level_t)atomic_load(&thermal_level)));
+            atomic_store(&pointcloud_requested, POINTCLOUD_IDLE);
+        }
+        if (atomic_load(&pointcloud_requested) == POINTCLOUD_READY) {
+            char* cloud_json = create_pointcloud_json();
+            if (cloud_json && mosq && atomic_load(&mqtt_connected)) {
+                debug_print("Sende Punktwolken-Daten...\n");
+                int rc = mosquitto_publish(mosq, NULL, MQTT_POINTCLOUD_TOPIC, 
+                                strlen(cloud_json), cloud_json, 0, false);
+                if (rc != MOSQ_ERR_SUCCESS) {
+                    debug_print("FEHLER: Punktwolken-Publish fehlgeschlagen: %d\n", rc);
                 } else {
-                    debug_print("FEHLER: Punktwolken-JSON konnte nicht erstellt werden oder MQTT nicht verbunden\n");
+                    debug_print("Punktwolke erfolgreich gesendet\n");
                 }
             } else {
-                debug_print("FEHLER: Punktwolken-Messung fehlgeschlagen\n");
+                debug_print("FEHLER: Punktwolken-JSON konnte nicht erstellt werden oder MQTT nicht verbunden\n");
             }
-            atomic_store(&pointcloud_requested, 0);  // Request zurücksetzen
+            int expected = POINTCLOUD_READY;  // Neue Anforderung während des Sendens bleibt stehen
+            atomic_compare_exchange_strong(&pointcloud_requested, &expected, POINTCLOUD_IDLE);
         }
         
         usleep(OUTPUT_INTERVAL_MS * 1000);
@@ -705,7 +1869,31 @@ void mqtt_message_callback(struct mosquitto *mosq, void *userdata, const struct
         }
         else if (strncmp(message->payload, "get_pointcloud", message->payloadlen) == 0) {
             debug_print("Punktwolke angefordert via MQTT\n");
-            atomic_store(&pointcloud_requested, 1);
+            atomic_store(&pointcloud_requested, POINTCLOUD_PENDING);
+        }
+        else if (strncmp(message->payload, "trigger", message->payloadlen) == 0) {
+            if (trigger_enabled && trigger_capture_request(&g_trigger, TRIGGER_SOURCE_MQTT, 0) == 0) {
+                debug_print("Trigger-Aufnahme angefordert via MQTT\n");
+            } else {
+                debug_print("WARNUNG: Trigger via MQTT abgelehnt - %s\n",
+                            trigger_enabled ? "Aufnahme läuft bereits" : "Aufzeichnung nicht konfiguriert");
+            }
+        }
+        else if (message->payloadlen >= 5 && message->payloadlen < 64 &&
+                 strncmp(message->payload, "burst", 5) == 0) {
+            char args[64];
+            int frames;
+            burst_mode_t mode;
+            memcpy(args, (const char*)message->payload + 5, message->payloadlen - 5);
+            args[message->payloadlen - 5] = '\0';
+            parse_burst_args(args, &frames, &mode);
+            int rc = request_burst(frames, mode, 1);
+            if (rc == 0) {
+                debug_print("Burst angefordert via MQTT: %d Frames (%s)\n", frames, burst_mode_name(mode));
+            } else {
+                debug_print("WARNUNG: Burst via MQTT abgelehnt - %s\n",
+                            rc == -2 ? "thermisch gesperrt" : "bereits aktiv");
+            }
         }
     }
 }
@@ -718,6 +1906,7 @@ void mqtt_connect_callback(struct mosquitto *mosq, void *userdata, int result) {
     if (!result) {
         atomic_store(&mqtt_connected, 1);
         debug_print("MQTT: Verbindung hergestellt\n");
+        startup_mark(&startup.mqtt_ms, "MQTT");
         
         // Resubscribe nach Reconnect
         if (mosquitto_subscribe(mosq, NULL, MQTT_CONTROL_TOPIC, 0) != MOSQ_ERR_SUCCESS) {
@@ -760,25 +1949,20 @@ int init_mqtt(void) {
     mosquitto_disconnect_callback_set(mosq, mqtt_disconnect_callback);
     mosquitto_message_callback_set(mosq, mqtt_message_callback);
 
-    // Verbindungsversuch
-    if (mosquitto_connect(mosq, MQTT_HOST, MQTT_PORT, 60) != MOSQ_ERR_SUCCESS) {
-        printf("WARNUNG: MQTT Verbindung fehlgeschlagen - verwende nur HTTP\n");
-        return -1;
-    }
-
-    // Subscribe to control topic
-    if (mosquitto_subscribe(mosq, NULL, MQTT_CONTROL_TOPIC, 0) != MOSQ_ERR_SUCCESS) {
-        printf("WARNUNG: MQTT Subscribe fehlgeschlagen\n");
-        return -1;
-    }
-
-    // Start MQTT loop in background
+    // Verbindung im Hintergrund aufbauen: der Loop-Thread verbindet (und bei
+    // Fehlern erneut), Subscribe erfolgt im Connect-Callback
+    mosquitto_reconnect_delay_set(mosq, 1, MQTT_RECONNECT_DELAY * 6, true);
     if (mosquitto_loop_start(mosq) != MOSQ_ERR_SUCCESS) {
         printf("WARNUNG: MQTT Loop konnte nicht gestartet werden\n");
         return -1;
     }
+    if (mosquitto_connect_async(mosq, MQTT_HOST, MQTT_PORT, 60) != MOSQ_ERR_SUCCESS) {
+        printf("WARNUNG: MQTT Verbindungsaufbau zu %s:%d nicht möglich - neuer Versuch im Hintergrund\n",
+               MQTT_HOST, MQTT_PORT);
+        return 0;
+    }
 
-    printf("MQTT Client verbunden mit %s:%d\n", MQTT_HOST, MQTT_PORT);
+    printf("MQTT Client verbindet mit %s:%d\n", MQTT_HOST, MQTT_PORT);
     return 0;
 }
 
@@ -788,6 +1972,15 @@ int init_http_server() {
     int opt = 1;
     
     debug_print("Initialisiere HTTP Server...\n");
+
+    // Von systemd vorab gebundenen Socket übernehmen: Verbindungen während eines
+    // Neustarts warten in dessen Backlog statt abgewiesen zu werden
+    int listen_fd = systemd_listen_fd();
+    if (listen_fd >= 0) {
+        http_socket = listen_fd;
+        debug_print("HTTP Server nutzt Socket von systemd (fd %d)\n", listen_fd);
+        return 0;
+    }
     
     // Socket erstellen
     http_socket = socket(AF_INET, SOCK_STREAM, 0);
@@ -807,11 +2000,11 @@ int init_http_server() {
     memset(&server_addr, 0, sizeof(server_addr));
     server_addr.sin_family = AF_INET;
     server_addr.sin_addr.s_addr = INADDR_ANY;
-    server_addr.sin_port = htons(HTTP_PORT);
+    server_addr.sin_port = htons(http_port);
     
     // Socket binden
     if (bind(http_socket, (struct sockaddr *)&server_addr, sizeof(server_addr)) < 0) {
-        debug_print("FEHLER: HTTP Socket konnte nicht gebunden werden (Port %d möglicherweise belegt)\n", HTTP_PORT);
+        debug_print("FEHLER: HTTP Socket konnte nicht gebunden werden (Port %d möglicherweise belegt)\n", http_port);
         close(http_socket);
         http_socket = -1;
         // Wir geben hier 0 zurück, damit der Service trotzdem startet
@@ -826,7 +2019,7 @@ int init_http_server() {
         return 0;
     }
     
-    debug_print("HTTP Server läuft auf Port %d\n", HTTP_PORT);
+    debug_print("HTTP Server läuft auf Port %d\n", http_port);
     return 0;
 }
 
@@ -834,9 +2027,11 @@ int init_http_server() {
 void* http_server_thread(void* arg) {
     (void)arg;  // Ungenutzte Parameter markieren
     char buffer[1024];
-    char response[1024];
+    char response[BURST_RESULT_SIZE];
     
     while (running) {
+        size_t response_len = 0;        // 0 = Textantwort, Länge per strlen
+        const char *content_type = "application/json";
         struct sockaddr_in client_addr;
         socklen_t client_len = sizeof(client_addr);
         
@@ -848,15 +2043,157 @@ void* http_server_thread(void* arg) {
             buffer[bytes_read] = '\0';
             
             // Parse HTTP request
-            if (strstr(buffer, "GET /status") != NULL) {
+            if (strstr(buffer, "GET /pixels") != NULL) {
+                // Bericht der Pixel-Überwachung mit allen maskierten Pixeln
+                pthread_mutex_lock(&data_mutex);
+                int len = pixel_health_report_json(&g_pixels, response, sizeof(response));
+                pthread_mutex_unlock(&data_mutex);
+                if (len < 0) {
+                    snprintf(response, sizeof(response), "{\"error\": \"pixel report too large\"}");
+                }
+            }
+            else if (strstr(buffer, "GET /measurements") != NULL) {
+                // Letzter Schnappschuss eines Ausgabeprofils; ohne profile= die Profilliste
+                char *query = strstr(buffer, "GET /measurements") + strlen("GET /measurements");
+                char *line_end = strpbrk(query, " \r\n");
+                if (line_end) {
+                    *line_end = '\0';
+                }
+                const char *name = strstr(query, "profile=");
+                if (!name) {
+                    int pos = snprintf(response, sizeof(response), "{\"profiles\": [");
+                    for (int p = 0; p < num_profiles; p++) {
+                        pos += snprintf(response + pos, sizeof(response) - pos, "%s\"%s\"", p ? ", " : "",
+                                        g_profiles[p].name);
+                    }
+                    snprintf(response + pos, sizeof(response) - pos, "]}");
+                } else {
+                    name += strlen("profile=");
+                    int p = find_output_profile(name, strcspn(name, "&"));
+                    if (p < 0) {
+                        snprintf(response, sizeof(response), "{\"error\": \"unknown profile\"}");
+                    } else {
+                        pthread_mutex_lock(&profile_mutex);
+                        response_len = (size_t)g_profile_out[p].len;
+                        memcpy(response, g_profile_out[p].payload, response_len);
+                        pthread_mutex_unlock(&profile_mutex);
+                        if (response_len == 0) {
+                            snprintf(response, sizeof(response), "{\"error\": \"no measurement yet\"}");
+                        } else {
+                            content_type = output_encoding_content_type(g_profiles[p].encoding);
+                        }
+                    }
+                }
+            }
+            else if (strstr(buffer, "GET /zones") != NULL) {
+                // Letzte Zonenwerte oder eine freie Abfrage ?rect=x,y,w,h auf dem letzten Frame
+                char *query = strstr(buffer, "GET /zones") + strlen("GET /zones");
+                char *line_end = strpbrk(query, " \r\n");
+                if (line_end) {
+                    *line_end = '\0';
+                }
+                const char *rect = strstr(query, "rect=");
+                int x0, y0, w, h;
+                if (!minmax_index) {
+                    snprintf(response, sizeof(response), "{\"error\": \"minmax index disabled\"}");
+                } else if (!rect) {
+                    if (create_zones_json(response, sizeof(response)) < 0) {
+                        snprintf(response, sizeof(response), "{\"error\": \"zones too large\"}");
+                    }
+                } else if (sscanf(rect + 5, "%d,%d,%d,%d", &x0, &y0, &w, &h) != 4 || x0 < 0 || y0 < 0 ||
+                           w < 1 || h < 1 || x0 + w > SENSOR_WIDTH || y0 + h > SENSOR_HEIGHT) {
+                    snprintf(response, sizeof(response), "{\"error\": \"invalid rect\"}");
+                } else {
+                    uint16_t min, max;
+                    pthread_mutex_lock(&data_mutex);
+                    int valid = minmax_frames && region_minmax_query(&g_minmax, x0, y0, w, h, &min, &max);
+                    uint32_t frame = minmax_frames;
+                    pthread_mutex_unlock(&data_mutex);
+                    snprintf(response, sizeof(response), "{\"frame\": %u, \"min\": %u, \"max\": %u, \"valid\": %s}",
+                             frame, valid ? min : 0u, valid ? max : 0u, valid ? "true" : "false");
+                }
+            }
+            else if (strstr(buffer, "GET /histogram") != NULL) {
+                // Letztes Histogramm; ?zone=N nur eine Zone (falls alle zusammen nicht passen)
+                char *query = strstr(buffer, "GET /histogram") + strlen("GET /histogram");
+                char *line_end = strpbrk(query, " \r\n");
+                if (line_end) {
+                    *line_end = '\0';
+                }
+                const char *zone_arg = strstr(query, "zone=");
+                int zone = zone_arg ? atoi(zone_arg + 5) : -1;
+                if (!depth_histogram) {
+                    snprintf(response, sizeof(response), "{\"error\": \"depth histogram disabled\"}");
+                } else if (zone_arg && (zone < 0 || zone >= num_zones || !g_hist_zones)) {
+                    snprintf(response, sizeof(response), "{\"error\": \"unknown zone\"}");
+                } else if (create_histogram_json(response, sizeof(response), zone) < 0) {
+                    snprintf(response, sizeof(response), "{\"error\": \"histogram too large, use ?zone=\"}");
+                }
+            }
+            else if (strstr(buffer, "GET /status") != NULL) {
                 // Status Abfrage
+                pthread_mutex_lock(&data_mutex);
+                uint32_t pixels_masked = g_pixels.bad_count;
+                uint32_t pixels_dead = g_pixels.dead;
+                uint32_t pixels_stuck = g_pixels.stuck;
+                pthread_mutex_unlock(&data_mutex);
                 snprintf(response, sizeof(response), 
-                        "{\"active\": %s, \"connected\": %s, \"device_connected\": %s, \"power_save\": %s, \"retries\": %d}", 
+                        "{\"active\": %s, \"connected\": %s, \"device_connected\": %s, \"power_save\": %s, \"retries\": %d, \"frames_skipped\": %u, "
+                        "\"alarms\": %u, \"alarms_dropped\": %u, "
+                        "\"thermal\": {\"temp_c\": %.1f, \"level\": \"%s\"}, "
+                        "\"capture\": {\"scheduled\": %s, \"cycle_ms\": %.1f, \"offset_ms\": %.1f, "
+                        "\"transfer_ms\": %.1f, \"jitter_ms\": %.1f, \"late\": %u}, "
+                        "\"trigger\": {\"enabled\": %s, \"collecting\": %s, \"bundles\": %u, \"dropped\": %u, \"failed\": %u}, "
+                        "\"pixels\": {\"enabled\": %s, \"masked\": %u, \"dead\": %u, \"stuck\": %u}, "
+                        "\"correction\": {\"enabled\": %s, \"uncalibrated\": %u, \"reference_mm\": [%u, %u]}, "
+                        "\"optical_path\": \"%s\", "
+                        "\"pointcloud2\": {\"mqtt\": %s, \"shm\": %s, \"frames\": %u}, "
+                        "\"output_profiles\": %d, "
+                        "\"minmax\": {\"enabled\": %s, \"zones\": %d, \"frames\": %u}, "
+                        "\"histogram\": {\"enabled\": %s, \"bins\": %d, \"frames\": %u}, "
+                        "\"log\": {\"backend\": \"%s\", \"dropped\": %u, \"errors\": %u}, "
+                        "\"startup_ms\": {\"config\": %lld, \"http\": %lld, \"mqtt\": %lld, \"lidar\": %lld, \"first_frame\": %lld}}", 
                         atomic_load(&measurement_active) ? "true" : "false",
                         (g_handle >= 0 && HPS3D_IsConnect(g_handle)) ? "true" : "false",
                         atomic_load(&device_connected) ? "true" : "false",
                         atomic_load(&power_save_mode) ? "true" : "false",
-                        atomic_load(&connection_retries));
+                        atomic_load(&connection_retries),
+                        atomic_load(&frames_skipped),
+                        atomic_load(&g_alarms.edges),
+                        atomic_load(&alarms_dropped),
+                        atomic_load(&thermal_temp_mc) / 1000.0,
+                        thermal_level_name((thermal_level_t)atomic_load(&thermal_level)),
+                        capture_scheduled ? "true" : "false",
+                        atomic_load(&capture_cycle_us) / 1000.0,
+                        atomic_load(&capture_offset_us) / 1000.0,
+                        atomic_load(&capture_transfer_us) / 1000.0,
+                        atomic_load(&capture_jitter_us) / 1000.0,
+                        atomic_load(&capture_late),
+                        trigger_enabled ? "true" : "false",
+                        atomic_load(&g_trigger.collecting) ? "true" : "false",
+                        atomic_load(&g_trigger.bundles),
+                        atomic_load(&g_trigger.dropped),
+                        atomic_load(&g_trigger.failed),
+                        pixel_health_enabled ? "true" : "false",
+                        pixels_masked, pixels_dead, pixels_stuck,
+                        pixel_correction_enabled ? "true" : "false",
+                        g_correction.info.uncalibrated,
+                        g_correction.info.reference_mm[0], g_correction.info.reference_mm[1],
+                        optical_path_host ? "host" : "device",
+                        pointcloud2_mqtt ? "true" : "false",
+                        g_pc2_shm ? "true" : "false",
+                        atomic_load(&pointcloud2_frames),
+                        num_profiles,
+                        minmax_index ? "true" : "false", num_zones, minmax_frames,
+                        depth_histogram ? "true" : "false", depth_histogram ? g_hist_range.bins : 0, histogram_frames,
+                        async_writer_backend_name(g_log_writer.backend),
+                        atomic_load(&g_log_writer.dropped),
+                        atomic_load(&g_log_writer.errors),
+                        (long long)atomic_load(&startup.config_ms),
+                        (long long)atomic_load(&startup.http_ms),
+                        (long long)atomic_load(&startup.mqtt_ms),
+                        (long long)atomic_load(&startup.lidar_ms),
+                        (long long)atomic_load(&startup.first_frame_ms));
             }
             else if (strstr(buffer, "POST /start") != NULL) {
                 // Messung starten
@@ -864,6 +2201,39 @@ void* http_server_thread(void* arg) {
                 snprintf(response, sizeof(response), "{\"status\": \"started\"}");
                 debug_print("Messung aktiviert via HTTP\n");
             }
+            else if (strstr(buffer, "POST /burst") != NULL) {
+                // Burst-Messung: Antwort erst nach Abschluss (ein Round-Trip)
+                int frames;
+                burst_mode_t mode;
+                char *query = strstr(buffer, "POST /burst") + strlen("POST /burst");
+                char *line_end = strpbrk(query, " \r\n");
+                if (line_end) {
+                    *line_end = '\0';  // Query auf die Request-Zeile begrenzen
+                }
+                parse_burst_args(*query == '?' ? query + 1 : NULL, &frames, &mode);
+
+                int rc = request_burst(frames, mode, 0);
+                if (rc == 0) {
+                    debug_print("Burst angefordert via HTTP: %d Frames (%s)\n", frames, burst_mode_name(mode));
+                    wait_burst_result(response, sizeof(response));
+                } else if (rc == -2) {
+                    snprintf(response, sizeof(response), "{\"error\": \"burst disabled (thermal)\"}");
+                } else {
+                    snprintf(response, sizeof(response), "{\"error\": \"burst already running\"}");
+                }
+            }
+            else if (strstr(buffer, "POST /trigger") != NULL) {
+                // Vor-/Nachlauf um jetzt festhalten; die Datei entsteht asynchron
+                if (!trigger_enabled) {
+                    snprintf(response, sizeof(response), "{\"error\": \"trigger capture disabled\"}");
+                } else if (trigger_capture_request(&g_trigger, TRIGGER_SOURCE_HTTP, 0) == 0) {
+                    snprintf(response, sizeof(response), "{\"status\": \"triggered\", \"pre_frames\": %d, \"post_frames\": %d}",
+                             trigger_pre_frames, trigger_post_frames);
+                    debug_print("Trigger-Aufnahme angefordert via HTTP\n");
+                } else {
+                    snprintf(response, sizeof(response), "{\"error\": \"trigger capture already running\"}");
+                }
+            }
             else if (strstr(buffer, "POST /stop") != NULL) {
                 // Messung stoppen
                 atomic_store(&measurement_active, 0);
@@ -875,11 +2245,14 @@ void* http_server_thread(void* arg) {
                 snprintf(response, sizeof(response), "{\"error\": \"unknown command\"}");
             }
             
-            // HTTP Response senden
-            char http_response[2048];
-            snprintf(http_response, sizeof(http_response), HTTP_RESPONSE, 
-                    strlen(response), response);
-            write(client_socket, http_response, strlen(http_response));
+            // HTTP Response senden; binäre Profile tragen ihre Länge selbst
+            if (response_len == 0) {
+                response_len = strlen(response);
+            }
+            char http_header[160];
+            int header_len = snprintf(http_header, sizeof(http_header), HTTP_RESPONSE, response_len, content_type);
+            write(client_socket, http_header, header_len);
+            write(client_socket, response, response_len);
         }
         
         close(client_socket);
@@ -889,6 +2262,16 @@ void* http_server_thread(void* arg) {
 }
 
 // Mess-Thread mit verbesserter Idle-Mode-Verwaltung
+// Offene Punktwolken-Anforderung mit dem Ergebnis der Messung dieses Zyklus
+// beantworten (Mess-Thread); der Output-Thread publiziert bei POINTCLOUD_READY
+static void complete_pointcloud_request(bool measured) {
+    int expected = POINTCLOUD_PENDING;
+    if (atomic_compare_exchange_strong(&pointcloud_requested, &expected,
+                                       measured ? POINTCLOUD_READY : POINTCLOUD_IDLE) && !measured) {
+        debug_print("FEHLER: Punktwolken-Messung fehlgeschlagen\n");
+    }
+}
+
 void* measure_thread(void* arg) {
     (void)arg;  // Ungenutzte Parameter markieren
     bool was_active = false;  // Merker für Zustandswechsel
@@ -896,11 +2279,31 @@ void* measure_thread(void* arg) {
     int health_check_counter = 0; // Zähler für Verbindungsprüfungen
     
     debug_print("Mess-Thread gestartet mit verbesserter Power-Management-Logik\n");
+
+    // Gerät im Hintergrund öffnen - HTTP und MQTT nehmen währenddessen schon Befehle an
+    if (init_lidar() != 0) {
+        debug_print("WARNUNG: LIDAR beim Start nicht verfügbar - neuer Versuch bei Aktivierung\n");
+        systemd_notify("STATUS=LIDAR nicht verfügbar, warte auf Aktivierung");
+        cleanup_lidar_resources();
+    } else {
+        probe_first_frame(STARTUP_FRAME_WAIT_MS);
+    }
     
     while (running) {
         bool is_active = atomic_load(&measurement_active);
+        pipeline_heartbeat();
+        thermal_check();
         
         if (!is_active) {
+            // Burst ohne aktive Messung sofort mit Fehler beantworten
+            service_burst_request(false);
+
+            // Punktwolke auch ohne aktive Messung einzeln erfassen
+            if (atomic_load(&pointcloud_requested) == POINTCLOUD_PENDING) {
+                debug_print("Punktwolke angefordert, erfasse Daten...\n");
+                complete_pointcloud_request(measure_points() == 0);
+            }
+
             // === IDLE MODE LOGIC ===
             if (was_active) {
                 debug_print("Messung inaktiv - aktiviere Power-Save-Modus\n");
@@ -929,8 +2332,15 @@ void* measure_thread(void* arg) {
             debug_print("Messung aktiviert - verlasse Power-Save-Modus\n");
             exit_power_save_mode();
             
-            debug_print("Initialisiere LIDAR für aktive Messung...\n");
-            if (init_lidar() == 0) {
+            // Beim Start bereits geöffnetes Gerät weiterverwenden, sonst neu initialisieren
+            bool reuse = check_connection_health();
+            if (!reuse && g_handle >= 0) {
+                cleanup_lidar_resources();
+            }
+            if (!reuse) {
+                debug_print("Initialisiere LIDAR für aktive Messung...\n");
+            }
+            if (reuse || init_lidar() == 0) {
                 was_active = true;
                 idle_cycles = 0;
                 health_check_counter = 0;
@@ -958,8 +2368,18 @@ void* measure_thread(void* arg) {
             health_check_counter = 0;
         }
 
-        // Messpunkt erfassen
-        if (measure_points() != 0) {
+        // Anstehenden Burst vor der regulären Messung ausführen
+        service_burst_request(true);
+
+        // Im Bus-Zeitplan auf das eigene Fenster warten
+        if (capture_scheduled) {
+            capture_sched_wait(&g_capture, measure_interval_ms());
+        }
+
+        // Messpunkt erfassen; die Messung bedient auch eine offene Punktwolken-Anforderung
+        int measured = measure_points();
+        complete_pointcloud_request(measured == 0);
+        if (measured != 0) {
             debug_print("Messfehler - prüfe Verbindung\n");
             if (!check_connection_health()) {
                 debug_print("Verbindung verloren während Messung - Wiederverbindung\n");
@@ -970,22 +2390,263 @@ void* measure_thread(void* arg) {
                 usleep(500000); // 500ms Pause bei normalem Messfehler
             }
         } else {
-            // Erfolgreiche Messung - normales Intervall
-            usleep(MEASURE_INTERVAL_MS * 1000);
+            // Erfolgreiche Messung - im ROI-Modus die nächste Gruppe für das
+            // folgende Intervall aktivieren, damit das nächste Paket von ihr stammt
+            if (roi_mode) {
+                roi_select_next_group();
+            }
+            if (trigger_enabled) {
+                record_wait(measure_interval_ms());
+            } else if (!capture_scheduled) {
+                usleep(measure_interval_ms() * 1000);
+            }
         }
     }
     
     debug_print("Mess-Thread beendet - bereinige Ressourcen\n");
     cleanup_lidar_resources();
+    if (capture_scheduled) {
+        capture_sched_detach(&g_capture);
+    }
     return NULL;
 }
 
+// Schwellen aus pi4-tuning.conf (PI4_TUNING_FILE) laden und die CPU-Temperaturzone suchen
+static void setup_thermal_governor(void) {
+    thermal_config_t config;
+    thermal_config_defaults(&config);
+    if (!thermal_enabled) {
+        debug_print("Thermik-Governor deaktiviert\n");
+        return;
+    }
+
+    const char *tuning = getenv("PI4_TUNING_FILE");
+    if (!tuning || !*tuning) {
+        tuning = THERMAL_TUNING_FILE;
+    }
+    if (thermal_config_load(&config, tuning) < 0) {
+        debug_print("Thermik: %s nicht gefunden - Standardschwellen\n", tuning);
+    }
+    if (thermal_config_validate(&config) != 0) {
+        debug_print("WARNUNG: Thermik-Schwellen ungültig - Standardschwellen\n");
+        thermal_config_defaults(&config);
+    }
+    thermal_governor_init(&g_thermal, &config);
+
+    if (thermal_find_zone(THERMAL_ZONE_DIR, thermal_zone, sizeof(thermal_zone)) != 0) {
+        debug_print("Thermik: keine Temperaturzone lesbar - Governor aus\n");
+        thermal_zone[0] = '\0';
+        return;
+    }
+    debug_print("Thermik-Governor: %s, Stufen %d/%d/%d°C, alle %ds\n", thermal_zone,
+                config.limit_mc[THERMAL_REDUCED_RATE] / 1000, config.limit_mc[THERMAL_NO_ANALYTICS] / 1000,
+                config.limit_mc[THERMAL_NO_POINTCLOUD] / 1000, config.interval_s);
+}
+
+// Platz im gemeinsamen Bus-Zeitplan belegen (capture_bus); ohne ihn bleibt der Stream
+static void setup_capture_scheduler(void) {
+    if (!capture_bus_path[0]) {
+        return;
+    }
+    if (capture_sched_attach(&g_capture, capture_bus_path, (uint32_t)capture_guard_us) != 0) {
+        debug_print("WARNUNG: Bus-Zeitplan %s nicht nutzbar (%s) - freilaufender Stream\n",
+                    capture_bus_path, strerror(errno));
+        return;
+    }
+    capture_scheduled = 1;
+    debug_print("Bus-Zeitplan %s: Platz %d, Schutzabstand %d µs, Einzelaufnahmen statt Stream\n",
+                capture_bus_path, g_capture.slot, capture_guard_us);
+}
+
+// Pixel-Überwachung konfigurieren und die gespeicherte Maske übernehmen
+static void setup_pixel_health(void) {
+    pixel_health_init(&g_pixels);
+    if (!pixel_health_enabled) {
+        return;
+    }
+    g_pixels.every = (uint32_t)pixel_health_every;
+    g_pixels.window = (uint32_t)pixel_health_window;
+    if (pixel_mask_file[0] && pixel_health_load(&g_pixels, pixel_mask_file) == 0) {
+        debug_print("Pixelmaske %s: %u maskiert (%u tot, %u eingefroren)\n", pixel_mask_file,
+                    g_pixels.bad_count, g_pixels.dead, g_pixels.stuck);
+    }
+    debug_print("Pixel-Überwachung: jeder %d. Frame, Bewertung nach %d Stichproben\n",
+                pixel_health_every, pixel_health_window);
+}
+
+// Kosinus-Tabelle für optical_path=host; bei ungültigem Öffnungswinkel rechnet wieder das Gerät
+static void setup_optical_path(void) {
+    if (!optical_path_host) {
+        return;
+    }
+    if (optical_path_init(&g_optical, optical_fov_h, optical_fov_v) != 0) {
+        debug_print("WARNUNG: Öffnungswinkel %.1f x %.1f Grad ungültig - optische Wegkorrektur im Gerät\n",
+                    optical_fov_h, optical_fov_v);
+        optical_path_host = 0;
+        return;
+    }
+    debug_print("Optische Wegkorrektur auf dem Host (%.1f x %.1f Grad), Rohwerte als Schrägentfernung verfügbar\n",
+                optical_fov_h, optical_fov_v);
+}
+
+// Binäre Punktwolke (pointcloud2=mqtt|shm|both); ohne Shared Memory bleibt MQTT
+static void setup_pointcloud2(void) {
+    if (!pointcloud2_mqtt && !pointcloud2_shm) {
+        return;
+    }
+    if (pointcloud_soa_init(&g_cloud, SENSOR_PIXELS) != 0) {
+        debug_print("WARNUNG: Speicher für die PointCloud2-Wolke fehlt - Ausgabe aus\n");
+        pointcloud2_mqtt = pointcloud2_shm = 0;
+        return;
+    }
+    pointcloud2_init(&g_pc2, pointcloud2_frame_id);
+    if (pointcloud2_shm) {
+        g_pc2_shm = pointcloud2_shm_open(pointcloud2_shm_path);
+        if (!g_pc2_shm) {
+            debug_print("WARNUNG: PointCloud2-Datei %s nicht anlegbar (%s)\n", pointcloud2_shm_path, strerror(errno));
+            pointcloud2_shm = 0;
+        }
+    }
+    if (!pointcloud2_mqtt && !pointcloud2_shm) {
+        pointcloud_soa_free(&g_cloud);
+        return;
+    }
+    debug_print("PointCloud2-Ausgabe: %s%s%s, %zu Bytes je Frame\n", pointcloud2_mqtt ? MQTT_POINTCLOUD2_TOPIC : "",
+                pointcloud2_mqtt && pointcloud2_shm ? " und " : "", pointcloud2_shm ? pointcloud2_shm_path : "",
+                sizeof(g_pc2));
+}
+
+// Zonen-Histogramme und MQTT-Puffer einmal anlegen (depth_histogram gesetzt)
+static void setup_depth_histogram(void) {
+    if (!depth_histogram) {
+        return;
+    }
+    if (num_zones) {
+        g_hist_zones = calloc((size_t)num_zones, sizeof(*g_hist_zones));
+    }
+    // Je Klasse höchstens 10 Ziffern und ein Komma, dazu Kopf und Zähler
+    hist_json_size = 256 + (size_t)(num_zones + 1) * ((size_t)g_hist_range.bins * 11 + 8);
+    g_hist_json = malloc(hist_json_size);
+    if ((num_zones && !g_hist_zones) || !g_hist_json) {
+        debug_print("WARNUNG: Kein Speicher für Tiefenhistogramme - aus\n");
+        free(g_hist_zones);
+        free(g_hist_json);
+        g_hist_zones = NULL;
+        g_hist_json = NULL;
+        depth_histogram = 0;
+        return;
+    }
+    // Leere Histogramme mit Klassenzahl, bis der erste Frame ausgewertet ist
+    depth_hist_reset(&g_hist_frame, &g_hist_range);
+    for (int z = 0; z < num_zones; z++) {
+        depth_hist_reset(&g_hist_zones[z], &g_hist_range);
+    }
+    debug_print("Tiefenhistogramm: %d Klassen über %u..%u mm, %d Zonen\n", g_hist_range.bins,
+                g_hist_range.min_mm, g_hist_range.max_mm, num_zones);
+}
+
+// Korrekturtabelle laden (pixel_correction_file gesetzt)
+static void setup_pixel_correction(void) {
+    pixel_correction_identity(&g_correction);
+    if (!pixel_correction_file[0]) {
+        return;
+    }
+    if (pixel_correction_load(&g_correction, pixel_correction_file) != 0) {
+        debug_print("WARNUNG: Korrekturtabelle %s nicht lesbar - keine Korrektur je Pixel\n", pixel_correction_file);
+        return;
+    }
+    pixel_correction_enabled = 1;
+    debug_print("Korrektur je Pixel aus %s: Referenz %u/%u mm, %u Pixel ohne Korrektur\n", pixel_correction_file,
+                g_correction.info.reference_mm[0], g_correction.info.reference_mm[1], g_correction.info.uncalibrated);
+}
+
+// Vor-/Nachlauf-Aufzeichnung um Alarme und manuelle Auslöser (trigger_pre_frames > 0)
+static void setup_trigger_capture(void) {
+    if (trigger_pre_frames <= 0) {
+        return;
+    }
+    if (capture_scheduled) {
+        debug_print("WARNUNG: Trigger-Aufzeichnung braucht den Stream - im Bus-Zeitplan deaktiviert\n");
+        return;
+    }
+    if (mkdir(trigger_dir, 0755) != 0 && errno != EEXIST) {
+        debug_print("WARNUNG: Trigger-Verzeichnis %s nicht anlegbar (%s)\n", trigger_dir, strerror(errno));
+    }
+    if (trigger_capture_init(&g_trigger, (uint32_t)trigger_pre_frames, (uint32_t)trigger_post_frames,
+                             PACKET_MAX_SIZE, trigger_dir, release_dispatch_frame, NULL) != 0) {
+        debug_print("WARNUNG: Trigger-Aufzeichnung nicht verfügbar\n");
+        return;
+    }
+    trigger_enabled = 1;
+    debug_print("Trigger-Aufzeichnung: %d Frames Vorlauf, %d Nachlauf nach %s (%s)%s\n",
+                trigger_pre_frames, trigger_post_frames, trigger_dir,
+                async_writer_backend_name(g_trigger.writer.backend),
+                trigger_on_alarm && !alarms_enabled ? " - Alarmauslöser braucht threshold_alarms=1" : "");
+}
+
+// Zonen ohne eigene Gruppe der Standardgruppe zuordnen und den ROI-Zeitplan aufbauen
+static void setup_roi_schedule(void) {
+    roi_sched_init(&g_roi_sched, roi_policy);
+    for (int i = 0; i < num_points; i++) {
+        if (points[i].group < 0) {
+            points[i].group = roi_group;
+        }
+        if (roi_mode) {
+            roi_sched_add(&g_roi_sched, points[i].group, points[i].priority);
+        }
+    }
+    if (roi_mode) {
+        debug_print("ROI-Zeitplan: %d Zonen in %d Gruppen (%s, %d ms pro Gruppe)\n",
+                    num_points, g_roi_sched.count, roi_sched_policy_name(roi_policy), roi_dwell_ms);
+    }
+}
+
+// Debug-Log auf den asynchronen Writer umstellen; 0 / -1 (dann bleibt stdio)
+static int open_debug_log(const char *path) {
+    if (async_writer_init(&g_log_writer, NULL, LOG_BUFFERS, LOG_LINE_SIZE, ASYNC_WRITER_AUTO) != 0) {
+        return -1;
+    }
+    int id = async_writer_open(&g_log_writer, path, 1);
+    if (id < 0) {
+        async_writer_destroy(&g_log_writer);
+        return -1;
+    }
+
+    pthread_mutex_lock(&debug_mutex);
+    if (debug_file) {
+        fclose(debug_file);  // Vorläufige Datei aus dem ersten debug_print()
+        debug_file = NULL;
+    }
+    log_file = id;
+    pthread_mutex_unlock(&debug_mutex);
+    return 0;
+}
+
+// Ausstehende Log-Zeilen schreiben und den Writer beenden; danach loggt debug_print() wieder über stdio
+static void close_debug_log(void) {
+    pthread_mutex_lock(&debug_mutex);
+    int id = log_file;
+    log_file = -1;
+    pthread_mutex_unlock(&debug_mutex);
+    if (id >= 0) {
+        async_writer_flush(&g_log_writer, LOG_FLUSH_TIMEOUT_MS);
+        async_writer_destroy(&g_log_writer);
+    }
+}
+
 // Konfigurationsdatei laden
 int load_config() {
     // Debug standardmäßig aktivieren
     debug_enabled = DEFAULT_DEBUG_ENABLED;
+    change_gate_init(&g_gate);
+    threshold_tracker_init(&g_alarms, THRESHOLD_ALARM_DEFAULT_COUNT);
     
-    FILE *fp = fopen(CONFIG_FILE, "r");
+    // HPS3D_CONFIG: eigene Konfiguration je Instanz (mehrere Sensoren an einem Host)
+    const char *config_path = getenv("HPS3D_CONFIG");
+    if (!config_path || !*config_path) {
+        config_path = CONFIG_FILE;
+    }
+    FILE *fp = fopen(config_path, "r");
     if (!fp) {
         debug_print("Verwende Standard-Konfiguration (Debug aktiviert)\n");
         return 0;
@@ -1024,15 +2685,254 @@ int load_config() {
             continue;
         }
         
-        // Messpunkte verarbeiten
+        // Änderungs-Gate: unveränderte Frames nicht dekodieren/publizieren
+        if (strncmp(line, "change_gate=", 12) == 0) {
+            g_gate.enabled = atoi(line + 12);
+            continue;
+        }
+        if (strncmp(line, "gate_tolerance_mm=", 18) == 0) {
+            g_gate.tolerance_mm = (uint16_t)atoi(line + 18);
+            continue;
+        }
+        if (strncmp(line, "gate_max_skip=", 14) == 0) {
+            g_gate.max_skip = (uint32_t)atoi(line + 14);
+            continue;
+        }
+        if (strncmp(line, "gate_samples=", 13) == 0) {
+            g_gate.use_samples = atoi(line + 13);
+            continue;
+        }
+        
+        // Geräte-ROIs statt Vollbild (robuste Statistik über ROI-Pixel)
+        if (strncmp(line, "roi_mode=", 9) == 0) {
+            roi_mode = atoi(line + 9);
+            continue;
+        }
+        if (strncmp(line, "roi_group=", 10) == 0) {
+            int group = atoi(line + 10);
+            roi_group = (group >= 0 && group < 16) ? group : 0;
+            continue;
+        }
+        if (strncmp(line, "roi_outlier_k=", 14) == 0) {
+            float k = (float)atof(line + 14);
+            roi_outlier_k = k > 0.0f ? k : ROI_DEFAULT_OUTLIER_K;
+            continue;
+        }
+        // Schwellwert-Alarme des Geräts als MQTT-Flanken
+        if (strncmp(line, "threshold_alarms=", 17) == 0) {
+            alarms_enabled = atoi(line + 17);
+            continue;
+        }
+        if (strncmp(line, "alarm_qos=", 10) == 0) {
+            int qos = atoi(line + 10);
+            alarm_qos = (qos >= 0 && qos <= 2) ? qos : 0;
+            continue;
+        }
+        if (strncmp(line, "roi_schedule=", 13) == 0) {
+            const char *policy = line + 13;
+            if (roi_sched_parse_policy(policy, (int)strcspn(policy, " \r\n"), &roi_policy) != 0) {
+                printf("WARNUNG: Unbekannter ROI-Zeitplan '%s' - verwende round_robin\n", policy);
+                roi_policy = ROI_SCHED_ROUND_ROBIN;
+            }
+            continue;
+        }
+        if (strncmp(line, "thermal_governor=", 17) == 0) {
+            thermal_enabled = atoi(line + 17) != 0;
+            continue;
+        }
+        if (strncmp(line, "usb_port=", 9) == 0) {
+            sscanf(line + 9, "%63s", usb_port);
+            continue;
+        }
+        if (strncmp(line, "http_port=", 10) == 0) {
+            int port = atoi(line + 10);
+            http_port = (port > 0 && port < 65536) ? port : HTTP_PORT;
+            continue;
+        }
+        if (strncmp(line, "capture_bus=", 12) == 0) {
+            if (sscanf(line + 12, "%127s", capture_bus_path) != 1) {
+                capture_bus_path[0] = '\0';
+            }
+            continue;
+        }
+        if (strncmp(line, "capture_guard_us=", 17) == 0) {
+            int guard = atoi(line + 17);
+            capture_guard_us = guard > 0 ? guard : CAPTURE_DEFAULT_GUARD_US;
+            continue;
+        }
+        if (strncmp(line, "trigger_pre_frames=", 19) == 0) {
+            int frames = atoi(line + 19);
+            trigger_pre_frames = (frames > 0 && frames <= TRIGGER_MAX_FRAMES) ? frames : 0;
+            continue;
+        }
+        if (strncmp(line, "trigger_post_frames=", 20) == 0) {
+            int frames = atoi(line + 20);
+            trigger_post_frames = (frames > 0 && frames <= TRIGGER_MAX_FRAMES) ? frames : TRIGGER_DEFAULT_POST_FRAMES;
+            continue;
+        }
+        if (strncmp(line, "trigger_dir=", 12) == 0) {
+            if (sscanf(line + 12, "%127s", trigger_dir) != 1) {
+                snprintf(trigger_dir, sizeof(trigger_dir), "%s", TRIGGER_DEFAULT_DIR);
+            }
+            continue;
+        }
+        if (strncmp(line, "trigger_on_alarm=", 17) == 0) {
+            trigger_on_alarm = atoi(line + 17) != 0;
+            continue;
+        }
+        if (strncmp(line, "pixel_health=", 13) == 0) {
+            pixel_health_enabled = atoi(line + 13) != 0;
+            continue;
+        }
+        if (strncmp(line, "pixel_health_every=", 19) == 0) {
+            int every = atoi(line + 19);
+            pixel_health_every = every > 0 ? every : PIXEL_HEALTH_DEFAULT_EVERY;
+            continue;
+        }
+        if (strncmp(line, "pixel_health_window=", 20) == 0) {
+            int window = atoi(line + 20);
+            pixel_health_window = (window >= 4 && window <= PIXEL_HEALTH_MAX_WINDOW) ? window : PIXEL_HEALTH_DEFAULT_WINDOW;
+            continue;
+        }
+        if (strncmp(line, "pixel_mask_file=", 16) == 0) {
+            if (sscanf(line + 16, "%127s", pixel_mask_file) != 1) {
+                pixel_mask_file[0] = '\0';
+            }
+            continue;
+        }
+        if (strncmp(line, "optical_path=", 13) == 0) {
+            char mode[16] = "";
+            sscanf(line + 13, "%15s", mode);
+            optical_path_host = strcmp(mode, "host") == 0;
+            if (!optical_path_host && strcmp(mode, "device") != 0) {
+                printf("WARNUNG: Unbekannter optical_path '%s' - verwende device\n", mode);
+            }
+            continue;
+        }
+        if (strncmp(line, "optical_fov_h=", 14) == 0) {
+            optical_fov_h = (float)atof(line + 14);
+            continue;
+        }
+        if (strncmp(line, "optical_fov_v=", 14) == 0) {
+            optical_fov_v = (float)atof(line + 14);
+            continue;
+        }
+        if (strncmp(line, "pointcloud2=", 12) == 0) {
+            char mode[16] = "";
+            sscanf(line + 12, "%15s", mode);
+            pointcloud2_mqtt = strcmp(mode, "mqtt") == 0 || strcmp(mode, "both") == 0;
+            pointcloud2_shm = strcmp(mode, "shm") == 0 || strcmp(mode, "both") == 0;
+            if (!pointcloud2_mqtt && !pointcloud2_shm && strcmp(mode, "off") != 0) {
+                printf("WARNUNG: Unbekannter pointcloud2-Modus '%s' - aus\n", mode);
+            }
+            continue;
+        }
+        if (strncmp(line, "pointcloud2_shm=", 16) == 0) {
+            if (sscanf(line + 16, "%127s", pointcloud2_shm_path) != 1) {
+                strcpy(pointcloud2_shm_path, POINTCLOUD2_DEFAULT_SHM);
+            }
+            continue;
+        }
+        if (strncmp(line, "pointcloud2_transform=", 22) == 0) {
+            float *m = pointcloud2_pose;
+            pointcloud2_posed = sscanf(line + 22, "%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f", &m[0], &m[1], &m[2], &m[3],
+                                       &m[4], &m[5], &m[6], &m[7], &m[8], &m[9], &m[10], &m[11]) == 12;
+            if (!pointcloud2_posed) {
+                printf("WARNUNG: pointcloud2_transform braucht 12 Werte (R|t zeilenweise) - ignoriert\n");
+            }
+            continue;
+        }
+        if (strncmp(line, "pointcloud2_frame_id=", 21) == 0) {
+            if (sscanf(line + 21, "%31s", pointcloud2_frame_id) != 1) {
+                strcpy(pointcloud2_frame_id, "hps3d");
+            }
+            continue;
+        }
+        if (strncmp(line, "output_profile=", 15) == 0) {
+            output_profile_t *profile = &g_profiles[num_profiles];
+            if (num_profiles >= OUTPUT_PROFILE_MAX) {
+                printf("WARNUNG: Mehr als %d Ausgabeprofile - ignoriert\n", OUTPUT_PROFILE_MAX);
+            } else if (output_profile_parse(profile, line + 15, MQTT_TOPIC) != 0) {
+                printf("WARNUNG: Ungültiges Ausgabeprofil '%.*s' - ignoriert\n", (int)strcspn(line + 15, "\r\n"), line + 15);
+            } else if (find_output_profile(profile->name, strlen(profile->name)) >= 0) {
+                printf("WARNUNG: Ausgabeprofil %s doppelt - ignoriert\n", profile->name);
+            } else {
+                num_profiles++;
+            }
+            continue;
+        }
+        if (strncmp(line, "depth_histogram=", 16) == 0) {
+            int bins, lo, hi;
+            depth_histogram = 0;
+            if (strncmp(line + 16, "off", 3) == 0) {
+                continue;
+            }
+            if (sscanf(line + 16, "%d,%d,%d", &bins, &lo, &hi) != 3 || lo < 0 || hi > REGION_INVALID_MIN ||
+                depth_hist_range_init(&g_hist_range, bins, (uint16_t)lo, (uint16_t)hi) != 0) {
+                printf("WARNUNG: Ungültiges depth_histogram '%.*s' - aus\n", (int)strcspn(line + 16, "\r\n"),
+                       line + 16);
+            } else {
+                depth_histogram = 1;
+            }
+            continue;
+        }
+        if (strncmp(line, "depth_histogram_autorange=", 26) == 0) {
+            if (sscanf(line + 26, "%f,%f", &hist_auto_low, &hist_auto_high) != 2 || hist_auto_low < 0.0f ||
+                hist_auto_high > 100.0f || hist_auto_low >= hist_auto_high) {
+                printf("WARNUNG: Ungültiges depth_histogram_autorange - aus\n");
+                hist_auto_low = -1.0f;
+            }
+            continue;
+        }
+        if (strncmp(line, "minmax_index=", 13) == 0) {
+            if (strncmp(line + 13, "on", 2) == 0) {
+                minmax_index = 1;   // Mit Zonen ohnehin an
+            }
+            continue;
+        }
+        if (strncmp(line, "minmax_zone=", 12) == 0) {
+            int x0, y0, w, h;
+            if (num_zones >= MINMAX_MAX_ZONES) {
+                printf("WARNUNG: Mehr als %d Min/Max-Zonen - ignoriert\n", MINMAX_MAX_ZONES);
+            } else if (sscanf(line + 12, "%d,%d,%d,%d", &x0, &y0, &w, &h) != 4 || x0 < 0 || y0 < 0 || w < 1 ||
+                       h < 1 || x0 + w > SENSOR_WIDTH || y0 + h > SENSOR_HEIGHT) {
+                printf("WARNUNG: Ungültige Min/Max-Zone '%.*s' - ignoriert\n", (int)strcspn(line + 12, "\r\n"),
+                       line + 12);
+            } else {
+                minmax_zones[num_zones].x0 = x0;
+                minmax_zones[num_zones].y0 = y0;
+                minmax_zones[num_zones].w = w;
+                minmax_zones[num_zones].h = h;
+                num_zones++;
+                minmax_index = 1;   // Zonen brauchen die Tabelle
+            }
+            continue;
+        }
+        if (strncmp(line, "pixel_correction_file=", 22) == 0) {
+            if (sscanf(line + 22, "%127s", pixel_correction_file) != 1) {
+                pixel_correction_file[0] = '\0';
+            }
+            continue;
+        }
+        if (strncmp(line, "roi_dwell_ms=", 13) == 0) {
+            int dwell = atoi(line + 13);
+            roi_dwell_ms = dwell > 0 ? dwell : MEASURE_INTERVAL_MS;
+            continue;
+        }
+        
+        // Messpunkte verarbeiten: x,y,name[,gruppe[,priorität]]
         int x, y;
+        int group = -1, priority = 1;
         char name[32];
-        if (point_idx < MAX_POINTS && sscanf(line, "%d,%d,%s", &x, &y, name) == 3) {
-            if (x >= AREA_OFFSET && x < (160 - AREA_OFFSET) && 
-                y >= AREA_OFFSET && y < (60 - AREA_OFFSET)) {
+        if (point_idx < MAX_POINTS &&
+            sscanf(line, "%d,%d,%31[^,\r\n ],%d,%d", &x, &y, name, &group, &priority) >= 3) {
+            if (x >= AREA_OFFSET && x < (SENSOR_WIDTH - AREA_OFFSET) && 
+                y >= AREA_OFFSET && y < (SENSOR_HEIGHT - AREA_OFFSET)) {
                 points[point_idx].x = x;
                 points[point_idx].y = y;
                 strncpy(points[point_idx].name, name, sizeof(points[point_idx].name)-1);
+                points[point_idx].group = (group >= 0 && group < ROI_SCHED_MAX_GROUPS) ? group : -1;
+                points[point_idx].priority = priority > 0 ? priority : 1;
                 point_idx++;
             } else {
                 printf("WARNUNG: Koordinaten (%d,%d) ungültig - 5x5 Bereich außerhalb des Sensors\n", x, y);
@@ -1041,9 +2941,15 @@ int load_config() {
     }
     
     fclose(fp);
+    if (point_idx > 0) {
+        num_points = point_idx;
+    }
     
     // Debug-Datei öffnen wenn aktiviert
-    if (debug_enabled) {
+    if (debug_enabled && open_debug_log(debug_file_path) == 0) {
+        printf("Debug-Ausgaben werden in %s geschrieben (%s)\n", debug_file_path,
+               async_writer_backend_name(g_log_writer.backend));
+    } else if (debug_enabled) {
         debug_file = fopen(debug_file_path, "w");
         if (!debug_file) {
             printf("WARNUNG: Debug-Datei %s konnte nicht geöffnet werden\n", debug_file_path);
@@ -1052,8 +2958,9 @@ int load_config() {
         }
     }
     
-    printf("Konfiguration geladen: %d Punkte, Debug %s, min_valid_pixels %d\n", 
-           point_idx, debug_enabled ? "aktiviert" : "deaktiviert", min_valid_pixels);
+    printf("Konfiguration geladen: %d Punkte, Debug %s, min_valid_pixels %d, Gate %s\n", 
+           point_idx, debug_enabled ? "aktiviert" : "deaktiviert", min_valid_pixels,
+           g_gate.enabled ? "aktiviert" : "deaktiviert");
     return point_idx;
 }
 
@@ -1073,11 +2980,12 @@ int create_pid_file() {
 // Cleanup-Funktion überarbeitet
 void cleanup(void) {
     debug_print("Cleanup...\n");
+    systemd_notify("STOPPING=1");
     
     // Threads signalisieren dass sie beenden sollen
     running = 0;
     atomic_store(&measurement_active, 0);
-    atomic_store(&pointcloud_requested, 0);
+    atomic_store(&pointcloud_requested, POINTCLOUD_IDLE);
     
     // LIDAR-Ressourcen vollständig bereinigen
     debug_print("Bereinige LIDAR-Ressourcen...\n");
@@ -1105,10 +3013,22 @@ void cleanup(void) {
     debug_print("Räume SDK auf...\n");
     HPS3D_MeasureDataFree(&g_measureData);
     HPS3D_UnregisterEventCallback();
+    if (trigger_enabled) {
+        trigger_capture_destroy(&g_trigger);  // Laufende Aufnahme noch auf die Platte bringen
+        trigger_enabled = 0;
+    }
+    event_dispatch_shutdown();
+    burst_free(&g_burst);
+    pthread_mutex_lock(&data_mutex);
+    pointcloud2_shm_close(g_pc2_shm);   // Datei bleibt für Leser, Sequenz gerade
+    g_pc2_shm = NULL;
+    pointcloud_soa_free(&g_cloud);
+    pthread_mutex_unlock(&data_mutex);
     
     // Debug-Log schließen
+    debug_print("Schließe Debug-Log...\n");
+    close_debug_log();
     if (debug_file) {
-        debug_print("Schließe Debug-Log...\n");
         fclose(debug_file);
         debug_file = NULL;
     }
@@ -1156,17 +3076,99 @@ static int thread_join_timeout(pthread_t thread, void **retval, const struct tim
 #endif
 }
 
+// Einen Satz Full-Depth-Frames vor dem ebenen Ziel mitteln
+static int calibration_collect(pixel_calib_accum_t *acc, uint32_t reference_mm, int frames) {
+    printf("Ebenes Ziel senkrecht zur Sensorachse in %u mm Abstand aufstellen, dann Enter... ", reference_mm);
+    fflush(stdout);
+    char answer[16];
+    if (!fgets(answer, sizeof(answer), stdin)) {
+        printf("\n");  // Keine Eingabe (Skript): sofort messen
+    }
+
+    pixel_calib_reset(acc);
+    int attempts = 0;
+    while (acc->frames < (uint32_t)frames && attempts++ < frames * 3 && running) {
+        HPS3D_EventType_t event_type;
+        if (HPS3D_SingleCapture(g_handle, &event_type, &g_measureData) == HPS3D_RET_OK &&
+            event_type == HPS3D_FULL_DEPTH_EVEN) {
+            if (optical_path_host) {
+                optical_path_perpendicular(&g_optical, g_measureData.full_depth_data.distance);
+            }
+            pixel_calib_add(acc, g_measureData.full_depth_data.distance);
+        }
+    }
+    printf("%u/%d Frames bei %u mm\n", acc->frames, frames, reference_mm);
+    return acc->frames == (uint32_t)frames ? 0 : -1;
+}
+
+// hps3d_service --calibrate <mm>[,<mm>] [frames] [datei]
+// Eine Entfernung ergibt reine Offsets, zwei Entfernungen Gain und Offset je Pixel.
+static int run_calibration(int argc, char *argv[]) {
+    static pixel_calib_accum_t acc[2];
+    unsigned int reference[2] = {0, 0};
+    int references = argc > 2 ? sscanf(argv[2], "%u,%u", &reference[0], &reference[1]) : 0;
+    int frames = argc > 3 ? atoi(argv[3]) : PIXEL_CALIB_DEFAULT_FRAMES;
+    const char *path = argc > 4 ? argv[4] :
+                       pixel_correction_file[0] ? pixel_correction_file : PIXEL_CORRECTION_DEFAULT_FILE;
+    if (references < 1 || frames <= 0 || frames > UINT16_MAX) {
+        fprintf(stderr, "Aufruf: %s --calibrate <mm>[,<mm>] [frames] [datei]\n", argv[0]);
+        return 1;
+    }
+
+    if (HPS3D_MeasureDataInit(&g_measureData) != HPS3D_RET_OK ||
+        HPS3D_USBConnectDevice(usb_port, &g_handle) != HPS3D_RET_OK) {
+        fprintf(stderr, "FEHLER: Verbindung zu HPS3D-160 an %s fehlgeschlagen\n", usb_port);
+        HPS3D_MeasureDataFree(&g_measureData);
+        return 1;
+    }
+    configure_device_filters();
+
+    static pixel_correction_t table;
+    int ret = 1;
+    if (calibration_collect(&acc[0], reference[0], frames) == 0 &&
+        (references < 2 || calibration_collect(&acc[1], reference[1], frames) == 0)) {
+        int uncalibrated = pixel_correction_from_flat(&table, &acc[0], reference[0],
+                                                      references < 2 ? NULL : &acc[1], reference[1]);
+        if (uncalibrated < 0) {
+            fprintf(stderr, "FEHLER: Ungültige Referenzentfernungen\n");
+        } else if (pixel_correction_save(&table, path) != 0) {
+            fprintf(stderr, "FEHLER: %s konnte nicht geschrieben werden (%s)\n", path, strerror(errno));
+        } else {
+            printf("Korrekturtabelle %s geschrieben, %d Pixel ohne Korrektur\n", path, uncalibrated);
+            ret = 0;
+        }
+    } else {
+        fprintf(stderr, "FEHLER: Zu wenige gültige Frames\n");
+    }
+
+    HPS3D_CloseDevice(g_handle);
+    HPS3D_MeasureDataFree(&g_measureData);
+    return ret;
+}
+
 // Hauptprogramm anpassen
 int main(int argc, char *argv[]) {
     // Signal Handler
     signal(SIGINT, signal_handler);
     signal(SIGTERM, signal_handler);
     
+    // Kalibrierung statt Service: eigenständig, ohne HTTP/MQTT
+    if (argc > 1 && strcmp(argv[1], "--calibrate") == 0) {
+        if (load_config() < 0) {
+            return 1;
+        }
+        setup_optical_path();
+        return run_calibration(argc, argv);
+    }
+
     // Daemon Mode
     if (argc > 1 && strcmp(argv[1], "-d") == 0) {
         daemon(0, 0);
     }
     
+    startup.t0_ms = monotonic_ms();
+    watchdog_interval_ms = systemd_watchdog_usec() / 1000;
+
     // Debug sofort aktivieren und Service-Start loggen
     debug_enabled = DEFAULT_DEBUG_ENABLED;
     debug_print("HPS3D-160 LIDAR Service startet...\n");
@@ -1176,32 +3178,51 @@ int main(int argc, char *argv[]) {
         debug_print("FEHLER: Konfiguration konnte nicht geladen werden\n");
         return 1;
     }
+    setup_roi_schedule();
+    setup_thermal_governor();
+    setup_capture_scheduler();
+    setup_trigger_capture();
+    setup_optical_path();
+    setup_pixel_correction();
+    setup_pixel_health();
+    setup_pointcloud2();
+    setup_depth_histogram();
+    startup_mark(&startup.config_ms, "Konfiguration");
     
     // PID-Datei erstellen
     if (create_pid_file() != 0) {
         debug_print("WARNUNG: PID-Datei konnte nicht erstellt werden\n");
     }
     
-    // MQTT initialisieren
+    // Steuerpfade zuerst: HTTP Server starten - Fehler werden toleriert
+    init_http_server();
+    pthread_t measure_tid, output_tid, http_tid;
+    if (http_socket >= 0) {
+        if (pthread_create(&http_tid, NULL, http_server_thread, NULL) != 0) {
+            debug_print("FEHLER: HTTP-Thread konnte nicht erstellt werden\n");
+            cleanup();
+            return 1;
+        }
+        startup_mark(&startup.http_ms, "HTTP");
+    }
+    
+    // MQTT verbindet asynchron, Bereitschaft meldet der Connect-Callback
     if (init_mqtt() != 0) {
         debug_print("WARNUNG: MQTT konnte nicht initialisiert werden\n");
     }
     
-    // HTTP Server starten - Fehler werden toleriert
-    init_http_server();
-    
-    // LIDAR initialisieren
-    if (init_lidar() != 0) {
-        debug_print("FEHLER: LIDAR konnte nicht initialisiert werden\n");
+    // Callback-Verteilung vorbereiten; die Paketpuffer entstehen erst beim Öffnen des Geräts.
+    // Der Vorlauf-Ring hält Puffer der Verteilung, dafür entsprechend mehr.
+    uint32_t dispatch_buffers = EVENT_DISPATCH_BUFFERS + (trigger_enabled ? (uint32_t)trigger_pre_frames : 0);
+    if (event_dispatch_init(dispatch_buffers, PACKET_MAX_SIZE) != 0) {
+        debug_print("FEHLER: Callback-Verteilung konnte nicht initialisiert werden\n");
         cleanup();
         return 1;
     }
-    
-    debug_print("Service gestartet, warte auf Aktivierung via MQTT/HTTP...\n");
-    
-    // Threads starten
-    pthread_t measure_tid, output_tid, http_tid;
-    
+
+    // Der Mess-Thread öffnet das LIDAR selbst; ein fehlendes Gerät beendet den Service nicht.
+    // READY=1 folgt mit dem ersten gültigen Frame.
+    systemd_notify("STATUS=Warte auf ersten Frame");
     if (pthread_create(&measure_tid, NULL, measure_thread, NULL) != 0) {
         debug_print("FEHLER: Mess-Thread konnte nicht erstellt werden\n");
         cleanup();
@@ -1214,14 +3235,7 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
-    // HTTP-Thread nur starten wenn Socket erfolgreich erstellt wurde
-    if (http_socket >= 0) {
-        if (pthread_create(&http_tid, NULL, http_server_thread, NULL) != 0) {
-            debug_print("FEHLER: HTTP-Thread konnte nicht erstellt werden\n");
-            cleanup();
-            return 1;
-        }
-    }
+    debug_print("Service gestartet, warte auf Aktivierung via MQTT/HTTP...\n");
     
     // Warte auf Signal zum Beenden
     while (running) {
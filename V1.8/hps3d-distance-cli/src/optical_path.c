@@ -0,0 +1,74 @@
+/*
+ * Optische Wegkorrektur (Schräg- -> Senkrechtentfernung) auf dem Host
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include "optical_path.h"
+#include "region.h"
+
+int optical_path_init(optical_path_t *op, float fov_h_deg, float fov_v_deg) {
+    if (!(fov_h_deg >= 1.0f && fov_h_deg <= 170.0f && fov_v_deg >= 1.0f && fov_v_deg <= 170.0f)) {
+        return -1;
+    }
+    const double deg = 3.14159265358979323846 / 180.0;
+    // Brennweite in Pixeln: halbe Bildbreite sieht den halben Öffnungswinkel
+    double fx = (SENSOR_WIDTH / 2.0) / tan(fov_h_deg * deg / 2.0);
+    double fy = (SENSOR_HEIGHT / 2.0) / tan(fov_v_deg * deg / 2.0);
+    double cx = (SENSOR_WIDTH - 1) / 2.0;
+    double cy = (SENSOR_HEIGHT - 1) / 2.0;
+
+    for (int y = 0; y < SENSOR_HEIGHT; y++) {
+        double v = (y - cy) / fy;
+        for (int x = 0; x < SENSOR_WIDTH; x++) {
+            double u = (x - cx) / fx;
+            double c = 1.0 / sqrt(1.0 + u * u + v * v);
+            op->cos_q[y * SENSOR_WIDTH + x] = (uint16_t)(c * OPTICAL_PATH_COS_ONE + 0.5);
+        }
+    }
+    op->fov_h = fov_h_deg;
+    op->fov_v = fov_v_deg;
+    return 0;
+}
+
+// Senkrechte Entfernung eines Pixels; Sentinel-Werte bleiben
+static inline uint16_t perpendicular(uint16_t d, uint16_t c) {
+    uint32_t p = ((uint32_t)d * c + (OPTICAL_PATH_COS_ONE / 2)) >> OPTICAL_PATH_COS_SHIFT;
+    p = p < 1 ? 1 : p;
+    return region_pixel_valid(d) ? (uint16_t)p : d;
+}
+
+static void perpendicular_span(const uint16_t *KERNEL_RESTRICT cos_q, uint16_t *KERNEL_RESTRICT distance, int n) {
+    KERNEL_UNROLL(4)
+    for (int i = 0; i < n; i++) {
+        distance[i] = perpendicular(distance[i], cos_q[i]);
+    }
+}
+
+void optical_path_split(const optical_path_t *op, uint16_t *KERNEL_RESTRICT distance, uint16_t *KERNEL_RESTRICT range) {
+    const uint16_t *KERNEL_RESTRICT cos_q = op->cos_q;
+    KERNEL_UNROLL(4)
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        uint16_t d = distance[i];
+        range[i] = d;
+        distance[i] = perpendicular(d, cos_q[i]);
+    }
+}
+
+void optical_path_perpendicular(const optical_path_t *op, uint16_t *distance) {
+    perpendicular_span(op->cos_q, distance, SENSOR_PIXELS);
+}
+
+void optical_path_perpendicular_roi(const optical_path_t *op, HPS3D_FullRoiData_t *roi) {
+    int w = roi->right_bottom_x - roi->left_top_x + 1;
+    int h = roi->right_bottom_y - roi->left_top_y + 1;
+    if (!roi->distance || w <= 0 || h <= 0 || (uint32_t)(w * h) > roi->pixel_number ||
+        roi->right_bottom_x >= SENSOR_WIDTH || roi->right_bottom_y >= SENSOR_HEIGHT) {
+        return;
+    }
+    for (int y = 0; y < h; y++) {
+        int base = (roi->left_top_y + y) * SENSOR_WIDTH + roi->left_top_x;
+        perpendicular_span(op->cos_q + base, roi->distance + y * w, w);
+    }
+}
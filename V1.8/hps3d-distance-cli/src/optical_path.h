@@ -0,0 +1,49 @@
+#ifndef OPTICAL_PATH_H
+#define OPTICAL_PATH_H
+
+#include <stdint.h>
+#include "HPS3DUser_IF.h"
+#include "sensor_geometry.h"
+
+/*
+ * Optische Wegkorrektur auf dem Host. Der Sensor misst die Weglänge entlang
+ * des Sichtstrahls jedes Pixels (Schrägentfernung); die Entfernung senkrecht
+ * zur Sensorebene ist
+ *
+ *   senkrecht = schräg * cos(theta)
+ *
+ * mit theta = Winkel zwischen Sichtstrahl und optischer Achse. Die Kosinus-
+ * Tabelle folgt einem Lochkameramodell aus dem Öffnungswinkel und wird einmal
+ * beim Start berechnet (Festkomma, OPTICAL_PATH_COS_ONE = 1.0).
+ *
+ * split() macht daraus in einem branchfreien, vom Compiler vektorisierten
+ * Durchlauf beide Ebenen: die Rohwerte (Schrägentfernung) landen in range,
+ * die Distanzebene wird in place senkrecht. Sentinel-Werte bleiben in beiden
+ * Ebenen unverändert. Ersetzt HPS3D_SetOpticalPathCalibration, das nur eine
+ * der beiden Ebenen liefert.
+ */
+
+#define OPTICAL_PATH_COS_SHIFT 15
+#define OPTICAL_PATH_COS_ONE (1 << OPTICAL_PATH_COS_SHIFT)
+#define OPTICAL_PATH_DEFAULT_FOV_H 76.0f   // Grad, Datenblatt HPS3D-160
+#define OPTICAL_PATH_DEFAULT_FOV_V 32.0f
+
+typedef struct {
+    uint16_t cos_q[SENSOR_PIXELS];  // cos(theta) je Pixel
+    float fov_h;                    // Öffnungswinkel in Grad
+    float fov_v;
+} optical_path_t;
+
+// Kosinus-Tabelle aus den Öffnungswinkeln; Rückgabe 0 / -1 (Winkel außerhalb 1..170 Grad)
+int optical_path_init(optical_path_t *op, float fov_h_deg, float fov_v_deg);
+
+// Distanzebene in place senkrecht machen, Rohwerte nach range kopieren
+void optical_path_split(const optical_path_t *op, uint16_t *distance, uint16_t *range);
+
+// Nur senkrecht, ohne Rohwerte (Burst, Kalibrierung)
+void optical_path_perpendicular(const optical_path_t *op, uint16_t *distance);
+
+// Dasselbe für ein Geräte-ROI (Distanzwerte in ROI-Koordinaten)
+void optical_path_perpendicular_roi(const optical_path_t *op, HPS3D_FullRoiData_t *roi);
+
+#endif // OPTICAL_PATH_H
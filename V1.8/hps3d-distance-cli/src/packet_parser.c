@@ -0,0 +1,194 @@
+/*
+ * Paket-Parser für HPS3D Messdaten
+ *
+ * Ersetzt das ungeprüfte Parsing aus HPS3D_ConvertToMeasureData():
+ * - packet_validate() prüft Layout und Länge einmal pro Paket
+ *   (ROI-Anzahl, pixel_number pro ROI, Gesamtlänge gegen dataLen)
+ * - packet_decode() läuft danach ohne weitere Prüfungen über den Body
+ */
+
+#include <stddef.h>
+#include "packet_parser.h"
+#include "sensor_geometry.h"
+
+// Spezialisierte Kernel für 160x60; andere Sensormodelle bekommen eine eigene Instanz
+DEFINE_DEPTH_DECODE_KERNELS(160x60, SENSOR_WIDTH, SENSOR_HEIGHT)
+
+static inline uint16_t rd16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t rd32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+// width/height im Header: nur 160x60 oder 0x0 (festes Layout). Alle Verbraucher
+// indizieren die Distanzebene mit SENSOR_WIDTH, andere Geometrien werden abgelehnt
+static int full_depth_geometry_ok(const uint8_t *data) {
+    int width = rd16(data + 10);
+    int height = rd16(data + 12);
+    return (width == 0 && height == 0) || (width == SENSOR_WIDTH && height == SENSOR_HEIGHT);
+}
+
+int packet_validate(const uint8_t *data, int dataLen, HPS3D_EventType_t type) {
+    if (!data || dataLen <= 0) {
+        return -1;
+    }
+
+    switch (type) {
+        case HPS3D_SIMPLE_ROI_EVEN: {
+            int num = data[0];
+            if (num > HPS3D_MAX_ROI_NUMBER) return -1;
+            int len = num * PACKET_SIMPLE_ROI_SIZE;
+            return (len <= dataLen) ? len : -1;
+        }
+
+        case HPS3D_FULL_ROI_EVEN: {
+            int num = data[0];
+            if (num > HPS3D_MAX_ROI_NUMBER) return -1;
+
+            // Variable Länge: pixel_number jeder ROI bestimmt den Offset der nächsten
+            int len = 0;
+            for (int i = 0; i < num; i++) {
+                if (dataLen - len < PACKET_FULL_ROI_HEADER) return -1;
+                uint32_t pixel_number = rd32(data + len + 18);
+                if (pixel_number > HPS3D_MAX_PIXEL_NUMBER) return -1;
+                len += PACKET_FULL_ROI_HEADER;
+                if ((uint32_t)(dataLen - len) < pixel_number * 2) return -1;
+                len += (int)pixel_number * 2;
+            }
+            return len;
+        }
+
+        case HPS3D_SIMPLE_DEPTH_EVEN:
+            return (dataLen >= PACKET_SIMPLE_DEPTH_SIZE) ? PACKET_SIMPLE_DEPTH_SIZE : -1;
+
+        case HPS3D_FULL_DEPTH_EVEN: {
+            if (dataLen < PACKET_FULL_DEPTH_HEADER) return -1;
+            if (!full_depth_geometry_ok(data)) return -1;
+            return (dataLen >= PACKET_FULL_DEPTH_SIZE) ? PACKET_FULL_DEPTH_SIZE : -1;
+        }
+
+        default:
+            return -1;
+    }
+}
+
+static int decode_simple_roi(const uint8_t *data, HPS3D_SimpleRoiData_t *roi) {
+    const uint8_t *p = data;
+    int num = data[0];
+
+    for (int i = 0; i < num; i++, p += PACKET_SIMPLE_ROI_SIZE) {
+        roi[i].roi_num = p[0];
+        roi[i].group_id = p[1];
+        roi[i].roi_id = p[2];
+        roi[i].threshold_state = p[3];
+        roi[i].distance_average = rd16(p + 4);
+        roi[i].distance_min = rd16(p + 6);
+        roi[i].saturation_count = rd16(p + 8);
+        roi[i].frame_cnt = rd32(p + 10);
+    }
+    return (int)(p - data);
+}
+
+static int decode_full_roi(const uint8_t *data, HPS3D_FullRoiData_t *roi) {
+    const uint8_t *p = data;
+    int num = data[0];
+
+    for (int i = 0; i < num; i++) {
+        roi[i].roi_num = p[0];
+        roi[i].group_id = p[1];
+        roi[i].roi_id = p[2];
+        roi[i].threshold_state = p[3];
+        roi[i].left_top_x = rd16(p + 4);
+        roi[i].left_top_y = rd16(p + 6);
+        roi[i].right_bottom_x = rd16(p + 8);
+        roi[i].right_bottom_y = rd16(p + 10);
+        roi[i].distance_average = rd16(p + 12);
+        roi[i].distance_min = rd16(p + 14);
+        roi[i].saturation_count = rd16(p + 16);
+        roi[i].pixel_number = rd32(p + 18);
+        roi[i].frame_cnt = rd32(p + 22);
+        p += PACKET_FULL_ROI_HEADER;
+
+        uint16_t *distance = roi[i].distance;
+        uint32_t n = roi[i].pixel_number;
+        for (uint32_t j = 0; j < n; j++) {
+            distance[j] = rd16(p + 2 * j);
+        }
+        p += 2 * n;
+    }
+    return (int)(p - data);
+}
+
+static void decode_depth_header(const uint8_t *p, HPS3D_DepthData_t *depth) {
+    depth->distance_average = rd16(p);
+    depth->distance_min = rd16(p + 2);
+    depth->saturation_count = rd16(p + 4);
+    depth->frame_cnt = rd32(p + 6);
+}
+
+// Header und Distanzebene (nur nach packet_validate, also immer 160x60)
+static void decode_full_depth_plane(const uint8_t *data, HPS3D_DepthData_t *depth) {
+    decode_depth_header(data, depth);
+    depth->point_cloud_data.width = rd16(data + 10);
+    depth->point_cloud_data.height = rd16(data + 12);
+    depth->point_cloud_data.points = rd16(data + 14);
+
+    decode_distance_160x60((const uint8_t (*)[2 * SENSOR_WIDTH])(data + PACKET_FULL_DEPTH_HEADER),
+                           (depth_row_t *)depth->distance);
+}
+
+static int decode_full_depth(const uint8_t *data, HPS3D_DepthData_t *depth) {
+    decode_full_depth_plane(data, depth);
+    const uint8_t *pts = data + PACKET_FULL_DEPTH_HEADER + 2 * SENSOR_PIXELS;
+
+    decode_points_160x60((const uint8_t (*)[12 * SENSOR_WIDTH])pts,
+                         (HPS3D_PerPointCloudData_t (*)[SENSOR_WIDTH])depth->point_cloud_data.point_data);
+    return PACKET_FULL_DEPTH_SIZE;
+}
+
+int packet_decode(const uint8_t *data, HPS3D_MeasureData_t *resultData, HPS3D_EventType_t type) {
+    switch (type) {
+        case HPS3D_SIMPLE_ROI_EVEN:
+            return decode_simple_roi(data, resultData->simple_roi_data);
+        case HPS3D_FULL_ROI_EVEN:
+            return decode_full_roi(data, resultData->full_roi_data);
+        case HPS3D_SIMPLE_DEPTH_EVEN:
+            decode_depth_header(data, &resultData->simple_depth_data);
+            return PACKET_SIMPLE_DEPTH_SIZE;
+        case HPS3D_FULL_DEPTH_EVEN:
+            return decode_full_depth(data, &resultData->full_depth_data);
+        default:
+            return 0;
+    }
+}
+
+int packet_parse(const uint8_t *data, int dataLen, HPS3D_MeasureData_t *resultData, HPS3D_EventType_t type) {
+    if (!resultData || packet_validate(data, dataLen, type) < 0) {
+        return -1;
+    }
+    return packet_decode(data, resultData, type);
+}
+
+int packet_parse_full_depth_soa(const uint8_t *data, int dataLen, HPS3D_DepthData_t *depth,
+                                pointcloud_soa_t *cloud) {
+    if (!depth || !cloud || packet_validate(data, dataLen, HPS3D_FULL_DEPTH_EVEN) < 0) {
+        return -1;
+    }
+    if (cloud->capacity < SENSOR_PIXELS) {
+        return -1;
+    }
+
+    decode_full_depth_plane(data, depth);
+    const uint8_t *pts = data + PACKET_FULL_DEPTH_HEADER + 2 * SENSOR_PIXELS;
+
+    decode_points_soa_160x60((const uint8_t (*)[12 * SENSOR_WIDTH])pts,
+                             (float (*)[SENSOR_WIDTH])cloud->x,
+                             (float (*)[SENSOR_WIDTH])cloud->y,
+                             (float (*)[SENSOR_WIDTH])cloud->z);
+    cloud->width = SENSOR_WIDTH;
+    cloud->height = SENSOR_HEIGHT;
+    cloud->count = SENSOR_PIXELS;
+    return PACKET_FULL_DEPTH_SIZE;
+}
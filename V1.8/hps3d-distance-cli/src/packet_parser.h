@@ -0,0 +1,38 @@
+#ifndef PACKET_PARSER_H
+#define PACKET_PARSER_H
+
+#include <stdint.h>
+#include "HPS3DUser_IF.h"
+#include "pointcloud.h"
+
+// Paketlayout der Messdaten (Big-Endian, siehe HPS3D_ConvertToMeasureData)
+#define PACKET_SIMPLE_ROI_SIZE    14   // Pro ROI: IDs, Alarm, avg/min/sat, frame_cnt
+#define PACKET_FULL_ROI_HEADER    26   // Pro ROI ohne Pixel: + Rechteck, pixel_number
+#define PACKET_SIMPLE_DEPTH_SIZE  10   // avg/min/sat, frame_cnt
+#define PACKET_FULL_DEPTH_HEADER  16   // + width, height, points
+#define PACKET_BYTES_PER_PIXEL    14   // 2 Byte Distanz + 3x4 Byte Punktwolke
+#define PACKET_FULL_DEPTH_BYTES(pixels) (PACKET_FULL_DEPTH_HEADER + PACKET_BYTES_PER_PIXEL * (pixels))
+#define PACKET_FULL_DEPTH_SIZE    PACKET_FULL_DEPTH_BYTES(HPS3D_MAX_PIXEL_NUMBER)  // 160x60
+#define PACKET_FULL_ROI_MAX_SIZE  (HPS3D_MAX_ROI_NUMBER * (PACKET_FULL_ROI_HEADER + 2 * HPS3D_MAX_PIXEL_NUMBER))
+// Größtes gültiges Paket über alle Typen (Puffergröße für Rohpakete)
+#define PACKET_MAX_SIZE ((PACKET_FULL_ROI_MAX_SIZE > PACKET_FULL_DEPTH_SIZE) ? \
+                         PACKET_FULL_ROI_MAX_SIZE : PACKET_FULL_DEPTH_SIZE)
+
+// Prüft das komplette Paketlayout einmalig gegen dataLen.
+// Rückgabe: Anzahl Bytes die packet_decode() lesen wird, -1 bei ungültigem Paket
+int packet_validate(const uint8_t *data, int dataLen, HPS3D_EventType_t type);
+
+// Ungeprüfter Fast-Path - nur nach erfolgreichem packet_validate() aufrufen.
+// Rückgabe: Anzahl gelesener Bytes
+int packet_decode(const uint8_t *data, HPS3D_MeasureData_t *resultData, HPS3D_EventType_t type);
+
+// Validierung + Dekodierung in einem Schritt, -1 bei ungültigem Paket
+int packet_parse(const uint8_t *data, int dataLen, HPS3D_MeasureData_t *resultData, HPS3D_EventType_t type);
+
+// Full-Depth Paket mit Punktwolke direkt im SoA-Layout (ohne AoS-Zwischenschritt).
+// depth->point_cloud_data.point_data wird nicht angefasst.
+// Rückgabe: Anzahl gelesener Bytes, -1 bei ungültigem Paket oder zu kleiner Wolke
+int packet_parse_full_depth_soa(const uint8_t *data, int dataLen, HPS3D_DepthData_t *depth,
+                                pointcloud_soa_t *cloud);
+
+#endif // PACKET_PARSER_H
@@ -0,0 +1,161 @@
+/*
+ * Offset-/Gain-Korrektur je Pixel aus einer Kalibrierdatei
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "pixel_correction.h"
+#include "region.h"
+
+void pixel_correction_identity(pixel_correction_t *table) {
+    memset(table, 0, sizeof(*table));
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        table->gain[i] = PIXEL_CORRECTION_GAIN_ONE;
+    }
+    memcpy(table->info.magic, PIXEL_CORRECTION_FILE_MAGIC, sizeof(table->info.magic));
+    table->info.version = PIXEL_CORRECTION_FILE_VERSION;
+    table->info.width = SENSOR_WIDTH;
+    table->info.height = SENSOR_HEIGHT;
+    table->info.gain_shift = PIXEL_CORRECTION_GAIN_SHIFT;
+}
+
+// Ein zusammenhängender Abschnitt; feste Formel, keine Verzweigung
+static void apply_span(const int16_t *KERNEL_RESTRICT offset, const uint16_t *KERNEL_RESTRICT gain,
+                       uint16_t *KERNEL_RESTRICT distance, int n) {
+    KERNEL_UNROLL(4)
+    for (int i = 0; i < n; i++) {
+        uint16_t d = distance[i];
+        int32_t c = (int32_t)(((uint32_t)d * gain[i] + (PIXEL_CORRECTION_GAIN_ONE / 2)) >> PIXEL_CORRECTION_GAIN_SHIFT)
+                    + offset[i];
+        c = c < 1 ? 1 : c;
+        c = c > REGION_INVALID_MIN - 1 ? REGION_INVALID_MIN - 1 : c;
+        distance[i] = region_pixel_valid(d) ? (uint16_t)c : d;
+    }
+}
+
+void pixel_correction_apply(const pixel_correction_t *table, uint16_t *distance) {
+    apply_span(table->offset, table->gain, distance, SENSOR_PIXELS);
+}
+
+void pixel_correction_apply_roi(const pixel_correction_t *table, HPS3D_FullRoiData_t *roi) {
+    int w = roi->right_bottom_x - roi->left_top_x + 1;
+    int h = roi->right_bottom_y - roi->left_top_y + 1;
+    if (!roi->distance || w <= 0 || h <= 0 || (uint32_t)(w * h) > roi->pixel_number ||
+        roi->right_bottom_x >= SENSOR_WIDTH || roi->right_bottom_y >= SENSOR_HEIGHT) {
+        return;
+    }
+    // Zeilenweise: jede ROI-Zeile ist ein Abschnitt einer Sensorzeile
+    for (int y = 0; y < h; y++) {
+        int base = (roi->left_top_y + y) * SENSOR_WIDTH + roi->left_top_x;
+        apply_span(table->offset + base, table->gain + base, roi->distance + y * w, w);
+    }
+}
+
+void pixel_calib_reset(pixel_calib_accum_t *acc) {
+    memset(acc, 0, sizeof(*acc));
+}
+
+void pixel_calib_add(pixel_calib_accum_t *acc, const uint16_t *KERNEL_RESTRICT distance) {
+    uint32_t *KERNEL_RESTRICT sum = acc->sum;
+    uint16_t *KERNEL_RESTRICT count = acc->count;
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        uint16_t d = distance[i];
+        int valid = region_pixel_valid(d);
+        sum[i] += valid ? d : 0;
+        count[i] += (uint16_t)valid;
+    }
+    acc->frames++;
+}
+
+// Mittelwert eines Pixels, 0 wenn zu selten gültig
+static float pixel_mean(const pixel_calib_accum_t *acc, int i) {
+    uint32_t needed = (acc->frames * PIXEL_CALIB_MIN_VALID_PERCENT + 99) / 100;
+    if (acc->count[i] == 0 || acc->count[i] < needed) {
+        return 0.0f;
+    }
+    return (float)acc->sum[i] / (float)acc->count[i];
+}
+
+int pixel_correction_from_flat(pixel_correction_t *table, const pixel_calib_accum_t *a, uint32_t ref_a_mm,
+                               const pixel_calib_accum_t *b, uint32_t ref_b_mm) {
+    if (!a || a->frames == 0 || ref_a_mm == 0 || ref_a_mm >= REGION_INVALID_MIN ||
+        (b && (b->frames == 0 || ref_b_mm == 0 || ref_b_mm == ref_a_mm || ref_b_mm >= REGION_INVALID_MIN))) {
+        return -1;
+    }
+    pixel_correction_identity(table);
+
+    int uncalibrated = 0;
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        float mean_a = pixel_mean(a, i);
+        float mean_b = b ? pixel_mean(b, i) : 0.0f;
+        float gain = 1.0f;
+        if (mean_a <= 0.0f || (b && (mean_b <= 0.0f || mean_b == mean_a))) {
+            uncalibrated++;
+            continue;
+        }
+        if (b) {
+            gain = ((float)ref_b_mm - (float)ref_a_mm) / (mean_b - mean_a);
+        }
+        float offset = (float)ref_a_mm - gain * mean_a;
+        if (gain < PIXEL_CORRECTION_GAIN_MIN || gain > PIXEL_CORRECTION_GAIN_MAX ||
+            offset < -PIXEL_CORRECTION_MAX_OFFSET || offset > PIXEL_CORRECTION_MAX_OFFSET) {
+            uncalibrated++;
+            continue;
+        }
+        table->gain[i] = (uint16_t)(gain * PIXEL_CORRECTION_GAIN_ONE + 0.5f);
+        table->offset[i] = (int16_t)(offset < 0.0f ? offset - 0.5f : offset + 0.5f);
+    }
+
+    table->info.reference_mm[0] = ref_a_mm;
+    table->info.reference_mm[1] = b ? ref_b_mm : 0;
+    table->info.frames = a->frames;
+    table->info.uncalibrated = (uint32_t)uncalibrated;
+    table->info.created = (int64_t)time(NULL);
+    return uncalibrated;
+}
+
+int pixel_correction_save(const pixel_correction_t *table, const char *path) {
+    char tmp[512];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) {
+        return -1;
+    }
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp) {
+        return -1;
+    }
+    int ok = fwrite(&table->info, sizeof(table->info), 1, fp) == 1 &&
+             fwrite(table->offset, sizeof(table->offset), 1, fp) == 1 &&
+             fwrite(table->gain, sizeof(table->gain), 1, fp) == 1;
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+int pixel_correction_load(pixel_correction_t *table, const char *path) {
+    static pixel_correction_t loaded;
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return -1;
+    }
+    pixel_correction_file_t *info = &loaded.info;
+    int ok = fread(info, sizeof(*info), 1, fp) == 1 &&
+             memcmp(info->magic, PIXEL_CORRECTION_FILE_MAGIC, sizeof(info->magic)) == 0 &&
+             info->version == PIXEL_CORRECTION_FILE_VERSION &&
+             info->width == SENSOR_WIDTH && info->height == SENSOR_HEIGHT &&
+             info->gain_shift == PIXEL_CORRECTION_GAIN_SHIFT &&
+             fread(loaded.offset, sizeof(loaded.offset), 1, fp) == 1 &&
+             fread(loaded.gain, sizeof(loaded.gain), 1, fp) == 1;
+    fclose(fp);
+    if (!ok) {
+        return -1;
+    }
+    memcpy(table, &loaded, sizeof(loaded));
+    return 0;
+}
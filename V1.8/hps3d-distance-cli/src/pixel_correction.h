@@ -0,0 +1,85 @@
+#ifndef PIXEL_CORRECTION_H
+#define PIXEL_CORRECTION_H
+
+#include <stdint.h>
+#include "HPS3DUser_IF.h"
+#include "sensor_geometry.h"
+
+/*
+ * Korrektur des festen Musters je Pixel, das HPS3D_SetDistanceOffset mit
+ * einem einzigen globalen Offset nicht erfasst:
+ *
+ *   korrigiert = gain[i] * d + offset[i]
+ *
+ * gain ist Festkomma (PIXEL_CORRECTION_GAIN_ONE = 1.0), offset in mm. Die
+ * Anwendung ist ein einziger branchfreier Durchlauf über die Distanzebene
+ * direkt nach dem Dekodieren; Sentinel-Werte bleiben unverändert, korrigierte
+ * Werte werden auf den gültigen Bereich begrenzt.
+ *
+ * Die Tabelle entsteht vor einem ebenen Ziel senkrecht zur Sensorachse:
+ * Mittelwerte je Pixel über viele Frames bei einer bekannten Entfernung
+ * ergeben reine Offsets, Mittelwerte bei zwei Entfernungen Gain und Offset.
+ * Pixel ohne genügend gültige Frames oder mit unplausiblem Gain erhalten die
+ * Identität.
+ *
+ * Dateiformat (native Byte-Reihenfolge): pixel_correction_file_t, dann
+ * int16 offset[SENSOR_PIXELS], dann uint16 gain[SENSOR_PIXELS].
+ */
+
+#define PIXEL_CORRECTION_GAIN_SHIFT 14
+#define PIXEL_CORRECTION_GAIN_ONE (1 << PIXEL_CORRECTION_GAIN_SHIFT)
+#define PIXEL_CORRECTION_GAIN_MIN 0.5f         // Außerhalb: Pixel bleibt unkorrigiert
+#define PIXEL_CORRECTION_GAIN_MAX 2.0f
+#define PIXEL_CORRECTION_MAX_OFFSET 2000       // mm
+#define PIXEL_CORRECTION_FILE_MAGIC "HPS3DCOR"
+#define PIXEL_CORRECTION_FILE_VERSION 1
+#define PIXEL_CALIB_DEFAULT_FRAMES 200
+#define PIXEL_CALIB_MIN_VALID_PERCENT 80       // Gültige Frames je Pixel für eine Korrektur
+
+typedef struct {
+    char magic[8];                      // PIXEL_CORRECTION_FILE_MAGIC
+    uint16_t version;
+    uint16_t width;
+    uint16_t height;
+    uint16_t gain_shift;                // PIXEL_CORRECTION_GAIN_SHIFT
+    uint32_t reference_mm[2];           // Zielentfernungen der Kalibrierung (zweite 0 = nur Offset)
+    uint32_t frames;                    // Frames je Entfernung
+    uint32_t uncalibrated;              // Pixel mit Identität
+    int64_t created;                    // time() der Kalibrierung
+} pixel_correction_file_t;
+
+typedef struct {
+    int16_t offset[SENSOR_PIXELS];
+    uint16_t gain[SENSOR_PIXELS];
+    pixel_correction_file_t info;
+} pixel_correction_t;
+
+// Mittelwerte je Pixel vor einem ebenen Ziel
+typedef struct {
+    uint32_t sum[SENSOR_PIXELS];
+    uint16_t count[SENSOR_PIXELS];
+    uint32_t frames;
+} pixel_calib_accum_t;
+
+// Identität (gain 1, offset 0)
+void pixel_correction_identity(pixel_correction_t *table);
+
+// Korrektur auf die Distanzebene anwenden (in place)
+void pixel_correction_apply(const pixel_correction_t *table, uint16_t *distance);
+
+// Dasselbe für ein Geräte-ROI (Distanzwerte in ROI-Koordinaten)
+void pixel_correction_apply_roi(const pixel_correction_t *table, HPS3D_FullRoiData_t *roi);
+
+void pixel_calib_reset(pixel_calib_accum_t *acc);
+void pixel_calib_add(pixel_calib_accum_t *acc, const uint16_t *distance);
+
+// Tabelle aus einer (b == NULL: nur Offset) oder zwei Messreihen berechnen.
+// Rückgabe: Anzahl Pixel ohne Korrektur, -1 bei ungültigen Argumenten
+int pixel_correction_from_flat(pixel_correction_t *table, const pixel_calib_accum_t *a, uint32_t ref_a_mm,
+                               const pixel_calib_accum_t *b, uint32_t ref_b_mm);
+
+// Rückgabe 0 / -1 (Datei fehlt, falsches Format oder falsche Auflösung)
+int pixel_correction_save(const pixel_correction_t *table, const char *path);
+int pixel_correction_load(pixel_correction_t *table, const char *path);
+
+#endif // PIXEL_CORRECTION_H
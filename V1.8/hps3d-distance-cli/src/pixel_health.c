@@ -0,0 +1,237 @@
+/*
+ * Erkennung und Maskierung toter oder eingefrorener Pixel
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include "pixel_health.h"
+#include "region.h"
+#include "roi_stats.h"
+
+typedef struct {
+    char magic[8];                      // PIXEL_HEALTH_FILE_MAGIC
+    uint16_t version;
+    uint16_t width;
+    uint16_t height;
+    uint16_t reserved;
+} pixel_health_file_t;
+
+void pixel_health_init(pixel_health_t *ph) {
+    memset(ph, 0, sizeof(*ph));
+    ph->every = PIXEL_HEALTH_DEFAULT_EVERY;
+    ph->window = PIXEL_HEALTH_DEFAULT_WINDOW;
+    ph->dead_permille = PIXEL_HEALTH_DEFAULT_DEAD_PERMILLE;
+    ph->stuck_msd = PIXEL_HEALTH_DEFAULT_STUCK_MSD;
+    ph->mark_windows = PIXEL_HEALTH_DEFAULT_MARK_WINDOWS;
+    ph->scene_limit_permille = PIXEL_HEALTH_DEFAULT_SCENE_LIMIT;
+}
+
+void pixel_health_restart(pixel_health_t *ph) {
+    ph->frames = 0;
+    ph->samples = 0;
+    memset(ph->prev, 0, sizeof(ph->prev));
+    memset(ph->invalid, 0, sizeof(ph->invalid));
+    memset(ph->pairs, 0, sizeof(ph->pairs));
+    memset(ph->diff_sq, 0, sizeof(ph->diff_sq));
+}
+
+// Stichprobe in die Zähler je Pixel; feste Länge, keine Verzweigung
+static void accumulate(pixel_health_t *ph, const uint16_t *KERNEL_RESTRICT distance) {
+    uint16_t *KERNEL_RESTRICT prev = ph->prev;
+    uint16_t *KERNEL_RESTRICT invalid = ph->invalid;
+    uint16_t *KERNEL_RESTRICT pairs = ph->pairs;
+    uint32_t *KERNEL_RESTRICT diff_sq = ph->diff_sq;
+
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        uint16_t d = distance[i];
+        uint16_t p = prev[i];
+        uint16_t valid = (uint16_t)region_pixel_valid(d);
+        uint16_t both = (uint16_t)(valid & region_pixel_valid(p));
+        int32_t diff = (int32_t)d - (int32_t)p;
+        uint32_t mag = (uint32_t)(diff < 0 ? -diff : diff);
+        mag = mag > PIXEL_HEALTH_DIFF_CLAMP ? PIXEL_HEALTH_DIFF_CLAMP : mag;
+        invalid[i] += (uint16_t)(1 - valid);
+        pairs[i] += both;
+        diff_sq[i] += both ? mag * mag : 0;
+        prev[i] = d;
+    }
+}
+
+static void rebuild_bad_list(pixel_health_t *ph) {
+    uint32_t n = 0, dead = 0, stuck = 0;
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        if (ph->mask[i]) {
+            ph->bad[n++] = (uint16_t)i;
+            dead += (ph->mask[i] & PIXEL_DEAD) != 0;
+            stuck += (ph->mask[i] & PIXEL_STUCK) != 0;
+        }
+    }
+    ph->bad_count = n;
+    ph->dead = dead;
+    ph->stuck = stuck;
+}
+
+// Fenster bewerten und Maske nachführen; Rückgabe 1 bei geänderter Maske
+static int evaluate_window(pixel_health_t *ph) {
+    static uint8_t verdict[SENSOR_PIXELS];
+    uint32_t samples = ph->samples;
+    uint32_t min_pairs = samples / 2;
+    uint32_t suspects = 0;
+
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        uint8_t v = 0;
+        if ((uint32_t)ph->invalid[i] * 1000 >= ph->dead_permille * samples) {
+            v |= PIXEL_DEAD;
+        }
+        if (ph->pairs[i] >= min_pairs && ph->pairs[i] > 0 &&
+            ph->diff_sq[i] <= ph->stuck_msd * ph->pairs[i]) {
+            v |= PIXEL_STUCK;
+        }
+        verdict[i] = v;
+        suspects += v != 0;
+    }
+
+    ph->windows++;
+    if ((uint64_t)suspects * 1000 > (uint64_t)ph->scene_limit_permille * SENSOR_PIXELS) {
+        ph->scene_windows++;
+        return 0;
+    }
+
+    int changed = 0;
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        uint8_t before = ph->mask[i];
+        if (verdict[i]) {
+            if (ph->strikes[i] < ph->mark_windows) {
+                ph->strikes[i]++;
+            }
+            if (ph->strikes[i] >= ph->mark_windows) {
+                ph->mask[i] = verdict[i];
+            }
+        } else if (ph->strikes[i] > 0 && --ph->strikes[i] == 0) {
+            ph->mask[i] = 0;
+        }
+        changed |= ph->mask[i] != before;
+    }
+    if (changed) {
+        rebuild_bad_list(ph);
+    }
+    return changed;
+}
+
+int pixel_health_update(pixel_health_t *ph, const uint16_t *distance) {
+    if (++ph->frames < ph->every) {
+        return 0;
+    }
+    ph->frames = 0;
+    accumulate(ph, distance);
+    if (++ph->samples < ph->window) {
+        return 0;
+    }
+
+    int changed = evaluate_window(ph);
+    // Letzter Wert bleibt als Bezug für die erste Differenz des nächsten Fensters
+    ph->samples = 0;
+    memset(ph->invalid, 0, sizeof(ph->invalid));
+    memset(ph->pairs, 0, sizeof(ph->pairs));
+    memset(ph->diff_sq, 0, sizeof(ph->diff_sq));
+    return changed;
+}
+
+void pixel_health_apply(const pixel_health_t *ph, uint16_t *distance, HPS3D_PerPointCloudData_t *points) {
+    for (uint32_t n = 0; n < ph->bad_count; n++) {
+        uint16_t i = ph->bad[n];
+        distance[i] = HPS3D_INVALID_DATA;
+        if (points) {
+            points[i].x = 0.0f;
+            points[i].y = 0.0f;
+            points[i].z = 0.0f;
+        }
+    }
+}
+
+void pixel_health_apply_roi(const pixel_health_t *ph, HPS3D_FullRoiData_t *roi) {
+    int w = roi->right_bottom_x - roi->left_top_x + 1;
+    int h = roi->right_bottom_y - roi->left_top_y + 1;
+    if (!roi->distance || w <= 0 || h <= 0 || (uint32_t)(w * h) > roi->pixel_number) {
+        return;
+    }
+    for (uint32_t n = 0; n < ph->bad_count; n++) {
+        int x = ph->bad[n] % SENSOR_WIDTH;
+        int y = ph->bad[n] / SENSOR_WIDTH;
+        if (roi_contains(roi, x, y)) {
+            roi->distance[(y - roi->left_top_y) * w + (x - roi->left_top_x)] = HPS3D_INVALID_DATA;
+        }
+    }
+}
+
+int pixel_health_save(const pixel_health_t *ph, const char *path) {
+    char tmp[512];
+    if (snprintf(tmp, sizeof(tmp), "%s.tmp", path) >= (int)sizeof(tmp)) {
+        return -1;
+    }
+    FILE *fp = fopen(tmp, "wb");
+    if (!fp) {
+        return -1;
+    }
+    pixel_health_file_t header = {
+        .version = PIXEL_HEALTH_FILE_VERSION,
+        .width = SENSOR_WIDTH,
+        .height = SENSOR_HEIGHT,
+    };
+    memcpy(header.magic, PIXEL_HEALTH_FILE_MAGIC, sizeof(header.magic));
+    int ok = fwrite(&header, sizeof(header), 1, fp) == 1 &&
+             fwrite(ph->mask, sizeof(ph->mask), 1, fp) == 1 &&
+             fwrite(ph->strikes, sizeof(ph->strikes), 1, fp) == 1;
+    ok = fclose(fp) == 0 && ok;
+    // Erst die vollständige Datei ersetzt die alte
+    if (!ok || rename(tmp, path) != 0) {
+        unlink(tmp);
+        return -1;
+    }
+    return 0;
+}
+
+int pixel_health_load(pixel_health_t *ph, const char *path) {
+    static uint8_t mask[SENSOR_PIXELS], strikes[SENSOR_PIXELS];
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return -1;
+    }
+    pixel_health_file_t header;
+    int ok = fread(&header, sizeof(header), 1, fp) == 1 &&
+             memcmp(header.magic, PIXEL_HEALTH_FILE_MAGIC, sizeof(header.magic)) == 0 &&
+             header.version == PIXEL_HEALTH_FILE_VERSION &&
+             header.width == SENSOR_WIDTH && header.height == SENSOR_HEIGHT &&
+             fread(mask, sizeof(mask), 1, fp) == 1 &&
+             fread(strikes, sizeof(strikes), 1, fp) == 1;
+    fclose(fp);
+    if (!ok) {
+        return -1;
+    }
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        ph->mask[i] = mask[i] & (PIXEL_DEAD | PIXEL_STUCK);
+        ph->strikes[i] = strikes[i] > ph->mark_windows ? (uint8_t)ph->mark_windows : strikes[i];
+    }
+    rebuild_bad_list(ph);
+    return 0;
+}
+
+int pixel_health_report_json(const pixel_health_t *ph, char *out, size_t size) {
+    int pos = snprintf(out, size,
+        "{\"every\": %u, \"window\": %u, \"windows\": %u, \"scene_windows\": %u, "
+        "\"masked\": %u, \"dead\": %u, \"stuck\": %u, \"pixels\": [",
+        ph->every, ph->window, ph->windows, ph->scene_windows, ph->bad_count, ph->dead, ph->stuck);
+    for (uint32_t n = 0; n < ph->bad_count && pos > 0 && (size_t)pos < size; n++) {
+        uint16_t i = ph->bad[n];
+        pos += snprintf(out + pos, size - (size_t)pos, "%s[%d, %d, \"%s\"]", n ? ", " : "",
+                        i % SENSOR_WIDTH, i / SENSOR_WIDTH,
+                        (ph->mask[i] & PIXEL_DEAD) ? "dead" : "stuck");
+    }
+    if (pos > 0 && (size_t)pos < size) {
+        pos += snprintf(out + pos, size - (size_t)pos, "]}");
+    }
+    return (pos > 0 && (size_t)pos < size) ? pos : -1;
+}
@@ -0,0 +1,105 @@
+#ifndef PIXEL_HEALTH_H
+#define PIXEL_HEALTH_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "HPS3DUser_IF.h"
+#include "sensor_geometry.h"
+
+/*
+ * Langzeitüberwachung einzelner Pixel. Jeder every-te Full-Depth-Frame geht
+ * als Stichprobe in Zähler je Pixel ein (branchfreie Schleife mit fester
+ * Länge, vom Compiler vektorisiert):
+ *   invalid  - Stichproben mit Sentinel-Wert (HPS3D_LOW_AMPLITUDE usw.)
+ *   pairs    - aufeinanderfolgende gültige Stichproben
+ *   diff_sq  - Summe der quadrierten Folgedifferenzen (auf 255 mm begrenzt)
+ * Die mittlere quadrierte Folgedifferenz ist ein Maß für das zeitliche
+ * Rauschen, das langsame Szenenänderungen kaum sieht.
+ *
+ * Nach window Stichproben wird bewertet:
+ *   tot         - Anteil ungültiger Stichproben >= dead_permille
+ *   eingefroren - mindestens halb so viele Paare wie Stichproben und
+ *                 diff_sq <= stuck_msd * pairs (0 = exakt konstant)
+ * Ist mehr als scene_limit_permille des Bildes auffällig (Himmel, verdeckte
+ * Optik, wiederholte Frames), gilt das Fenster als Szene und zählt nicht.
+ *
+ * Die Maske ist träge: ein Pixel wird erst nach mark_windows auffälligen
+ * Fenstern maskiert und erst wieder frei, wenn ebenso viele unauffällige
+ * gefolgt sind. Maskierte Pixel werden weiter beobachtet.
+ *
+ * apply() setzt maskierte Pixel in der Distanzebene auf HPS3D_INVALID_DATA und
+ * in der Punktwolke auf z = 0; alle nachfolgenden Stufen behandeln sie damit
+ * wie jeden anderen ungültigen Pixel. Kosten: O(maskierte Pixel).
+ *
+ * Nicht thread-sicher; der Aufrufer serialisiert (im Service: data_mutex).
+ */
+
+#define PIXEL_HEALTH_DEFAULT_EVERY 10
+#define PIXEL_HEALTH_DEFAULT_WINDOW 64
+#define PIXEL_HEALTH_DEFAULT_DEAD_PERMILLE 950
+#define PIXEL_HEALTH_DEFAULT_STUCK_MSD 0
+#define PIXEL_HEALTH_DEFAULT_MARK_WINDOWS 3
+#define PIXEL_HEALTH_DEFAULT_SCENE_LIMIT 100   // Promille des Bildes
+#define PIXEL_HEALTH_MAX_WINDOW 4096           // invalid/pairs sind 16 Bit
+#define PIXEL_HEALTH_DIFF_CLAMP 255
+#define PIXEL_HEALTH_FILE_MAGIC "HPS3DPXM"
+#define PIXEL_HEALTH_FILE_VERSION 1
+
+#define PIXEL_DEAD  0x1
+#define PIXEL_STUCK 0x2
+
+typedef struct {
+    // Konfiguration (vor dem ersten update() setzen)
+    uint32_t every;                     // Jeder every-te Frame ist eine Stichprobe
+    uint32_t window;                    // Stichproben je Bewertung
+    uint32_t dead_permille;
+    uint32_t stuck_msd;                 // mm² pro Folgedifferenz
+    uint32_t mark_windows;
+    uint32_t scene_limit_permille;
+
+    // Laufendes Fenster
+    uint32_t frames;                    // Frames seit der letzten Stichprobe
+    uint32_t samples;
+    uint16_t prev[SENSOR_PIXELS];
+    uint16_t invalid[SENSOR_PIXELS];
+    uint16_t pairs[SENSOR_PIXELS];
+    uint32_t diff_sq[SENSOR_PIXELS];
+
+    // Maske
+    uint8_t strikes[SENSOR_PIXELS];     // Auffällige Fenster in Folge (mit Abbau)
+    uint8_t mask[SENSOR_PIXELS];        // PIXEL_DEAD | PIXEL_STUCK, 0 = gut
+    uint16_t bad[SENSOR_PIXELS];        // Indizes maskierter Pixel
+    uint32_t bad_count;
+
+    // Statistik
+    uint32_t windows;                   // Bewertete Fenster
+    uint32_t scene_windows;             // Als Szene verworfene Fenster
+    uint32_t dead;                      // Maskiert als tot
+    uint32_t stuck;                     // Maskiert als eingefroren
+} pixel_health_t;
+
+// Standardkonfiguration, leere Maske
+void pixel_health_init(pixel_health_t *ph);
+
+// Zähler zurücksetzen (z.B. nach Konfigurationsänderung); Maske bleibt
+void pixel_health_restart(pixel_health_t *ph);
+
+// Frame einrechnen (Rohwerte vor apply). Rückgabe: 1 wenn sich die Maske
+// geändert hat, sonst 0
+int pixel_health_update(pixel_health_t *ph, const uint16_t *distance);
+
+// Maske auf Distanzebene und Punktwolke (points darf NULL sein) anwenden
+void pixel_health_apply(const pixel_health_t *ph, uint16_t *distance, HPS3D_PerPointCloudData_t *points);
+
+// Maske auf eine Geräte-ROI anwenden (Distanzen in ROI-Koordinaten)
+void pixel_health_apply_roi(const pixel_health_t *ph, HPS3D_FullRoiData_t *roi);
+
+// Maske und Fensterzähler der Trägheit sichern bzw. laden; Rückgabe 0 / -1
+int pixel_health_save(const pixel_health_t *ph, const char *path);
+int pixel_health_load(pixel_health_t *ph, const char *path);
+
+// Bericht als JSON: Zähler und die maskierten Pixel als [x, y, "dead"|"stuck"].
+// Rückgabe: geschriebene Zeichen, -1 wenn out zu klein ist
+int pixel_health_report_json(const pixel_health_t *ph, char *out, size_t size);
+
+#endif // PIXEL_HEALTH_H
@@ -0,0 +1,67 @@
+/*
+ * Structure-of-Arrays Punktwolke und Konvertierung vom SDK-Layout
+ */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <stdlib.h>
+#include <string.h>
+#include "pointcloud.h"
+
+// Arrays auf ganze Cache-Lines auffüllen, damit y[] und z[] ausgerichtet bleiben
+static uint32_t padded_capacity(uint32_t capacity) {
+    const uint32_t per_line = POINTCLOUD_ALIGN / sizeof(float);
+    return (capacity + per_line - 1) / per_line * per_line;
+}
+
+int pointcloud_soa_init(pointcloud_soa_t *cloud, uint32_t capacity) {
+    if (!cloud || capacity == 0) {
+        return -1;
+    }
+
+    memset(cloud, 0, sizeof(*cloud));
+    uint32_t stride = padded_capacity(capacity);
+    void *block = NULL;
+    if (posix_memalign(&block, POINTCLOUD_ALIGN, (size_t)stride * 3 * sizeof(float)) != 0) {
+        return -1;
+    }
+    memset(block, 0, (size_t)stride * 3 * sizeof(float));
+
+    cloud->x = (float *)block;
+    cloud->y = cloud->x + stride;
+    cloud->z = cloud->y + stride;
+    cloud->capacity = capacity;
+    return 0;
+}
+
+void pointcloud_soa_free(pointcloud_soa_t *cloud) {
+    if (!cloud) {
+        return;
+    }
+    free(cloud->x);  // x zeigt auf den Anfang des gemeinsamen Blocks
+    memset(cloud, 0, sizeof(*cloud));
+}
+
+int pointcloud_aos_to_soa(const HPS3D_PerPointCloudData_t *in, uint32_t count, pointcloud_soa_t *out) {
+    if (!in || !out || count > out->capacity) {
+        return -1;
+    }
+
+    float *x = out->x, *y = out->y, *z = out->z;
+    for (uint32_t i = 0; i < count; i++) {
+        x[i] = in[i].x;
+        y[i] = in[i].y;
+        z[i] = in[i].z;
+    }
+    out->count = count;
+    return 0;
+}
+
+void pointcloud_soa_to_aos(const pointcloud_soa_t *in, HPS3D_PerPointCloudData_t *out) {
+    const float *x = in->x, *y = in->y, *z = in->z;
+    for (uint32_t i = 0; i < in->count; i++) {
+        out[i].x = x[i];
+        out[i].y = y[i];
+        out[i].z = z[i];
+    }
+}
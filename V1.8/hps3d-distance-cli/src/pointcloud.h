@@ -0,0 +1,35 @@
+#ifndef POINTCLOUD_H
+#define POINTCLOUD_H
+
+#include <stdint.h>
+#include "HPS3DUser_IF.h"
+
+// Punktwolke als Structure-of-Arrays: x[], y[], z[] liegen jeweils
+// zusammenhängend und 64-Byte-ausgerichtet im Speicher, damit
+// Transformationen, Filter und Ebenen-Fits über ganze Vektoren laufen.
+// Ungültige Pixel haben z <= 0 (wie in HPS3D_PerPointCloudData_t).
+typedef struct {
+    float *x;
+    float *y;
+    float *z;
+    uint32_t count;      // Anzahl belegter Punkte
+    uint32_t capacity;   // Allokierte Punkte pro Array
+    uint16_t width;      // Organisierte Wolke: Punkte pro Zeile (0 = unorganisiert)
+    uint16_t height;     // Organisierte Wolke: Zeilen
+} pointcloud_soa_t;
+
+#define POINTCLOUD_ALIGN 64
+
+static inline int pointcloud_point_valid(float z) {
+    return z > 0.0f;
+}
+
+// Ein Speicherblock für alle drei Arrays; Rückgabe 0 bei Erfolg, -1 bei Fehler
+int pointcloud_soa_init(pointcloud_soa_t *cloud, uint32_t capacity);
+void pointcloud_soa_free(pointcloud_soa_t *cloud);
+
+// Konvertierung zwischen SDK-Layout (AoS) und SoA; -1 wenn die Kapazität nicht reicht
+int pointcloud_aos_to_soa(const HPS3D_PerPointCloudData_t *in, uint32_t count, pointcloud_soa_t *out);
+void pointcloud_soa_to_aos(const pointcloud_soa_t *in, HPS3D_PerPointCloudData_t *out);
+
+#endif // POINTCLOUD_H
@@ -0,0 +1,124 @@
+/*
+ * Punktwolke im PointCloud2-Layout für MQTT und Shared Memory
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <fcntl.h>
+#include <math.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "pointcloud2.h"
+#include "region.h"
+
+// Punkte direkt hinter dem Kopf, 16-Byte-ausgerichtet wie in der Nachricht
+_Static_assert(sizeof(pc2_header_t) % 16 == 0, "pc2_header_t muss 16-Byte-Vielfaches sein");
+_Static_assert(sizeof(pc2_point_t) == PC2_POINT_STEP, "pc2_point_t passt nicht zu PC2_POINT_STEP");
+_Static_assert(offsetof(pc2_frame_t, points) == sizeof(pc2_header_t), "Punkte nicht direkt hinter dem Kopf");
+_Static_assert(offsetof(pc2_shm_t, frame) == 64, "Frame nicht auf eigener Cache-Line");
+
+const pc2_field_t PC2_FIELDS[PC2_FIELD_COUNT] = {
+    {.name = "x", .offset = offsetof(pc2_point_t, x), .datatype = PC2_FLOAT32, .count = 1},
+    {.name = "y", .offset = offsetof(pc2_point_t, y), .datatype = PC2_FLOAT32, .count = 1},
+    {.name = "z", .offset = offsetof(pc2_point_t, z), .datatype = PC2_FLOAT32, .count = 1},
+    {.name = "distance", .offset = offsetof(pc2_point_t, distance), .datatype = PC2_UINT16, .count = 1},
+};
+
+void pointcloud2_init(pc2_frame_t *frame, const char *frame_id) {
+    pc2_header_t *h = &frame->header;
+    memset(h, 0, sizeof(*h));
+    memcpy(h->magic, PC2_MAGIC, sizeof(h->magic));
+    h->version = PC2_VERSION;
+    h->header_size = sizeof(pc2_header_t);
+    if (frame_id) {
+        strncpy(h->frame_id, frame_id, sizeof(h->frame_id) - 1);
+    }
+    h->height = SENSOR_HEIGHT;
+    h->width = SENSOR_WIDTH;
+    h->point_step = PC2_POINT_STEP;
+    h->row_step = SENSOR_WIDTH * PC2_POINT_STEP;
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    h->is_bigendian = 1;
+#endif
+    h->is_dense = 0;                    // Ungültige Pixel bleiben als NaN in der Wolke
+    h->field_count = PC2_FIELD_COUNT;
+    h->data_size = PC2_DATA_SIZE;
+    memcpy(h->fields, PC2_FIELDS, sizeof(PC2_FIELDS));
+    memset(frame->points, 0, sizeof(frame->points));
+}
+
+void pointcloud2_fill(pc2_frame_t *frame, const pointcloud_soa_t *cloud, const uint16_t *distance,
+                      uint32_t seq, int64_t stamp_ns) {
+    pc2_point_t *KERNEL_RESTRICT out = frame->points;
+    const float *KERNEL_RESTRICT x = cloud->x;
+    const float *KERNEL_RESTRICT y = cloud->y;
+    const float *KERNEL_RESTRICT z = cloud->z;
+    const uint16_t *KERNEL_RESTRICT d = distance;
+    const float nan = NAN;
+
+    // Feste Länge, ohne Sprünge: drei lineare Ströme, mm -> m oder NaN je nach Distanz
+    KERNEL_UNROLL(4)
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        int valid = region_pixel_valid(d[i]);
+        out[i].x = valid ? x[i] * 0.001f : nan;
+        out[i].y = valid ? y[i] * 0.001f : nan;
+        out[i].z = valid ? z[i] * 0.001f : nan;
+        out[i].distance = d[i];
+        out[i].pad = 0;
+    }
+    frame->header.seq = seq;
+    frame->header.stamp_ns = stamp_ns;
+}
+
+pc2_shm_t *pointcloud2_shm_open(const char *path) {
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return NULL;
+    }
+    if (ftruncate(fd, (off_t)sizeof(pc2_shm_t)) != 0) {
+        close(fd);
+        return NULL;
+    }
+    void *map = mmap(NULL, sizeof(pc2_shm_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) {
+        return NULL;
+    }
+    pc2_shm_t *shm = map;
+    // Ein abgebrochener Schreiber hinterlässt eine ungerade Sequenz
+    uint32_t seq = atomic_load_explicit(&shm->seq, memory_order_relaxed);
+    atomic_store_explicit(&shm->seq, (seq + 1) & ~1u, memory_order_release);
+    shm->size = sizeof(pc2_frame_t);
+    return shm;
+}
+
+void pointcloud2_shm_close(pc2_shm_t *shm) {
+    if (shm) {
+        munmap(shm, sizeof(*shm));
+    }
+}
+
+void pointcloud2_shm_publish(pc2_shm_t *shm, const pc2_frame_t *frame) {
+    uint32_t seq = atomic_load_explicit(&shm->seq, memory_order_relaxed);
+    atomic_store_explicit(&shm->seq, seq + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&shm->frame, frame, sizeof(*frame));
+    atomic_store_explicit(&shm->seq, seq + 2, memory_order_release);
+}
+
+int64_t pointcloud2_shm_read(const pc2_shm_t *shm, pc2_frame_t *out, int retries) {
+    for (int i = 0; i < retries; i++) {
+        uint32_t before = atomic_load_explicit(&shm->seq, memory_order_acquire);
+        if (before & 1u) {
+            continue;
+        }
+        memcpy(out, &shm->frame, sizeof(*out));
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&shm->seq, memory_order_relaxed) == before) {
+            return before;
+        }
+    }
+    return -1;
+}
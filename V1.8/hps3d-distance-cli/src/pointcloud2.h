@@ -0,0 +1,110 @@
+#ifndef POINTCLOUD2_H
+#define POINTCLOUD2_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "pointcloud.h"
+#include "sensor_geometry.h"
+
+/*
+ * Punktwolke im Speicherlayout von sensor_msgs/PointCloud2
+ *
+ * Organisiert 160x60, je Punkt 16 Byte: float32 x/y/z in Metern (REP 103),
+ * uint16 Distanz in mm, 2 Byte Füllung. Ungültige Pixel haben x/y/z = NaN
+ * und behalten ihren Sentinel-Wert in distance (is_dense = 0).
+ *
+ * pc2_frame_t ist genau eine Nachricht: Kopf mit den PointCloud2-Feldern
+ * und Feldbeschreibungen, danach die Punkte. Als MQTT-Nutzlast und in der
+ * Shared-Memory-Datei liegt er unverändert (native Byte-Reihenfolge,
+ * is_bigendian im Kopf); die Bridge übernimmt die Kopfwerte und kopiert
+ * data_size Bytes ab header_size mit einem memcpy.
+ *
+ * Shared Memory: pc2_shm_t vor dem Frame trägt eine Sequenz (Seqlock,
+ * ungerade = Schreiben läuft). Ein Schreiber, beliebig viele Leser.
+ */
+
+#define PC2_MAGIC "HPS3DPC2"
+#define PC2_VERSION 1
+#define PC2_FIELD_COUNT 4
+#define PC2_POINT_STEP 16
+#define PC2_DATA_SIZE (SENSOR_PIXELS * PC2_POINT_STEP)
+
+// sensor_msgs/PointField Datentypen
+#define PC2_INT8    1
+#define PC2_UINT8   2
+#define PC2_INT16   3
+#define PC2_UINT16  4
+#define PC2_INT32   5
+#define PC2_UINT32  6
+#define PC2_FLOAT32 7
+#define PC2_FLOAT64 8
+
+typedef struct {
+    char name[12];                      // Nullterminiert
+    uint32_t offset;                    // Byte-Offset im Punkt
+    uint8_t datatype;                   // PC2_*
+    uint8_t reserved[3];
+    uint32_t count;
+} pc2_field_t;
+
+typedef struct {
+    char magic[8];                      // PC2_MAGIC
+    uint16_t version;
+    uint16_t header_size;               // sizeof(pc2_header_t), Beginn der Punkte
+    uint32_t seq;                       // Laufende Frame-Nummer
+    int64_t stamp_ns;                   // CLOCK_REALTIME der Aufnahme
+    char frame_id[32];
+    uint32_t height;
+    uint32_t width;
+    uint32_t point_step;
+    uint32_t row_step;
+    uint8_t is_bigendian;
+    uint8_t is_dense;
+    uint16_t field_count;
+    uint32_t data_size;                 // Bytes nach dem Kopf
+    pc2_field_t fields[PC2_FIELD_COUNT];
+} pc2_header_t;
+
+typedef struct {
+    float x;
+    float y;
+    float z;
+    uint16_t distance;
+    uint16_t pad;
+} pc2_point_t;
+
+typedef struct {
+    pc2_header_t header;
+    pc2_point_t points[SENSOR_PIXELS];
+} pc2_frame_t;
+
+typedef struct {
+    _Atomic uint32_t seq;               // Ungerade: Frame wird gerade geschrieben
+    uint32_t size;                      // sizeof(pc2_frame_t)
+    uint8_t reserved[56];               // Frame beginnt auf eigener Cache-Line
+    pc2_frame_t frame;
+} pc2_shm_t;
+
+extern const pc2_field_t PC2_FIELDS[PC2_FIELD_COUNT];
+
+// Kopf mit Maßen und Feldbeschreibungen füllen; frame_id darf NULL sein
+void pointcloud2_init(pc2_frame_t *frame, const char *frame_id);
+
+// Punkte aus der organisierten SoA-Wolke (mm, SENSOR_PIXELS Punkte) und der
+// Distanzebene; Pixel mit ungültiger Distanz werden NaN. Setzt seq und stamp_ns im Kopf
+void pointcloud2_fill(pc2_frame_t *frame, const pointcloud_soa_t *cloud, const uint16_t *distance,
+                      uint32_t seq, int64_t stamp_ns);
+
+// Datei anlegen bzw. öffnen (z.B. unter /dev/shm) und einblenden; Rückgabe Zeiger / NULL
+pc2_shm_t *pointcloud2_shm_open(const char *path);
+void pointcloud2_shm_close(pc2_shm_t *shm);
+
+// Frame unter dem Seqlock in die Datei kopieren (nur ein Schreiber)
+void pointcloud2_shm_publish(pc2_shm_t *shm, const pc2_frame_t *frame);
+
+// Konsistente Kopie lesen; Rückgabe Sequenz (gerade) oder -1, wenn nach
+// retries Versuchen kein unzerrissener Frame gelesen werden konnte
+int64_t pointcloud2_shm_read(const pc2_shm_t *shm, pc2_frame_t *out, int retries);
+
+#endif // POINTCLOUD2_H
@@ -0,0 +1,32 @@
+/*
+ * Regions-Statistik über die Distanzebene
+ *
+ * Die festen Kernel (DEFINE_REGION_KERNEL) werden dort instanziiert, wo die
+ * Bereichsgröße bekannt ist; hier liegt nur der generische Pfad.
+ */
+
+#include "region.h"
+
+void region_stats(const uint16_t *distance, int stride, int x0, int y0, int w, int h,
+                  region_stats_t *out) {
+    uint32_t sum = 0;
+    int count = 0;
+    uint16_t min = REGION_INVALID_MIN, max = 0;
+
+    for (int y = y0; y < y0 + h; y++) {
+        const uint16_t *row = distance + (long)y * stride + x0;
+        for (int x = 0; x < w; x++) {
+            uint16_t d = row[x];
+            int valid = region_pixel_valid(d);
+            sum += valid ? d : 0;
+            count += valid;
+            min = (valid && d < min) ? d : min;
+            max = (valid && d > max) ? d : max;
+        }
+    }
+
+    out->sum = sum;
+    out->count = count;
+    out->min = min;
+    out->max = max;
+}
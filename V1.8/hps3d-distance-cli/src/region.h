@@ -0,0 +1,59 @@
+#ifndef REGION_H
+#define REGION_H
+
+#include <stdint.h>
+#include "sensor_geometry.h"
+
+// Statistik über einen rechteckigen Bereich der Distanzebene
+typedef struct {
+    uint32_t sum;       // Summe gültiger Distanzen in mm
+    int count;          // Anzahl gültiger Pixel
+    uint16_t min;       // Minimum gültiger Pixel (65000 wenn keiner gültig)
+    uint16_t max;       // Maximum gültiger Pixel (0 wenn keiner gültig)
+} region_stats_t;
+
+#define REGION_INVALID_MIN 65000
+
+// Gültig sind 1..64999 - alle Sentinel-Werte (HPS3D_LOW_AMPLITUDE,
+// HPS3D_SATURATION, HPS3D_ADC_OVERFLOW, HPS3D_INVALID_DATA) liegen darüber.
+// Als eine vorzeichenlose Vergleichsoperation bleibt die Schleife branchfrei.
+static inline int region_pixel_valid(uint16_t d) {
+    return (uint16_t)(d - 1u) < (uint16_t)(REGION_INVALID_MIN - 1);
+}
+
+/*
+ * Erzeugt einen Regions-Kernel mit fester Zeilenbreite und fester
+ * Bereichsgröße AW x AH:
+ *   void region_stats_TAG(const uint16_t (*rows)[STRIDE], int x0, int y0, region_stats_t *out)
+ * x0/y0 ist die linke obere Ecke; der Aufrufer garantiert die Grenzen.
+ */
+#define DEFINE_REGION_KERNEL(TAG, STRIDE, AW, AH)                                   \
+static inline void region_stats_##TAG(const uint16_t (*rows)[(STRIDE)],             \
+                                      int x0, int y0, region_stats_t *out) {        \
+    uint32_t sum = 0;                                                               \
+    int count = 0;                                                                  \
+    uint16_t min = REGION_INVALID_MIN, max = 0;                                     \
+    KERNEL_UNROLL(AH)                                                               \
+    for (int dy = 0; dy < (AH); dy++) {                                             \
+        const uint16_t *row = &rows[y0 + dy][x0];                                   \
+        KERNEL_UNROLL(AW)                                                           \
+        for (int dx = 0; dx < (AW); dx++) {                                         \
+            uint16_t d = row[dx];                                                   \
+            int valid = region_pixel_valid(d);                                      \
+            sum += valid ? d : 0;                                                   \
+            count += valid;                                                         \
+            min = (valid && d < min) ? d : min;                                     \
+            max = (valid && d > max) ? d : max;                                     \
+        }                                                                           \
+    }                                                                               \
+    out->sum = sum;                                                                 \
+    out->count = count;                                                             \
+    out->min = min;                                                                 \
+    out->max = max;                                                                 \
+}
+
+// Generischer Pfad für beliebige Rechtecke und Zeilenbreiten
+void region_stats(const uint16_t *distance, int stride, int x0, int y0, int w, int h,
+                  region_stats_t *out);
+
+#endif // REGION_H
@@ -0,0 +1,58 @@
+/*
+ * Sparse-Table für Min/Max-Abfragen über Rechtecke der Distanzebene
+ */
+
+#include "region_minmax.h"
+
+// Elementweise Min/Max zweier Blöcke; restrict-Parameter, damit der Compiler
+// ohne Aliasing-Prüfung vektorisiert
+static void combine(uint16_t *KERNEL_RESTRICT dst_lo, uint16_t *KERNEL_RESTRICT dst_hi,
+                    const uint16_t *KERNEL_RESTRICT a_lo, const uint16_t *KERNEL_RESTRICT b_lo,
+                    const uint16_t *KERNEL_RESTRICT a_hi, const uint16_t *KERNEL_RESTRICT b_hi, int n) {
+    KERNEL_UNROLL(8)
+    for (int x = 0; x < n; x++) {
+        dst_lo[x] = a_lo[x] < b_lo[x] ? a_lo[x] : b_lo[x];
+        dst_hi[x] = a_hi[x] > b_hi[x] ? a_hi[x] : b_hi[x];
+    }
+}
+
+static void base_level(uint16_t *KERNEL_RESTRICT lo, uint16_t *KERNEL_RESTRICT hi,
+                       const uint16_t *KERNEL_RESTRICT d) {
+    KERNEL_UNROLL(8)
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        int valid = region_pixel_valid(d[i]);
+        lo[i] = valid ? d[i] : REGION_INVALID_MIN;
+        hi[i] = valid ? d[i] : 0;
+    }
+}
+
+void region_minmax_build(region_minmax_t *table, const uint16_t *distance) {
+    // Ebene [0][0]: Pixel mit neutralen Werten für ungültige Distanzen
+    base_level(&table->min[0][0][0][0], &table->max[0][0][0][0], distance);
+
+    // Zeilenrichtung: [0][kx] aus zwei Blöcken von [0][kx-1]. Spalten hinter
+    // SENSOR_WIDTH - 2^kx fragt niemand ab, sie bleiben unberechnet
+    for (int kx = 1; kx < REGION_MINMAX_LEVELS_X; kx++) {
+        int half = 1 << (kx - 1);
+        int n = SENSOR_WIDTH - (1 << kx) + 1;
+        for (int y = 0; y < SENSOR_HEIGHT; y++) {
+            const uint16_t *lo = table->min[0][kx - 1][y];
+            const uint16_t *hi = table->max[0][kx - 1][y];
+            combine(table->min[0][kx][y], table->max[0][kx][y], lo, lo + half, hi, hi + half, n);
+        }
+    }
+
+    // Spaltenrichtung: [ky][kx] aus [ky-1][kx], ganze Zeilen mit fester Länge
+    for (int ky = 1; ky < REGION_MINMAX_LEVELS_Y; ky++) {
+        int half = 1 << (ky - 1);
+        int rows = SENSOR_HEIGHT - (1 << ky) + 1;
+        for (int kx = 0; kx < REGION_MINMAX_LEVELS_X; kx++) {
+            const depth_row_t *lo = table->min[ky - 1][kx];
+            const depth_row_t *hi = table->max[ky - 1][kx];
+            for (int y = 0; y < rows; y++) {
+                combine(table->min[ky][kx][y], table->max[ky][kx][y], lo[y], lo[y + half], hi[y], hi[y + half],
+                        SENSOR_WIDTH);
+            }
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef REGION_MINMAX_H
+#define REGION_MINMAX_H
+
+#include <stdint.h>
+#include "region.h"
+#include "sensor_geometry.h"
+
+/*
+ * Minimum/Maximum beliebiger Rechtecke der Distanzebene in O(1)
+ *
+ * 2D-Sparse-Table: Ebene [ky][kx] enthält für jedes Pixel (x,y) Min und Max
+ * über das Rechteck 2^kx x 2^ky ab (x,y). Eine Abfrage w x h überdeckt das
+ * Rechteck mit vier sich überlappenden Blöcken der Ebene [log2 h][log2 w].
+ *
+ * Ungültige Pixel (region_pixel_valid) gehen als neutrale Werte ein
+ * (REGION_INVALID_MIN bzw. 0), die Ergebnisse entsprechen region_stats().
+ * Aufbau einmal je Frame, 48 Ebenen mit je einer vektorisierbaren Schleife;
+ * Speicher 2 x 48 x 9600 x 2 Byte = 1,8 MB.
+ */
+
+#define REGION_MINMAX_LEVELS_X 8        // 2^7 = 128 <= SENSOR_WIDTH
+#define REGION_MINMAX_LEVELS_Y 6        // 2^5 = 32 <= SENSOR_HEIGHT
+
+typedef struct {
+    depth_row_t min[REGION_MINMAX_LEVELS_Y][REGION_MINMAX_LEVELS_X][SENSOR_HEIGHT];
+    depth_row_t max[REGION_MINMAX_LEVELS_Y][REGION_MINMAX_LEVELS_X][SENSOR_HEIGHT];
+} region_minmax_t;
+
+// Tabelle aus der Distanzebene (SENSOR_WIDTH x SENSOR_HEIGHT) aufbauen
+void region_minmax_build(region_minmax_t *table, const uint16_t *distance);
+
+// Ganzzahliger log2 für 1 <= n <= SENSOR_WIDTH
+static inline int region_minmax_log2(int n) {
+#if defined(__GNUC__)
+    return 31 - __builtin_clz((unsigned)n);
+#else
+    int k = 0;
+    while ((2 << k) <= n) {
+        k++;
+    }
+    return k;
+#endif
+}
+
+/*
+ * Min/Max über das Rechteck w x h ab (x0,y0); der Aufrufer garantiert
+ * w, h >= 1 und die Grenzen. Ohne gültiges Pixel: min = REGION_INVALID_MIN,
+ * max = 0. Rückgabe: 1 wenn mindestens ein Pixel gültig ist, sonst 0
+ */
+static inline int region_minmax_query(const region_minmax_t *table, int x0, int y0, int w, int h,
+                                      uint16_t *min, uint16_t *max) {
+    int kx = region_minmax_log2(w);
+    int ky = region_minmax_log2(h);
+    int x1 = x0 + w - (1 << kx);
+    int y1 = y0 + h - (1 << ky);
+    const depth_row_t *lo = table->min[ky][kx];
+    const depth_row_t *hi = table->max[ky][kx];
+
+    uint16_t a = lo[y0][x0] < lo[y0][x1] ? lo[y0][x0] : lo[y0][x1];
+    uint16_t b = lo[y1][x0] < lo[y1][x1] ? lo[y1][x0] : lo[y1][x1];
+    uint16_t c = hi[y0][x0] > hi[y0][x1] ? hi[y0][x0] : hi[y0][x1];
+    uint16_t d = hi[y1][x0] > hi[y1][x1] ? hi[y1][x0] : hi[y1][x1];
+    *min = a < b ? a : b;
+    *max = c > d ? c : d;
+    return *max != 0;
+}
+
+#endif // REGION_MINMAX_H
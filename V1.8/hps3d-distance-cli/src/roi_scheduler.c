@@ -0,0 +1,112 @@
+/*
+ * Round-Robin- und Prioritäts-Zeitplan über die ROI-Gruppen des Geräts
+ */
+
+#include <string.h>
+#include "roi_scheduler.h"
+
+void roi_sched_init(roi_scheduler_t *sched, roi_sched_policy_t policy) {
+    memset(sched, 0, sizeof(*sched));
+    sched->policy = policy;
+    sched->cursor = -1;
+    sched->current = -1;
+}
+
+static int find_group(const roi_scheduler_t *sched, int group) {
+    for (int i = 0; i < sched->count; i++) {
+        if (sched->groups[i].group == group) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int roi_sched_add(roi_scheduler_t *sched, int group, int priority) {
+    if (!sched || group < 0 || group >= ROI_SCHED_MAX_GROUPS) {
+        return -1;
+    }
+    if (priority < 1) {
+        priority = 1;
+    }
+
+    int idx = find_group(sched, group);
+    if (idx < 0) {
+        idx = sched->count++;
+        memset(&sched->groups[idx], 0, sizeof(sched->groups[idx]));
+        sched->groups[idx].group = (uint8_t)group;
+    }
+    if (priority > sched->groups[idx].priority) {
+        sched->groups[idx].priority = priority;
+    }
+    return idx;
+}
+
+int roi_sched_limit(roi_scheduler_t *sched, int max_groups) {
+    int kept = 0;
+    for (int i = 0; i < sched->count; i++) {
+        if (sched->groups[i].group < max_groups) {
+            sched->groups[kept++] = sched->groups[i];
+        }
+    }
+    int removed = sched->count - kept;
+    sched->count = kept;
+    if (sched->cursor >= kept) {
+        sched->cursor = -1;
+    }
+    return removed;
+}
+
+int roi_sched_next(roi_scheduler_t *sched, uint64_t now_ms) {
+    if (!sched || sched->count == 0) {
+        return -1;
+    }
+
+    if (sched->policy == ROI_SCHED_ROUND_ROBIN) {
+        sched->cursor = (sched->cursor + 1) % sched->count;
+        return sched->groups[sched->cursor].group;
+    }
+
+    // Nie besuchte Gruppe zuerst, sonst größtes Alter * Gewicht; bei Gleichstand die erste
+    int best = 0;
+    uint64_t best_score = 0;
+    for (int i = 0; i < sched->count; i++) {
+        const roi_sched_group_t *g = &sched->groups[i];
+        if (g->last_ms == 0) {
+            best = i;
+            break;
+        }
+        uint64_t age = now_ms > g->last_ms ? now_ms - g->last_ms : 0;
+        uint64_t score = age * (uint64_t)g->priority;
+        if (score > best_score) {
+            best_score = score;
+            best = i;
+        }
+    }
+    sched->cursor = best;
+    return sched->groups[best].group;
+}
+
+void roi_sched_mark(roi_scheduler_t *sched, int group, uint64_t now_ms) {
+    int idx = find_group(sched, group);
+    if (idx < 0) {
+        return;
+    }
+    sched->groups[idx].last_ms = now_ms ? now_ms : 1;
+    sched->groups[idx].updates++;
+}
+
+const char *roi_sched_policy_name(roi_sched_policy_t policy) {
+    return policy == ROI_SCHED_PRIORITY ? "priority" : "round_robin";
+}
+
+int roi_sched_parse_policy(const char *name, int len, roi_sched_policy_t *policy) {
+    if (len == 11 && strncmp(name, "round_robin", 11) == 0) {
+        *policy = ROI_SCHED_ROUND_ROBIN;
+        return 0;
+    }
+    if (len == 8 && strncmp(name, "priority", 8) == 0) {
+        *policy = ROI_SCHED_PRIORITY;
+        return 0;
+    }
+    return -1;
+}
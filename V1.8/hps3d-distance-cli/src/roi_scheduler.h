@@ -0,0 +1,57 @@
+#ifndef ROI_SCHEDULER_H
+#define ROI_SCHEDULER_H
+
+#include <stdint.h>
+
+/*
+ * Zeitplan über die ROI-Gruppen des Geräts. Pro Gruppe liefert das Gerät
+ * höchstens max_roi_number ROIs (Standard 8); mehr Zonen werden auf bis zu
+ * 16 Gruppen verteilt und per HPS3D_SetROIGroupID nacheinander aktiviert.
+ *
+ * Round-Robin wechselt reihum. Priority wählt die Gruppe mit dem größten
+ * Produkt aus Alter und Gewicht, nie besuchte Gruppen zuerst - eine Gruppe
+ * mit Gewicht 4 wird also etwa viermal so oft aktualisiert wie eine mit 1.
+ */
+
+#define ROI_SCHED_MAX_GROUPS 16
+
+typedef enum {
+    ROI_SCHED_ROUND_ROBIN = 0,
+    ROI_SCHED_PRIORITY
+} roi_sched_policy_t;
+
+typedef struct {
+    uint8_t group;                      // ROI-Gruppe auf dem Gerät
+    int priority;                       // Gewicht >= 1 (Maximum der Zonen dieser Gruppe)
+    uint64_t last_ms;                   // Letztes Paket dieser Gruppe (0 = nie)
+    uint32_t updates;
+} roi_sched_group_t;
+
+typedef struct {
+    roi_sched_policy_t policy;
+    roi_sched_group_t groups[ROI_SCHED_MAX_GROUPS];
+    int count;
+    int cursor;                         // Round-Robin: zuletzt gewählter Index
+    int current;                        // Am Gerät gesetzte Gruppe, -1 = unbekannt
+} roi_scheduler_t;
+
+void roi_sched_init(roi_scheduler_t *sched, roi_sched_policy_t policy);
+
+// Gruppe aufnehmen; mehrfach genannte Gruppen behalten das höchste Gewicht.
+// Rückgabe: Index in groups[], -1 bei ungültiger Gruppe
+int roi_sched_add(roi_scheduler_t *sched, int group, int priority);
+
+// Gruppen ab max_groups entfernen (Gerätegrenze aus HPS3D_ExportSettings).
+// Rückgabe: Anzahl entfernter Gruppen
+int roi_sched_limit(roi_scheduler_t *sched, int max_groups);
+
+// Nächste zu aktivierende Gruppe; -1 wenn keine Gruppe eingetragen ist
+int roi_sched_next(roi_scheduler_t *sched, uint64_t now_ms);
+
+// Paket der Gruppe ausgewertet; unbekannte Gruppen werden ignoriert
+void roi_sched_mark(roi_scheduler_t *sched, int group, uint64_t now_ms);
+
+const char *roi_sched_policy_name(roi_sched_policy_t policy);
+int roi_sched_parse_policy(const char *name, int len, roi_sched_policy_t *policy);
+
+#endif // ROI_SCHEDULER_H
@@ -0,0 +1,101 @@
+/*
+ * Median/MAD-Statistik über ROI-Pixel
+ */
+
+#include <string.h>
+#include "region.h"
+#include "roi_stats.h"
+
+// k-kleinster Wert (Quickselect, ordnet v um); erwartet 0 <= k < n
+static uint16_t select_kth(uint16_t *v, int n, int k) {
+    int lo = 0, hi = n - 1;
+    while (lo < hi) {
+        uint16_t pivot = v[lo + (hi - lo) / 2];
+        int i = lo, j = hi;
+        while (i <= j) {
+            while (v[i] < pivot) i++;
+            while (v[j] > pivot) j--;
+            if (i <= j) {
+                uint16_t t = v[i];
+                v[i] = v[j];
+                v[j] = t;
+                i++;
+                j--;
+            }
+        }
+        if (k <= j) {
+            hi = j;
+        } else if (k >= i) {
+            lo = i;
+        } else {
+            break;
+        }
+    }
+    return v[k];
+}
+
+// Median über n Werte; bei gerader Anzahl Mittel der beiden mittleren
+static float median_of(uint16_t *v, int n) {
+    uint16_t upper = select_kth(v, n, n / 2);
+    if (n & 1) {
+        return upper;
+    }
+    // Untere Hälfte liegt nach dem Select links von n/2: deren Maximum
+    uint16_t lower = v[0];
+    for (int i = 1; i < n / 2; i++) {
+        lower = v[i] > lower ? v[i] : lower;
+    }
+    return 0.5f * ((float)lower + (float)upper);
+}
+
+int roi_robust_stats(const uint16_t *distance, uint32_t count, float k, uint16_t *scratch,
+                     roi_robust_t *out) {
+    memset(out, 0, sizeof(*out));
+
+    int n = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t d = distance[i];
+        scratch[n] = d;
+        n += region_pixel_valid(d);
+    }
+    out->valid = n;
+    if (n == 0) {
+        return 0;
+    }
+
+    float median = median_of(scratch, n);
+
+    // Abweichungen auf ganze mm gerundet - genügt bei mm-Auflösung der Rohdaten
+    for (int i = 0; i < n; i++) {
+        float dev = (float)scratch[i] - median;
+        scratch[i] = (uint16_t)((dev < 0 ? -dev : dev) + 0.5f);
+    }
+    float mad = median_of(scratch, n);
+
+    float sigma = 1.4826f * mad;
+    if (sigma < ROI_MIN_SIGMA_MM) {
+        sigma = ROI_MIN_SIGMA_MM;
+    }
+    float limit = k * sigma;
+
+    uint32_t sum = 0;
+    int inliers = 0;
+    uint16_t min = REGION_INVALID_MIN, max = 0;
+    for (uint32_t i = 0; i < count; i++) {
+        uint16_t d = distance[i];
+        float dev = (float)d - median;
+        int keep = region_pixel_valid(d) && dev <= limit && dev >= -limit;
+        sum += keep ? d : 0;
+        inliers += keep;
+        min = (keep && d < min) ? d : min;
+        max = (keep && d > max) ? d : max;
+    }
+
+    out->median = median;
+    out->mad = mad;
+    out->inliers = inliers;
+    out->mean = inliers ? (float)sum / inliers : median;
+    out->min = inliers ? min : 0;
+    out->max = max;
+    return inliers;
+}
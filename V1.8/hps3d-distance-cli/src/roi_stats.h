@@ -0,0 +1,36 @@
+#ifndef ROI_STATS_H
+#define ROI_STATS_H
+
+#include <stdint.h>
+#include "HPS3DUser_IF.h"
+
+/*
+ * Robuste Statistik über die Pixel einer Geräte-ROI (HPS3D_FULL_ROI_EVEN).
+ * Median und MAD (median absolute deviation) über gültige Pixel, danach
+ * Mittelwert nur über Pixel innerhalb von k * sigma um den Median
+ * (sigma = 1.4826 * MAD, Normalverteilungs-Äquivalent).
+ */
+
+#define ROI_DEFAULT_OUTLIER_K 3.0f
+#define ROI_MIN_SIGMA_MM 1.0f          // Untergrenze, falls MAD = 0 (quantisierte Werte)
+
+typedef struct {
+    float median;                      // Median gültiger Pixel in mm
+    float mad;                         // Median der absoluten Abweichung in mm
+    float mean;                        // Mittel der Inlier in mm
+    uint16_t min, max;                 // Über die Inlier
+    int valid;                         // Gültige Pixel
+    int inliers;                       // Nach Ausreißer-Verwerfung
+} roi_robust_t;
+
+// scratch muss count Werte fassen; Rückgabe: Anzahl Inlier (0 wenn kein Pixel gültig)
+int roi_robust_stats(const uint16_t *distance, uint32_t count, float k, uint16_t *scratch,
+                     roi_robust_t *out);
+
+// Liegt Pixel (x,y) im Rechteck der ROI?
+static inline int roi_contains(const HPS3D_FullRoiData_t *roi, int x, int y) {
+    return x >= roi->left_top_x && x <= roi->right_bottom_x &&
+           y >= roi->left_top_y && y <= roi->right_bottom_y;
+}
+
+#endif // ROI_STATS_H
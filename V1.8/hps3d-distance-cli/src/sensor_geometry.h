@@ -0,0 +1,87 @@
+#ifndef SENSOR_GEOMETRY_H
+#define SENSOR_GEOMETRY_H
+
+#include <stdint.h>
+#include "HPS3DUser_IF.h"
+
+// Feste Geometrie des HPS3D-160 (alle Kernel werden darauf spezialisiert)
+#define SENSOR_WIDTH   160
+#define SENSOR_HEIGHT  60
+#define SENSOR_PIXELS  (SENSOR_WIDTH * SENSOR_HEIGHT)
+
+#if SENSOR_PIXELS != HPS3D_MAX_PIXEL_NUMBER
+#error "SENSOR_WIDTH x SENSOR_HEIGHT passt nicht zu HPS3D_MAX_PIXEL_NUMBER"
+#endif
+
+// Eine Zeile der Tiefenkarte mit fester Länge - als Parametertyp
+// (const depth_row_t *) kennt der Compiler Stride und Zeilenlänge
+typedef uint16_t depth_row_t[SENSOR_WIDTH];
+
+// Schleifen-Unrolling nur wo der Compiler es unterstützt
+#define KERNEL_PRAGMA(x) _Pragma(#x)
+#if defined(__GNUC__) && !defined(__clang__) && (__GNUC__ >= 8)
+    #define KERNEL_UNROLL(n) KERNEL_PRAGMA(GCC unroll n)
+#elif defined(__clang__)
+    #define KERNEL_UNROLL(n) KERNEL_PRAGMA(clang loop unroll_count(n))
+#else
+    #define KERNEL_UNROLL(n)
+#endif
+
+#if defined(__GNUC__)
+    #define KERNEL_RESTRICT __restrict__
+#else
+    #define KERNEL_RESTRICT
+#endif
+
+/*
+ * Erzeugt Dekodier-Kernel für eine feste Auflösung W x H:
+ *   decode_distance_TAG() - Big-Endian uint16 Zeilen -> Distanzebene
+ *   decode_points_TAG()   - Big-Endian int32 x/y/z (1/100 mm) -> float
+ *   decode_points_soa_TAG() - wie oben, direkt in getrennte x[]/y[]/z[] Ebenen
+ * Zeilenlänge und Zeilenanzahl sind Konstanten, die innere Schleife hat
+ * eine feste Trip-Count und wird vom Compiler voll vektorisiert.
+ */
+#define DEFINE_DEPTH_DECODE_KERNELS(TAG, W, H)                                      \
+static void decode_distance_##TAG(const uint8_t (*KERNEL_RESTRICT src)[2 * (W)],   \
+                                  uint16_t (*KERNEL_RESTRICT dst)[(W)]) {          \
+    for (int y = 0; y < (H); y++) {                                                 \
+        KERNEL_UNROLL(8)                                                            \
+        for (int x = 0; x < (W); x++) {                                             \
+            dst[y][x] = (uint16_t)((src[y][2 * x] << 8) | src[y][2 * x + 1]);       \
+        }                                                                           \
+    }                                                                               \
+}                                                                                   \
+static void decode_points_##TAG(const uint8_t (*KERNEL_RESTRICT src)[12 * (W)],    \
+                                HPS3D_PerPointCloudData_t (*KERNEL_RESTRICT dst)[(W)]) { \
+    for (int y = 0; y < (H); y++) {                                                 \
+        KERNEL_UNROLL(4)                                                            \
+        for (int x = 0; x < (W); x++) {                                             \
+            const uint8_t *p = &src[y][12 * x];                                     \
+            int32_t px = (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]);  \
+            int32_t py = (int32_t)(((uint32_t)p[4] << 24) | ((uint32_t)p[5] << 16) | ((uint32_t)p[6] << 8) | p[7]);  \
+            int32_t pz = (int32_t)(((uint32_t)p[8] << 24) | ((uint32_t)p[9] << 16) | ((uint32_t)p[10] << 8) | p[11]); \
+            dst[y][x].x = (float)(px / 100.0);                                      \
+            dst[y][x].y = (float)(py / 100.0);                                      \
+            dst[y][x].z = (float)(pz / 100.0);                                      \
+        }                                                                           \
+    }                                                                               \
+}                                                                                   \
+static void decode_points_soa_##TAG(const uint8_t (*KERNEL_RESTRICT src)[12 * (W)], \
+                                    float (*KERNEL_RESTRICT dx)[(W)],               \
+                                    float (*KERNEL_RESTRICT dy)[(W)],               \
+                                    float (*KERNEL_RESTRICT dz)[(W)]) {             \
+    for (int y = 0; y < (H); y++) {                                                 \
+        KERNEL_UNROLL(4)                                                            \
+        for (int x = 0; x < (W); x++) {                                             \
+            const uint8_t *p = &src[y][12 * x];                                     \
+            int32_t px = (int32_t)(((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3]);  \
+            int32_t py = (int32_t)(((uint32_t)p[4] << 24) | ((uint32_t)p[5] << 16) | ((uint32_t)p[6] << 8) | p[7]);  \
+            int32_t pz = (int32_t)(((uint32_t)p[8] << 24) | ((uint32_t)p[9] << 16) | ((uint32_t)p[10] << 8) | p[11]); \
+            dx[y][x] = (float)(px / 100.0);                                         \
+            dy[y][x] = (float)(py / 100.0);                                         \
+            dz[y][x] = (float)(pz / 100.0);                                         \
+        }                                                                           \
+    }                                                                               \
+}
+
+#endif // SENSOR_GEOMETRY_H
@@ -0,0 +1,203 @@
+/*
+ * HPS3D-Protokoll über USB-CDC oder Pseudo-Terminal
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE     // B921600, TIOCGSERIAL
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/uio.h>
+#ifdef __linux__
+#include <linux/serial.h>
+#endif
+#include "serial_transport.h"
+
+const wire_framing_t WIRE_FRAMING_DEFAULT = {
+    .sync = {0xF5, 0x3D},
+    .header_len = 8,
+    .cmd_offset = 2,
+    .status_offset = 3,
+    .len_offset = 4,
+    .trailer_len = 1,
+    .trailer = 0xFA,
+};
+
+int serial_open_low_latency(const char *path) {
+    int fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct termios tio;
+    if (tcgetattr(fd, &tio) != 0) {
+        close(fd);
+        return -1;
+    }
+    cfmakeraw(&tio);
+    tio.c_cflag |= CLOCAL | CREAD;
+    tio.c_cflag &= ~(CSTOPB | CRTSCTS);
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+    // Kein Sammeln im Treiber: read() liefert sofort, was da ist (Wartezeit macht poll()).
+    // VMIN 1 statt 0, damit ein leerer Puffer EAGAIN meldet und 0 eindeutig Hangup heißt.
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+    // Bei CDC-ACM ohne Wirkung, bei echten UARTs die höchste übliche Rate
+    cfsetispeed(&tio, B921600);
+    cfsetospeed(&tio, B921600);
+    if (tcsetattr(fd, TCSANOW, &tio) != 0) {
+        close(fd);
+        return -1;
+    }
+
+#if defined(__linux__) && defined(TIOCGSERIAL)
+    // Flip-Buffer sofort weiterreichen statt per Timer; nicht jeder Treiber kennt das
+    struct serial_struct ss;
+    if (ioctl(fd, TIOCGSERIAL, &ss) == 0) {
+        ss.flags |= ASYNC_LOW_LATENCY;
+        (void)ioctl(fd, TIOCSSERIAL, &ss);
+    }
+#endif
+    tcflush(fd, TCIOFLUSH);
+    return fd;
+}
+
+static inline uint32_t rd32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+int wire_write_frame(int fd, const wire_framing_t *framing, uint8_t cmd, uint8_t status,
+                     const void *payload, uint32_t len, int timeout_ms) {
+    uint8_t header[WIRE_MAX_HEADER] = {0};
+    header[0] = framing->sync[0];
+    header[1] = framing->sync[1];
+    header[framing->cmd_offset] = cmd;
+    header[framing->status_offset] = status;
+    header[framing->len_offset] = (uint8_t)(len >> 24);
+    header[framing->len_offset + 1] = (uint8_t)(len >> 16);
+    header[framing->len_offset + 2] = (uint8_t)(len >> 8);
+    header[framing->len_offset + 3] = (uint8_t)len;
+
+    struct iovec iov[3] = {
+        {.iov_base = header, .iov_len = framing->header_len},
+        {.iov_base = (void *)payload, .iov_len = payload ? len : 0},
+        {.iov_base = (void *)&framing->trailer, .iov_len = framing->trailer_len},
+    };
+    int iovcnt = 3;
+    struct iovec *v = iov;
+
+    while (iovcnt > 0) {
+        ssize_t n = writev(fd, v, iovcnt);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            struct pollfd pfd = {.fd = fd, .events = POLLOUT};
+            if (errno != EAGAIN || poll(&pfd, 1, timeout_ms) <= 0) {
+                return -1;
+            }
+            continue;
+        }
+        // Teilweise geschrieben: iovec weiterschieben
+        while (iovcnt > 0 && (size_t)n >= v->iov_len) {
+            n -= (ssize_t)v->iov_len;
+            v++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            v->iov_base = (uint8_t *)v->iov_base + n;
+            v->iov_len -= (size_t)n;
+        }
+    }
+    return 0;
+}
+
+void wire_reader_init(wire_reader_t *r, int fd, const wire_framing_t *framing, frame_pool_t *pool) {
+    memset(r, 0, sizeof(*r));
+    r->fd = fd;
+    r->framing = framing;
+    r->pool = pool;
+}
+
+void wire_reader_reset(wire_reader_t *r) {
+    if (r->cur) {
+        frame_pool_release(r->pool, r->cur);
+        r->cur = NULL;
+    }
+    r->fill = 0;
+    r->total = 0;
+}
+
+// Header prüfen; bei Fehler ein Byte weiter nach dem nächsten Sync suchen
+static int check_header(wire_reader_t *r) {
+    const wire_framing_t *f = r->framing;
+    uint8_t *h = r->cur->data;
+    uint32_t len = rd32(h + f->len_offset);
+    int max_payload = r->cur->capacity - f->header_len - f->trailer_len;
+    if (h[0] == f->sync[0] && h[1] == f->sync[1] && len <= (uint32_t)max_payload) {
+        r->total = f->header_len + (int)len + f->trailer_len;
+        return 1;
+    }
+    memmove(h, h + 1, (size_t)(r->fill - 1));
+    r->fill--;
+    r->resyncs++;
+    return 0;
+}
+
+int wire_reader_poll(wire_reader_t *r, frame_buf_t **out) {
+    const wire_framing_t *f = r->framing;
+    for (;;) {
+        if (!r->cur) {
+            r->cur = frame_pool_acquire(r->pool);
+            if (!r->cur) {
+                return 0;  // Daten bleiben im Treiber, bis ein Puffer zurückkommt
+            }
+            r->fill = 0;
+            r->total = 0;
+        }
+
+        // Nie über das Frame-Ende hinaus lesen: der nächste Frame beginnt im nächsten Puffer
+        int want = r->total ? r->total : f->header_len;
+        ssize_t n = read(r->fd, r->cur->data + r->fill, (size_t)(want - r->fill));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (errno == EAGAIN || errno == EWOULDBLOCK) ? 0 : -1;
+        }
+        if (n == 0) {
+            // Pty ohne Gegenseite meldet EIO, ein abgezogenes CDC-Gerät EOF
+            errno = ENODEV;
+            return -1;
+        }
+        r->fill += (int)n;
+        if (r->fill < want) {
+            continue;
+        }
+
+        if (!r->total) {
+            check_header(r);
+            continue;
+        }
+
+        frame_buf_t *buf = r->cur;
+        r->cur = NULL;
+        if (f->trailer_len && buf->data[r->total - 1] != f->trailer) {
+            r->resyncs++;
+            frame_pool_release(r->pool, buf);
+            continue;
+        }
+        buf->len = r->total;
+        buf->event_type = buf->data[f->status_offset];
+        buf->seq = r->frames++;
+        clock_gettime(CLOCK_MONOTONIC, &buf->received);
+        *out = buf;
+        return 1;
+    }
+}
@@ -0,0 +1,112 @@
+#ifndef SERIAL_TRANSPORT_H
+#define SERIAL_TRANSPORT_H
+
+#include <stdint.h>
+#include "frame_pool.h"
+
+/*
+ * Serielle Übertragung für die HPS3DAPI_* Aufrufe über USB-CDC (/dev/ttyACM*)
+ * oder ein Pseudo-Terminal, ohne die geschlossene SDK-Bibliothek.
+ *
+ * Jeder Frame auf der Leitung:
+ *
+ *   sync[0] sync[1] | cmd | status | Länge (uint32 BE) | Nutzlast | trailer
+ *
+ * Die Lage der Felder steht in wire_framing_t und ist austauschbar; die
+ * Befehlscodes stehen unten. WIRE_FRAMING_DEFAULT und die WIRE_CMD_* Codes
+ * sind ein eigenes Format von Transport und Emulator, NICHT das Protokoll
+ * des Geräts. libHPS3D sendet beim Verbinden Frames der Form
+ * F5 0A | Länge (1 Byte, inkl. CRC) | Nutzlast | CRC16, z.B.
+ * F5 0A 05 BA FF 02 1F D6; das lässt sich mit wire_framing_t nicht
+ * abbilden. Messdaten-Frames (cmd WIRE_CMD_DATA, status =
+ * HPS3D_EventType_t) tragen als Nutzlast genau das Paket, das der
+ * SDK-Callback liefert (packet_parser.h).
+ *
+ * Der Leser liest direkt in Puffer aus einem frame_pool_t und nie über das
+ * Frame-Ende hinaus: erst den Header, dann den Rest. Es wird nichts
+ * umkopiert; die Nutzlast wird an Ort und Stelle weitergegeben. Nur bei
+ * verlorener Synchronisation werden die wenigen Header-Bytes verschoben.
+ */
+
+typedef struct {
+    uint8_t sync[2];            // Startbytes
+    uint8_t header_len;         // Bytes vor der Nutzlast
+    uint8_t cmd_offset;
+    uint8_t status_offset;
+    uint8_t len_offset;         // Nutzlastlänge, uint32 Big-Endian
+    uint8_t trailer_len;        // 0 oder 1
+    uint8_t trailer;            // Endbyte nach der Nutzlast
+} wire_framing_t;
+
+extern const wire_framing_t WIRE_FRAMING_DEFAULT;
+
+// Befehle (Host -> Gerät); die Antwort trägt denselben cmd und einen Status
+#define WIRE_CMD_HELLO           0x01   // Antwort: Geräteversion (Text)
+#define WIRE_CMD_SERIAL          0x02   // Antwort: Seriennummer (Text)
+#define WIRE_CMD_START           0x10
+#define WIRE_CMD_STOP            0x11
+#define WIRE_CMD_SINGLE          0x12   // Antwort: ein Messdaten-Frame
+#define WIRE_CMD_EXPORT          0x20   // Antwort: HPS3D_DeviceSettings_t
+#define WIRE_CMD_SAVE            0x21
+#define WIRE_CMD_USER_ID         0x30   // Nutzlast: uint8
+#define WIRE_CMD_ROI_GROUP       0x31   // Nutzlast: uint8
+#define WIRE_CMD_CAMERA_CODE     0x32   // Nutzlast: uint8
+#define WIRE_CMD_DISTANCE_FILTER 0x33   // Nutzlast: uint8 enable, float K (BE, IEEE 754)
+#define WIRE_CMD_SMOOTH_FILTER   0x34   // Nutzlast: uint8 type, int32 args (BE)
+#define WIRE_CMD_DISTANCE_OFFSET 0x35   // Nutzlast: int16 (BE)
+#define WIRE_CMD_OPTICAL_PATH    0x36   // Nutzlast: uint8
+#define WIRE_CMD_EDGE_FILTER     0x37   // Nutzlast: uint8
+#define WIRE_CMD_DATA            0x80   // Gerät -> Host, status = Ereignistyp
+
+#define WIRE_STATUS_OK           0x00
+#define WIRE_STATUS_ERROR        0x01
+
+#define WIRE_MAX_HEADER 16
+
+// Gerät öffnen und für niedrige Latenz einstellen: roh, 8N1, nicht blockierend,
+// VMIN 1/VTIME 0, ASYNC_LOW_LATENCY wo der Treiber es kennt. Rückgabe fd / -1
+int serial_open_low_latency(const char *path);
+
+// Frame schreiben (writev, Nutzlast ohne Kopie); blockiert bis alles raus ist
+// oder timeout_ms abgelaufen ist. Rückgabe 0 / -1
+int wire_write_frame(int fd, const wire_framing_t *framing, uint8_t cmd, uint8_t status,
+                     const void *payload, uint32_t len, int timeout_ms);
+
+typedef struct {
+    int fd;
+    const wire_framing_t *framing;
+    frame_pool_t *pool;
+    frame_buf_t *cur;           // Puffer im Aufbau
+    int fill;                   // Bytes in cur
+    int total;                  // Länge des Frames, 0 solange der Header fehlt
+    uint32_t frames;
+    uint32_t resyncs;           // Verworfene Bytes oder Frames
+} wire_reader_t;
+
+void wire_reader_init(wire_reader_t *r, int fd, const wire_framing_t *framing, frame_pool_t *pool);
+
+// Liest, was ohne Blockieren da ist. Rückgabe 1: vollständiger Frame in *out
+// (buf->len = Frame-Länge, zurück mit frame_pool_release), 0: noch keiner
+// (oder kein freier Puffer), -1: Ende der Verbindung oder Lesefehler
+int wire_reader_poll(wire_reader_t *r, frame_buf_t **out);
+
+// Verwirft einen angefangenen Frame (nach Reconnect oder Fehler)
+void wire_reader_reset(wire_reader_t *r);
+
+static inline uint8_t wire_frame_cmd(const wire_framing_t *f, const frame_buf_t *buf) {
+    return buf->data[f->cmd_offset];
+}
+
+static inline uint8_t wire_frame_status(const wire_framing_t *f, const frame_buf_t *buf) {
+    return buf->data[f->status_offset];
+}
+
+static inline uint8_t *wire_frame_payload(const wire_framing_t *f, const frame_buf_t *buf) {
+    return buf->data + f->header_len;
+}
+
+static inline int wire_frame_payload_len(const wire_framing_t *f, const frame_buf_t *buf) {
+    return buf->len - f->header_len - f->trailer_len;
+}
+
+#endif // SERIAL_TRANSPORT_H
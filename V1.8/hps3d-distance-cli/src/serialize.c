@@ -0,0 +1,356 @@
+/*
+ * Ausgabe der Messdaten
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "region.h"
+#include "serialize.h"
+
+int serialize_cloud_json(const uint16_t *distance, const uint16_t *range, int width, int height, long timestamp,
+                         char *out, size_t size, int *valid_points) {
+    int valid = 0;
+    size_t pos = (size_t)snprintf(out, size, "{\"timestamp\":%ld,\"width\":%d,\"height\":%d,\"data\":[",
+                                  timestamp, width, height);
+    if (pos >= size) {
+        return -1;
+    }
+
+    for (int y = 0; y < height; y++) {
+        const uint16_t *row = distance + (size_t)y * width;
+        for (int x = 0; x < width; x++) {
+            uint16_t d = row[x];
+            if (!region_pixel_valid(d)) {
+                continue;
+            }
+            // Komma vor jedem außer dem ersten Punkt
+            if (range) {
+                pos += (size_t)snprintf(out + pos, size - pos, "%s{\"x\":%d,\"y\":%d,\"d\":%d,\"r\":%d}",
+                                        valid ? "," : "", x, y, d, range[(size_t)y * width + x]);
+            } else {
+                pos += (size_t)snprintf(out + pos, size - pos, "%s{\"x\":%d,\"y\":%d,\"d\":%d}",
+                                        valid ? "," : "", x, y, d);
+            }
+            if (pos >= size) {
+                return -1;
+            }
+            valid++;
+        }
+    }
+
+    pos += (size_t)snprintf(out + pos, size - pos, "]}");
+    if (pos >= size) {
+        return -1;
+    }
+    if (valid_points) {
+        *valid_points = valid;
+    }
+    return (int)pos;
+}
+
+// Namen in Bit-Reihenfolge der OUT_FIELD_*; gleichzeitig JSON-Schlüssel
+static const char *const field_names[] = {
+    "distance_mm", "distance_m", "min_distance_mm", "max_distance_mm", "valid_pixels",
+    "valid", "age_ms", "coordinates", "range_mm", "roi_group",
+};
+#define FIELD_COUNT ((int)(sizeof(field_names) / sizeof(field_names[0])))
+
+uint32_t output_field_from_name(const char *name, size_t len) {
+    if (len == 3 && strncmp(name, "all", 3) == 0) {
+        return OUT_FIELD_ALL;
+    }
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        if (strlen(field_names[i]) == len && strncmp(name, field_names[i], len) == 0) {
+            return 1u << i;
+        }
+    }
+    return 0;
+}
+
+static int parse_fields(const char *list, size_t len, uint32_t *fields) {
+    *fields = 0;
+    while (len > 0) {
+        size_t n = 0;
+        while (n < len && list[n] != ',') {
+            n++;
+        }
+        uint32_t bit = output_field_from_name(list, n);
+        if (!bit) {
+            return -1;
+        }
+        *fields |= bit;
+        list += n;
+        len -= n;
+        if (len > 0) {      // Komma
+            list++;
+            len--;
+        }
+    }
+    return *fields ? 0 : -1;
+}
+
+int output_profile_parse(output_profile_t *profile, const char *spec, const char *default_topic_prefix) {
+    memset(profile, 0, sizeof(*profile));
+    profile->fields = OUT_FIELD_ALL;
+    profile->decimals = 1;
+    profile->encoding = OUT_ENCODING_JSON;
+
+    const char *p = spec;
+    int have_topic = 0;
+    while (*p) {
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        size_t n = strcspn(p, " \t\r\n");
+        if (n == 0) {
+            break;
+        }
+        const char *eq = memchr(p, '=', n);
+        if (!profile->name[0]) {
+            // Erstes Wort: Profilname
+            if (eq || n >= sizeof(profile->name)) {
+                return -1;
+            }
+            memcpy(profile->name, p, n);
+        } else if (!eq) {
+            return -1;
+        } else {
+            size_t key_len = (size_t)(eq - p);
+            const char *value = eq + 1;
+            size_t value_len = n - key_len - 1;
+            if (key_len == 6 && strncmp(p, "fields", 6) == 0) {
+                if (parse_fields(value, value_len, &profile->fields) != 0) {
+                    return -1;
+                }
+            } else if (key_len == 8 && strncmp(p, "decimals", 8) == 0) {
+                int decimals = atoi(value);
+                if (value_len != 1 || decimals < 0 || decimals > 3) {
+                    return -1;
+                }
+                profile->decimals = decimals;
+            } else if (key_len == 8 && strncmp(p, "encoding", 8) == 0) {
+                if (value_len == 4 && strncmp(value, "json", 4) == 0) {
+                    profile->encoding = OUT_ENCODING_JSON;
+                } else if (value_len == 3 && strncmp(value, "csv", 3) == 0) {
+                    profile->encoding = OUT_ENCODING_CSV;
+                } else if (value_len == 6 && strncmp(value, "binary", 6) == 0) {
+                    profile->encoding = OUT_ENCODING_BINARY;
+                } else {
+                    return -1;
+                }
+            } else if (key_len == 5 && strncmp(p, "topic", 5) == 0) {
+                if (value_len >= sizeof(profile->topic)) {
+                    return -1;
+                }
+                // "-": kein MQTT, nur HTTP
+                if (!(value_len == 1 && value[0] == '-')) {
+                    memcpy(profile->topic, value, value_len);
+                }
+                have_topic = 1;
+            } else {
+                return -1;
+            }
+        }
+        p += n;
+    }
+    if (!profile->name[0]) {
+        return -1;
+    }
+    if (!have_topic && default_topic_prefix) {
+        int len = snprintf(profile->topic, sizeof(profile->topic), "%s/%s", default_topic_prefix, profile->name);
+        if (len < 0 || (size_t)len >= sizeof(profile->topic)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+// Text anhängen; -1 sobald out voll ist
+static int append(char *out, size_t size, size_t *pos, const char *fmt, ...) {
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(out + *pos, size - *pos, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= size - *pos) {
+        return -1;
+    }
+    *pos += (size_t)n;
+    return 0;
+}
+
+// Zahlenwert von Feld field als Text (valid/coordinates formatiert der Aufrufer)
+static int append_value(char *out, size_t size, size_t *pos, const out_point_t *pt, int field, int decimals) {
+    switch (1u << field) {
+        case OUT_FIELD_DISTANCE_MM:  return append(out, size, pos, "%.*f", decimals, pt->distance_mm);
+        case OUT_FIELD_DISTANCE_M:   return append(out, size, pos, "%.*f", decimals + 3, pt->distance_mm / 1000.0);
+        case OUT_FIELD_MIN_MM:       return append(out, size, pos, "%.*f", decimals, pt->min_mm);
+        case OUT_FIELD_MAX_MM:       return append(out, size, pos, "%.*f", decimals, pt->max_mm);
+        case OUT_FIELD_VALID_PIXELS: return append(out, size, pos, "%d", pt->valid_pixels);
+        case OUT_FIELD_AGE_MS:       return append(out, size, pos, "%ld", pt->age_ms);
+        case OUT_FIELD_RANGE_MM:     return append(out, size, pos, "%.*f", decimals, pt->range_mm);
+        case OUT_FIELD_ROI_GROUP:    return append(out, size, pos, "%d", pt->group);
+        default:                     return -1;
+    }
+}
+
+static int serialize_json(const output_profile_t *profile, const out_point_t *points, int count,
+                          int64_t timestamp_ms, char *out, size_t size) {
+    size_t pos = 0;
+    if (append(out, size, &pos, "{\"ts\":%lld,\"points\":{", (long long)timestamp_ms) != 0) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        const out_point_t *pt = &points[i];
+        if (append(out, size, &pos, "%s\"%s\":{", i ? "," : "", pt->name) != 0) {
+            return -1;
+        }
+        int first = 1;
+        for (int f = 0; f < FIELD_COUNT; f++) {
+            if (!(profile->fields & (1u << f))) {
+                continue;
+            }
+            if (append(out, size, &pos, "%s\"%s\":", first ? "" : ",", field_names[f]) != 0) {
+                return -1;
+            }
+            first = 0;
+            int rc;
+            if ((1u << f) == OUT_FIELD_VALID) {
+                rc = append(out, size, &pos, "%s", pt->valid ? "true" : "false");
+            } else if ((1u << f) == OUT_FIELD_COORDINATES) {
+                rc = append(out, size, &pos, "{\"x\":%d,\"y\":%d}", pt->x, pt->y);
+            } else {
+                rc = append_value(out, size, &pos, pt, f, profile->decimals);
+            }
+            if (rc != 0) {
+                return -1;
+            }
+        }
+        if (append(out, size, &pos, "}") != 0) {
+            return -1;
+        }
+    }
+    if (append(out, size, &pos, "}}") != 0) {
+        return -1;
+    }
+    return (int)pos;
+}
+
+static int serialize_csv(const output_profile_t *profile, const out_point_t *points, int count,
+                         int64_t timestamp_ms, char *out, size_t size) {
+    size_t pos = 0;
+    if (append(out, size, &pos, "ts,name") != 0) {
+        return -1;
+    }
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        if (profile->fields & (1u << f)) {
+            int rc = (1u << f) == OUT_FIELD_COORDINATES ? append(out, size, &pos, ",x,y")
+                                                         : append(out, size, &pos, ",%s", field_names[f]);
+            if (rc != 0) {
+                return -1;
+            }
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        const out_point_t *pt = &points[i];
+        if (append(out, size, &pos, "\n%lld,%s", (long long)timestamp_ms, pt->name) != 0) {
+            return -1;
+        }
+        for (int f = 0; f < FIELD_COUNT; f++) {
+            if (!(profile->fields & (1u << f))) {
+                continue;
+            }
+            int rc;
+            if ((1u << f) == OUT_FIELD_VALID) {
+                rc = append(out, size, &pos, ",%d", pt->valid ? 1 : 0);
+            } else if ((1u << f) == OUT_FIELD_COORDINATES) {
+                rc = append(out, size, &pos, ",%d,%d", pt->x, pt->y);
+            } else {
+                rc = append(out, size, &pos, ",");
+                rc = rc ? rc : append_value(out, size, &pos, pt, f, profile->decimals);
+            }
+            if (rc != 0) {
+                return -1;
+            }
+        }
+    }
+    if (append(out, size, &pos, "\n") != 0) {
+        return -1;
+    }
+    return (int)pos;
+}
+
+static uint8_t *put_le32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+    return p + 4;
+}
+
+static uint8_t *put_f32(uint8_t *p, float v) {
+    uint32_t bits;
+    memcpy(&bits, &v, sizeof(bits));
+    return put_le32(p, bits);
+}
+
+// Bytes je Punkt für die gewählten Felder
+static size_t binary_point_size(uint32_t fields) {
+    size_t n = 0;
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        if (fields & (1u << f)) {
+            n += (1u << f) == OUT_FIELD_VALID ? 1 : (1u << f) == OUT_FIELD_COORDINATES ? 8 : 4;
+        }
+    }
+    return n;
+}
+
+static int serialize_binary(const output_profile_t *profile, const out_point_t *points, int count,
+                            int64_t timestamp_ms, char *out, size_t size) {
+    uint32_t fields = profile->fields;
+    size_t total = 14 + (size_t)count * binary_point_size(fields);
+    if (count > UINT16_MAX || total > size) {
+        return -1;
+    }
+    uint8_t *p = (uint8_t *)out;
+    p = put_le32(p, (uint32_t)(uint64_t)timestamp_ms);
+    p = put_le32(p, (uint32_t)((uint64_t)timestamp_ms >> 32));
+    p = put_le32(p, fields);
+    *p++ = (uint8_t)count;
+    *p++ = (uint8_t)(count >> 8);
+    for (int i = 0; i < count; i++) {
+        const out_point_t *pt = &points[i];
+        if (fields & OUT_FIELD_DISTANCE_MM)  p = put_f32(p, pt->distance_mm);
+        if (fields & OUT_FIELD_DISTANCE_M)   p = put_f32(p, pt->distance_mm / 1000.0f);
+        if (fields & OUT_FIELD_MIN_MM)       p = put_f32(p, pt->min_mm);
+        if (fields & OUT_FIELD_MAX_MM)       p = put_f32(p, pt->max_mm);
+        if (fields & OUT_FIELD_VALID_PIXELS) p = put_le32(p, (uint32_t)pt->valid_pixels);
+        if (fields & OUT_FIELD_VALID)        *p++ = (uint8_t)(pt->valid != 0);
+        if (fields & OUT_FIELD_AGE_MS)       p = put_le32(p, (uint32_t)(int32_t)pt->age_ms);
+        if (fields & OUT_FIELD_COORDINATES) {
+            p = put_le32(p, (uint32_t)pt->x);
+            p = put_le32(p, (uint32_t)pt->y);
+        }
+        if (fields & OUT_FIELD_RANGE_MM)     p = put_f32(p, pt->range_mm);
+        if (fields & OUT_FIELD_ROI_GROUP)    p = put_le32(p, (uint32_t)pt->group);
+    }
+    return (int)(p - (uint8_t *)out);
+}
+
+int serialize_points(const output_profile_t *profile, const out_point_t *points, int count, int64_t timestamp_ms,
+                     char *out, size_t size) {
+    switch (profile->encoding) {
+        case OUT_ENCODING_CSV:    return serialize_csv(profile, points, count, timestamp_ms, out, size);
+        case OUT_ENCODING_BINARY: return serialize_binary(profile, points, count, timestamp_ms, out, size);
+        default:                  return serialize_json(profile, points, count, timestamp_ms, out, size);
+    }
+}
+
+const char *output_encoding_content_type(out_encoding_t encoding) {
+    switch (encoding) {
+        case OUT_ENCODING_CSV:    return "text/csv";
+        case OUT_ENCODING_BINARY: return "application/octet-stream";
+        default:                  return "application/json";
+    }
+}
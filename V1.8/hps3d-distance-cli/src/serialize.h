@@ -0,0 +1,95 @@
+#ifndef SERIALIZE_H
+#define SERIALIZE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Ausgabe der Messdaten für MQTT/HTTP. Reine Funktionen ohne globale
+ * Zustände, damit sie auch im Replay-Benchmark (make pgo) laufen.
+ */
+
+// Punktwolken-JSON {"timestamp":..,"width":..,"height":..,"data":[{"x":..,"y":..,"d":..},..]}
+// mit allen gültigen Pixeln der Distanzebene. range (optional) ergänzt jeden Punkt
+// um die Schrägentfernung "r". valid_points (optional) erhält die Anzahl
+// ausgegebener Punkte. Rückgabe: Länge ohne '\0', -1 wenn out zu klein ist
+int serialize_cloud_json(const uint16_t *distance, const uint16_t *range, int width, int height, long timestamp,
+                         char *out, size_t size, int *valid_points);
+
+/*
+ * Ausgabeprofile: benannte Auswahl der Messpunkt-Felder mit eigener
+ * Genauigkeit und Kodierung. Konfiguration je Profil in einer Zeile:
+ *
+ *   <name> [fields=distance_mm,valid,...|all] [decimals=0..3]
+ *          [encoding=json|csv|binary] [topic=<mqtt-topic>|-]
+ *
+ * json:   {"ts":..,"points":{"<name>":{"distance_mm":..,..},..}}
+ * csv:    Kopfzeile "ts,name,<felder>", dann eine Zeile je Punkt
+ * binary: Little-Endian, int64 ts, uint32 Feldmaske, uint16 Punkte, dann je
+ *         Punkt die gewählten Felder in Bit-Reihenfolge (Entfernungen float32,
+ *         Zähler/Koordinaten int32, valid uint8); Punktnamen entfallen, die
+ *         Reihenfolge ist die der Konfiguration
+ */
+
+#define OUTPUT_PROFILE_MAX 8
+#define OUTPUT_PROFILE_NAME 16
+#define OUTPUT_PROFILE_TOPIC 64
+
+enum {
+    OUT_FIELD_DISTANCE_MM  = 1u << 0,
+    OUT_FIELD_DISTANCE_M   = 1u << 1,
+    OUT_FIELD_MIN_MM       = 1u << 2,
+    OUT_FIELD_MAX_MM       = 1u << 3,
+    OUT_FIELD_VALID_PIXELS = 1u << 4,
+    OUT_FIELD_VALID        = 1u << 5,
+    OUT_FIELD_AGE_MS       = 1u << 6,
+    OUT_FIELD_COORDINATES  = 1u << 7,   // x und y
+    OUT_FIELD_RANGE_MM     = 1u << 8,
+    OUT_FIELD_ROI_GROUP    = 1u << 9,
+    OUT_FIELD_ALL          = (1u << 10) - 1,
+};
+
+typedef enum {
+    OUT_ENCODING_JSON = 0,
+    OUT_ENCODING_CSV,
+    OUT_ENCODING_BINARY,
+} out_encoding_t;
+
+typedef struct {
+    char name[OUTPUT_PROFILE_NAME];
+    char topic[OUTPUT_PROFILE_TOPIC];   // Leer = nur HTTP (?profile=<name>)
+    uint32_t fields;                    // OUT_FIELD_*
+    int decimals;                       // Nachkommastellen der mm-Werte
+    out_encoding_t encoding;
+} output_profile_t;
+
+// Schnappschuss eines Messpunkts, unabhängig von der Datenhaltung im Service
+typedef struct {
+    char name[16];
+    float distance_mm;
+    float min_mm;
+    float max_mm;
+    float range_mm;
+    int valid_pixels;
+    int valid;
+    long age_ms;
+    int x;
+    int y;
+    int group;
+} out_point_t;
+
+// Profilzeile parsen; default_topic_prefix + "/" + name, wenn kein topic= angegeben ist.
+// Rückgabe 0, -1 bei unbekanntem Feld, Schlüssel oder Wert
+int output_profile_parse(output_profile_t *profile, const char *spec, const char *default_topic_prefix);
+
+// Feldname (z.B. "distance_mm") zu OUT_FIELD_*, 0 wenn unbekannt
+uint32_t output_field_from_name(const char *name, size_t len);
+
+// Punkte nach Profil kodieren. Rückgabe: Länge (ohne '\0' bei Text), -1 wenn out zu klein ist
+int serialize_points(const output_profile_t *profile, const out_point_t *points, int count, int64_t timestamp_ms,
+                     char *out, size_t size);
+
+// MIME-Typ der Kodierung für die HTTP-Antwort
+const char *output_encoding_content_type(out_encoding_t encoding);
+
+#endif // SERIALIZE_H
@@ -0,0 +1,66 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Lock-freier Ringpuffer für genau einen Produzenten und einen Konsumenten.
+ * Transportiert Zeiger; der Speicher für die Slots kommt vom Aufrufer.
+ * Kapazität muss eine Zweierpotenz sein. Weder push noch pop blockiert.
+ */
+
+#define SPSC_CACHE_LINE 64
+
+typedef struct {
+    _Alignas(SPSC_CACHE_LINE) _Atomic uint32_t head;   // Nächster Lese-Index (Konsument)
+    _Alignas(SPSC_CACHE_LINE) _Atomic uint32_t tail;   // Nächster Schreib-Index (Produzent)
+    _Alignas(SPSC_CACHE_LINE) void **slots;
+    uint32_t mask;
+} spsc_ring_t;
+
+// Rückgabe 0 bei Erfolg, -1 wenn capacity keine Zweierpotenz ist
+static inline int spsc_ring_init(spsc_ring_t *ring, void **storage, uint32_t capacity) {
+    if (!ring || !storage || capacity == 0 || (capacity & (capacity - 1)) != 0) {
+        return -1;
+    }
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    ring->slots = storage;
+    ring->mask = capacity - 1;
+    return 0;
+}
+
+// Nur vom Produzenten; -1 wenn der Ring voll ist
+static inline int spsc_ring_push(spsc_ring_t *ring, void *item) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    if (tail - head > ring->mask) {
+        return -1;
+    }
+    ring->slots[tail & ring->mask] = item;
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+    return 0;
+}
+
+// Nur vom Konsumenten; NULL wenn der Ring leer ist
+static inline void *spsc_ring_pop(spsc_ring_t *ring) {
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    if (head == tail) {
+        return NULL;
+    }
+    void *item = ring->slots[head & ring->mask];
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+    return item;
+}
+
+// Momentaufnahme der Füllung (von beiden Seiten nutzbar, nur als Statistik)
+static inline uint32_t spsc_ring_count(spsc_ring_t *ring) {
+    uint32_t tail = atomic_load_explicit(&ring->tail, memory_order_acquire);
+    uint32_t head = atomic_load_explicit(&ring->head, memory_order_acquire);
+    return tail - head;
+}
+
+#endif // SPSC_RING_H
@@ -0,0 +1,101 @@
+/*
+ * sd_notify- und Socket-Aktivierungsprotokoll von systemd
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "systemd_notify.h"
+
+// Variable als Zahl lesen; -1 wenn nicht gesetzt oder ungültig
+static long env_number(const char *name) {
+    const char *value = getenv(name);
+    if (!value || !*value) {
+        return -1;
+    }
+    char *end;
+    errno = 0;
+    long n = strtol(value, &end, 10);
+    return (errno == 0 && *end == '\0' && n >= 0) ? n : -1;
+}
+
+// Gilt die Variable (LISTEN_PID/WATCHDOG_PID) für diesen Prozess? Fehlt sie, ja.
+static int env_pid_matches(const char *name) {
+    if (!getenv(name)) {
+        return 1;
+    }
+    return env_number(name) == (long)getpid();
+}
+
+int systemd_listen_fd(void) {
+    long count = env_number("LISTEN_FDS");
+    int for_us = getenv("LISTEN_PID") && env_pid_matches("LISTEN_PID");
+
+    unsetenv("LISTEN_PID");
+    unsetenv("LISTEN_FDS");
+    unsetenv("LISTEN_FDNAMES");
+
+    if (!for_us || count < 1) {
+        return -1;
+    }
+
+    int fd = SYSTEMD_LISTEN_FDS_START;
+    struct stat st;
+    int type = 0;
+    socklen_t len = sizeof(type);
+    if (fstat(fd, &st) != 0 || !S_ISSOCK(st.st_mode) ||
+        getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &len) != 0 || type != SOCK_STREAM) {
+        return -1;
+    }
+
+    // Deskriptoren von systemd haben kein CLOEXEC
+    int flags = fcntl(fd, F_GETFD);
+    if (flags >= 0) {
+        fcntl(fd, F_SETFD, flags | FD_CLOEXEC);
+    }
+    return fd;
+}
+
+int systemd_notify(const char *state) {
+    const char *path = getenv("NOTIFY_SOCKET");
+    if (!path || !state) {
+        return 0;
+    }
+
+    size_t path_len = strlen(path);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if ((path[0] != '/' && path[0] != '@') || path_len >= sizeof(addr.sun_path)) {
+        return -1;
+    }
+    memcpy(addr.sun_path, path, path_len);
+    if (path[0] == '@') {
+        addr.sun_path[0] = '\0';  // Abstrakter Namensraum
+    }
+
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    socklen_t addr_len = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + path_len);
+    ssize_t sent = sendto(fd, state, strlen(state), MSG_NOSIGNAL, (struct sockaddr *)&addr, addr_len);
+    close(fd);
+    return sent >= 0 ? 1 : -1;
+}
+
+uint64_t systemd_watchdog_usec(void) {
+    long usec = env_number("WATCHDOG_USEC");
+    if (usec <= 0 || !env_pid_matches("WATCHDOG_PID")) {
+        return 0;
+    }
+    return (uint64_t)usec;
+}
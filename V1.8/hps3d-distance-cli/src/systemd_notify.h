@@ -0,0 +1,28 @@
+#ifndef SYSTEMD_NOTIFY_H
+#define SYSTEMD_NOTIFY_H
+
+#include <stdint.h>
+
+/*
+ * Minimaler Client für das systemd-Protokoll ohne libsystemd:
+ * - Socket-Aktivierung (LISTEN_PID/LISTEN_FDS, erster Deskriptor ab 3)
+ * - Statusmeldungen an $NOTIFY_SOCKET (READY=1, WATCHDOG=1, STATUS=...)
+ * - Watchdog-Intervall aus WATCHDOG_USEC/WATCHDOG_PID
+ *
+ * Ohne systemd (Variablen nicht gesetzt oder für einen anderen Prozess)
+ * sind alle Funktionen wirkungslos.
+ */
+
+#define SYSTEMD_LISTEN_FDS_START 3
+
+// Von systemd übergebener Listen-Socket oder -1. Die Umgebungsvariablen
+// werden entfernt, damit Kindprozesse den Socket nicht übernehmen.
+int systemd_listen_fd(void);
+
+// Nachricht an den Service-Manager; Rückgabe 1 = gesendet, 0 = kein systemd, -1 = Fehler
+int systemd_notify(const char *state);
+
+// Watchdog-Intervall in µs, 0 wenn der Watchdog für diesen Prozess nicht aktiv ist
+uint64_t systemd_watchdog_usec(void);
+
+#endif // SYSTEMD_NOTIFY_H
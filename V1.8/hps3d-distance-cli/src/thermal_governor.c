@@ -0,0 +1,176 @@
+/*
+ * Temperaturabhängige Lastbegrenzung über /sys/class/thermal
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <dirent.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "thermal_governor.h"
+
+void thermal_config_defaults(thermal_config_t *config) {
+    memset(config, 0, sizeof(*config));
+    config->limit_mc[THERMAL_REDUCED_RATE] = 65000;
+    config->limit_mc[THERMAL_NO_ANALYTICS] = 70000;
+    config->limit_mc[THERMAL_NO_POINTCLOUD] = 75000;
+    config->hysteresis_mc = THERMAL_DEFAULT_HYSTERESIS_MC;
+    config->interval_s = THERMAL_DEFAULT_INTERVAL_S;
+    config->rate_factor = THERMAL_DEFAULT_RATE_FACTOR;
+}
+
+int thermal_config_load(thermal_config_t *config, const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return -1;
+    }
+
+    int applied = 0;
+    char line[256];
+    while (fgets(line, sizeof(line), fp)) {
+        char key[64];
+        char value[32];
+        // Kommentare hinter dem Wert ("cpu_temp_warning=70  # ...") fallen beim Scan weg
+        if (line[0] == '#' || sscanf(line, " %63[^= ] = %31[^# \t\r\n]", key, value) != 2) {
+            continue;
+        }
+        char *end;
+        long n = strtol(value, &end, 10);
+        if (*end != '\0') {
+            continue;
+        }
+
+        if (strcmp(key, "power_save_temp") == 0) {
+            config->limit_mc[THERMAL_REDUCED_RATE] = (int32_t)(n * 1000);
+        } else if (strcmp(key, "cpu_temp_warning") == 0) {
+            config->limit_mc[THERMAL_NO_ANALYTICS] = (int32_t)(n * 1000);
+        } else if (strcmp(key, "thermal_throttle_temp") == 0) {
+            config->limit_mc[THERMAL_NO_POINTCLOUD] = (int32_t)(n * 1000);
+        } else if (strcmp(key, "temp_check_interval") == 0) {
+            config->interval_s = (int)n;
+        } else {
+            continue;
+        }
+        applied++;
+    }
+    fclose(fp);
+    return applied;
+}
+
+int thermal_config_validate(const thermal_config_t *config) {
+    if (config->interval_s < 1 || config->hysteresis_mc < 0 || config->rate_factor < 1) {
+        return -1;
+    }
+    for (int level = THERMAL_NO_ANALYTICS; level < THERMAL_LEVELS; level++) {
+        if (config->limit_mc[level] < config->limit_mc[level - 1]) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+void thermal_governor_init(thermal_governor_t *gov, const thermal_config_t *config) {
+    memset(gov, 0, sizeof(*gov));
+    gov->config = *config;
+    gov->level = THERMAL_NORMAL;
+}
+
+thermal_level_t thermal_governor_update(thermal_governor_t *gov, int32_t temp_mc) {
+    gov->temp_mc = temp_mc;
+
+    // Höchste Stufe, deren Schwelle erreicht ist
+    thermal_level_t target = THERMAL_NORMAL;
+    for (int level = THERMAL_REDUCED_RATE; level < THERMAL_LEVELS; level++) {
+        if (temp_mc >= gov->config.limit_mc[level]) {
+            target = (thermal_level_t)level;
+        }
+    }
+
+    thermal_level_t next = gov->level;
+    if (target > gov->level) {
+        next = target;
+    } else if (gov->level > THERMAL_NORMAL &&
+               temp_mc < gov->config.limit_mc[gov->level] - gov->config.hysteresis_mc) {
+        next = (thermal_level_t)(gov->level - 1);
+    }
+
+    if (next != gov->level) {
+        gov->level = next;
+        gov->transitions++;
+    }
+    return gov->level;
+}
+
+int thermal_read_mc(const char *path, int32_t *temp_mc) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        return -1;
+    }
+    long value;
+    int ok = fscanf(fp, "%ld", &value) == 1;
+    fclose(fp);
+    if (!ok) {
+        return -1;
+    }
+    *temp_mc = (int32_t)value;
+    return 0;
+}
+
+int thermal_find_zone(const char *base_dir, char *path, size_t path_size) {
+    DIR *dir = opendir(base_dir);
+    if (!dir) {
+        return -1;
+    }
+
+    int best = -1;
+    int best_is_cpu = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        int index;
+        if (sscanf(entry->d_name, "thermal_zone%d", &index) != 1) {
+            continue;
+        }
+
+        char file[512];
+        int32_t temp;
+        snprintf(file, sizeof(file), "%s/%s/temp", base_dir, entry->d_name);
+        if (thermal_read_mc(file, &temp) != 0) {
+            continue;
+        }
+
+        char type[64] = "";
+        snprintf(file, sizeof(file), "%s/%s/type", base_dir, entry->d_name);
+        FILE *fp = fopen(file, "r");
+        if (fp) {
+            if (!fgets(type, sizeof(type), fp)) {
+                type[0] = '\0';
+            }
+            fclose(fp);
+        }
+        int is_cpu = strstr(type, "cpu") != NULL;
+
+        // CPU-Zone bevorzugen, sonst die niedrigste Nummer (zone0 auf dem Pi)
+        if (best < 0 || (is_cpu && !best_is_cpu) || (is_cpu == best_is_cpu && index < best)) {
+            best = index;
+            best_is_cpu = is_cpu;
+        }
+    }
+    closedir(dir);
+
+    if (best < 0) {
+        return -1;
+    }
+    snprintf(path, path_size, "%s/thermal_zone%d/temp", base_dir, best);
+    return 0;
+}
+
+const char *thermal_level_name(thermal_level_t level) {
+    switch (level) {
+        case THERMAL_NORMAL:        return "normal";
+        case THERMAL_REDUCED_RATE:  return "reduced_rate";
+        case THERMAL_NO_ANALYTICS:  return "no_analytics";
+        case THERMAL_NO_POINTCLOUD: return "no_pointcloud";
+        default:                    return "unknown";
+    }
+}
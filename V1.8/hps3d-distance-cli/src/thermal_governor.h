@@ -0,0 +1,72 @@
+#ifndef THERMAL_GOVERNOR_H
+#define THERMAL_GOVERNOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Temperaturabhängige Lastbegrenzung. Die Stufen bauen aufeinander auf:
+ *   1 = Messrate reduziert (power_save_temp)
+ *   2 = zusätzlich optionale Analysen aus (cpu_temp_warning)
+ *   3 = zusätzlich keine Punktwolke (thermal_throttle_temp)
+ * Steigt die Temperatur, wird sofort die passende Stufe gesetzt. Zurück geht
+ * es nur eine Stufe pro Prüfung und erst, wenn die Schwelle der aktuellen
+ * Stufe um die Hysterese unterschritten ist.
+ *
+ * Temperaturen in Milli-°C wie in /sys/class/thermal.
+ */
+
+#define THERMAL_ZONE_DIR "/sys/class/thermal"
+#define THERMAL_TUNING_FILE "/etc/hps3d/pi4-tuning.conf"
+#define THERMAL_DEFAULT_HYSTERESIS_MC 3000
+#define THERMAL_DEFAULT_INTERVAL_S 5
+#define THERMAL_DEFAULT_RATE_FACTOR 2
+
+typedef enum {
+    THERMAL_NORMAL = 0,
+    THERMAL_REDUCED_RATE,
+    THERMAL_NO_ANALYTICS,
+    THERMAL_NO_POINTCLOUD,
+    THERMAL_LEVELS
+} thermal_level_t;
+
+typedef struct {
+    int32_t limit_mc[THERMAL_LEVELS];   // Eintrittsschwelle je Stufe (Index 0 unbenutzt)
+    int32_t hysteresis_mc;
+    int interval_s;                     // temp_check_interval
+    int rate_factor;                    // Messintervall-Faktor ab Stufe 1
+} thermal_config_t;
+
+typedef struct {
+    thermal_config_t config;
+    thermal_level_t level;
+    int32_t temp_mc;                    // Letzter Messwert
+    uint32_t transitions;
+} thermal_governor_t;
+
+// Standardwerte aus pi4-tuning.conf (65/70/75 °C, 5 s)
+void thermal_config_defaults(thermal_config_t *config);
+
+// Schwellen aus einer key=value-Datei übernehmen (power_save_temp, cpu_temp_warning,
+// thermal_throttle_temp in °C, temp_check_interval in s). Unbekannte Schlüssel
+// werden ignoriert. Rückgabe: Anzahl übernommener Werte, -1 wenn die Datei fehlt
+int thermal_config_load(thermal_config_t *config, const char *path);
+
+// Schwellen aufsteigend sortiert und Intervall > 0? 0 = gültig, -1 = ungültig
+int thermal_config_validate(const thermal_config_t *config);
+
+void thermal_governor_init(thermal_governor_t *gov, const thermal_config_t *config);
+
+// Neuen Messwert einordnen; Rückgabe: Stufe nach der Prüfung
+thermal_level_t thermal_governor_update(thermal_governor_t *gov, int32_t temp_mc);
+
+// Temperaturdatei der CPU finden (Typ "cpu-thermal", sonst erste Zone).
+// Rückgabe 0 und Pfad in path, -1 wenn keine Zone lesbar ist
+int thermal_find_zone(const char *base_dir, char *path, size_t path_size);
+
+// Temperatur in Milli-°C lesen; -1 bei Fehler
+int thermal_read_mc(const char *path, int32_t *temp_mc);
+
+const char *thermal_level_name(thermal_level_t level);
+
+#endif // THERMAL_GOVERNOR_H
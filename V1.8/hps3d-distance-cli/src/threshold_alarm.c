@@ -0,0 +1,98 @@
+/*
+ * Schwellwert-Alarme der Geräte-ROIs direkt aus dem Rohpaket
+ */
+
+#include <string.h>
+#include "packet_parser.h"
+#include "threshold_alarm.h"
+
+static inline uint16_t rd16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static inline uint32_t rd32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+void threshold_tracker_init(threshold_tracker_t *tracker, int threshold_count) {
+    if (threshold_count < 1 || threshold_count > 8) {
+        threshold_count = THRESHOLD_ALARM_DEFAULT_COUNT;
+    }
+    memset(tracker->state, 0, sizeof(tracker->state));
+    tracker->mask = (uint8_t)((1u << threshold_count) - 1);
+    atomic_init(&tracker->packets, 0);
+    atomic_init(&tracker->edges, 0);
+    atomic_init(&tracker->malformed, 0);
+}
+
+void threshold_tracker_reset(threshold_tracker_t *tracker) {
+    memset(tracker->state, 0, sizeof(tracker->state));
+}
+
+// Ein ROI-Kopf: Offsets der Kopfwerte unterscheiden sich zwischen einfachem und vollem Paket
+static int scan_roi(threshold_tracker_t *tracker, const uint8_t *p, int avg_offset, int frame_offset,
+                    threshold_alarm_fn emit, void *user) {
+    uint8_t group = p[1];
+    uint8_t roi_id = p[2];
+    if (group >= THRESHOLD_ALARM_MAX_GROUPS || roi_id >= HPS3D_MAX_ROI_NUMBER) {
+        return 0;
+    }
+
+    uint8_t bits = p[3] & tracker->mask;
+    uint8_t changed = bits ^ tracker->state[group][roi_id];
+    if (!changed) {
+        return 0;
+    }
+    tracker->state[group][roi_id] = bits;
+
+    threshold_alarm_t alarm = {
+        .group = group,
+        .roi_id = roi_id,
+        .distance_average = rd16(p + avg_offset),
+        .distance_min = rd16(p + avg_offset + 2),
+        .frame_cnt = rd32(p + frame_offset)
+    };
+    int edges = 0;
+    for (uint8_t t = 0; changed; t++, changed >>= 1) {
+        if (changed & 1) {
+            alarm.threshold = t;
+            alarm.active = (bits >> t) & 1;
+            if (emit) {
+                emit(&alarm, user);
+            }
+            edges++;
+        }
+    }
+    return edges;
+}
+
+int threshold_tracker_scan(threshold_tracker_t *tracker, int event_type, const uint8_t *data, int len,
+                           threshold_alarm_fn emit, void *user) {
+    if (event_type != HPS3D_SIMPLE_ROI_EVEN && event_type != HPS3D_FULL_ROI_EVEN) {
+        return 0;
+    }
+    // Layout einmal prüfen, danach laufen die Kopf-Zugriffe ohne weitere Grenzprüfung
+    if (packet_validate(data, len, (HPS3D_EventType_t)event_type) < 0) {
+        atomic_fetch_add_explicit(&tracker->malformed, 1, memory_order_relaxed);
+        return -1;
+    }
+    atomic_fetch_add_explicit(&tracker->packets, 1, memory_order_relaxed);
+
+    int num = data[0];
+    int edges = 0;
+    const uint8_t *p = data;
+    for (int i = 0; i < num; i++) {
+        if (event_type == HPS3D_SIMPLE_ROI_EVEN) {
+            edges += scan_roi(tracker, p, 4, 10, emit, user);
+            p += PACKET_SIMPLE_ROI_SIZE;
+        } else {
+            edges += scan_roi(tracker, p, 12, 22, emit, user);
+            p += PACKET_FULL_ROI_HEADER + 2 * rd32(p + 18);
+        }
+    }
+
+    if (edges) {
+        atomic_fetch_add_explicit(&tracker->edges, (uint32_t)edges, memory_order_relaxed);
+    }
+    return edges;
+}
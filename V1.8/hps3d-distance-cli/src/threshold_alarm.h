@@ -0,0 +1,51 @@
+#ifndef THRESHOLD_ALARM_H
+#define THRESHOLD_ALARM_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include "HPS3DUser_IF.h"
+
+/*
+ * Flankenerkennung auf den Schwellwert-Bits der Geräte-ROIs (threshold_state,
+ * bit0..bit2 = Schwelle 0..2). Läuft direkt im SDK-Empfangsthread auf dem
+ * Rohpaket: nur die ROI-Köpfe werden gelesen, nichts dekodiert oder kopiert.
+ * Für jede Änderung eines Bits wird sofort der Callback aufgerufen.
+ *
+ * scan() gehört einem Thread (SDK-Empfang); reset() nur, solange kein
+ * Gerät verbunden ist.
+ */
+
+#define THRESHOLD_ALARM_MAX_GROUPS 16
+#define THRESHOLD_ALARM_DEFAULT_COUNT 3     // max_threshold_number des Geräts
+
+typedef struct {
+    uint8_t group;
+    uint8_t roi_id;
+    uint8_t threshold;                  // 0..2
+    uint8_t active;                     // 1 = ausgelöst, 0 = zurückgesetzt
+    uint16_t distance_average;          // Kopfwerte der ROI im auslösenden Paket
+    uint16_t distance_min;
+    uint32_t frame_cnt;
+} threshold_alarm_t;
+
+typedef void (*threshold_alarm_fn)(const threshold_alarm_t *alarm, void *user);
+
+typedef struct {
+    uint8_t mask;                       // Gültige Schwellwert-Bits
+    uint8_t state[THRESHOLD_ALARM_MAX_GROUPS][HPS3D_MAX_ROI_NUMBER];
+    _Atomic uint32_t packets;           // Gescannte ROI-Pakete
+    _Atomic uint32_t edges;             // Gemeldete Flanken
+    _Atomic uint32_t malformed;         // Verworfene Pakete
+} threshold_tracker_t;
+
+void threshold_tracker_init(threshold_tracker_t *tracker, int threshold_count);
+
+// Zustände vergessen (neue Verbindung); Bits die danach gesetzt sind, melden erneut eine Flanke
+void threshold_tracker_reset(threshold_tracker_t *tracker);
+
+// Rohpaket prüfen und Flanken melden. Andere Pakettypen werden ignoriert.
+// Rückgabe: Anzahl Flanken, -1 bei ungültigem Paket
+int threshold_tracker_scan(threshold_tracker_t *tracker, int event_type, const uint8_t *data, int len,
+                           threshold_alarm_fn emit, void *user);
+
+#endif // THRESHOLD_ALARM_H
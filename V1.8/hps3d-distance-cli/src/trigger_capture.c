@@ -0,0 +1,270 @@
+/*
+ * Vor-/Nachlauf-Aufzeichnung um Alarme und manuelle Auslöser
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "trigger_capture.h"
+
+static uint64_t timespec_us(const struct timespec *ts) {
+    return (uint64_t)ts->tv_sec * 1000000 + (uint64_t)ts->tv_nsec / 1000;
+}
+
+static uint64_t monotonic_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return timespec_us(&ts);
+}
+
+const char *trigger_source_name(trigger_source_t source) {
+    switch (source) {
+        case TRIGGER_SOURCE_ALARM: return "alarm";
+        case TRIGGER_SOURCE_MQTT:  return "mqtt";
+        case TRIGGER_SOURCE_HTTP:  return "http";
+        default:                   return "none";
+    }
+}
+
+int trigger_capture_init(trigger_capture_t *tc, uint32_t pre_frames, uint32_t post_frames, int packet_size,
+                         const char *dir, trigger_release_fn release, void *release_user) {
+    memset(tc, 0, sizeof(*tc));
+    tc->file = -1;
+    if (pre_frames == 0 || post_frames == 0 || packet_size <= 0 || !release) {
+        return -1;
+    }
+
+    tc->ring = calloc(pre_frames, sizeof(frame_buf_t *));
+    if (!tc->ring) {
+        return -1;
+    }
+    // Ein Puffer je Paket (Satzkopf + Rohdaten), dazu Dateikopf und Reserve
+    int buf_size = (int)sizeof(trigger_record_t) + packet_size;
+    if (buf_size < (int)sizeof(trigger_file_header_t)) {
+        buf_size = (int)sizeof(trigger_file_header_t);
+    }
+    if (async_writer_init(&tc->writer, NULL, pre_frames + post_frames + 2, buf_size, ASYNC_WRITER_AUTO) != 0) {
+        free(tc->ring);
+        tc->ring = NULL;
+        return -1;
+    }
+
+    tc->pre_frames = pre_frames;
+    tc->post_frames = post_frames;
+    tc->release = release;
+    tc->release_user = release_user;
+    snprintf(tc->dir, sizeof(tc->dir), "%s", dir && dir[0] ? dir : ".");
+    return 0;
+}
+
+// Paket als Satz in einen Schreibpuffer kopieren und einreichen
+static void submit_record(trigger_capture_t *tc, const frame_buf_t *buf, uint64_t trigger_us, uint32_t flags) {
+    frame_buf_t *out = async_writer_acquire(&tc->writer);
+    if (!out || (int)sizeof(trigger_record_t) + buf->len > out->capacity) {
+        if (out) {
+            // Zurück über den Writer, damit nur dessen Thread an den Pool gibt
+            out->len = 0;
+            async_writer_submit(&tc->writer, tc->file, out);
+        }
+        atomic_fetch_add_explicit(&tc->dropped, 1, memory_order_relaxed);
+        return;
+    }
+    trigger_record_t record = {
+        .len = (uint32_t)buf->len,
+        .event_type = buf->event_type,
+        .seq = buf->seq,
+        .flags = flags,
+        .rel_us = (int64_t)(timespec_us(&buf->received) - trigger_us),
+    };
+    memcpy(out->data, &record, sizeof(record));
+    memcpy(out->data + sizeof(record), buf->data, (size_t)buf->len);
+    out->len = (int)sizeof(record) + buf->len;
+    async_writer_submit(&tc->writer, tc->file, out);
+}
+
+void trigger_capture_poll(trigger_capture_t *tc) {
+    if (tc->file >= 0 && tc->post_left == 0 &&
+        atomic_load_explicit(&tc->writer.completed, memory_order_acquire) >= tc->close_after) {
+        async_writer_close(&tc->writer, tc->file);
+        tc->file = -1;
+    }
+}
+
+// Nachlauf beenden; die Datei wird geschlossen, sobald der Writer sie geschrieben hat
+static void finish_bundle(trigger_capture_t *tc) {
+    tc->post_left = 0;
+    tc->close_after = atomic_load(&tc->writer.submitted);
+    atomic_fetch_add_explicit(&tc->bundles, 1, memory_order_relaxed);
+    atomic_store(&tc->collecting, 0);
+    trigger_capture_poll(tc);
+}
+
+// Angeforderten Auslöser übernehmen: Datei anlegen, Vorlauf einfrieren
+static void start_bundle(trigger_capture_t *tc) {
+    trigger_capture_poll(tc);
+    if (tc->file >= 0) {
+        return;  // Vorige Datei noch nicht fertig geschrieben, beim nächsten Paket erneut
+    }
+    int source = atomic_exchange(&tc->request, 0);
+    if (source == TRIGGER_SOURCE_NONE) {
+        return;
+    }
+    uint64_t trigger_us = atomic_load(&tc->request_us);
+
+    struct timespec wall;
+    clock_gettime(CLOCK_REALTIME, &wall);
+    int64_t wall_ms = (int64_t)wall.tv_sec * 1000 + wall.tv_nsec / 1000000;
+    struct tm tm;
+    gmtime_r(&wall.tv_sec, &tm);
+    int n = snprintf(tc->path, sizeof(tc->path), "%s/trigger-%04d%02d%02d-%02d%02d%02d-%03d-%s" TRIGGER_FILE_SUFFIX,
+                     tc->dir, tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec,
+                     (int)(wall.tv_nsec / 1000000), trigger_source_name((trigger_source_t)source));
+    tc->file = (n > 0 && n < (int)sizeof(tc->path)) ? async_writer_open(&tc->writer, tc->path, 1) : -1;
+    frame_buf_t *head = tc->file >= 0 ? async_writer_acquire(&tc->writer) : NULL;
+    if (!head) {
+        if (tc->file >= 0) {
+            async_writer_close(&tc->writer, tc->file);
+            tc->file = -1;
+        }
+        atomic_fetch_add_explicit(&tc->failed, 1, memory_order_relaxed);
+        atomic_store(&tc->collecting, 0);
+        return;
+    }
+
+    trigger_file_header_t header = {
+        .version = TRIGGER_FILE_VERSION,
+        .header_size = sizeof(trigger_file_header_t),
+        .record_size = sizeof(trigger_record_t),
+        .source = (uint16_t)source,
+        .pre_frames = tc->count,
+        .post_frames = tc->post_frames,
+        .detail = atomic_load(&tc->request_detail),
+        .trigger_us = trigger_us,
+        .wall_ms = wall_ms,
+    };
+    memcpy(header.magic, TRIGGER_FILE_MAGIC, sizeof(header.magic));
+    memcpy(head->data, &header, sizeof(header));
+    head->len = (int)sizeof(header);
+    async_writer_submit(&tc->writer, tc->file, head);
+
+    // Vorlauf in Schreibpuffer kopieren; die Originale gehen zurück an ihren Pool
+    for (uint32_t i = 0; i < tc->count; i++) {
+        frame_buf_t *buf = tc->ring[(tc->head + i) % tc->pre_frames];
+        submit_record(tc, buf, trigger_us, 0);
+        tc->release(buf, tc->release_user);
+    }
+    tc->head = 0;
+    tc->count = 0;
+    tc->post_left = tc->post_frames;
+}
+
+void trigger_capture_push(trigger_capture_t *tc, frame_buf_t *buf) {
+    if (atomic_load_explicit(&tc->request, memory_order_relaxed) != TRIGGER_SOURCE_NONE) {
+        start_bundle(tc);
+    }
+    if (tc->post_left > 0) {
+        submit_record(tc, buf, atomic_load_explicit(&tc->request_us, memory_order_relaxed), TRIGGER_RECORD_POST);
+        if (--tc->post_left == 0) {
+            finish_bundle(tc);
+        }
+    } else if (tc->file >= 0) {
+        trigger_capture_poll(tc);
+    }
+
+    // Ring weiterführen, damit auch ein Auslöser direkt nach einer Aufnahme Vorlauf hat
+    if (tc->count == tc->pre_frames) {
+        tc->release(tc->ring[tc->head], tc->release_user);
+        tc->ring[tc->head] = buf;
+        tc->head = (tc->head + 1) % tc->pre_frames;
+    } else {
+        tc->ring[(tc->head + tc->count) % tc->pre_frames] = buf;
+        tc->count++;
+    }
+}
+
+void trigger_capture_drop_all(trigger_capture_t *tc) {
+    if (!tc->ring) {
+        return;
+    }
+    if (tc->post_left > 0) {
+        finish_bundle(tc);
+    }
+    for (uint32_t i = 0; i < tc->count; i++) {
+        tc->release(tc->ring[(tc->head + i) % tc->pre_frames], tc->release_user);
+    }
+    tc->head = 0;
+    tc->count = 0;
+}
+
+int trigger_capture_request(trigger_capture_t *tc, trigger_source_t source, uint32_t detail) {
+    if (!tc->ring || source == TRIGGER_SOURCE_NONE) {
+        return -1;
+    }
+    // collecting bleibt von der Anforderung bis zum Ende des Nachlaufs gesetzt
+    int expected = 0;
+    if (!atomic_compare_exchange_strong(&tc->collecting, &expected, 1)) {
+        return -1;
+    }
+    atomic_store(&tc->request_detail, detail);
+    atomic_store(&tc->request_us, monotonic_us());
+    atomic_store(&tc->request, (int)source);
+    return 0;
+}
+
+void trigger_capture_destroy(trigger_capture_t *tc) {
+    if (!tc->ring) {
+        return;
+    }
+    trigger_capture_drop_all(tc);
+    async_writer_flush(&tc->writer, TRIGGER_FLUSH_TIMEOUT_MS);
+    async_writer_destroy(&tc->writer);  // Schließt auch eine noch offene Datei
+    free(tc->ring);
+    tc->ring = NULL;
+    tc->file = -1;
+}
+
+int trigger_reader_open(trigger_reader_t *reader, const char *path) {
+    memset(reader, 0, sizeof(*reader));
+    reader->fp = fopen(path, "rb");
+    if (!reader->fp) {
+        return -1;
+    }
+    if (fread(&reader->header, sizeof(reader->header), 1, reader->fp) != 1 ||
+        memcmp(reader->header.magic, TRIGGER_FILE_MAGIC, sizeof(reader->header.magic)) != 0 ||
+        reader->header.version != TRIGGER_FILE_VERSION ||
+        reader->header.header_size < sizeof(trigger_file_header_t) ||
+        reader->header.record_size < sizeof(trigger_record_t) ||
+        fseek(reader->fp, reader->header.header_size, SEEK_SET) != 0) {
+        trigger_reader_close(reader);
+        return -1;
+    }
+    return 0;
+}
+
+int trigger_reader_next(trigger_reader_t *reader, trigger_record_t *record, uint8_t *data, int size) {
+    size_t got = fread(record, 1, sizeof(*record), reader->fp);
+    if (got == 0 && feof(reader->fp)) {
+        return 0;
+    }
+    if (got != sizeof(*record) || (int)record->len > size || record->len > (uint32_t)INT32_MAX) {
+        return -1;
+    }
+    // Neuere Versionen dürfen den Satzkopf verlängern
+    long extra = (long)reader->header.record_size - (long)sizeof(*record);
+    if (extra > 0 && fseek(reader->fp, extra, SEEK_CUR) != 0) {
+        return -1;
+    }
+    if (record->len > 0 && fread(data, record->len, 1, reader->fp) != 1) {
+        return -1;
+    }
+    return (int)record->len;
+}
+
+void trigger_reader_close(trigger_reader_t *reader) {
+    if (reader->fp) {
+        fclose(reader->fp);
+        reader->fp = NULL;
+    }
+}
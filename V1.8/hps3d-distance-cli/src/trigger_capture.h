@@ -0,0 +1,135 @@
+#ifndef TRIGGER_CAPTURE_H
+#define TRIGGER_CAPTURE_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include "async_writer.h"
+#include "frame_pool.h"
+
+/*
+ * Vor-/Nachlauf-Aufzeichnung um einen Auslöser (Zonenalarm, MQTT, HTTP).
+ *
+ * Im Normalbetrieb hält der Ring die letzten pre_frames Rohpakete selbst: es
+ * sind die Puffer aus dem Pool der Callback-Verteilung, die der Mess-Thread
+ * sonst sofort zurückgegeben hätte. Das älteste Paket geht über release()
+ * zurück an seinen Pool, sobald ein neues kommt - ohne Kopie, ohne Allokation.
+ * Der Pool der Verteilung muss dafür pre_frames Puffer mehr haben.
+ *
+ * Beim Auslösen wird der Vorlauf eingefroren: die Pakete werden einmal in
+ * Puffer des eigenen async_writer kopiert (damit der Verteilungs-Pool frei
+ * bleibt) und zusammen mit den nächsten post_frames Paketen asynchron in eine
+ * eigene Datei geschrieben. Der Mess-Thread wartet dabei nie auf die Platte.
+ *
+ * Dateiformat (native Byte-Reihenfolge, Felder natürlich ausgerichtet):
+ *   trigger_file_header_t
+ *   je Paket: trigger_record_t + len Bytes Rohpaket wie vom SDK geliefert
+ * Eine abgebrochene Aufnahme endet einfach früher; Leser lesen bis EOF.
+ *
+ * push/poll/drop_all nur aus dem Mess-Thread, request aus beliebigen Threads.
+ */
+
+#define TRIGGER_FILE_MAGIC "HPS3DTRG"
+#define TRIGGER_FILE_VERSION 1
+#define TRIGGER_FILE_SUFFIX ".h3t"
+#define TRIGGER_RECORD_POST 0x1         // Paket nach dem Auslöser
+#define TRIGGER_FLUSH_TIMEOUT_MS 2000
+
+typedef enum {
+    TRIGGER_SOURCE_NONE = 0,
+    TRIGGER_SOURCE_ALARM,
+    TRIGGER_SOURCE_MQTT,
+    TRIGGER_SOURCE_HTTP,
+} trigger_source_t;
+
+typedef struct {
+    char magic[8];                      // TRIGGER_FILE_MAGIC
+    uint16_t version;
+    uint16_t header_size;               // sizeof(trigger_file_header_t)
+    uint16_t record_size;               // sizeof(trigger_record_t)
+    uint16_t source;                    // trigger_source_t
+    uint32_t pre_frames;                // Eingefrorene Pakete vor dem Auslöser
+    uint32_t post_frames;               // Geplante Pakete danach
+    uint32_t detail;                    // Quelle: ROI-ID des Alarms, sonst 0
+    uint32_t reserved;
+    uint64_t trigger_us;                // CLOCK_MONOTONIC des Auslösers
+    int64_t wall_ms;                    // CLOCK_REALTIME des Auslösers
+} trigger_file_header_t;
+
+typedef struct {
+    uint32_t len;                       // Folgende Paketbytes
+    int32_t event_type;                 // HPS3D_EventType_t
+    uint32_t seq;                       // Laufende Nummer der Callback-Verteilung
+    uint32_t flags;                     // TRIGGER_RECORD_POST
+    int64_t rel_us;                     // Empfang relativ zum Auslöser (Vorlauf negativ)
+} trigger_record_t;
+
+typedef void (*trigger_release_fn)(frame_buf_t *buf, void *user);
+
+typedef struct {
+    frame_buf_t **ring;                 // Vorlauf, ältestes Paket bei head
+    uint32_t pre_frames;
+    uint32_t post_frames;
+    uint32_t head;
+    uint32_t count;
+    trigger_release_fn release;         // Paket an seinen Pool zurückgeben
+    void *release_user;
+    async_writer_t writer;
+    char dir[128];
+
+    // Laufende Aufnahme (nur Mess-Thread)
+    int file;                           // Datei-ID im Writer, -1 = keine offen
+    uint32_t post_left;
+    uint64_t close_after;               // Datei schließen, wenn so viele Puffer fertig sind
+    char path[192];                     // Zuletzt begonnene Datei
+
+    _Atomic int collecting;             // Nachlauf läuft
+    _Atomic int request;                // Angeforderte Quelle, 0 = keine
+    _Atomic uint32_t request_detail;
+    _Atomic uint64_t request_us;
+
+    _Atomic uint32_t bundles;           // Vollständig eingereichte Aufnahmen
+    _Atomic uint32_t dropped;           // Pakete ohne freien Schreibpuffer
+    _Atomic uint32_t failed;            // Aufnahmen, deren Datei nicht angelegt werden konnte
+} trigger_capture_t;
+
+// pre_frames/post_frames > 0; packet_size = größtes Rohpaket. Der eigene Pool
+// fasst einen kompletten Vor- und Nachlauf. Rückgabe 0 / -1
+int trigger_capture_init(trigger_capture_t *tc, uint32_t pre_frames, uint32_t post_frames, int packet_size,
+                         const char *dir, trigger_release_fn release, void *release_user);
+
+// Laufende Aufnahme abschließen, Writer leeren, gehaltene Pakete zurückgeben
+void trigger_capture_destroy(trigger_capture_t *tc);
+
+// Paket übernehmen (gehört danach dem Ring bzw. wird zurückgegeben)
+void trigger_capture_push(trigger_capture_t *tc, frame_buf_t *buf);
+
+// Fertig geschriebene Dateien schließen; regelmäßig aus dem Mess-Thread
+void trigger_capture_poll(trigger_capture_t *tc);
+
+// Alle gehaltenen Pakete zurückgeben (vor dem Trennen des Geräts); eine
+// laufende Aufnahme endet mit den bisher geschriebenen Paketen
+void trigger_capture_drop_all(trigger_capture_t *tc);
+
+// Auslöser setzen; die Aufnahme beginnt mit dem nächsten Paket.
+// Rückgabe 0, -1 wenn bereits eine Aufnahme angefordert ist oder läuft
+int trigger_capture_request(trigger_capture_t *tc, trigger_source_t source, uint32_t detail);
+
+const char *trigger_source_name(trigger_source_t source);
+
+// Aufzeichnung lesen (Replay, Tests)
+typedef struct {
+    FILE *fp;
+    trigger_file_header_t header;
+} trigger_reader_t;
+
+// Rückgabe 0, -1 wenn die Datei fehlt oder kein Trigger-Bundle ist
+int trigger_reader_open(trigger_reader_t *reader, const char *path);
+
+// Nächstes Paket nach data; Rückgabe: Paketlänge, 0 am Ende, -1 bei Fehler
+// (abgeschnittenes Paket oder größer als size)
+int trigger_reader_next(trigger_reader_t *reader, trigger_record_t *record, uint8_t *data, int size);
+
+void trigger_reader_close(trigger_reader_t *reader);
+
+#endif // TRIGGER_CAPTURE_H
@@ -0,0 +1,132 @@
+/*
+ * Benchmark: freilaufende vs. versetzte Aufnahmen mehrerer Sensoren an einem Bus
+ *
+ * Simuliert SENSORS Sensoren als Threads an einem gemeinsamen USB-Bus. Eine
+ * Übertragung belegt den Bus für die Transferzeit des Sensors; wer auf einen
+ * belegten Bus trifft, wartet und zahlt zusätzlich COLLISION_PENALTY der
+ * eigenen Transferzeit (Wiederholungen, NAKs, Umschalten im Controller).
+ *
+ * freilaufend: Aufnahme, dann Intervall schlafen (wie die Mess-Schleife ohne
+ *              capture_bus)
+ * versetzt:    capture_sched_wait/begin/end über eine gemeinsame Bus-Tabelle
+ *
+ * Ausgabe je Modus: Gesamt-fps und je Sensor Mittelwert und
+ * Standardabweichung der Latenz (Anforderung bis Daten da).
+ *
+ * Usage: ./bench_capture_sched [sekunden]
+ */
+
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "capture_scheduler.h"
+
+#define SENSORS 3
+#define INTERVAL_MS 50
+#define COLLISION_PENALTY 0.3
+
+static const uint32_t transfer_us[SENSORS] = {12000, 15000, 18000};
+
+static pthread_mutex_t bus = PTHREAD_MUTEX_INITIALIZER;
+static volatile int stop;
+static char bus_path[128];
+
+typedef struct {
+    int id;
+    int scheduled;
+    uint64_t frames;
+    double sum_us;
+    double sum_sq_us;
+} sensor_t;
+
+static void sleep_us(uint64_t us) {
+    struct timespec ts = { .tv_sec = (time_t)(us / 1000000), .tv_nsec = (long)(us % 1000000) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+// Eine Übertragung auf dem simulierten Bus; Rückgabe: Latenz in µs
+static uint64_t transfer(int id) {
+    uint64_t start = capture_now_us();
+    uint64_t cost = transfer_us[id];
+    if (pthread_mutex_trylock(&bus) != 0) {
+        pthread_mutex_lock(&bus);
+        cost += (uint64_t)(transfer_us[id] * COLLISION_PENALTY);
+    }
+    sleep_us(cost);
+    pthread_mutex_unlock(&bus);
+    return capture_now_us() - start;
+}
+
+static void *sensor_thread(void *arg) {
+    sensor_t *s = arg;
+    capture_sched_t sched;
+    if (s->scheduled && capture_sched_attach(&sched, bus_path, 0) != 0) {
+        perror("capture_sched_attach");
+        return NULL;
+    }
+    while (!stop) {
+        if (s->scheduled) {
+            capture_sched_wait(&sched, INTERVAL_MS);
+            capture_sched_begin(&sched);
+        }
+        uint64_t latency = transfer(s->id);
+        if (s->scheduled) {
+            capture_sched_end(&sched, 1);
+        } else {
+            sleep_us(INTERVAL_MS * 1000);
+        }
+        s->frames++;
+        s->sum_us += (double)latency;
+        s->sum_sq_us += (double)latency * (double)latency;
+    }
+    if (s->scheduled) {
+        capture_sched_detach(&sched);
+    }
+    return NULL;
+}
+
+static void run(int scheduled, int seconds) {
+    pthread_t threads[SENSORS];
+    sensor_t sensors[SENSORS] = {0};
+    stop = 0;
+    for (int i = 0; i < SENSORS; i++) {
+        sensors[i].id = i;
+        sensors[i].scheduled = scheduled;
+        pthread_create(&threads[i], NULL, sensor_thread, &sensors[i]);
+    }
+    sleep((unsigned)seconds);
+    stop = 1;
+
+    uint64_t frames = 0;
+    for (int i = 0; i < SENSORS; i++) {
+        pthread_join(threads[i], NULL);
+        frames += sensors[i].frames;
+    }
+    printf("%-12s aggregate %6.1f fps\n", scheduled ? "scheduled" : "free-running", (double)frames / seconds);
+    for (int i = 0; i < SENSORS; i++) {
+        sensor_t *s = &sensors[i];
+        double n = s->frames ? (double)s->frames : 1.0;
+        double mean = s->sum_us / n;
+        double var = s->sum_sq_us / n - mean * mean;
+        printf("  sensor %d  transfer %5.1f ms  latency %6.2f ms  stddev %6.2f ms  (%llu frames)\n",
+               i, transfer_us[i] / 1000.0, mean / 1000.0, sqrt(var > 0 ? var : 0) / 1000.0,
+               (unsigned long long)s->frames);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    int seconds = (argc > 1) ? atoi(argv[1]) : 3;
+    if (seconds <= 0) {
+        seconds = 3;
+    }
+    snprintf(bus_path, sizeof(bus_path), "/tmp/bench_capture_bus_%d", (int)getpid());
+
+    printf("# %d Sensoren, Intervall %d ms, %d s je Modus\n", SENSORS, INTERVAL_MS, seconds);
+    run(0, seconds);
+    run(1, seconds);
+    unlink(bus_path);
+    return 0;
+}
@@ -0,0 +1,78 @@
+/*
+ * Benchmark: bounds-checked packet_parse() vs. unchecked packet_decode()
+ *
+ * Validation runs once per packet before the unchecked body loop, so the
+ * checked path should be within measurement noise of the raw decoder.
+ * Reports the best-of-N time per packet for both variants.
+ *
+ * Usage: ./bench_packet_parser [packets_per_round]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "packet_builder.h"
+
+#define ROUNDS 9
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static double run_round(const uint8_t *packet, int len, HPS3D_EventType_t type,
+                        HPS3D_MeasureData_t *data, int checked, int packets) {
+    double start = now_ns();
+    for (int i = 0; i < packets; i++) {
+        int ret = checked ? packet_parse(packet, len, data, type)
+                          : packet_decode(packet, data, type);
+        if (ret != len) {
+            fprintf(stderr, "Unexpected decode result %d\n", ret);
+            exit(1);
+        }
+    }
+    return (now_ns() - start) / packets;
+}
+
+static void bench(const char *name, const uint8_t *packet, int len, HPS3D_EventType_t type,
+                  HPS3D_MeasureData_t *data, int packets) {
+    double best_raw = 1e30, best_checked = 1e30;
+
+    // Abwechselnd messen, damit Frequenz-/Cache-Effekte beide Varianten gleich treffen
+    for (int r = 0; r < ROUNDS; r++) {
+        double raw = run_round(packet, len, type, data, 0, packets);
+        double checked = run_round(packet, len, type, data, 1, packets);
+        if (raw < best_raw) best_raw = raw;
+        if (checked < best_checked) best_checked = checked;
+    }
+
+    printf("%-12s %8d B  unchecked %10.1f ns  checked %10.1f ns  overhead %+6.2f%%\n",
+           name, len, best_raw, best_checked, (best_checked - best_raw) / best_raw * 100.0);
+}
+
+int main(int argc, char *argv[]) {
+    int packets = (argc > 1) ? atoi(argv[1]) : 200;
+    static uint8_t packet[PACKET_FULL_DEPTH_SIZE];
+    static const uint32_t roi_pixels[HPS3D_MAX_ROI_NUMBER] = {25, 25, 100, 100, 400, 400, 1600, 1600};
+    HPS3D_MeasureData_t data;
+
+    if (packets <= 0 || pb_measure_data_alloc(&data) != 0) {
+        fprintf(stderr, "Setup failed\n");
+        return 1;
+    }
+
+    printf("=== Packet Parser Benchmark (%d packets/round, best of %d) ===\n", packets, ROUNDS);
+
+    int len = pb_full_depth(packet, 1500, 1);
+    bench("full_depth", packet, len, HPS3D_FULL_DEPTH_EVEN, &data, packets);
+
+    len = pb_full_roi(packet, HPS3D_MAX_ROI_NUMBER, roi_pixels);
+    bench("full_roi", packet, len, HPS3D_FULL_ROI_EVEN, &data, packets * 10);
+
+    len = pb_simple_roi(packet, HPS3D_MAX_ROI_NUMBER);
+    bench("simple_roi", packet, len, HPS3D_SIMPLE_ROI_EVEN, &data, packets * 1000);
+
+    pb_measure_data_free(&data);
+    return 0;
+}
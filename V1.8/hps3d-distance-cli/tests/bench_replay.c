@@ -0,0 +1,267 @@
+/*
+ * Replay-Workload: Dekodieren, Auswertung und Serialisierung wie im Service
+ *
+ * Erzeugt einmalig eine feste Sequenz synthetischer Full-Depth-Pakete
+ * (schräger Boden, wandernder Quader, Rauschen, ungültige Pixel) und spielt
+ * sie danach wiederholt durch dieselben Module wie der Service. Dient als
+ * Trainingslauf für make pgo und als Messung für den Vergleichsbericht.
+ *
+ * Statt der synthetischen Sequenz kann eine Trigger-Aufnahme (.h3t) vom
+ * Sensor dienen; verwendet werden deren Full-Depth-Pakete.
+ *
+ * Ausgabe: eine Zeile "stage <name> <ns pro Frame>" je Stufe (bester von
+ * ROUNDS Durchläufen), damit Berichte per awk verglichen werden können.
+ *
+ * Usage: ./bench_replay [frames] [aufnahme.h3t]
+ */
+
+#ifndef _GNU_SOURCE
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "packet_builder.h"
+#include "sensor_geometry.h"
+#include "region.h"
+#include "change_gate.h"
+#include "burst.h"
+#include "roi_stats.h"
+#include "pointcloud.h"
+#include "cloud_analytics.h"
+#include "serialize.h"
+#include "trigger_capture.h"
+
+#define ROUNDS 5
+#define SEQUENCE_FRAMES 32      // Verschiedene Frames der Aufnahme
+#define REGION_POINTS 16
+#define BURST_FRAMES 10
+#define ROI_SIZE 20
+#define RANSAC_ITERATIONS 32
+#define JSON_SIZE (SENSOR_PIXELS * 50)
+
+enum { ST_GATE, ST_DECODE, ST_DECODE_SOA, ST_REGIONS, ST_BURST, ST_CLOUD, ST_SERIALIZE, ST_COUNT };
+static const char *stage_names[ST_COUNT] = {
+    "gate", "decode", "decode_soa", "regions", "burst", "cloud", "serialize"
+};
+
+static uint8_t *sequence[SEQUENCE_FRAMES];
+static int sequence_len[SEQUENCE_FRAMES];
+static int sequence_count = SEQUENCE_FRAMES;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+// Deterministischer Generator, damit jeder Lauf dieselbe Aufnahme sieht
+static uint32_t rng_state = 12345;
+static uint32_t rng_next(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+static int build_frame(uint8_t *buf, int frame) {
+    static uint16_t distance[SENSOR_PIXELS];
+    uint32_t sum = 0, count = 0;
+    uint16_t min = 0xFFFF;
+    int box_x = 10 + (frame * 4) % (SENSOR_WIDTH - 40);
+
+    for (int y = 0; y < SENSOR_HEIGHT; y++) {
+        for (int x = 0; x < SENSOR_WIDTH; x++) {
+            uint32_t r = rng_next();
+            uint16_t d = (uint16_t)(1500 + y * 20 + (r % 7));
+            if (x >= box_x && x < box_x + 24 && y >= 15 && y < 45) {
+                d = (uint16_t)(900 + (r % 5));
+            }
+            if ((r >> 12) % 100 < 3) {
+                d = HPS3D_LOW_AMPLITUDE;
+            }
+            distance[y * SENSOR_WIDTH + x] = d;
+            if (region_pixel_valid(d)) {
+                sum += d;
+                count++;
+                min = d < min ? d : min;
+            }
+        }
+    }
+
+    uint8_t *p = buf;
+    p = pb_put16(p, (uint16_t)(count ? sum / count : 0));
+    p = pb_put16(p, min);
+    p = pb_put16(p, 0);
+    p = pb_put32(p, (uint32_t)frame);
+    p = pb_put16(p, SENSOR_WIDTH);
+    p = pb_put16(p, SENSOR_HEIGHT);
+    p = pb_put16(p, HPS3D_MAX_PIXEL_NUMBER);
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        p = pb_put16(p, distance[i]);
+    }
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        int valid = region_pixel_valid(distance[i]);
+        int32_t z = valid ? (int32_t)distance[i] * 100 : 0;
+        p = pb_put32(p, (uint32_t)(((i % SENSOR_WIDTH) - SENSOR_WIDTH / 2) * z / 110));
+        p = pb_put32(p, (uint32_t)(((i / SENSOR_WIDTH) - SENSOR_HEIGHT / 2) * z / 110));
+        p = pb_put32(p, (uint32_t)z);
+    }
+    return (int)(p - buf);
+}
+
+// Full-Depth-Pakete einer Trigger-Aufnahme als Sequenz übernehmen; Rückgabe: Anzahl
+static int load_bundle(const char *path) {
+    trigger_reader_t reader;
+    trigger_record_t record;
+    if (trigger_reader_open(&reader, path) != 0) {
+        return 0;
+    }
+    int count = 0;
+    while (count < SEQUENCE_FRAMES &&
+           trigger_reader_next(&reader, &record, sequence[count], PACKET_MAX_SIZE) > 0) {
+        if (record.event_type == HPS3D_FULL_DEPTH_EVEN) {
+            sequence_len[count++] = (int)record.len;
+        }
+    }
+    trigger_reader_close(&reader);
+    return count;
+}
+
+int main(int argc, char *argv[]) {
+    int frames = (argc > 1) ? atoi(argv[1]) : 200;
+    HPS3D_MeasureData_t data;
+    pointcloud_soa_t cloud, reduced;
+    cloud_voxel_workspace_t ws;
+    burst_buffer_t burst;
+    change_gate_t gate;
+    static uint16_t scratch[ROI_SIZE * ROI_SIZE];
+    static uint16_t roi_pixels[ROI_SIZE * ROI_SIZE];
+    char *json = malloc(JSON_SIZE);
+
+    if (frames <= 0 || !json || pb_measure_data_alloc(&data) != 0 ||
+        pointcloud_soa_init(&cloud, SENSOR_PIXELS) != 0 || pointcloud_soa_init(&reduced, SENSOR_PIXELS) != 0 ||
+        cloud_voxel_workspace_init(&ws, SENSOR_PIXELS) != 0 ||
+        burst_init(&burst, BURST_MAX_FRAMES, SENSOR_PIXELS) != 0) {
+        fprintf(stderr, "Setup failed\n");
+        return 1;
+    }
+    for (int i = 0; i < SEQUENCE_FRAMES; i++) {
+        sequence[i] = malloc(PACKET_MAX_SIZE);
+        if (!sequence[i]) {
+            fprintf(stderr, "Setup failed\n");
+            return 1;
+        }
+        sequence_len[i] = build_frame(sequence[i], i);
+    }
+    if (argc > 2) {
+        sequence_count = load_bundle(argv[2]);
+        if (sequence_count == 0) {
+            fprintf(stderr, "%s: keine Full-Depth-Pakete\n", argv[2]);
+            return 1;
+        }
+        fprintf(stderr, "Replay von %d Paketen aus %s\n", sequence_count, argv[2]);
+    }
+    change_gate_init(&gate);
+    gate.enabled = 1;
+    gate.use_samples = 1;
+
+    double best[ST_COUNT];
+    for (int s = 0; s < ST_COUNT; s++) {
+        best[s] = 1e30;
+    }
+    long checksum = 0;  // Verhindert, dass der Compiler Ergebnisse verwirft
+
+    for (int round = 0; round < ROUNDS; round++) {
+        double total[ST_COUNT] = {0};
+        change_gate_reset(&gate);
+        burst_reset(&burst);
+
+        for (int f = 0; f < frames; f++) {
+            const uint8_t *packet = sequence[f % sequence_count];
+            int len = sequence_len[f % sequence_count];
+            double t0 = now_ns();
+
+            checksum += change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN);
+            double t1 = now_ns();
+
+            if (packet_parse(packet, len, &data, HPS3D_FULL_DEPTH_EVEN) != len) {
+                fprintf(stderr, "Decode failed\n");
+                return 1;
+            }
+            double t2 = now_ns();
+
+            packet_parse_full_depth_soa(packet, len, &data.full_depth_data, &cloud);
+            double t3 = now_ns();
+
+            const uint16_t *distance = data.full_depth_data.distance;
+            for (int i = 0; i < REGION_POINTS; i++) {
+                region_stats_t stats;
+                region_stats(distance, SENSOR_WIDTH, 4 + (i % 8) * 19, 4 + (i / 8) * 40, 5, 5, &stats);
+                checksum += stats.count;
+            }
+            for (int y = 0; y < ROI_SIZE; y++) {
+                memcpy(roi_pixels + y * ROI_SIZE, distance + (20 + y) * SENSOR_WIDTH + 70,
+                       ROI_SIZE * sizeof(uint16_t));
+            }
+            roi_robust_t robust;
+            checksum += roi_robust_stats(roi_pixels, ROI_SIZE * ROI_SIZE, ROI_DEFAULT_OUTLIER_K, scratch, &robust);
+            double t4 = now_ns();
+
+            uint16_t *plane = burst_next_frame(&burst);
+            if (plane) {
+                memcpy(plane, distance, SENSOR_PIXELS * sizeof(uint16_t));
+                burst_commit_frame(&burst);
+            }
+            if (burst.count == BURST_FRAMES) {
+                burst_region_t region;
+                burst_merge(&burst, (f / BURST_FRAMES) & 1 ? BURST_MEDIAN : BURST_MEAN, BURST_FRAMES / 2);
+                burst_region(&burst, SENSOR_WIDTH, 78, 28, 5, 5, &region);
+                checksum += region.valid_pixels;
+                burst_reset(&burst);
+            }
+            double t5 = now_ns();
+
+            cloud_plane_t fit;
+            checksum += cloud_voxel_downsample(&cloud, 50.0f, &ws, &reduced);
+            checksum += cloud_ransac_plane(&reduced, RANSAC_ITERATIONS, 20.0f, (uint32_t)f, &fit);
+            double t6 = now_ns();
+
+            checksum += serialize_cloud_json(distance, NULL, SENSOR_WIDTH, SENSOR_HEIGHT, 0, json, JSON_SIZE, NULL);
+            double t7 = now_ns();
+
+            total[ST_GATE] += t1 - t0;
+            total[ST_DECODE] += t2 - t1;
+            total[ST_DECODE_SOA] += t3 - t2;
+            total[ST_REGIONS] += t4 - t3;
+            total[ST_BURST] += t5 - t4;
+            total[ST_CLOUD] += t6 - t5;
+            total[ST_SERIALIZE] += t7 - t6;
+        }
+
+        for (int s = 0; s < ST_COUNT; s++) {
+            if (total[s] / frames < best[s]) {
+                best[s] = total[s] / frames;
+            }
+        }
+    }
+
+    printf("# Replay-Workload: %d Frames x %d Runden, bester Lauf (checksum %ld)\n", frames, ROUNDS, checksum);
+    double sum = 0;
+    for (int s = 0; s < ST_COUNT; s++) {
+        printf("stage %-10s %12.1f\n", stage_names[s], best[s]);
+        sum += best[s];
+    }
+    printf("stage %-10s %12.1f\n", "total", sum);
+
+    for (int i = 0; i < SEQUENCE_FRAMES; i++) {
+        free(sequence[i]);
+    }
+    free(json);
+    burst_free(&burst);
+    cloud_voxel_workspace_free(&ws);
+    pointcloud_soa_free(&reduced);
+    pointcloud_soa_free(&cloud);
+    pb_measure_data_free(&data);
+    return 0;
+}
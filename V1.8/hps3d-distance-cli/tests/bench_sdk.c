@@ -0,0 +1,158 @@
+/*
+ * Benchmark: HPS3DAPI throughput, latency and CPU cost against the pty emulator
+ *
+ * Starts device_emulator in-process, connects through HPS3D_USBConnectDevice
+ * and streams for the given time. Each callback decodes the packet with
+ * HPS3D_ConvertToMeasureDataChecked like the service does. Latency is measured
+ * from the moment the emulator starts writing a frame to the callback.
+ * Host CPU is the process CPU time minus that of the emulator thread.
+ *
+ * Built against the open serial transport (src/hps3d_open_api.c). The
+ * emulator speaks that transport's own framing, not the device protocol, so
+ * libHPS3DSDK64 cannot be measured with this harness.
+ *
+ * Ausgabe: eine Zeile "sdk <api> fps ... p50_ms ... p99_ms ... max_ms ...
+ * host_cpu_pct ... dropped ..." zum Vergleich per awk.
+ *
+ * Usage: ./bench_sdk [sekunden] [rate_hz] [aufnahme.h3t]
+ *   rate_hz: -1 = so schnell wie möglich (Standard), 0 = Zeitbasis der Aufnahme
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "HPS3DUser_IF.h"
+#include "packet_builder.h"
+#include "device_emulator.h"
+
+#define API_NAME "open"
+
+#define SEQUENCE_FRAMES 32
+#define MAX_SAMPLES (1 << 20)
+
+static device_emulator_t emu;
+static HPS3D_MeasureData_t measure;
+static uint32_t *latency_us;
+static _Atomic uint64_t received;
+static _Atomic uint64_t decode_errors;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t cpu_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void on_event(int handle, int type, uint8_t *data, int len, void *user) {
+    (void)handle;
+    (void)user;
+    uint64_t t = now_ns();
+    if (type == HPS3D_DISCONNECT_EVEN || type == HPS3D_SYS_EXCEPTION_EVEN) {
+        return;
+    }
+    if (HPS3D_ConvertToMeasureDataChecked(data, len, &measure, (HPS3D_EventType_t)type) <= 0) {
+        atomic_fetch_add(&decode_errors, 1);
+    }
+    // Callbacks arrive in send order; a lost frame shifts the pairing, counted as dropped
+    uint64_t index = atomic_fetch_add(&received, 1);
+    uint64_t sent = device_emulator_stamp(&emu, index);
+    if (sent && index < MAX_SAMPLES) {
+        latency_us[index] = (uint32_t)((t - sent) / 1000);
+    }
+}
+
+static int cmp_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t *)a;
+    uint32_t y = *(const uint32_t *)b;
+    return (x > y) - (x < y);
+}
+
+int main(int argc, char **argv) {
+    int seconds = argc > 1 ? atoi(argv[1]) : 5;
+    double rate = argc > 2 ? atof(argv[2]) : -1.0;
+    const char *bundle = argc > 3 ? argv[3] : NULL;
+
+    emu_config_t cfg;
+    device_emulator_defaults(&cfg);
+    cfg.rate_hz = rate;
+    device_emulator_init(&emu, &cfg);
+    if (bundle) {
+        if (device_emulator_load(&emu, bundle) <= 0) {
+            fprintf(stderr, "%s: keine verwendbare Trigger-Aufnahme\n", bundle);
+            return 1;
+        }
+    } else {
+        static uint8_t packet[PACKET_FULL_DEPTH_SIZE];
+        for (int i = 0; i < SEQUENCE_FRAMES; i++) {
+            int len = pb_full_depth(packet, (uint16_t)(1000 + 10 * i), (uint32_t)i);
+            device_emulator_add_frame(&emu, HPS3D_FULL_DEPTH_EVEN, packet, len, (int64_t)i * 66667);
+        }
+    }
+
+    latency_us = calloc(MAX_SAMPLES, sizeof(*latency_us));
+    if (!latency_us || HPS3D_MeasureDataInit(&measure) != HPS3D_RET_OK || device_emulator_start(&emu) != 0) {
+        fprintf(stderr, "setup failed\n");
+        return 1;
+    }
+
+    printf("# %s API, %d s, rate %s, %d packets%s\n", API_NAME, seconds,
+           rate < 0 ? "unthrottled" : rate == 0 ? "recorded" : argv[2], emu.count, bundle ? "" : " (synthetic)");
+    fflush(stdout);
+
+    HPS3D_RegisterEventCallback(on_event, NULL);
+    int handle = -1;
+    if (HPS3D_USBConnectDevice(emu.slave, &handle) != HPS3D_RET_OK) {
+        fprintf(stderr, "connect to %s failed (framing does not match this API?)\n", emu.slave);
+        device_emulator_destroy(&emu);
+        return 1;
+    }
+
+    clockid_t process = CLOCK_PROCESS_CPUTIME_ID;
+    uint64_t cpu0 = cpu_ns(process) - cpu_ns(emu.cpu_clock);
+    uint64_t t0 = now_ns();
+    if (HPS3D_StartCapture(handle) != HPS3D_RET_OK) {
+        fprintf(stderr, "start failed\n");
+        HPS3D_CloseDevice(handle);
+        device_emulator_destroy(&emu);
+        return 1;
+    }
+    sleep((unsigned)seconds);
+    HPS3D_StopCapture(handle);
+    uint64_t wall = now_ns() - t0;
+    uint64_t cpu = cpu_ns(process) - cpu_ns(emu.cpu_clock) - cpu0;
+    usleep(100000);     // Frames still on the line
+
+    uint64_t frames = atomic_load(&received);
+    uint64_t sent = atomic_load(&emu.sent);
+    uint64_t samples = frames < MAX_SAMPLES ? frames : MAX_SAMPLES;
+    uint32_t p50 = 0, p99 = 0, max = 0;
+    if (samples) {
+        qsort(latency_us, samples, sizeof(*latency_us), cmp_u32);
+        p50 = latency_us[samples / 2];
+        p99 = latency_us[samples * 99 / 100];
+        max = latency_us[samples - 1];
+    }
+    printf("sdk %s fps %.1f p50_ms %.3f p99_ms %.3f max_ms %.3f host_cpu_pct %.1f dropped %llu decode_errors %llu\n",
+           API_NAME, (double)frames * 1e9 / (double)wall, p50 / 1e3, p99 / 1e3, max / 1e3,
+           100.0 * (double)cpu / (double)wall, (unsigned long long)(sent - frames),
+           (unsigned long long)atomic_load(&decode_errors));
+
+    HPS3D_CloseDevice(handle);
+    HPS3D_UnregisterEventCallback();
+    device_emulator_destroy(&emu);
+    HPS3D_MeasureDataFree(&measure);
+    free(latency_us);
+    return 0;
+}
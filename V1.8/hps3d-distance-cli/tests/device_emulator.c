@@ -0,0 +1,410 @@
+/*
+ * HPS3D device emulator on a pseudo-terminal, see device_emulator.h
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <termios.h>
+#include <unistd.h>
+#include "device_emulator.h"
+#include "packet_parser.h"
+#include "trigger_capture.h"
+
+#define EMU_COMMAND_BUF 256
+#define EMU_WRITE_TIMEOUT_MS 1000       // Host not reading for this long: stop streaming
+#define EMU_IDLE_POLL_MS 20
+#define EMU_DEFAULT_GAP_US 66667        // Recorded timing with a single frame: 15 Hz
+
+// Exported settings, in HPS3D_DeviceSettings_t order (16 x int32 BE)
+enum {
+    SET_USER_ID, SET_RES_X, SET_RES_Y, SET_ROI_GROUPS, SET_ROIS, SET_THRESHOLDS, SET_CAMERA_CODES,
+    SET_DIST_FILTER, SET_DIST_FILTER_K, SET_SMOOTH_TYPE, SET_SMOOTH_ARGS, SET_GROUP_ID,
+    SET_CAMERA_CODE, SET_DIST_OFFSET, SET_OPTICAL_PATH, SET_EDGE_FILTER, SET_COUNT
+};
+
+typedef struct {
+    int cursor;                         // Next frame for stream and single capture
+    uint32_t burst;                     // Stream frames since START
+    uint64_t deadline;                  // Send time of the next stream frame
+    uint64_t gap;                       // Planned distance to the previous frame
+    uint32_t settings[SET_COUNT];
+} emu_state_t;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void put32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+void device_emulator_defaults(emu_config_t *cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    cfg->framing = &WIRE_FRAMING_DEFAULT;
+    cfg->rate_hz = 0.0;
+    cfg->speed = 1.0;
+    cfg->loop = 1;
+    cfg->version = "HPS3D160-EMU 1.8";
+    cfg->serial = "EMU-0001";
+}
+
+void device_emulator_init(device_emulator_t *emu, const emu_config_t *cfg) {
+    memset(emu, 0, sizeof(*emu));
+    emu->cfg = *cfg;
+    if (!emu->cfg.framing) {
+        emu->cfg.framing = &WIRE_FRAMING_DEFAULT;
+    }
+    if (emu->cfg.speed <= 0.0) {
+        emu->cfg.speed = 1.0;
+    }
+    emu->master = -1;
+    emu->slave_fd = -1;
+}
+
+int device_emulator_add_frame(device_emulator_t *emu, int32_t event_type, const uint8_t *data, int len,
+                              int64_t rel_us) {
+    if (len <= 0 || len > PACKET_MAX_SIZE) {
+        return -1;
+    }
+    if (emu->count == emu->capacity) {
+        int capacity = emu->capacity ? emu->capacity * 2 : 64;
+        emu_frame_t *frames = realloc(emu->frames, (size_t)capacity * sizeof(*frames));
+        if (!frames) {
+            return -1;
+        }
+        emu->frames = frames;
+        emu->capacity = capacity;
+    }
+    emu_frame_t *frame = &emu->frames[emu->count];
+    frame->data = malloc((size_t)len);
+    if (!frame->data) {
+        return -1;
+    }
+    memcpy(frame->data, data, (size_t)len);
+    frame->len = len;
+    frame->event_type = event_type;
+    frame->rel_us = rel_us;
+    emu->count++;
+    return 0;
+}
+
+int device_emulator_load(device_emulator_t *emu, const char *path) {
+    trigger_reader_t reader;
+    if (trigger_reader_open(&reader, path) != 0) {
+        return -1;
+    }
+    uint8_t *data = malloc(PACKET_MAX_SIZE);
+    if (!data) {
+        trigger_reader_close(&reader);
+        return -1;
+    }
+    int loaded = 0;
+    trigger_record_t record;
+    int len;
+    while ((len = trigger_reader_next(&reader, &record, data, PACKET_MAX_SIZE)) > 0) {
+        if (device_emulator_add_frame(emu, record.event_type, data, len, record.rel_us) != 0) {
+            loaded = -1;
+            break;
+        }
+        loaded++;
+    }
+    if (len < 0) {
+        loaded = -1;
+    }
+    free(data);
+    trigger_reader_close(&reader);
+    return loaded;
+}
+
+static void reply(device_emulator_t *emu, uint8_t cmd, uint8_t status, const void *payload, uint32_t len) {
+    if (wire_write_frame(emu->master, emu->cfg.framing, cmd, status, payload, len, EMU_WRITE_TIMEOUT_MS) != 0) {
+        atomic_fetch_add(&emu->write_errors, 1);
+    }
+}
+
+// Distance to the frame after frame i in ns; with a fixed rate the period
+static uint64_t next_gap(const device_emulator_t *emu, int i) {
+    if (emu->cfg.rate_hz > 0.0) {
+        return (uint64_t)(1e9 / emu->cfg.rate_hz);
+    }
+    if (emu->cfg.rate_hz < 0.0) {
+        return 0;
+    }
+    int64_t gap_us;
+    if (i + 1 < emu->count) {
+        gap_us = emu->frames[i + 1].rel_us - emu->frames[i].rel_us;
+    } else if (emu->count > 1) {
+        // Wrap around: mean distance of the recording
+        gap_us = (emu->frames[emu->count - 1].rel_us - emu->frames[0].rel_us) / (emu->count - 1);
+    } else {
+        gap_us = EMU_DEFAULT_GAP_US;
+    }
+    if (gap_us < 0) {
+        gap_us = 0;
+    }
+    return (uint64_t)((double)gap_us * 1000.0 / emu->cfg.speed);
+}
+
+static void handle_command(device_emulator_t *emu, emu_state_t *st, const frame_buf_t *buf) {
+    const wire_framing_t *f = emu->cfg.framing;
+    uint8_t cmd = wire_frame_cmd(f, buf);
+    const uint8_t *p = wire_frame_payload(f, buf);
+    int len = wire_frame_payload_len(f, buf);
+    atomic_fetch_add(&emu->commands, 1);
+
+    switch (cmd) {
+        case WIRE_CMD_HELLO:
+            // New host session: whatever the previous one left running stops
+            atomic_store(&emu->streaming, 0);
+            reply(emu, cmd, WIRE_STATUS_OK, emu->cfg.version, (uint32_t)strlen(emu->cfg.version));
+            return;
+        case WIRE_CMD_SERIAL:
+            reply(emu, cmd, WIRE_STATUS_OK, emu->cfg.serial, (uint32_t)strlen(emu->cfg.serial));
+            return;
+        case WIRE_CMD_START:
+            if (emu->count == 0) {
+                reply(emu, cmd, WIRE_STATUS_ERROR, NULL, 0);
+                return;
+            }
+            reply(emu, cmd, WIRE_STATUS_OK, NULL, 0);
+            st->burst = 0;
+            st->gap = 0;
+            st->deadline = now_ns();
+            atomic_store(&emu->streaming, 1);
+            return;
+        case WIRE_CMD_STOP:
+            atomic_store(&emu->streaming, 0);
+            reply(emu, cmd, WIRE_STATUS_OK, NULL, 0);
+            return;
+        case WIRE_CMD_SINGLE: {
+            if (emu->count == 0) {
+                reply(emu, cmd, WIRE_STATUS_ERROR, NULL, 0);
+                return;
+            }
+            const emu_frame_t *frame = &emu->frames[st->cursor];
+            st->cursor = (st->cursor + 1) % emu->count;
+            reply(emu, cmd, (uint8_t)frame->event_type, frame->data, (uint32_t)frame->len);
+            return;
+        }
+        case WIRE_CMD_EXPORT: {
+            uint8_t out[SET_COUNT * 4];
+            for (int i = 0; i < SET_COUNT; i++) {
+                put32(out + 4 * i, st->settings[i]);
+            }
+            reply(emu, cmd, WIRE_STATUS_OK, out, sizeof(out));
+            return;
+        }
+        default:
+            break;
+    }
+
+    // Setters: remember the value so EXPORT reflects it
+    int ok = 1;
+    switch (cmd) {
+        case WIRE_CMD_USER_ID:          ok = len >= 1; if (ok) st->settings[SET_USER_ID] = p[0]; break;
+        case WIRE_CMD_ROI_GROUP:        ok = len >= 1; if (ok) st->settings[SET_GROUP_ID] = p[0]; break;
+        case WIRE_CMD_CAMERA_CODE:      ok = len >= 1; if (ok) st->settings[SET_CAMERA_CODE] = p[0]; break;
+        case WIRE_CMD_OPTICAL_PATH:     ok = len >= 1; if (ok) st->settings[SET_OPTICAL_PATH] = p[0]; break;
+        case WIRE_CMD_EDGE_FILTER:      ok = len >= 1; if (ok) st->settings[SET_EDGE_FILTER] = p[0]; break;
+        case WIRE_CMD_DISTANCE_FILTER:
+            ok = len >= 5;
+            if (ok) {
+                st->settings[SET_DIST_FILTER] = p[0];
+                st->settings[SET_DIST_FILTER_K] = get32(p + 1);
+            }
+            break;
+        case WIRE_CMD_SMOOTH_FILTER:
+            ok = len >= 5;
+            if (ok) {
+                st->settings[SET_SMOOTH_TYPE] = p[0];
+                st->settings[SET_SMOOTH_ARGS] = get32(p + 1);
+            }
+            break;
+        case WIRE_CMD_DISTANCE_OFFSET:
+            ok = len >= 2;
+            if (ok) {
+                st->settings[SET_DIST_OFFSET] = (uint32_t)(int32_t)(int16_t)(((uint16_t)p[0] << 8) | p[1]);
+            }
+            break;
+        case WIRE_CMD_SAVE:
+            break;
+        default:
+            ok = 0;
+            break;
+    }
+    reply(emu, cmd, ok ? WIRE_STATUS_OK : WIRE_STATUS_ERROR, NULL, 0);
+}
+
+static void stream_frame(device_emulator_t *emu, emu_state_t *st, uint64_t now) {
+    if (st->gap && now > st->deadline && now - st->deadline > st->gap) {
+        atomic_fetch_add(&emu->late, 1);
+    }
+    const emu_frame_t *frame = &emu->frames[st->cursor];
+    uint64_t index = atomic_load(&emu->sent);
+    atomic_store(&emu->stamps[index % EMU_STAMP_RING], now);
+    if (wire_write_frame(emu->master, emu->cfg.framing, WIRE_CMD_DATA, (uint8_t)frame->event_type,
+                         frame->data, (uint32_t)frame->len, EMU_WRITE_TIMEOUT_MS) != 0) {
+        // Nobody reads: the host is gone or stuck
+        atomic_fetch_add(&emu->write_errors, 1);
+        atomic_store(&emu->streaming, 0);
+        return;
+    }
+    atomic_store(&emu->sent, index + 1);
+    st->burst++;
+
+    st->gap = next_gap(emu, st->cursor);
+    st->cursor++;
+    if (st->cursor == emu->count) {
+        st->cursor = 0;
+        if (!emu->cfg.loop) {
+            atomic_store(&emu->streaming, 0);
+        }
+    }
+    if (emu->cfg.max_frames && st->burst >= emu->cfg.max_frames) {
+        atomic_store(&emu->streaming, 0);
+    }
+    // Absolute schedule: a late frame does not shift the following ones
+    st->deadline = emu->cfg.rate_hz < 0.0 ? now : st->deadline + st->gap;
+}
+
+static void *emulator_thread(void *arg) {
+    device_emulator_t *emu = arg;
+    emu_state_t st;
+    memset(&st, 0, sizeof(st));
+    st.settings[SET_RES_X] = 160;
+    st.settings[SET_RES_Y] = 60;
+    st.settings[SET_ROI_GROUPS] = 16;
+    st.settings[SET_ROIS] = 8;
+    st.settings[SET_THRESHOLDS] = 3;
+    st.settings[SET_CAMERA_CODES] = 16;
+
+    frame_pool_t pool;
+    wire_reader_t reader;
+    if (frame_pool_init(&pool, 2, EMU_COMMAND_BUF) != 0) {
+        return NULL;
+    }
+    wire_reader_init(&reader, emu->master, emu->cfg.framing, &pool);
+    struct pollfd pfd = {.fd = emu->master, .events = POLLIN};
+
+    while (!atomic_load(&emu->stop)) {
+        int timeout = EMU_IDLE_POLL_MS;
+        if (atomic_load(&emu->streaming)) {
+            uint64_t now = now_ns();
+            timeout = st.deadline <= now ? 0 : (int)((st.deadline - now) / 1000000);
+            if (timeout > EMU_IDLE_POLL_MS) {
+                timeout = EMU_IDLE_POLL_MS;
+            }
+        }
+        poll(&pfd, 1, timeout);
+
+        frame_buf_t *buf;
+        while (wire_reader_poll(&reader, &buf) == 1) {
+            handle_command(emu, &st, buf);
+            frame_pool_release(&pool, buf);
+        }
+
+        if (!atomic_load(&emu->streaming)) {
+            continue;
+        }
+        // Sub-millisecond rest of the wait: poll() only has ms resolution
+        uint64_t now = now_ns();
+        if (now < st.deadline) {
+            if (st.deadline - now >= 1000000) {
+                continue;
+            }
+            struct timespec ts = {.tv_sec = (time_t)(st.deadline / 1000000000ull),
+                                  .tv_nsec = (long)(st.deadline % 1000000000ull)};
+            clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL);
+            now = now_ns();
+        }
+        stream_frame(emu, &st, now);
+    }
+
+    wire_reader_reset(&reader);
+    frame_pool_destroy(&pool);
+    return NULL;
+}
+
+int device_emulator_start(device_emulator_t *emu) {
+    emu->master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (emu->master < 0) {
+        return -1;
+    }
+    if (grantpt(emu->master) != 0 || unlockpt(emu->master) != 0 ||
+        ptsname_r(emu->master, emu->slave, sizeof(emu->slave)) != 0) {
+        goto fail;
+    }
+    // Own slave descriptor in raw mode: no echo before the host configures the
+    // line, and closing the host side does not hang up the master
+    emu->slave_fd = open(emu->slave, O_RDWR | O_NOCTTY);
+    if (emu->slave_fd < 0) {
+        goto fail;
+    }
+    struct termios tio;
+    if (tcgetattr(emu->slave_fd, &tio) == 0) {
+        cfmakeraw(&tio);
+        tcsetattr(emu->slave_fd, TCSANOW, &tio);
+    }
+    fcntl(emu->master, F_SETFL, O_NONBLOCK);
+
+    atomic_store(&emu->stop, 0);
+    if (pthread_create(&emu->tid, NULL, emulator_thread, emu) != 0) {
+        goto fail;
+    }
+    if (pthread_getcpuclockid(emu->tid, &emu->cpu_clock) != 0) {
+        emu->cpu_clock = CLOCK_MONOTONIC;
+    }
+    emu->running = 1;
+    return 0;
+
+fail:
+    if (emu->slave_fd >= 0) {
+        close(emu->slave_fd);
+        emu->slave_fd = -1;
+    }
+    close(emu->master);
+    emu->master = -1;
+    return -1;
+}
+
+void device_emulator_stop(device_emulator_t *emu) {
+    if (!emu->running) {
+        return;
+    }
+    atomic_store(&emu->stop, 1);
+    pthread_join(emu->tid, NULL);
+    emu->running = 0;
+    atomic_store(&emu->streaming, 0);
+    close(emu->slave_fd);
+    close(emu->master);
+    emu->slave_fd = -1;
+    emu->master = -1;
+}
+
+void device_emulator_destroy(device_emulator_t *emu) {
+    device_emulator_stop(emu);
+    for (int i = 0; i < emu->count; i++) {
+        free(emu->frames[i].data);
+    }
+    free(emu->frames);
+    emu->frames = NULL;
+    emu->count = 0;
+    emu->capacity = 0;
+}
@@ -0,0 +1,94 @@
+/*
+ * HPS3D device emulator on a pseudo-terminal
+ *
+ * Opens a pty master, answers the wire commands from serial_transport.h and
+ * streams recorded packets (trigger bundles, .h3t) or synthetic ones at a
+ * fixed rate, with the recorded timing, or as fast as the link takes them.
+ * The open HPS3DAPI implementation can connect to the slave path like to
+ * /dev/ttyACM0; the emulator keeps its own slave descriptor open so a host
+ * reconnect does not hang up the master.
+ *
+ * The framing is the one passed in emu_config_t (WIRE_FRAMING_DEFAULT unless
+ * set). That is the open transport's own format, not the device protocol,
+ * so neither libHPS3D nor the service can connect to the emulator.
+ */
+
+#ifndef DEVICE_EMULATOR_H
+#define DEVICE_EMULATOR_H
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <time.h>
+#include "serial_transport.h"
+
+#define EMU_STAMP_RING 1024             // Send timestamps kept for latency measurement
+
+typedef struct {
+    const wire_framing_t *framing;
+    double rate_hz;                     // > 0 fixed rate, 0 recorded timing, < 0 as fast as possible
+    double speed;                       // Time scale for recorded timing (2 = twice as fast)
+    int loop;                           // Start over at the end of the frames
+    uint32_t max_frames;                // Stop streaming after this many, 0 = no limit
+    const char *version;                // HELLO reply
+    const char *serial;                 // SERIAL reply
+} emu_config_t;
+
+typedef struct {
+    uint8_t *data;
+    int len;
+    int32_t event_type;                 // HPS3D_EventType_t, sent as frame status
+    int64_t rel_us;                     // Recorded receive time
+} emu_frame_t;
+
+typedef struct {
+    emu_config_t cfg;
+    emu_frame_t *frames;
+    int count;
+    int capacity;
+
+    int master;
+    int slave_fd;                       // Held open so the master never sees a hangup
+    char slave[64];                     // Path for HPS3D_USBConnectDevice
+    pthread_t tid;
+    clockid_t cpu_clock;                // CPU time of the emulator thread
+    int running;
+
+    _Atomic int stop;
+    _Atomic int streaming;
+    _Atomic uint64_t sent;              // Stream frames written
+    _Atomic uint64_t late;              // Frames sent more than one period behind schedule
+    _Atomic uint64_t commands;
+    _Atomic uint64_t write_errors;
+    _Atomic uint64_t stamps[EMU_STAMP_RING];   // CLOCK_MONOTONIC ns at send, by stream index
+} device_emulator_t;
+
+void device_emulator_defaults(emu_config_t *cfg);
+
+void device_emulator_init(device_emulator_t *emu, const emu_config_t *cfg);
+
+// Copies one packet into the frame list. Returns 0 / -1
+int device_emulator_add_frame(device_emulator_t *emu, int32_t event_type, const uint8_t *data, int len,
+                              int64_t rel_us);
+
+// Appends all packets of a trigger bundle. Returns the number of packets, -1 on error
+int device_emulator_load(device_emulator_t *emu, const char *path);
+
+// Creates the pty and starts the device thread; emu->slave is valid afterwards.
+// Returns 0 / -1
+int device_emulator_start(device_emulator_t *emu);
+
+// Stops the thread and closes the pty: the host sees the device disappear
+void device_emulator_stop(device_emulator_t *emu);
+
+void device_emulator_destroy(device_emulator_t *emu);
+
+// Send time of stream frame index (0-based) while it is still in the ring, else 0
+static inline uint64_t device_emulator_stamp(device_emulator_t *emu, uint64_t index) {
+    if (index + EMU_STAMP_RING < atomic_load(&emu->sent)) {
+        return 0;
+    }
+    return atomic_load(&emu->stamps[index % EMU_STAMP_RING]);
+}
+
+#endif // DEVICE_EMULATOR_H
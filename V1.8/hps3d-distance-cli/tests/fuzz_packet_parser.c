@@ -0,0 +1,231 @@
+/*
+ * Fuzz harness and unit tests for the bounds-checked packet parser
+ *
+ * Two modes:
+ * - libFuzzer:  clang -fsanitize=fuzzer,address -DFUZZ_LIBFUZZER ...
+ *               (first input byte selects the packet type)
+ * - standalone: deterministic unit tests followed by a mutation loop over
+ *               valid seed packets (default 20000 iterations, argv[1] overrides)
+ *
+ * Decode targets are exact-size heap buffers, so any overrun is reported
+ * when built with ASAN=1.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "packet_builder.h"
+
+static HPS3D_MeasureData_t fuzz_data;
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    if (size < 1) return 0;
+    if (!fuzz_data.full_depth_data.distance && pb_measure_data_alloc(&fuzz_data) != 0) return 0;
+
+    HPS3D_EventType_t type = (HPS3D_EventType_t)(data[0] % 9);
+    int len = (size - 1 > 0x7fffffff) ? 0x7fffffff : (int)(size - 1);
+    int ret = packet_parse(data + 1, len, &fuzz_data, type);
+    if (ret > len) {
+        // Parser hat mehr Bytes gelesen als vorhanden - darf nie passieren
+        abort();
+    }
+    return 0;
+}
+
+#ifndef FUZZ_LIBFUZZER
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static uint8_t packet[PACKET_FULL_DEPTH_SIZE + 64];
+static HPS3D_MeasureData_t result;
+
+int test_full_depth_valid(void) {
+    int len = pb_full_depth(packet, 2000, 123);
+    TEST_ASSERT(len == PACKET_FULL_DEPTH_SIZE, "Builder size mismatch");
+    TEST_ASSERT(packet_validate(packet, len, HPS3D_FULL_DEPTH_EVEN) == len, "Valid packet rejected");
+    TEST_ASSERT(packet_parse(packet, len, &result, HPS3D_FULL_DEPTH_EVEN) == len, "Parse length wrong");
+    TEST_ASSERT(result.full_depth_data.frame_cnt == 123, "frame_cnt wrong");
+    TEST_ASSERT(result.full_depth_data.point_cloud_data.width == 160, "width wrong");
+    TEST_ASSERT(result.full_depth_data.distance[0] == 2000, "First pixel wrong");
+    TEST_ASSERT(result.full_depth_data.distance[9599] == 2000 + 9599 % 97, "Last pixel wrong");
+    TEST_ASSERT(result.full_depth_data.point_cloud_data.point_data[0].x == -80.0f, "Point x wrong");
+    TEST_ASSERT(result.full_depth_data.point_cloud_data.point_data[9599].y == 29.0f, "Point y wrong");
+    TEST_SUCCESS();
+}
+
+int test_full_depth_truncated(void) {
+    int len = pb_full_depth(packet, 2000, 1);
+    TEST_ASSERT(packet_parse(packet, len - 1, &result, HPS3D_FULL_DEPTH_EVEN) == -1, "Truncated packet accepted");
+    TEST_ASSERT(packet_parse(packet, 0, &result, HPS3D_FULL_DEPTH_EVEN) == -1, "Empty packet accepted");
+    TEST_ASSERT(packet_parse(NULL, len, &result, HPS3D_FULL_DEPTH_EVEN) == -1, "NULL packet accepted");
+    TEST_SUCCESS();
+}
+
+int test_full_depth_geometry(void) {
+    // Alle Verbraucher indizieren 160 breite Zeilen: nur 160x60 und 0x0 zulässig
+    int len = pb_full_depth(packet, 2000, 1);
+    TEST_ASSERT(packet_validate(packet, len, HPS3D_FULL_DEPTH_EVEN) == len, "160x60 rejected");
+    pb_put16(packet + 10, 0);
+    pb_put16(packet + 12, 0);
+    TEST_ASSERT(packet_validate(packet, len, HPS3D_FULL_DEPTH_EVEN) == len, "0x0 rejected");
+
+    // Andere Geometrien auch bei ausreichend langem Paket ablehnen
+    static const uint16_t sizes[][2] = { {80, 30}, {10, 2}, {160, 30}, {200, 100}, {0, 60} };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        pb_put16(packet + 10, sizes[i][0]);
+        pb_put16(packet + 12, sizes[i][1]);
+        TEST_ASSERT(packet_validate(packet, (int)sizeof(packet), HPS3D_FULL_DEPTH_EVEN) == -1,
+                    "Foreign geometry accepted");
+        TEST_ASSERT(packet_parse(packet, len, &result, HPS3D_FULL_DEPTH_EVEN) == -1,
+                    "Foreign geometry decoded");
+    }
+    TEST_SUCCESS();
+}
+
+int test_simple_packets(void) {
+    int len = pb_simple_depth(packet, 1234, 9);
+    TEST_ASSERT(packet_parse(packet, len, &result, HPS3D_SIMPLE_DEPTH_EVEN) == len, "Simple depth rejected");
+    TEST_ASSERT(result.simple_depth_data.distance_average == 1234, "Simple depth avg wrong");
+    TEST_ASSERT(packet_parse(packet, len - 1, &result, HPS3D_SIMPLE_DEPTH_EVEN) == -1, "Short simple depth accepted");
+
+    len = pb_simple_roi(packet, 3);
+    TEST_ASSERT(packet_parse(packet, len, &result, HPS3D_SIMPLE_ROI_EVEN) == len, "Simple ROI rejected");
+    TEST_ASSERT(result.simple_roi_data[2].roi_id == 2, "ROI id wrong");
+    TEST_ASSERT(result.simple_roi_data[2].distance_average == 1002, "ROI avg wrong");
+    TEST_ASSERT(packet_parse(packet, len - 1, &result, HPS3D_SIMPLE_ROI_EVEN) == -1, "Short simple ROI accepted");
+    TEST_SUCCESS();
+}
+
+int test_roi_count_overflow(void) {
+    int len = pb_simple_roi(packet, HPS3D_MAX_ROI_NUMBER + 1);
+    TEST_ASSERT(packet_parse(packet, len, &result, HPS3D_SIMPLE_ROI_EVEN) == -1, "ROI count > max accepted");
+
+    uint32_t pixels[HPS3D_MAX_ROI_NUMBER + 1] = {1, 1, 1, 1, 1, 1, 1, 1, 1};
+    len = pb_full_roi(packet, HPS3D_MAX_ROI_NUMBER + 1, pixels);
+    TEST_ASSERT(packet_parse(packet, len, &result, HPS3D_FULL_ROI_EVEN) == -1, "Full ROI count > max accepted");
+    TEST_SUCCESS();
+}
+
+int test_full_roi_pixel_number(void) {
+    uint32_t pixels[2] = {25, 121};
+    int len = pb_full_roi(packet, 2, pixels);
+    TEST_ASSERT(packet_parse(packet, len, &result, HPS3D_FULL_ROI_EVEN) == len, "Full ROI rejected");
+    TEST_ASSERT(result.full_roi_data[1].pixel_number == 121, "pixel_number wrong");
+    TEST_ASSERT(result.full_roi_data[1].distance[120] == 1500 + 120 % 50, "ROI pixel wrong");
+
+    // pixel_number der zweiten ROI zeigt hinter das Paketende
+    TEST_ASSERT(packet_parse(packet, len - 2, &result, HPS3D_FULL_ROI_EVEN) == -1, "Overlong pixel_number accepted");
+
+    // pixel_number größer als der Zielpuffer
+    pb_put32(packet + 18, HPS3D_MAX_PIXEL_NUMBER + 1);
+    TEST_ASSERT(packet_parse(packet, (int)sizeof(packet), &result, HPS3D_FULL_ROI_EVEN) == -1, "Huge pixel_number accepted");
+    TEST_SUCCESS();
+}
+
+int test_unknown_type(void) {
+    int len = pb_simple_depth(packet, 1, 1);
+    TEST_ASSERT(packet_parse(packet, len, &result, HPS3D_DISCONNECT_EVEN) == -1, "Non-data event accepted");
+    TEST_SUCCESS();
+}
+
+// Mutation-Fuzzing über gültige Seeds
+static uint32_t rng_state = 0x12345678u;
+
+static uint32_t rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+int test_mutation_fuzz(long iterations) {
+    static uint8_t seeds[4][PACKET_FULL_DEPTH_SIZE];
+    static uint8_t input[PACKET_FULL_DEPTH_SIZE + 1];
+    static const uint32_t roi_pixels[3] = {9, 400, 2};
+    int seed_len[4];
+    const HPS3D_EventType_t seed_type[4] = {
+        HPS3D_SIMPLE_ROI_EVEN, HPS3D_FULL_ROI_EVEN, HPS3D_FULL_DEPTH_EVEN, HPS3D_SIMPLE_DEPTH_EVEN
+    };
+
+    seed_len[0] = pb_simple_roi(seeds[0], 5);
+    seed_len[1] = pb_full_roi(seeds[1], 3, roi_pixels);
+    seed_len[2] = pb_full_depth(seeds[2], 1800, 77);
+    seed_len[3] = pb_simple_depth(seeds[3], 900, 5);
+
+    long accepted = 0;
+    for (long it = 0; it < iterations; it++) {
+        int s = (int)(rng_next() % 4);
+        int len = seed_len[s];
+        input[0] = (uint8_t)seed_type[s];
+        memcpy(input + 1, seeds[s], (size_t)len);
+
+        // Ein paar Header-Bytes verändern, gelegentlich das Paket kürzen
+        int flips = 1 + (int)(rng_next() % 4);
+        for (int f = 0; f < flips; f++) {
+            int pos = (int)(rng_next() % (uint32_t)(len < 64 ? len : 64));
+            input[1 + pos] = (uint8_t)rng_next();
+        }
+        if (rng_next() % 3 == 0) {
+            len = (int)(rng_next() % (uint32_t)(len + 1));
+        }
+        if (rng_next() % 16 == 0) {
+            input[0] = (uint8_t)rng_next();
+        }
+
+        LLVMFuzzerTestOneInput(input, (size_t)len + 1);
+        if (packet_validate(input + 1, len, (HPS3D_EventType_t)(input[0] % 9)) >= 0) {
+            accepted++;
+        }
+    }
+
+    printf("PASS: %s (%ld iterations, %ld accepted)\n", __func__, iterations, accepted);
+    return 1;
+}
+
+int main(int argc, char *argv[]) {
+    long iterations = (argc > 1) ? atol(argv[1]) : 20000;
+
+    printf("=== Packet Parser Tests ===\n");
+
+    if (pb_measure_data_alloc(&result) != 0) {
+        printf("FAIL: allocation\n");
+        return 1;
+    }
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_full_depth_valid();
+    total_tests++; passed_tests += test_full_depth_truncated();
+    total_tests++; passed_tests += test_full_depth_geometry();
+    total_tests++; passed_tests += test_simple_packets();
+    total_tests++; passed_tests += test_roi_count_overflow();
+    total_tests++; passed_tests += test_full_roi_pixel_number();
+    total_tests++; passed_tests += test_unknown_type();
+    total_tests++; passed_tests += test_mutation_fuzz(iterations);
+
+    pb_measure_data_free(&result);
+    pb_measure_data_free(&fuzz_data);
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
+
+#endif // FUZZ_LIBFUZZER
@@ -0,0 +1,117 @@
+/*
+ * HPS3D device emulator on a pseudo-terminal (command line)
+ *
+ * Replays trigger bundles (.h3t) or synthetic full-depth packets so that
+ * bench_sdk or another client of the open transport (src/hps3d_open_api.c)
+ * can connect to the printed /dev/pts/N (or the -s link) instead of a sensor. Runs until
+ * SIGINT/SIGTERM and prints its counters on exit.
+ *
+ * Usage: ./hps3d_emulator [-r hz] [-x speed] [-n frames] [-1] [-s link] [aufnahme.h3t ...]
+ *   -r hz      stream rate; 0 = recorded timing, -1 = as fast as the link takes
+ *              (default: recorded timing with a file, 15 Hz without)
+ *   -x speed   time scale for recorded timing
+ *   -n frames  stop streaming after this many frames per start
+ *   -1         play the recording once instead of looping
+ *   -s link    fixed symlink to the slave
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "packet_builder.h"
+#include "device_emulator.h"
+
+#define SYNTHETIC_FRAMES 32
+#define SYNTHETIC_RATE_HZ 15.0
+
+static volatile sig_atomic_t stop;
+
+static void on_signal(int sig) {
+    (void)sig;
+    stop = 1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-r hz] [-x speed] [-n frames] [-1] [-s link] [aufnahme.h3t ...]\n", prog);
+}
+
+int main(int argc, char **argv) {
+    emu_config_t cfg;
+    device_emulator_defaults(&cfg);
+    int rate_set = 0;
+    const char *link_path = NULL;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "r:x:n:1s:h")) != -1) {
+        switch (opt) {
+            case 'r': cfg.rate_hz = atof(optarg); rate_set = 1; break;
+            case 'x': cfg.speed = atof(optarg); break;
+            case 'n': cfg.max_frames = (uint32_t)strtoul(optarg, NULL, 10); break;
+            case '1': cfg.loop = 0; break;
+            case 's': link_path = optarg; break;
+            default: usage(argv[0]); return 2;
+        }
+    }
+
+    device_emulator_t emu;
+    device_emulator_init(&emu, &cfg);
+    for (int i = optind; i < argc; i++) {
+        int n = device_emulator_load(&emu, argv[i]);
+        if (n < 0) {
+            fprintf(stderr, "%s: no trigger bundle or truncated\n", argv[i]);
+            device_emulator_destroy(&emu);
+            return 1;
+        }
+        fprintf(stderr, "%s: %d packets\n", argv[i], n);
+    }
+    if (emu.count == 0) {
+        static uint8_t packet[PACKET_FULL_DEPTH_SIZE];
+        for (int i = 0; i < SYNTHETIC_FRAMES; i++) {
+            int len = pb_full_depth(packet, (uint16_t)(1000 + 10 * i), (uint32_t)i);
+            device_emulator_add_frame(&emu, HPS3D_FULL_DEPTH_EVEN, packet, len, 0);
+        }
+        if (!rate_set) {
+            emu.cfg.rate_hz = SYNTHETIC_RATE_HZ;
+        }
+    }
+
+    if (device_emulator_start(&emu) != 0) {
+        perror("pty");
+        device_emulator_destroy(&emu);
+        return 1;
+    }
+    if (link_path) {
+        unlink(link_path);
+        if (symlink(emu.slave, link_path) != 0) {
+            perror(link_path);
+            link_path = NULL;
+        }
+    }
+    printf("%s\n", emu.slave);
+    fflush(stdout);
+
+    signal(SIGINT, on_signal);
+    signal(SIGTERM, on_signal);
+    while (!stop) {
+        usleep(100000);     // The signal may hit the emulator thread: poll the flag
+    }
+
+    struct timespec cpu;
+    clock_gettime(emu.cpu_clock, &cpu);
+    fprintf(stderr, "sent %llu  late %llu  commands %llu  write_errors %llu  cpu %.1f ms\n",
+            (unsigned long long)atomic_load(&emu.sent), (unsigned long long)atomic_load(&emu.late),
+            (unsigned long long)atomic_load(&emu.commands), (unsigned long long)atomic_load(&emu.write_errors),
+            (double)cpu.tv_sec * 1e3 + (double)cpu.tv_nsec / 1e6);
+    if (link_path) {
+        unlink(link_path);
+    }
+    device_emulator_destroy(&emu);
+    return 0;
+}
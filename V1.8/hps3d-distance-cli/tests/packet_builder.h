@@ -0,0 +1,131 @@
+/*
+ * Synthetic HPS3D packet builder shared by parser tests, fuzzer and benchmarks
+ *
+ * Produces packets in the exact big-endian layout read by packet_decode().
+ */
+
+#ifndef PACKET_BUILDER_H
+#define PACKET_BUILDER_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "HPS3DUser_IF.h"
+#include "packet_parser.h"
+
+static inline uint8_t *pb_put16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+    return p + 2;
+}
+
+static inline uint8_t *pb_put32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)(v >> 24);
+    p[1] = (uint8_t)(v >> 16);
+    p[2] = (uint8_t)(v >> 8);
+    p[3] = (uint8_t)v;
+    return p + 4;
+}
+
+// Full depth packet; distance[i] = base + (i % 97), point cloud in 1/100 mm
+static inline int pb_full_depth(uint8_t *buf, uint16_t base, uint32_t frame_cnt) {
+    uint8_t *p = buf;
+    p = pb_put16(p, base);
+    p = pb_put16(p, base);
+    p = pb_put16(p, 0);
+    p = pb_put32(p, frame_cnt);
+    p = pb_put16(p, 160);
+    p = pb_put16(p, 60);
+    p = pb_put16(p, HPS3D_MAX_PIXEL_NUMBER);
+    for (int i = 0; i < HPS3D_MAX_PIXEL_NUMBER; i++) {
+        p = pb_put16(p, (uint16_t)(base + (i % 97)));
+    }
+    for (int i = 0; i < HPS3D_MAX_PIXEL_NUMBER; i++) {
+        p = pb_put32(p, (uint32_t)(int32_t)((i % 160) - 80) * 100);
+        p = pb_put32(p, (uint32_t)(int32_t)((i / 160) - 30) * 100);
+        p = pb_put32(p, (uint32_t)(base + (i % 97)) * 100);
+    }
+    return (int)(p - buf);
+}
+
+static inline int pb_simple_depth(uint8_t *buf, uint16_t avg, uint32_t frame_cnt) {
+    uint8_t *p = buf;
+    p = pb_put16(p, avg);
+    p = pb_put16(p, avg / 2);
+    p = pb_put16(p, 3);
+    p = pb_put32(p, frame_cnt);
+    return (int)(p - buf);
+}
+
+static inline int pb_simple_roi(uint8_t *buf, int num) {
+    uint8_t *p = buf;
+    for (int i = 0; i < num; i++) {
+        *p++ = (uint8_t)num;
+        *p++ = 0;
+        *p++ = (uint8_t)i;
+        *p++ = (uint8_t)(i & 0x07);
+        p = pb_put16(p, (uint16_t)(1000 + i));
+        p = pb_put16(p, (uint16_t)(900 + i));
+        p = pb_put16(p, 0);
+        p = pb_put32(p, 42);
+    }
+    return (int)(p - buf);
+}
+
+// Full ROI packet with num ROIs of pixels[i] pixels each
+static inline int pb_full_roi(uint8_t *buf, int num, const uint32_t *pixels) {
+    uint8_t *p = buf;
+    for (int i = 0; i < num; i++) {
+        *p++ = (uint8_t)num;
+        *p++ = 0;
+        *p++ = (uint8_t)i;
+        *p++ = 0;
+        p = pb_put16(p, 10);
+        p = pb_put16(p, 10);
+        p = pb_put16(p, 20);
+        p = pb_put16(p, 20);
+        p = pb_put16(p, (uint16_t)(1500 + i));
+        p = pb_put16(p, (uint16_t)(1400 + i));
+        p = pb_put16(p, 0);
+        p = pb_put32(p, pixels[i]);
+        p = pb_put32(p, 7);
+        for (uint32_t j = 0; j < pixels[i]; j++) {
+            p = pb_put16(p, (uint16_t)(1500 + j % 50));
+        }
+    }
+    return (int)(p - buf);
+}
+
+// Exact-size heap buffers so AddressSanitizer catches any overrun
+static inline int pb_measure_data_alloc(HPS3D_MeasureData_t *data) {
+    memset(data, 0, sizeof(*data));
+    data->simple_roi_data = calloc(HPS3D_MAX_ROI_NUMBER, sizeof(HPS3D_SimpleRoiData_t));
+    data->full_roi_data = calloc(HPS3D_MAX_ROI_NUMBER, sizeof(HPS3D_FullRoiData_t));
+    data->full_depth_data.distance = calloc(HPS3D_MAX_PIXEL_NUMBER, sizeof(uint16_t));
+    data->full_depth_data.point_cloud_data.point_data =
+        calloc(HPS3D_MAX_PIXEL_NUMBER, sizeof(HPS3D_PerPointCloudData_t));
+    if (!data->simple_roi_data || !data->full_roi_data || !data->full_depth_data.distance ||
+        !data->full_depth_data.point_cloud_data.point_data) {
+        return -1;
+    }
+    for (int i = 0; i < HPS3D_MAX_ROI_NUMBER; i++) {
+        data->full_roi_data[i].distance = calloc(HPS3D_MAX_PIXEL_NUMBER, sizeof(uint16_t));
+        if (!data->full_roi_data[i].distance) return -1;
+    }
+    return 0;
+}
+
+static inline void pb_measure_data_free(HPS3D_MeasureData_t *data) {
+    if (data->full_roi_data) {
+        for (int i = 0; i < HPS3D_MAX_ROI_NUMBER; i++) {
+            free(data->full_roi_data[i].distance);
+        }
+    }
+    free(data->full_roi_data);
+    free(data->simple_roi_data);
+    free(data->full_depth_data.distance);
+    free(data->full_depth_data.point_cloud_data.point_data);
+    memset(data, 0, sizeof(*data));
+}
+
+#endif // PACKET_BUILDER_H
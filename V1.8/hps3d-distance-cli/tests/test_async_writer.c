@@ -0,0 +1,200 @@
+/*
+ * Unit tests for the asynchronous log/recording writer
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "async_writer.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+#define LINES 2000
+
+static char expected[LINES * 32];
+
+static long read_file(const char *path, char *out, long size) {
+    FILE *fp = fopen(path, "rb");
+    if (!fp) {
+        return -1;
+    }
+    long n = (long)fread(out, 1, (size_t)size, fp);
+    fclose(fp);
+    return n;
+}
+
+static int temp_path(char *path, size_t size, const char *name) {
+    snprintf(path, size, "/tmp/test_async_writer_%d_%s", (int)getpid(), name);
+    return 0;
+}
+
+// Viele kurze Zeilen wie vom Logger: Reihenfolge und Inhalt müssen erhalten bleiben
+static int ordered_lines(async_writer_mode_t mode, const char *tag) {
+    async_writer_t writer;
+    if (async_writer_init(&writer, NULL, 32, 256, mode) != 0) {
+        return -1;
+    }
+
+    char path[128];
+    temp_path(path, sizeof(path), tag);
+    int file = async_writer_open(&writer, path, 1);
+    if (file < 0) {
+        async_writer_destroy(&writer);
+        return -1;
+    }
+
+    int expected_len = 0;
+    for (int i = 0; i < LINES; i++) {
+        frame_buf_t *buf;
+        while ((buf = async_writer_acquire(&writer)) == NULL) {
+            usleep(100);  // Pool leer: im Test warten statt verwerfen
+        }
+        buf->len = snprintf((char *)buf->data, (size_t)buf->capacity, "line %05d\n", i);
+        memcpy(expected + expected_len, buf->data, (size_t)buf->len);
+        expected_len += buf->len;
+        async_writer_submit(&writer, file, buf);
+    }
+    int flushed = async_writer_flush(&writer, 5000);
+    async_writer_destroy(&writer);
+
+    static char actual[LINES * 32];
+    long n = read_file(path, actual, sizeof(actual));
+    unlink(path);
+    if (flushed != 0 || n != expected_len || memcmp(actual, expected, (size_t)n) != 0) {
+        return -1;
+    }
+    return 0;
+}
+
+int test_thread_backend_order(void) {
+    TEST_ASSERT(ordered_lines(ASYNC_WRITER_THREAD, "thread") == 0, "pwritev backend lost or reordered data");
+    TEST_SUCCESS();
+}
+
+int test_auto_backend_order(void) {
+    // io_uring wenn verfügbar (Container ohne io_uring fallen auf den Thread zurück)
+    TEST_ASSERT(ordered_lines(ASYNC_WRITER_AUTO, "auto") == 0, "auto backend lost or reordered data");
+    TEST_SUCCESS();
+}
+
+int test_append_and_two_files(void) {
+    char path_a[128], path_b[128];
+    temp_path(path_a, sizeof(path_a), "a");
+    temp_path(path_b, sizeof(path_b), "b");
+    FILE *fp = fopen(path_a, "w");
+    TEST_ASSERT(fp != NULL, "cannot create file");
+    fputs("old\n", fp);
+    fclose(fp);
+
+    async_writer_t writer;
+    TEST_ASSERT(async_writer_init(&writer, NULL, 8, 64, ASYNC_WRITER_AUTO) == 0, "init failed");
+    int a = async_writer_open(&writer, path_a, 0);
+    int b = async_writer_open(&writer, path_b, 1);
+    TEST_ASSERT(a >= 0 && b >= 0 && a != b, "open failed");
+
+    async_writer_write(&writer, a, "a1\n", 3);
+    async_writer_write(&writer, b, "b1\n", 3);
+    async_writer_write(&writer, a, "a2\n", 3);
+    // Größer als ein Puffer: wird auf mehrere Puffer verteilt
+    char big[200];
+    memset(big, 'x', sizeof(big));
+    TEST_ASSERT(async_writer_write(&writer, b, big, sizeof(big)) == (int)sizeof(big), "split write failed");
+    TEST_ASSERT(async_writer_flush(&writer, 5000) == 0, "flush timed out");
+    TEST_ASSERT(atomic_load(&writer.bytes) == 9 + sizeof(big), "byte count wrong");
+    async_writer_destroy(&writer);
+
+    char content[512];
+    long n = read_file(path_a, content, sizeof(content));
+    TEST_ASSERT(n == 10 && memcmp(content, "old\na1\na2\n", 10) == 0, "append file wrong");
+    n = read_file(path_b, content, sizeof(content));
+    TEST_ASSERT(n == 3 + (long)sizeof(big) && memcmp(content, "b1\n", 3) == 0 && content[n - 1] == 'x',
+                "second file wrong");
+    unlink(path_a);
+    unlink(path_b);
+    TEST_SUCCESS();
+}
+
+int test_exhausted_pool_drops(void) {
+    async_writer_t writer;
+    TEST_ASSERT(async_writer_init(&writer, NULL, 2, 64, ASYNC_WRITER_THREAD) == 0, "init failed");
+
+    frame_buf_t *a = async_writer_acquire(&writer);
+    frame_buf_t *b = async_writer_acquire(&writer);
+    TEST_ASSERT(a && b, "pool too small");
+    TEST_ASSERT(async_writer_acquire(&writer) == NULL, "acquire beyond pool");
+    TEST_ASSERT(atomic_load(&writer.dropped) == 1, "drop not counted");
+
+    // Ungültige Datei-ID: Puffer kommt als Fehler zurück in den Pool
+    a->len = 4;
+    b->len = 4;
+    async_writer_submit(&writer, 5, a);
+    async_writer_submit(&writer, -1, b);
+    TEST_ASSERT(async_writer_flush(&writer, 5000) == 0, "flush timed out");
+    TEST_ASSERT(atomic_load(&writer.errors) == 2, "errors not counted");
+    TEST_ASSERT(frame_pool_available(writer.pool) == 2, "buffers not returned");
+    async_writer_destroy(&writer);
+    TEST_SUCCESS();
+}
+
+int test_external_pool(void) {
+    frame_pool_t pool;
+    TEST_ASSERT(frame_pool_init(&pool, 4, 128) == 0, "pool init failed");
+
+    async_writer_t writer;
+    TEST_ASSERT(async_writer_init(&writer, &pool, 0, 0, ASYNC_WRITER_AUTO) == 0, "init failed");
+    TEST_ASSERT(writer.pool == &pool, "external pool not used");
+
+    char path[128];
+    temp_path(path, sizeof(path), "ext");
+    int file = async_writer_open(&writer, path, 1);
+    frame_buf_t *buf = async_writer_acquire(&writer);
+    TEST_ASSERT(buf && buf->data >= pool.storage, "buffer not from external pool");
+    memcpy(buf->data, "frame", 5);
+    buf->len = 5;
+    async_writer_submit(&writer, file, buf);
+    TEST_ASSERT(async_writer_flush(&writer, 5000) == 0, "flush timed out");
+    printf("  backend: %s\n", async_writer_backend_name(writer.backend));
+    async_writer_destroy(&writer);
+
+    TEST_ASSERT(pool.storage != NULL && frame_pool_available(&pool) == pool.count, "external pool touched");
+    frame_pool_destroy(&pool);
+
+    char content[16];
+    long n = read_file(path, content, sizeof(content));
+    unlink(path);
+    TEST_ASSERT(n == 5 && memcmp(content, "frame", 5) == 0, "content wrong");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Async Writer Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_thread_backend_order();
+    total_tests++; passed_tests += test_auto_backend_order();
+    total_tests++; passed_tests += test_append_and_two_files();
+    total_tests++; passed_tests += test_exhausted_pool_drops();
+    total_tests++; passed_tests += test_external_pool();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
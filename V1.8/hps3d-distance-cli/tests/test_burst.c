@@ -0,0 +1,133 @@
+/*
+ * Unit tests for burst capture merging and per-region standard error
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "HPS3DUser_IF.h"
+#include "burst.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+#define W 4
+#define H 2
+
+static burst_buffer_t burst;
+
+// Frame f: Pixel i = 1000 + i + f, Pixel 1 immer gesättigt, Pixel 2 nur in Frame 0 gültig
+static void fill_frames(int count) {
+    burst_reset(&burst);
+    for (int f = 0; f < count; f++) {
+        uint16_t *frame = burst_next_frame(&burst);
+        for (int i = 0; i < W * H; i++) {
+            frame[i] = (uint16_t)(1000 + i + f);
+        }
+        frame[1] = HPS3D_SATURATION;
+        frame[2] = (f == 0) ? 500 : HPS3D_LOW_AMPLITUDE;
+        burst_commit_frame(&burst);
+    }
+}
+
+int test_capacity(void) {
+    TEST_ASSERT(burst_init(&burst, BURST_MAX_FRAMES + 1, W * H) == -1, "Oversized burst accepted");
+    TEST_ASSERT(burst_init(&burst, 5, W * H) == 0, "Init failed");
+    fill_frames(5);
+    TEST_ASSERT(burst.count == 5, "Count wrong");
+    TEST_ASSERT(burst_next_frame(&burst) == NULL, "Full burst returned slot");
+    TEST_SUCCESS();
+}
+
+int test_merge_mean(void) {
+    fill_frames(5);
+    burst_merge(&burst, BURST_MEAN, 3);
+    TEST_ASSERT(burst.merged[0] == 1002, "Mean wrong");
+    TEST_ASSERT(burst.merged[1] == HPS3D_SATURATION, "Saturation sentinel lost");
+    TEST_ASSERT(burst.merged[2] == HPS3D_LOW_AMPLITUDE, "Pixel below min_valid not invalidated");
+    TEST_ASSERT(burst.valid_count[2] == 1, "Valid count wrong");
+
+    burst_merge(&burst, BURST_MEAN, 1);
+    TEST_ASSERT(burst.merged[2] == 500, "Single valid sample not used");
+    TEST_SUCCESS();
+}
+
+int test_merge_median(void) {
+    fill_frames(5);
+    // Ausreißer in einem Frame darf den Median nicht verschieben
+    burst.frames[3 * W * H + 0] = 9000;
+    burst_merge(&burst, BURST_MEDIAN, 3);
+    TEST_ASSERT(burst.merged[0] == 1002, "Median affected by outlier");
+    TEST_ASSERT(burst.merged[1] == HPS3D_SATURATION, "Sentinel lost");
+
+    burst_merge(&burst, BURST_MEAN, 3);
+    TEST_ASSERT(burst.merged[0] > 1002, "Mean should include outlier");
+
+    // Gerade Anzahl: Mittel der beiden mittleren Werte
+    fill_frames(4);
+    burst_merge(&burst, BURST_MEDIAN, 1);
+    TEST_ASSERT(burst.merged[0] == 1002, "Even median wrong");  // (1001 + 1002 + 1) / 2
+    TEST_SUCCESS();
+}
+
+int test_region_std_error(void) {
+    fill_frames(5);
+    burst_merge(&burst, BURST_MEAN, 3);
+
+    burst_region_t region;
+    burst_region(&burst, W, 0, 1, W, 1, &region);
+    // Zeile 1: Frame-Mittel 1005.5 + f -> Standardabweichung sqrt(2.5), SE = sqrt(2.5/5)
+    TEST_ASSERT(region.valid_pixels == 4, "Valid pixels wrong");
+    TEST_ASSERT(region.frames_used == 5, "Frames used wrong");
+    TEST_ASSERT(fabsf(region.distance - 1007.5f) < 0.01f, "Region distance wrong");
+    TEST_ASSERT(fabsf(region.std_error - sqrtf(0.5f)) < 0.001f, "Standard error wrong");
+
+    // Bereich nur aus ungültigen Pixeln
+    burst_region(&burst, W, 1, 0, 1, 1, &region);
+    TEST_ASSERT(region.valid_pixels == 0 && region.frames_used == 0, "Invalid region counted");
+    TEST_ASSERT(region.std_error == 0.0f, "Standard error without samples");
+    TEST_SUCCESS();
+}
+
+int test_parse_mode(void) {
+    burst_mode_t mode = BURST_MEAN;
+    TEST_ASSERT(burst_parse_mode("median", 6, &mode) == 0 && mode == BURST_MEDIAN, "median not parsed");
+    TEST_ASSERT(burst_parse_mode("mean", 4, &mode) == 0 && mode == BURST_MEAN, "mean not parsed");
+    TEST_ASSERT(burst_parse_mode("medi", 4, &mode) == -1, "Prefix accepted");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Burst Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_capacity();
+    total_tests++; passed_tests += test_merge_mean();
+    total_tests++; passed_tests += test_merge_median();
+    total_tests++; passed_tests += test_region_std_error();
+    total_tests++; passed_tests += test_parse_mode();
+
+    burst_free(&burst);
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+/*
+ * Unit tests for the bus-aware capture scheduler
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "capture_scheduler.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static void set_slot(capture_bus_t *bus, int i, int32_t pid, uint32_t transfer_us, uint32_t interval_us,
+                     uint64_t heartbeat_us) {
+    atomic_store(&bus->slots[i].pid, pid);
+    atomic_store(&bus->slots[i].transfer_us, transfer_us);
+    atomic_store(&bus->slots[i].interval_us, interval_us);
+    atomic_store(&bus->slots[i].heartbeat_us, heartbeat_us);
+}
+
+int test_plan_staggers_windows(void) {
+    static capture_bus_t bus;
+    memset(&bus, 0, sizeof(bus));
+    uint64_t now = 10000000;
+    set_slot(&bus, 0, 100, 18000, 100000, now);
+    set_slot(&bus, 2, 101, 25000, 150000, now);
+    set_slot(&bus, 5, 102, 10000, 100000, now);
+
+    capture_plan_t a, b, c;
+    capture_bus_plan(&bus, 0, now, 2000, &a);
+    capture_bus_plan(&bus, 2, now, 2000, &b);
+    capture_bus_plan(&bus, 5, now, 2000, &c);
+
+    TEST_ASSERT(a.active == 3 && b.active == 3 && c.active == 3, "active count wrong");
+    TEST_ASSERT(a.cycle_us == 150000 && b.cycle_us == 150000 && c.cycle_us == 150000,
+                "sensors disagree on the shared cycle");
+    TEST_ASSERT(a.offset_us == 0 && b.offset_us == 20000 && c.offset_us == 47000, "offsets wrong");
+    TEST_ASSERT(b.window_us == 27000, "window wrong");
+
+    // Fenster passen nicht mehr ins Intervall: der Zyklus wird gestreckt
+    set_slot(&bus, 2, 101, 140000, 150000, now);
+    capture_bus_plan(&bus, 5, now, 2000, &c);
+    TEST_ASSERT(c.cycle_us == 20000 + 142000 + 12000, "cycle not stretched");
+    TEST_ASSERT(c.offset_us == 162000, "offset after growth wrong");
+    TEST_SUCCESS();
+}
+
+int test_plan_ignores_stale_slots(void) {
+    static capture_bus_t bus;
+    memset(&bus, 0, sizeof(bus));
+    uint64_t now = 100000000;
+    set_slot(&bus, 0, 100, 30000, 100000, now - 10000000);  // Seit 10 s still
+    set_slot(&bus, 1, 101, 20000, 100000, now);
+
+    capture_plan_t plan;
+    capture_bus_plan(&bus, 1, now, 1000, &plan);
+    TEST_ASSERT(plan.active == 1 && plan.offset_us == 0, "stale slot still occupies the bus");
+
+    // Der eigene Platz zählt immer, auch vor dem ersten Herzschlag
+    capture_bus_plan(&bus, 0, now, 1000, &plan);
+    TEST_ASSERT(plan.active == 2 && plan.offset_us == 0 && plan.window_us == 31000, "own slot dropped");
+    TEST_SUCCESS();
+}
+
+int test_next_window(void) {
+    TEST_ASSERT(capture_next_window(0, 0, 100000, 20000) == 20000, "first window wrong");
+    TEST_ASSERT(capture_next_window(20000, 0, 100000, 20000) == 20000, "exact start not taken");
+    TEST_ASSERT(capture_next_window(20001, 0, 100000, 20000) == 120000, "next cycle not chosen");
+    TEST_ASSERT(capture_next_window(1000050000, 0, 100000, 20000) == 1000120000, "large time wrong");
+    // Vor der Epoche: erstes Fenster der Zeitachse
+    TEST_ASSERT(capture_next_window(5000, 700000, 100000, 20000) == 720000, "epoch ignored");
+    TEST_ASSERT(capture_next_window(900000, 700000, 100000, 20000) == 920000, "epoch offset wrong");
+    TEST_SUCCESS();
+}
+
+int test_transfer_tracking_adapts(void) {
+    capture_sched_t sched;
+    TEST_ASSERT(capture_sched_attach(&sched, NULL, 1000) == 0, "private attach failed");
+
+    for (int i = 0; i < 40; i++) {
+        capture_sched_record(&sched, 20000);
+    }
+    TEST_ASSERT(sched.transfer_us == 20000 && sched.transfer_dev_us == 0, "steady transfer wrong");
+    TEST_ASSERT(atomic_load(&sched.bus->slots[sched.slot].transfer_us) == 20000, "window not published");
+
+    // Sensor wird langsamer: Fenster wächst, Ausreißer erhöhen den Jitter
+    for (int i = 0; i < 40; i++) {
+        capture_sched_record(&sched, 30000);
+    }
+    TEST_ASSERT(sched.transfer_us > 29000 && sched.transfer_us <= 30000, "mean did not follow");
+    capture_sched_record(&sched, 60000);
+    TEST_ASSERT(sched.transfer_dev_us > 5000, "deviation not tracked");
+    TEST_ASSERT(atomic_load(&sched.bus->slots[sched.slot].transfer_us) > sched.transfer_us,
+                "published window lacks jitter margin");
+    capture_sched_detach(&sched);
+    TEST_SUCCESS();
+}
+
+int test_shared_file_slots(void) {
+    char path[128];
+    snprintf(path, sizeof(path), "/tmp/test_capture_bus_%d", (int)getpid());
+    unlink(path);
+
+    capture_sched_t a, b;
+    TEST_ASSERT(capture_sched_attach(&a, path, 1000) == 0, "first attach failed");
+    TEST_ASSERT(capture_sched_attach(&b, path, 1000) == 0, "second attach failed");
+    TEST_ASSERT(a.slot != b.slot, "same slot handed out twice");
+
+    capture_sched_record(&a, 15000);
+    capture_sched_record(&b, 25000);
+    uint64_t wa = capture_sched_wait(&a, 50);
+    uint64_t wb = capture_sched_wait(&b, 50);
+    TEST_ASSERT(a.plan.cycle_us == 50000 && b.plan.cycle_us == 50000, "shared cycle wrong");
+    TEST_ASSERT(b.plan.offset_us == 16000, "second sensor not behind first");
+    TEST_ASSERT(a.plan.epoch_us == b.plan.epoch_us, "sensors on different timelines");
+    TEST_ASSERT((wa - a.plan.epoch_us) % 50000 == 0 && (wb - b.plan.epoch_us) % 50000 == 16000,
+                "windows not on shared timeline");
+
+    // Längere Übertragung streckt den Zyklus ab der nächsten Grenze der alten Achse
+    uint64_t old_epoch = a.plan.epoch_us;
+    capture_sched_record(&b, 60000);
+    uint32_t b_window = atomic_load(&b.bus->slots[b.slot].transfer_us) + 1000;
+    capture_sched_wait(&a, 50);
+    TEST_ASSERT(b_window > 35000 && a.plan.cycle_us == 16000 + b_window, "cycle not stretched");
+    TEST_ASSERT(a.plan.epoch_us > old_epoch && (a.plan.epoch_us - old_epoch) % 50000 == 0,
+                "timeline not switched at a cycle boundary");
+
+    // Verwaister Platz eines beendeten Prozesses wird wiederverwendet
+    int freed = b.slot;
+    atomic_store(&b.bus->slots[freed].pid, 0x7ffffff0);
+    b.slot = -1;
+    capture_sched_detach(&b);
+    capture_sched_t c;
+    TEST_ASSERT(capture_sched_attach(&c, path, 1000) == 0 && c.slot == freed, "orphaned slot not reused");
+
+    capture_sched_detach(&c);
+    capture_sched_detach(&a);
+    unlink(path);
+    TEST_ASSERT(capture_sched_attach(&a, "/nonexistent/bus", 1000) == -1, "bad path accepted");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Capture Scheduler Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_plan_staggers_windows();
+    total_tests++; passed_tests += test_plan_ignores_stale_slots();
+    total_tests++; passed_tests += test_next_window();
+    total_tests++; passed_tests += test_transfer_tracking_adapts();
+    total_tests++; passed_tests += test_shared_file_slots();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
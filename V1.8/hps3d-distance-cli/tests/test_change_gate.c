@@ -0,0 +1,161 @@
+/*
+ * Unit tests for the frame-level change gate
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "packet_builder.h"
+#include "change_gate.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static uint8_t packet[PACKET_FULL_DEPTH_SIZE];
+static change_gate_t gate;
+
+// Distanz von Pixel (x,y) im Rohpaket überschreiben
+static void set_pixel(int x, int y, uint16_t d) {
+    pb_put16(packet + PACKET_FULL_DEPTH_HEADER + 2 * (y * 160 + x), d);
+}
+
+static void setup(void) {
+    change_gate_init(&gate);
+    gate.enabled = 1;
+}
+
+int test_disabled_passes(void) {
+    change_gate_init(&gate);
+    int len = pb_full_depth(packet, 2000, 1);
+    TEST_ASSERT(change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_PASS, "Disabled gate skipped");
+    TEST_ASSERT(change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_PASS, "Disabled gate skipped");
+    TEST_ASSERT(gate.frames_skipped == 0, "Skip counted while disabled");
+    TEST_SUCCESS();
+}
+
+int test_static_scene_skipped(void) {
+    setup();
+    int len = pb_full_depth(packet, 2000, 1);
+    TEST_ASSERT(change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_PASS, "First frame skipped");
+
+    // Neuer Frame, Rauschen innerhalb der Toleranz
+    pb_put32(packet + 6, 2);
+    pb_put16(packet, 2005);
+    set_pixel(10, 3, (uint16_t)(2000 + (3 * 160 + 10) % 97 + 8));
+    TEST_ASSERT(change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_SKIP, "Static frame passed");
+    TEST_ASSERT(gate.frames_skipped == 1 && gate.frames_seen == 2, "Counters wrong");
+
+    // Andere Pakettypen werden nie verworfen
+    TEST_ASSERT(change_gate_check(&gate, packet, 10, HPS3D_SIMPLE_DEPTH_EVEN) == CHANGE_GATE_PASS, "Simple packet skipped");
+    TEST_SUCCESS();
+}
+
+int test_summary_change_passes(void) {
+    setup();
+    int len = pb_full_depth(packet, 2000, 1);
+    change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN);
+
+    pb_put32(packet + 6, 2);
+    pb_put16(packet + 2, 1500);  // distance_min
+    TEST_ASSERT(change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_PASS, "Min change skipped");
+
+    pb_put32(packet + 6, 3);
+    pb_put16(packet + 4, 1);     // saturation_count
+    TEST_ASSERT(change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_PASS, "Saturation change skipped");
+    TEST_SUCCESS();
+}
+
+int test_sample_change_passes(void) {
+    setup();
+    int len = pb_full_depth(packet, 2000, 1);
+    change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN);
+
+    // Objekt an einem Stichprobenpixel (Raster 1/1 = x 30, y 11), Kopfwerte unverändert
+    pb_put32(packet + 6, 2);
+    set_pixel(30, 11, 800);
+    TEST_ASSERT(change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_PASS, "Local change skipped");
+
+    // Pixel wird ungültig
+    pb_put32(packet + 6, 3);
+    set_pixel(30, 11, HPS3D_LOW_AMPLITUDE);
+    TEST_ASSERT(change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_PASS, "Validity change skipped");
+
+    // Ohne Stichprobe reicht die Kopfzeile
+    gate.use_samples = 0;
+    pb_put32(packet + 6, 4);
+    set_pixel(30, 11, 800);
+    TEST_ASSERT(change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_SKIP, "Header-only gate passed");
+    TEST_SUCCESS();
+}
+
+int test_drift_and_max_skip(void) {
+    setup();
+    gate.max_skip = 3;
+    int len = pb_full_depth(packet, 2000, 1);
+    change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN);
+
+    // Nach max_skip Skips wird ein Frame erzwungen
+    int passes = 0;
+    for (uint32_t f = 2; f < 10; f++) {
+        pb_put32(packet + 6, f);
+        passes += change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_PASS;
+    }
+    TEST_ASSERT(passes == 2, "max_skip not enforced");
+
+    // Langsame Drift von 5 mm pro Frame muss gegen die Referenz auslösen
+    setup();
+    change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN);
+    int passed_at = -1;
+    for (int f = 1; f <= 10 && passed_at < 0; f++) {
+        pb_put32(packet + 6, 100 + (uint32_t)f);
+        pb_put16(packet, (uint16_t)(2000 + 5 * f));
+        if (change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_PASS) {
+            passed_at = f;
+        }
+    }
+    TEST_ASSERT(passed_at == 5, "Drift not detected against reference");
+    TEST_SUCCESS();
+}
+
+int test_reset(void) {
+    setup();
+    int len = pb_full_depth(packet, 2000, 1);
+    change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN);
+    change_gate_reset(&gate);
+    TEST_ASSERT(change_gate_check(&gate, packet, len, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_PASS, "Frame after reset skipped");
+    TEST_ASSERT(change_gate_check(&gate, packet, 8, HPS3D_FULL_DEPTH_EVEN) == CHANGE_GATE_PASS, "Short packet skipped");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Change Gate Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_disabled_passes();
+    total_tests++; passed_tests += test_static_scene_skipped();
+    total_tests++; passed_tests += test_summary_change_passes();
+    total_tests++; passed_tests += test_sample_change_passes();
+    total_tests++; passed_tests += test_drift_and_max_skip();
+    total_tests++; passed_tests += test_reset();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
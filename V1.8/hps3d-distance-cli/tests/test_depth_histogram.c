@@ -0,0 +1,207 @@
+/*
+ * Unit tests for the depth histogram
+ *
+ * Compares the lane-interleaved binning against a scalar reference, checks
+ * below/above/invalid accounting and bin edges, merging of per-band partial
+ * histograms, percentile auto-ranging and the compact JSON array.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "depth_histogram.h"
+#include "region.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static uint16_t distance[SENSOR_PIXELS];
+static depth_hist_partial_t scratch;
+static depth_hist_partial_t band[2];
+static depth_hist_t hist;
+static depth_hist_t merged;
+
+static void make_scene(unsigned seed) {
+    srand(seed);
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        int r = rand() % 100;
+        distance[i] = r < 8 ? (uint16_t)(65000 + rand() % 536) : r < 10 ? 0 : (uint16_t)(1 + rand() % 12000);
+    }
+}
+
+// Skalare Referenz: Klasse per Ganzzahl-Division
+static int same_as_reference(const depth_hist_t *h, int x0, int y0, int w, int h_px) {
+    static uint32_t ref[DEPTH_HIST_MAX_BINS];
+    uint32_t below = 0, above = 0, invalid = 0;
+    memset(ref, 0, sizeof(ref));
+    for (int y = y0; y < y0 + h_px; y++) {
+        for (int x = x0; x < x0 + w; x++) {
+            uint16_t d = distance[y * SENSOR_WIDTH + x];
+            if (!region_pixel_valid(d)) {
+                invalid++;
+            } else if (d < h->min_mm) {
+                below++;
+            } else if (d >= h->max_mm) {
+                above++;
+            } else {
+                ref[(uint32_t)(d - h->min_mm) * (uint32_t)h->bins / (uint32_t)(h->max_mm - h->min_mm)]++;
+            }
+        }
+    }
+    return below == h->below && above == h->above && invalid == h->invalid &&
+           memcmp(ref, h->count, (size_t)h->bins * sizeof(ref[0])) == 0;
+}
+
+int test_range_init(void) {
+    depth_hist_range_t r;
+    TEST_ASSERT(depth_hist_range_init(&r, 64, 0, 10000) == 0 && r.bins == 64, "valid range rejected");
+    TEST_ASSERT(depth_hist_range_init(&r, 0, 0, 10000) == -1, "zero bins accepted");
+    TEST_ASSERT(depth_hist_range_init(&r, DEPTH_HIST_MAX_BINS + 1, 0, 10000) == -1, "too many bins accepted");
+    TEST_ASSERT(depth_hist_range_init(&r, 16, 500, 500) == -1, "empty range accepted");
+    TEST_ASSERT(depth_hist_range_init(&r, 16, 500, 510) == -1, "bins narrower than 1 mm accepted");
+    TEST_ASSERT(depth_hist_range_init(&r, 16, 500, 516) == -1, "1 mm bins accepted");
+    TEST_ASSERT(depth_hist_range_init(&r, 256, 0, 64999) == 0, "full range rejected");
+    TEST_SUCCESS();
+}
+
+int test_binning(void) {
+    static const struct { int bins; uint16_t min, max; } cfg[4] = {
+        {64, 0, 10000}, {256, 0, 64999}, {7, 2000, 6001}, {1, 1, 65000},
+    };
+    for (unsigned seed = 1; seed < 4; seed++) {
+        make_scene(seed);
+        for (int c = 0; c < 4; c++) {
+            depth_hist_range_t r;
+            depth_hist_range_init(&r, cfg[c].bins, cfg[c].min, cfg[c].max);
+            depth_hist_compute(&hist, &scratch, &r, distance, SENSOR_WIDTH, 0, 0, SENSOR_WIDTH, SENSOR_HEIGHT);
+            TEST_ASSERT(same_as_reference(&hist, 0, 0, SENSOR_WIDTH, SENSOR_HEIGHT), "frame histogram differs");
+            // Breite nicht durch die Lane-Anzahl teilbar
+            depth_hist_compute(&hist, &scratch, &r, distance, SENSOR_WIDTH, 3, 7, 37, 11);
+            TEST_ASSERT(same_as_reference(&hist, 3, 7, 37, 11), "region histogram differs");
+        }
+    }
+    TEST_SUCCESS();
+}
+
+int test_edges(void) {
+    depth_hist_range_t r;
+    depth_hist_range_init(&r, 10, 1000, 2000);
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        distance[i] = 65300;
+    }
+    uint16_t probe[8] = {999, 1000, 1099, 1100, 1999, 2000, 0, 64999};
+    memcpy(distance, probe, sizeof(probe));
+    depth_hist_compute(&hist, &scratch, &r, distance, SENSOR_WIDTH, 0, 0, 8, 1);
+    TEST_ASSERT(hist.below == 1 && hist.above == 2 && hist.invalid == 1, "below/above/invalid wrong");
+    TEST_ASSERT(hist.count[0] == 2 && hist.count[1] == 1 && hist.count[9] == 1, "bin edges wrong");
+    TEST_SUCCESS();
+}
+
+int test_merge_bands(void) {
+    make_scene(7);
+    depth_hist_range_t r;
+    depth_hist_range_init(&r, 48, 0, 12000);
+    depth_hist_compute(&hist, &scratch, &r, distance, SENSOR_WIDTH, 0, 0, SENSOR_WIDTH, SENSOR_HEIGHT);
+
+    // Zwei Zeilenbänder getrennt (wie zwei Threads), danach zusammengeführt
+    depth_hist_partial_clear(&band[0], &r);
+    depth_hist_partial_clear(&band[1], &r);
+    depth_hist_accumulate(&band[0], &r, distance, SENSOR_WIDTH, 0, 0, SENSOR_WIDTH, 25);
+    depth_hist_accumulate(&band[1], &r, distance, SENSOR_WIDTH, 0, 25, SENSOR_WIDTH, SENSOR_HEIGHT - 25);
+    depth_hist_reset(&merged, &r);
+    depth_hist_merge(&merged, &band[0]);
+    depth_hist_merge(&merged, &band[1]);
+    TEST_ASSERT(memcmp(&merged, &hist, sizeof(hist)) == 0, "merged bands differ from frame histogram");
+
+    uint32_t total = merged.below + merged.above + merged.invalid;
+    for (int b = 0; b < merged.bins; b++) {
+        total += merged.count[b];
+    }
+    TEST_ASSERT(total == SENSOR_PIXELS, "pixels lost or counted twice");
+    TEST_SUCCESS();
+}
+
+int test_auto_range(void) {
+    depth_hist_range_t r;
+    depth_hist_range_init(&r, 100, 0, 10000);
+    // 1 % nah (500 mm), 98 % bei 3000..3999 mm, 1 % fern (9000 mm), dazu ungültige
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        distance[i] = (uint16_t)(3000 + i % 1000);
+    }
+    for (int i = 0; i < 96; i++) {
+        distance[i] = 500;
+        distance[SENSOR_PIXELS - 1 - i] = 9000;
+    }
+    for (int i = 100; i < 400; i++) {
+        distance[i] = 65530;
+    }
+    depth_hist_compute(&hist, &scratch, &r, distance, SENSOR_WIDTH, 0, 0, SENSOR_WIDTH, SENSOR_HEIGHT);
+
+    uint16_t lo, hi;
+    TEST_ASSERT(depth_hist_auto_range(&hist, 2.0f, 98.0f, &lo, &hi) == 0, "auto range failed");
+    TEST_ASSERT(lo == 3000 && hi == 4000, "percentile range not on the main cluster");
+    TEST_ASSERT(depth_hist_auto_range(&hist, 0.0f, 100.0f, &lo, &hi) == 0 && lo == 500 && hi == 9100,
+                "full range wrong");
+
+    // Alles über dem Bereich
+    memset(&hist.count, 0, sizeof(hist.count));
+    hist.below = 0;
+    hist.above = 10;
+    TEST_ASSERT(depth_hist_auto_range(&hist, 2.0f, 98.0f, &lo, &hi) == 0 && lo == 10000 && hi == 10000,
+                "range above the histogram wrong");
+    hist.above = 0;
+    TEST_ASSERT(depth_hist_auto_range(&hist, 2.0f, 98.0f, &lo, &hi) == -1, "empty histogram gave a range");
+    TEST_SUCCESS();
+}
+
+int test_counts_json(void) {
+    depth_hist_range_t r;
+    depth_hist_range_init(&r, 3, 0, 300);
+    depth_hist_reset(&hist, &r);
+    hist.count[0] = 5;
+    hist.count[2] = 12345;
+    char out[32];
+    TEST_ASSERT(depth_hist_counts_json(&hist, out, sizeof(out)) == 11 && strcmp(out, "[5,0,12345]") == 0,
+                "JSON array wrong");
+    TEST_ASSERT(depth_hist_counts_json(&hist, out, 12) == 11, "exact buffer rejected");
+    TEST_ASSERT(depth_hist_counts_json(&hist, out, 11) == -1, "short buffer accepted");
+
+    // Noch nicht berechnetes Histogramm ohne Klassen
+    depth_hist_t empty;
+    memset(&empty, 0, sizeof(empty));
+    TEST_ASSERT(depth_hist_counts_json(&empty, out, sizeof(out)) == 2 && strcmp(out, "[]") == 0,
+                "empty histogram not an empty array");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Depth Histogram Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_range_init();
+    total_tests++; passed_tests += test_binning();
+    total_tests++; passed_tests += test_edges();
+    total_tests++; passed_tests += test_merge_bands();
+    total_tests++; passed_tests += test_auto_range();
+    total_tests++; passed_tests += test_counts_json();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
@@ -0,0 +1,276 @@
+/*
+ * Unit tests for the pty device emulator
+ *
+ * The emulator replays trigger bundles or synthetic packets; the service-side
+ * HPS3DAPI (open serial transport) connects to its slave path like to a
+ * real /dev/ttyACM device.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "HPS3DUser_IF.h"
+#include "packet_builder.h"
+#include "device_emulator.h"
+#include "trigger_capture.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static uint8_t packet[PACKET_FULL_DEPTH_SIZE];
+static char bundle_path[64];
+
+static _Atomic int frames;
+static _Atomic int errors;
+static uint32_t frame_cnts[64];
+static uint64_t first_ns, last_ns;
+
+static uint64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void on_event(int handle, int type, uint8_t *data, int len, void *user) {
+    (void)handle;
+    (void)user;
+    if (type == HPS3D_DISCONNECT_EVEN) {
+        return;
+    }
+    if (type != HPS3D_FULL_DEPTH_EVEN || packet_validate(data, len, HPS3D_FULL_DEPTH_EVEN) != len) {
+        atomic_fetch_add(&errors, 1);
+        return;
+    }
+    int n = atomic_load(&frames);
+    if (n < 64) {
+        frame_cnts[n] = ((uint32_t)data[6] << 24) | ((uint32_t)data[7] << 16) | ((uint32_t)data[8] << 8) | data[9];
+    }
+    last_ns = now_ns();
+    if (n == 0) {
+        first_ns = last_ns;
+    }
+    atomic_fetch_add(&frames, 1);
+}
+
+static void reset_counters(void) {
+    atomic_store(&frames, 0);
+    atomic_store(&errors, 0);
+    memset(frame_cnts, 0, sizeof(frame_cnts));
+    first_ns = last_ns = 0;
+}
+
+static void wait_frames(int want, int timeout_ms) {
+    for (int i = 0; i < timeout_ms / 5 && atomic_load(&frames) < want; i++) {
+        usleep(5000);
+    }
+}
+
+// Trigger bundle as written by trigger_capture: 4 full-depth packets 40 ms apart
+// and one simple-depth packet
+static int write_bundle(const char *path) {
+    FILE *fp = fopen(path, "wb");
+    if (!fp) {
+        return -1;
+    }
+    trigger_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TRIGGER_FILE_MAGIC, sizeof(header.magic));
+    header.version = TRIGGER_FILE_VERSION;
+    header.header_size = sizeof(header);
+    header.record_size = sizeof(trigger_record_t);
+    header.pre_frames = 2;
+    header.post_frames = 3;
+    fwrite(&header, sizeof(header), 1, fp);
+    for (int i = 0; i < 5; i++) {
+        trigger_record_t record;
+        memset(&record, 0, sizeof(record));
+        int len = i < 4 ? pb_full_depth(packet, (uint16_t)(1000 + i), (uint32_t)(100 + i))
+                        : pb_simple_depth(packet, 900, 104);
+        record.len = (uint32_t)len;
+        record.event_type = i < 4 ? HPS3D_FULL_DEPTH_EVEN : HPS3D_SIMPLE_DEPTH_EVEN;
+        record.seq = (uint32_t)i;
+        record.rel_us = (int64_t)(i - 2) * 40000;
+        fwrite(&record, sizeof(record), 1, fp);
+        fwrite(packet, (size_t)len, 1, fp);
+    }
+    return fclose(fp);
+}
+
+static void add_synthetic(device_emulator_t *emu, int count) {
+    for (int i = 0; i < count; i++) {
+        int len = pb_full_depth(packet, 1200, (uint32_t)i);
+        device_emulator_add_frame(emu, HPS3D_FULL_DEPTH_EVEN, packet, len, 0);
+    }
+}
+
+int test_load_bundle(void) {
+    emu_config_t cfg;
+    device_emulator_defaults(&cfg);
+    device_emulator_t emu;
+    device_emulator_init(&emu, &cfg);
+    TEST_ASSERT(device_emulator_load(&emu, bundle_path) == 5, "bundle not loaded");
+    TEST_ASSERT(emu.count == 5 && emu.frames[0].len == PACKET_FULL_DEPTH_SIZE &&
+                emu.frames[4].len == PACKET_SIMPLE_DEPTH_SIZE, "packet lengths wrong");
+    TEST_ASSERT(emu.frames[0].event_type == HPS3D_FULL_DEPTH_EVEN &&
+                emu.frames[4].event_type == HPS3D_SIMPLE_DEPTH_EVEN, "event types wrong");
+    TEST_ASSERT(emu.frames[0].rel_us == -80000 && emu.frames[3].rel_us == 40000, "timestamps wrong");
+    device_emulator_destroy(&emu);
+
+    device_emulator_init(&emu, &cfg);
+    TEST_ASSERT(device_emulator_load(&emu, "/nonexistent/bundle.h3t") == -1, "missing file accepted");
+    uint8_t junk[4] = {0};
+    TEST_ASSERT(device_emulator_add_frame(&emu, HPS3D_FULL_DEPTH_EVEN, junk, 0, 0) == -1, "empty packet accepted");
+    device_emulator_destroy(&emu);
+    TEST_SUCCESS();
+}
+
+int test_fixed_rate(void) {
+    emu_config_t cfg;
+    device_emulator_defaults(&cfg);
+    cfg.rate_hz = 200.0;
+    cfg.max_frames = 30;
+    device_emulator_t emu;
+    device_emulator_init(&emu, &cfg);
+    add_synthetic(&emu, 8);
+    TEST_ASSERT(device_emulator_start(&emu) == 0, "emulator start failed");
+
+    reset_counters();
+    HPS3D_RegisterEventCallback(on_event, NULL);
+    int handle = -1;
+    TEST_ASSERT(HPS3D_USBConnectDevice(emu.slave, &handle) == HPS3D_RET_OK, "connect failed");
+    TEST_ASSERT(strcmp((const char *)HPS3D_GetDeviceVersion(handle), cfg.version) == 0, "version wrong");
+    TEST_ASSERT(HPS3D_StartCapture(handle) == HPS3D_RET_OK, "start failed");
+    wait_frames(30, 2000);
+    usleep(50000);   // Nothing after max_frames
+
+    TEST_ASSERT(atomic_load(&frames) == 30 && atomic_load(&errors) == 0, "frame count wrong");
+    for (int i = 0; i < 30; i++) {
+        TEST_ASSERT(frame_cnts[i] == (uint32_t)(i % 8), "frames out of order or not looped");
+    }
+    // 29 periods of 5 ms; generous upper bound for loaded build servers
+    double span_ms = (double)(last_ns - first_ns) / 1e6;
+    TEST_ASSERT(span_ms > 120.0 && span_ms < 1000.0, "rate not applied");
+    TEST_ASSERT(atomic_load(&emu.sent) == 30 && device_emulator_stamp(&emu, 29) != 0, "send stamps missing");
+
+    HPS3D_StopCapture(handle);
+    HPS3D_CloseDevice(handle);
+    HPS3D_UnregisterEventCallback();
+    device_emulator_destroy(&emu);
+    TEST_SUCCESS();
+}
+
+int test_recorded_timing(void) {
+    emu_config_t cfg;
+    device_emulator_defaults(&cfg);
+    cfg.rate_hz = 0.0;
+    cfg.speed = 2.0;
+    cfg.loop = 0;
+    device_emulator_t emu;
+    device_emulator_init(&emu, &cfg);
+    // Full-depth packets only: 0, 40, 80, 120 ms recorded, played at double speed
+    for (int i = 0; i < 4; i++) {
+        int len = pb_full_depth(packet, 1000, (uint32_t)(200 + i));
+        device_emulator_add_frame(&emu, HPS3D_FULL_DEPTH_EVEN, packet, len, (int64_t)i * 40000);
+    }
+    TEST_ASSERT(device_emulator_start(&emu) == 0, "emulator start failed");
+
+    reset_counters();
+    HPS3D_RegisterEventCallback(on_event, NULL);
+    int handle = -1;
+    TEST_ASSERT(HPS3D_USBConnectDevice(emu.slave, &handle) == HPS3D_RET_OK, "connect failed");
+    TEST_ASSERT(HPS3D_StartCapture(handle) == HPS3D_RET_OK, "start failed");
+    wait_frames(4, 2000);
+    usleep(100000);   // Without loop the stream ends with the recording
+
+    TEST_ASSERT(atomic_load(&frames) == 4 && frame_cnts[3] == 203, "recording not replayed once");
+    double span_ms = (double)(last_ns - first_ns) / 1e6;
+    TEST_ASSERT(span_ms > 50.0 && span_ms < 500.0, "recorded timing not applied");
+    TEST_ASSERT(!atomic_load(&emu.streaming), "still streaming after the recording");
+
+    HPS3D_CloseDevice(handle);
+    HPS3D_UnregisterEventCallback();
+    device_emulator_destroy(&emu);
+    TEST_SUCCESS();
+}
+
+int test_single_settings_reconnect(void) {
+    emu_config_t cfg;
+    device_emulator_defaults(&cfg);
+    device_emulator_t emu;
+    device_emulator_init(&emu, &cfg);
+    TEST_ASSERT(device_emulator_load(&emu, bundle_path) == 5, "bundle not loaded");
+    TEST_ASSERT(device_emulator_start(&emu) == 0, "emulator start failed");
+
+    static HPS3D_MeasureData_t data;
+    TEST_ASSERT(HPS3D_MeasureDataInit(&data) == HPS3D_RET_OK, "measure data init failed");
+    int handle = -1;
+    TEST_ASSERT(HPS3D_USBConnectDevice(emu.slave, &handle) == HPS3D_RET_OK, "connect failed");
+    HPS3D_EventType_t type;
+    TEST_ASSERT(HPS3D_SingleCapture(handle, &type, &data) == HPS3D_RET_OK && type == HPS3D_FULL_DEPTH_EVEN &&
+                data.full_depth_data.frame_cnt == 100, "first recorded packet not returned");
+    TEST_ASSERT(HPS3D_SingleCapture(handle, &type, &data) == HPS3D_RET_OK &&
+                data.full_depth_data.frame_cnt == 101, "packets not returned in order");
+
+    TEST_ASSERT(HPS3D_SetDistanceOffset(handle, -25) == HPS3D_RET_OK &&
+                HPS3D_SetOpticalPathCalibration(handle, true) == HPS3D_RET_OK, "setters failed");
+    HPS3D_DeviceSettings_t settings;
+    TEST_ASSERT(HPS3D_ExportSettings(handle, &settings) == HPS3D_RET_OK, "export failed");
+    TEST_ASSERT(settings.max_resolution_X == 160 && settings.max_resolution_Y == 60 &&
+                settings.dist_offset == -25 && settings.optical_path_calibration == 1, "settings not tracked");
+
+    // Host goes away and comes back: the emulator keeps the pty alive
+    TEST_ASSERT(HPS3D_CloseDevice(handle) == HPS3D_RET_OK, "close failed");
+    TEST_ASSERT(HPS3D_USBConnectDevice(emu.slave, &handle) == HPS3D_RET_OK, "reconnect failed");
+    TEST_ASSERT(HPS3D_SingleCapture(handle, &type, &data) == HPS3D_RET_OK &&
+                data.full_depth_data.frame_cnt == 102, "single capture after reconnect failed");
+
+    HPS3D_CloseDevice(handle);
+    HPS3D_MeasureDataFree(&data);
+    device_emulator_destroy(&emu);
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Device Emulator Tests ===\n");
+
+    snprintf(bundle_path, sizeof(bundle_path), "/tmp/test_emulator_%d.h3t", (int)getpid());
+    if (write_bundle(bundle_path) != 0) {
+        printf("FAIL: cannot write %s\n", bundle_path);
+        return 1;
+    }
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_load_bundle();
+    total_tests++; passed_tests += test_fixed_rate();
+    total_tests++; passed_tests += test_recorded_timing();
+    total_tests++; passed_tests += test_single_settings_reconnect();
+
+    unlink(bundle_path);
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
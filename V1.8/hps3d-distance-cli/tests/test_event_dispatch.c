@@ -0,0 +1,220 @@
+/*
+ * Unit tests for the SPSC ring, frame pool and per-handle callback dispatch
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "spsc_ring.h"
+#include "frame_pool.h"
+#include "event_dispatch.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+#define STRESS_ITEMS 200000
+
+static spsc_ring_t stress_ring;
+static void *stress_slots[64];
+
+static void *stress_producer(void *arg) {
+    (void)arg;
+    for (uintptr_t i = 1; i <= STRESS_ITEMS; i++) {
+        while (spsc_ring_push(&stress_ring, (void *)i) != 0) {
+            // Ring voll - Konsument holt auf
+        }
+    }
+    return NULL;
+}
+
+int test_spsc_ring_basic(void) {
+    spsc_ring_t ring;
+    void *slots[4];
+    int a = 1, b = 2;
+
+    TEST_ASSERT(spsc_ring_init(&ring, slots, 3) == -1, "Non power of two accepted");
+    TEST_ASSERT(spsc_ring_init(&ring, slots, 4) == 0, "Init failed");
+    TEST_ASSERT(spsc_ring_pop(&ring) == NULL, "Empty ring returned item");
+    TEST_ASSERT(spsc_ring_push(&ring, &a) == 0 && spsc_ring_push(&ring, &b) == 0, "Push failed");
+    spsc_ring_push(&ring, &a);
+    spsc_ring_push(&ring, &b);
+    TEST_ASSERT(spsc_ring_push(&ring, &a) == -1, "Full ring accepted item");
+    TEST_ASSERT(spsc_ring_count(&ring) == 4, "Count wrong");
+    TEST_ASSERT(spsc_ring_pop(&ring) == &a && spsc_ring_pop(&ring) == &b, "FIFO order broken");
+    TEST_SUCCESS();
+}
+
+int test_spsc_ring_threads(void) {
+    pthread_t producer;
+    TEST_ASSERT(spsc_ring_init(&stress_ring, stress_slots, 64) == 0, "Init failed");
+    TEST_ASSERT(pthread_create(&producer, NULL, stress_producer, NULL) == 0, "Thread start failed");
+
+    uintptr_t expected = 1;
+    int in_order = 1;
+    while (expected <= STRESS_ITEMS) {
+        void *item = spsc_ring_pop(&stress_ring);
+        if (!item) {
+            continue;
+        }
+        in_order &= ((uintptr_t)item == expected);
+        expected++;
+    }
+    pthread_join(producer, NULL);
+    TEST_ASSERT(in_order, "Items lost or reordered");
+    TEST_SUCCESS();
+}
+
+int test_frame_pool(void) {
+    frame_pool_t pool;
+    TEST_ASSERT(frame_pool_init(&pool, 3, 100) == 0, "Init failed");
+    TEST_ASSERT(pool.count == 4, "Count not rounded to power of two");
+
+    frame_buf_t *bufs[4];
+    for (int i = 0; i < 4; i++) {
+        bufs[i] = frame_pool_acquire(&pool);
+        TEST_ASSERT(bufs[i] != NULL, "Acquire failed");
+        TEST_ASSERT(((uintptr_t)bufs[i]->data % 64) == 0, "Buffer not aligned");
+        memset(bufs[i]->data, 0xAB, 100);
+    }
+    TEST_ASSERT(frame_pool_acquire(&pool) == NULL, "Exhausted pool returned buffer");
+    frame_pool_release(&pool, bufs[2]);
+    TEST_ASSERT(frame_pool_available(&pool) == 1, "Release not counted");
+    TEST_ASSERT(frame_pool_acquire(&pool) == bufs[2], "Released buffer not reused");
+
+    frame_pool_destroy(&pool);
+    TEST_SUCCESS();
+}
+
+int test_dispatch_routing(void) {
+    uint8_t packet[64];
+    memset(packet, 0x11, sizeof(packet));
+
+    event_device_t *dev_a = event_dispatch_attach(3);
+    event_device_t *dev_b = event_dispatch_attach(7);
+    TEST_ASSERT(dev_a && dev_b && dev_a != dev_b, "Attach failed");
+    TEST_ASSERT(event_dispatch_attach(3) == dev_a, "Re-attach returned new slot");
+
+    event_dispatch_callback(7, HPS3D_SIMPLE_DEPTH_EVEN, packet, 10, NULL);
+    event_dispatch_callback(3, HPS3D_FULL_DEPTH_EVEN, packet, 64, NULL);
+    event_dispatch_callback(9, HPS3D_FULL_DEPTH_EVEN, packet, 64, NULL);
+
+    frame_buf_t *buf = event_dispatch_next(dev_a, 0);
+    TEST_ASSERT(buf != NULL, "Packet for handle 3 missing");
+    TEST_ASSERT(buf->handle == 3 && buf->len == 64 && buf->event_type == HPS3D_FULL_DEPTH_EVEN, "Metadata wrong");
+    TEST_ASSERT(memcmp(buf->data, packet, 64) == 0, "Payload not copied");
+    event_dispatch_release(dev_a, buf);
+    TEST_ASSERT(event_dispatch_next(dev_a, 0) == NULL, "Packet for other handle routed to 3");
+
+    buf = event_dispatch_next(dev_b, 10);
+    TEST_ASSERT(buf != NULL && buf->len == 10, "Packet for handle 7 missing");
+    event_dispatch_release(dev_b, buf);
+
+    event_dispatch_stats_t stats;
+    event_dispatch_get_stats(dev_a, &stats);
+    TEST_ASSERT(stats.unrouted == 1, "Unrouted packet not counted");
+
+    event_dispatch_detach(dev_a);
+    event_dispatch_detach(dev_b);
+    TEST_SUCCESS();
+}
+
+int test_dispatch_never_blocks(void) {
+    uint8_t packet[64] = {0};
+    event_device_t *dev = event_dispatch_attach(1);
+    TEST_ASSERT(dev != NULL, "Attach failed");
+
+    // Konsument holt nichts ab: Pool läuft voll, danach wird verworfen
+    for (int i = 0; i < EVENT_DISPATCH_BUFFERS + 5; i++) {
+        packet[0] = (uint8_t)i;
+        event_dispatch_callback(1, HPS3D_FULL_DEPTH_EVEN, packet, 64, NULL);
+    }
+    event_dispatch_callback(1, HPS3D_FULL_DEPTH_EVEN, packet, 4096, NULL);
+
+    event_dispatch_stats_t stats;
+    event_dispatch_get_stats(dev, &stats);
+    TEST_ASSERT(stats.received == EVENT_DISPATCH_BUFFERS, "Received count wrong");
+    TEST_ASSERT(stats.dropped == 5, "Dropped count wrong");
+    TEST_ASSERT(stats.oversized == 1, "Oversized packet not rejected");
+
+    frame_buf_t *buf = event_dispatch_next(dev, 0);
+    TEST_ASSERT(buf && buf->data[0] == 0 && buf->seq == 0, "Oldest packet not first");
+    event_dispatch_release(dev, buf);
+
+    // Disconnect wird auch ohne freien Puffer gemeldet
+    event_dispatch_callback(1, HPS3D_DISCONNECT_EVEN, NULL, 0, NULL);
+    event_dispatch_callback(1, HPS3D_DISCONNECT_EVEN, NULL, 0, NULL);
+    TEST_ASSERT(event_dispatch_take_disconnect(dev) == 1, "Disconnect lost");
+    TEST_ASSERT(event_dispatch_take_disconnect(dev) == 0, "Disconnect reported twice");
+
+    event_dispatch_detach(dev);
+    TEST_ASSERT(event_dispatch_next(dev, 0) == NULL, "Detach left packets queued");
+    TEST_SUCCESS();
+}
+
+int test_dispatch_lazy_pools(void) {
+    event_device_t *devs[EVENT_DISPATCH_MAX_DEVICES];
+    uint8_t *storage[EVENT_DISPATCH_MAX_DEVICES];
+
+    // Puffer entstehen erst beim attach(), bleiben danach über detach() hinaus erhalten
+    for (int i = 0; i < EVENT_DISPATCH_MAX_DEVICES; i++) {
+        devs[i] = event_dispatch_attach(20 + i);
+        TEST_ASSERT(devs[i] != NULL, "Attach failed");
+        TEST_ASSERT(devs[i]->pool.count == EVENT_DISPATCH_BUFFERS, "Pool not allocated");
+        storage[i] = devs[i]->pool.storage;
+    }
+    TEST_ASSERT(event_dispatch_attach(99) == NULL, "Attach beyond slot count succeeded");
+
+    for (int i = 0; i < EVENT_DISPATCH_MAX_DEVICES; i++) {
+        event_dispatch_detach(devs[i]);
+    }
+    event_device_t *again = event_dispatch_attach(42);
+    TEST_ASSERT(again != NULL, "Re-attach failed");
+    int reused = 0;
+    for (int i = 0; i < EVENT_DISPATCH_MAX_DEVICES; i++) {
+        reused |= again->pool.storage == storage[i];
+    }
+    TEST_ASSERT(reused, "Slot buffers reallocated");
+    event_dispatch_detach(again);
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Event Dispatch Tests ===\n");
+
+    if (event_dispatch_init(EVENT_DISPATCH_BUFFERS, 1024) != 0) {
+        printf("FAIL: dispatch init\n");
+        return 1;
+    }
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_spsc_ring_basic();
+    total_tests++; passed_tests += test_spsc_ring_threads();
+    total_tests++; passed_tests += test_frame_pool();
+    total_tests++; passed_tests += test_dispatch_routing();
+    total_tests++; passed_tests += test_dispatch_never_blocks();
+    total_tests++; passed_tests += test_dispatch_lazy_pools();
+
+    event_dispatch_shutdown();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
@@ -0,0 +1,129 @@
+/*
+ * Unit tests for the host-side optical path correction
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "optical_path.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static optical_path_t op;
+static uint16_t frame[SENSOR_PIXELS];
+static uint16_t range[SENSOR_PIXELS];
+
+int test_cosine_table(void) {
+    TEST_ASSERT(optical_path_init(&op, OPTICAL_PATH_DEFAULT_FOV_H, OPTICAL_PATH_DEFAULT_FOV_V) == 0, "init failed");
+    // Bildmitte: fast auf der Achse
+    uint16_t center = op.cos_q[30 * SENSOR_WIDTH + 80];
+    TEST_ASSERT(center > OPTICAL_PATH_COS_ONE - 10, "center pixel not on axis");
+    // Rand der mittleren Zeile: knapp der halbe horizontale Öffnungswinkel
+    double edge = (double)op.cos_q[30 * SENSOR_WIDTH] / OPTICAL_PATH_COS_ONE;
+    TEST_ASSERT(fabs(edge - cos(38.0 * 3.14159265 / 180.0)) < 0.01, "edge angle wrong");
+    // Symmetrisch, Ecken am kleinsten
+    TEST_ASSERT(op.cos_q[0] == op.cos_q[SENSOR_PIXELS - 1] &&
+                op.cos_q[0] == op.cos_q[SENSOR_WIDTH - 1], "table not symmetric");
+    TEST_ASSERT(op.cos_q[0] < op.cos_q[30 * SENSOR_WIDTH] && op.cos_q[0] < op.cos_q[80], "corner not smallest");
+    TEST_ASSERT(optical_path_init(&op, 0.0f, 32.0f) == -1 && optical_path_init(&op, 76.0f, 180.0f) == -1,
+                "invalid field of view accepted");
+    TEST_SUCCESS();
+}
+
+int test_split_keeps_both_planes(void) {
+    optical_path_init(&op, OPTICAL_PATH_DEFAULT_FOV_H, OPTICAL_PATH_DEFAULT_FOV_V);
+    // Ebene Wand in 2000 mm: Schrägentfernung wächst zum Rand hin
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        frame[i] = (uint16_t)(2000.0 * OPTICAL_PATH_COS_ONE / op.cos_q[i] + 0.5);
+    }
+    frame[7] = HPS3D_LOW_AMPLITUDE;
+    frame[8] = 1;
+    uint16_t raw[SENSOR_PIXELS];
+    memcpy(raw, frame, sizeof(frame));
+
+    optical_path_split(&op, frame, range);
+    TEST_ASSERT(memcmp(raw, range, sizeof(raw)) == 0, "raw plane not preserved");
+    TEST_ASSERT(frame[7] == HPS3D_LOW_AMPLITUDE && frame[8] == 1, "sentinel or small value wrong");
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        if (i == 7 || i == 8) {
+            continue;
+        }
+        TEST_ASSERT(abs((int)frame[i] - 2000) <= 1, "wall not flat after correction");
+    }
+
+    // Ohne Rohwerte: gleiches Ergebnis
+    memcpy(range, raw, sizeof(raw));
+    optical_path_perpendicular(&op, range);
+    TEST_ASSERT(memcmp(range, frame, sizeof(frame)) == 0, "perpendicular differs from split");
+    TEST_SUCCESS();
+}
+
+int test_roi_matches_full_frame(void) {
+    optical_path_init(&op, OPTICAL_PATH_DEFAULT_FOV_H, OPTICAL_PATH_DEFAULT_FOV_V);
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        frame[i] = (uint16_t)(1000 + i % 3000);
+    }
+    uint16_t roi_distance[6 * 4];
+    for (int y = 0; y < 4; y++) {
+        memcpy(roi_distance + y * 6, frame + (50 + y) * SENSOR_WIDTH + 3, 6 * sizeof(uint16_t));
+    }
+    HPS3D_FullRoiData_t roi = {
+        .left_top_x = 3, .left_top_y = 50, .right_bottom_x = 8, .right_bottom_y = 53,
+        .pixel_number = 24, .distance = roi_distance,
+    };
+    optical_path_perpendicular(&op, frame);
+    optical_path_perpendicular_roi(&op, &roi);
+    for (int y = 0; y < 4; y++) {
+        TEST_ASSERT(memcmp(roi_distance + y * 6, frame + (50 + y) * SENSOR_WIDTH + 3, 6 * sizeof(uint16_t)) == 0,
+                    "ROI corrected differently");
+    }
+    TEST_SUCCESS();
+}
+
+int test_split_cost(void) {
+    struct timespec start, end;
+    optical_path_init(&op, OPTICAL_PATH_DEFAULT_FOV_H, OPTICAL_PATH_DEFAULT_FOV_V);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < 1000; r++) {
+        memcpy(frame, range, sizeof(frame));
+        optical_path_split(&op, frame, range);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double us = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / 1000.0 / 1000.0;
+    printf("  split: %.1f us per frame\n", us);
+    TEST_ASSERT(us < 1000.0, "split pass unreasonably slow");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Optical Path Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_cosine_table();
+    total_tests++; passed_tests += test_split_keeps_both_planes();
+    total_tests++; passed_tests += test_roi_matches_full_frame();
+    total_tests++; passed_tests += test_split_cost();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
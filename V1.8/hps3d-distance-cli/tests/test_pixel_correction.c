@@ -0,0 +1,189 @@
+/*
+ * Unit tests for the per-pixel offset/gain correction
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "pixel_correction.h"
+#include "region.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static pixel_correction_t table;
+static pixel_calib_accum_t acc_a, acc_b;
+static uint16_t frame[SENSOR_PIXELS];
+
+// Festes Muster des Sensors: Gain und Offset je Pixel
+static float true_gain(int i) {
+    return 1.0f + (float)((i * 7) % 21 - 10) / 400.0f;
+}
+
+static float true_offset(int i) {
+    return (float)((i * 13) % 41 - 20);
+}
+
+// Rohwert, den der Sensor bei Entfernung mm liefert (Umkehrung der Korrektur)
+static void flat_frame(uint32_t mm, int noise) {
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        float raw = ((float)mm - true_offset(i)) / true_gain(i);
+        frame[i] = (uint16_t)(raw + 0.5f + (float)(noise ? (i + (int)mm) % 3 - 1 : 0));
+    }
+}
+
+int test_identity_passes_through(void) {
+    pixel_correction_identity(&table);
+    flat_frame(1500, 0);
+    frame[5] = HPS3D_LOW_AMPLITUDE;
+    frame[6] = 0;
+    uint16_t before[SENSOR_PIXELS];
+    memcpy(before, frame, sizeof(frame));
+    pixel_correction_apply(&table, frame);
+    TEST_ASSERT(memcmp(before, frame, sizeof(frame)) == 0, "identity changed the frame");
+    TEST_SUCCESS();
+}
+
+int test_two_point_calibration(void) {
+    pixel_calib_reset(&acc_a);
+    pixel_calib_reset(&acc_b);
+    for (int f = 0; f < 30; f++) {
+        flat_frame(1000, 1);
+        pixel_calib_add(&acc_a, frame);
+        flat_frame(2500, 1);
+        pixel_calib_add(&acc_b, frame);
+    }
+    TEST_ASSERT(pixel_correction_from_flat(&table, &acc_a, 1000, &acc_b, 2500) == 0, "pixels left uncalibrated");
+    TEST_ASSERT(table.info.reference_mm[0] == 1000 && table.info.reference_mm[1] == 2500 &&
+                table.info.frames == 30, "calibration info wrong");
+
+    // Dazwischen und außerhalb: innerhalb von 2 mm der Wahrheit
+    static const uint32_t probes[] = {800, 1700, 3000};
+    for (int p = 0; p < 3; p++) {
+        flat_frame(probes[p], 0);
+        pixel_correction_apply(&table, frame);
+        for (int i = 0; i < SENSOR_PIXELS; i++) {
+            int err = (int)frame[i] - (int)probes[p];
+            TEST_ASSERT(err >= -2 && err <= 2, "corrected distance off");
+        }
+    }
+
+    // Sentinels bleiben, Werte bleiben im gültigen Bereich
+    frame[0] = HPS3D_SATURATION;
+    frame[1] = 64990;
+    frame[2] = 1;
+    table.gain[1] = PIXEL_CORRECTION_GAIN_ONE * 2 - 1;
+    table.offset[2] = -50;
+    pixel_correction_apply(&table, frame);
+    TEST_ASSERT(frame[0] == HPS3D_SATURATION, "sentinel modified");
+    TEST_ASSERT(frame[1] == REGION_INVALID_MIN - 1 && frame[2] == 1, "result not clamped to valid range");
+    TEST_SUCCESS();
+}
+
+int test_offset_only_and_bad_pixels(void) {
+    pixel_calib_reset(&acc_a);
+    for (int f = 0; f < 20; f++) {
+        flat_frame(1200, 0);
+        frame[100] = HPS3D_LOW_AMPLITUDE;           // Nie gültig
+        if (f % 2) {
+            frame[200] = HPS3D_LOW_AMPLITUDE;       // Nur halb so oft gültig
+        }
+        pixel_calib_add(&acc_a, frame);
+    }
+    TEST_ASSERT(pixel_correction_from_flat(&table, &acc_a, 1200, NULL, 0) == 2, "bad pixels not counted");
+    TEST_ASSERT(table.gain[100] == PIXEL_CORRECTION_GAIN_ONE && table.offset[100] == 0, "dead pixel corrected");
+    TEST_ASSERT(table.gain[200] == PIXEL_CORRECTION_GAIN_ONE && table.offset[200] == 0, "flaky pixel corrected");
+    TEST_ASSERT(table.gain[300] == PIXEL_CORRECTION_GAIN_ONE && table.offset[300] != 0, "offset not fitted");
+
+    flat_frame(1200, 0);
+    pixel_correction_apply(&table, frame);
+    TEST_ASSERT(abs((int)frame[300] - 1200) <= 1, "offset-only correction wrong at reference");
+
+    // Geräte-ROI: dieselbe Korrektur wie an der Sensorposition
+    uint16_t roi_distance[8 * 3];
+    HPS3D_FullRoiData_t roi = {
+        .left_top_x = 140, .left_top_y = 1, .right_bottom_x = 147, .right_bottom_y = 3,
+        .pixel_number = 24, .distance = roi_distance,
+    };
+    flat_frame(1200, 0);
+    for (int y = 0; y < 3; y++) {
+        memcpy(roi_distance + y * 8, frame + (1 + y) * SENSOR_WIDTH + 140, 8 * sizeof(uint16_t));
+    }
+    pixel_correction_apply(&table, frame);
+    pixel_correction_apply_roi(&table, &roi);
+    for (int y = 0; y < 3; y++) {
+        TEST_ASSERT(memcmp(roi_distance + y * 8, frame + (1 + y) * SENSOR_WIDTH + 140, 8 * sizeof(uint16_t)) == 0,
+                    "ROI corrected differently");
+    }
+    TEST_ASSERT(pixel_correction_from_flat(&table, &acc_a, 0, NULL, 0) == -1, "zero reference accepted");
+    TEST_ASSERT(pixel_correction_from_flat(&table, &acc_a, 1200, &acc_a, 1200) == -1, "equal references accepted");
+    TEST_SUCCESS();
+}
+
+int test_save_load_roundtrip(void) {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_pixel_correction_%d.bin", (int)getpid());
+    static pixel_correction_t loaded;
+    TEST_ASSERT(pixel_correction_save(&table, path) == 0, "save failed");
+    TEST_ASSERT(pixel_correction_load(&loaded, path) == 0, "load failed");
+    TEST_ASSERT(memcmp(loaded.offset, table.offset, sizeof(table.offset)) == 0 &&
+                memcmp(loaded.gain, table.gain, sizeof(table.gain)) == 0 &&
+                loaded.info.reference_mm[0] == table.info.reference_mm[0], "table not restored");
+
+    FILE *fp = fopen(path, "r+b");
+    TEST_ASSERT(fp != NULL, "reopen failed");
+    fseek(fp, 10, SEEK_SET);  // Breite
+    fputc(0x7f, fp);
+    fclose(fp);
+    TEST_ASSERT(pixel_correction_load(&loaded, path) == -1, "wrong resolution accepted");
+    TEST_ASSERT(pixel_correction_load(&loaded, "/nonexistent/cal.bin") == -1, "missing file accepted");
+    unlink(path);
+    TEST_SUCCESS();
+}
+
+int test_apply_cost(void) {
+    struct timespec start, end;
+    flat_frame(1500, 1);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int r = 0; r < 1000; r++) {
+        pixel_correction_apply(&table, frame);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double us = ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / 1000.0 / 1000.0;
+    printf("  apply: %.1f us per frame\n", us);
+    TEST_ASSERT(us < 1000.0, "correction pass unreasonably slow");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Pixel Correction Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_identity_passes_through();
+    total_tests++; passed_tests += test_two_point_calibration();
+    total_tests++; passed_tests += test_offset_only_and_bad_pixels();
+    total_tests++; passed_tests += test_save_load_roundtrip();
+    total_tests++; passed_tests += test_apply_cost();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
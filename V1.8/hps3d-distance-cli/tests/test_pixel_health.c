@@ -0,0 +1,190 @@
+/*
+ * Unit tests for the dead/stuck pixel tracker
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "pixel_health.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+#define DEAD_PIXEL (10 * SENSOR_WIDTH + 20)
+#define STUCK_PIXEL (30 * SENSOR_WIDTH + 100)
+
+static pixel_health_t ph;
+static uint16_t frame[SENSOR_PIXELS];
+static uint32_t rng_state = 4711;
+
+static uint32_t rng_next(void) {
+    rng_state = rng_state * 1664525u + 1013904223u;
+    return rng_state >> 8;
+}
+
+// Verrauschte Szene; optional ein toter und ein eingefrorener Pixel
+static void make_frame(int dead, int stuck) {
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        frame[i] = (uint16_t)(1200 + (i / SENSOR_WIDTH) * 10 + rng_next() % 9);
+    }
+    if (dead) {
+        frame[DEAD_PIXEL] = HPS3D_LOW_AMPLITUDE;
+    }
+    if (stuck) {
+        frame[STUCK_PIXEL] = 777;
+    }
+}
+
+// Ganze Fenster einrechnen; Rückgabe: Anzahl Maskenänderungen
+static int run_windows(int windows, int dead, int stuck) {
+    int changes = 0;
+    for (uint32_t f = 0; f < (uint32_t)windows * ph.window * ph.every; f++) {
+        make_frame(dead, stuck);
+        changes += pixel_health_update(&ph, frame);
+    }
+    return changes;
+}
+
+static void setup(void) {
+    pixel_health_init(&ph);
+    ph.every = 2;
+    ph.window = 16;
+}
+
+int test_marks_dead_and_stuck_pixels(void) {
+    setup();
+    TEST_ASSERT(run_windows(2, 1, 1) == 0 && ph.bad_count == 0, "masked before mark_windows");
+    TEST_ASSERT(ph.strikes[DEAD_PIXEL] == 2 && ph.strikes[STUCK_PIXEL] == 2, "strikes not counted");
+    TEST_ASSERT(run_windows(1, 1, 1) == 1, "mask change not reported");
+    TEST_ASSERT(ph.bad_count == 2 && ph.dead == 1 && ph.stuck == 1, "wrong pixels masked");
+    TEST_ASSERT(ph.mask[DEAD_PIXEL] == PIXEL_DEAD && ph.mask[STUCK_PIXEL] == PIXEL_STUCK, "wrong reasons");
+    TEST_ASSERT(ph.windows == 3 && ph.scene_windows == 0, "window count wrong");
+    TEST_SUCCESS();
+}
+
+int test_apply_masks_planes(void) {
+    static HPS3D_PerPointCloudData_t points[SENSOR_PIXELS];
+    setup();
+    run_windows(3, 1, 1);
+    make_frame(1, 1);
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        points[i].x = 1.0f;
+        points[i].y = 2.0f;
+        points[i].z = (float)frame[i];
+    }
+    pixel_health_apply(&ph, frame, points);
+    TEST_ASSERT(frame[STUCK_PIXEL] == HPS3D_INVALID_DATA && points[STUCK_PIXEL].z == 0.0f, "stuck pixel not masked");
+    TEST_ASSERT(frame[DEAD_PIXEL] == HPS3D_INVALID_DATA, "dead pixel not masked");
+    TEST_ASSERT(frame[STUCK_PIXEL + 1] != HPS3D_INVALID_DATA && points[STUCK_PIXEL + 1].z > 0.0f,
+                "healthy neighbour masked");
+
+    // Geräte-ROI um den eingefrorenen Pixel: Index in ROI-Koordinaten
+    uint16_t roi_distance[10 * 5];
+    for (int i = 0; i < 50; i++) {
+        roi_distance[i] = 1000;
+    }
+    HPS3D_FullRoiData_t roi = {
+        .left_top_x = 95, .left_top_y = 28, .right_bottom_x = 104, .right_bottom_y = 32,
+        .pixel_number = 50, .distance = roi_distance,
+    };
+    pixel_health_apply_roi(&ph, &roi);
+    TEST_ASSERT(roi_distance[2 * 10 + 5] == HPS3D_INVALID_DATA, "ROI pixel not masked");
+    int masked = 0;
+    for (int i = 0; i < 50; i++) {
+        masked += roi_distance[i] == HPS3D_INVALID_DATA;
+    }
+    TEST_ASSERT(masked == 1, "ROI mask hit other pixels");
+    TEST_SUCCESS();
+}
+
+int test_recovery_clears_mask(void) {
+    setup();
+    run_windows(3, 1, 1);
+    TEST_ASSERT(ph.bad_count == 2, "setup failed");
+    // Pixel erholen sich: erst nach ebenso vielen guten Fenstern frei
+    run_windows(2, 0, 0);
+    TEST_ASSERT(ph.bad_count == 2, "mask released too early");
+    TEST_ASSERT(run_windows(1, 0, 0) == 1 && ph.bad_count == 0, "mask not released");
+    TEST_SUCCESS();
+}
+
+int test_scene_wide_invalid_is_ignored(void) {
+    setup();
+    // Verdeckte Optik: alle Pixel ungültig
+    for (uint32_t f = 0; f < 4 * ph.window * ph.every; f++) {
+        for (int i = 0; i < SENSOR_PIXELS; i++) {
+            frame[i] = HPS3D_LOW_AMPLITUDE;
+        }
+        pixel_health_update(&ph, frame);
+    }
+    TEST_ASSERT(ph.bad_count == 0 && ph.scene_windows == 4, "scene counted as dead pixels");
+
+    // Wiederholte identische Frames dürfen nicht alles einfrieren
+    make_frame(0, 0);
+    for (uint32_t f = 0; f < 4 * ph.window * ph.every; f++) {
+        pixel_health_update(&ph, frame);
+    }
+    TEST_ASSERT(ph.bad_count == 0 && ph.scene_windows == 8, "repeated frame counted as stuck pixels");
+    TEST_SUCCESS();
+}
+
+int test_save_load_roundtrip(void) {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_pixel_health_%d.bin", (int)getpid());
+    setup();
+    run_windows(3, 1, 1);
+    TEST_ASSERT(pixel_health_save(&ph, path) == 0, "save failed");
+
+    static pixel_health_t loaded;
+    pixel_health_init(&loaded);
+    TEST_ASSERT(pixel_health_load(&loaded, path) == 0, "load failed");
+    TEST_ASSERT(loaded.bad_count == 2 && loaded.mask[STUCK_PIXEL] == PIXEL_STUCK &&
+                loaded.strikes[DEAD_PIXEL] == ph.strikes[DEAD_PIXEL], "mask not restored");
+
+    char report[512];
+    TEST_ASSERT(pixel_health_report_json(&loaded, report, sizeof(report)) > 0, "report failed");
+    TEST_ASSERT(strstr(report, "[20, 10, \"dead\"]") && strstr(report, "[100, 30, \"stuck\"]") &&
+                strstr(report, "\"masked\": 2"), "report content wrong");
+    TEST_ASSERT(pixel_health_report_json(&loaded, report, 40) == -1, "truncated report accepted");
+
+    FILE *fp = fopen(path, "r+b");
+    TEST_ASSERT(fp != NULL, "reopen failed");
+    fputc('X', fp);
+    fclose(fp);
+    TEST_ASSERT(pixel_health_load(&loaded, path) == -1, "corrupt file accepted");
+    TEST_ASSERT(pixel_health_load(&loaded, "/nonexistent/mask.bin") == -1, "missing file accepted");
+    unlink(path);
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Pixel Health Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_marks_dead_and_stuck_pixels();
+    total_tests++; passed_tests += test_apply_masks_planes();
+    total_tests++; passed_tests += test_recovery_clears_mask();
+    total_tests++; passed_tests += test_scene_wide_invalid_is_ignored();
+    total_tests++; passed_tests += test_save_load_roundtrip();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
@@ -0,0 +1,220 @@
+/*
+ * Unit tests for the SoA point cloud, direct SoA decode and analytics kernels
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "packet_builder.h"
+#include "pointcloud.h"
+#include "cloud_analytics.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static uint8_t packet[PACKET_FULL_DEPTH_SIZE];
+static HPS3D_MeasureData_t result;
+static pointcloud_soa_t cloud;
+
+int test_soa_alignment(void) {
+    TEST_ASSERT(((uintptr_t)cloud.x % POINTCLOUD_ALIGN) == 0, "x not aligned");
+    TEST_ASSERT(((uintptr_t)cloud.y % POINTCLOUD_ALIGN) == 0, "y not aligned");
+    TEST_ASSERT(((uintptr_t)cloud.z % POINTCLOUD_ALIGN) == 0, "z not aligned");
+    TEST_ASSERT(cloud.capacity == HPS3D_MAX_PIXEL_NUMBER, "capacity wrong");
+    TEST_SUCCESS();
+}
+
+int test_aos_soa_roundtrip(void) {
+    HPS3D_PerPointCloudData_t in[5] = {
+        {1.0f, 2.0f, 3.0f}, {-4.0f, 5.5f, 6.0f}, {0.0f, 0.0f, 0.0f}, {7.0f, -8.0f, 9.25f}, {1e3f, 2e3f, 3e3f}
+    };
+    HPS3D_PerPointCloudData_t out[5];
+
+    TEST_ASSERT(pointcloud_aos_to_soa(in, 5, &cloud) == 0, "AoS->SoA failed");
+    TEST_ASSERT(cloud.count == 5, "count wrong");
+    TEST_ASSERT(cloud.y[1] == 5.5f, "y wrong");
+    pointcloud_soa_to_aos(&cloud, out);
+    TEST_ASSERT(memcmp(in, out, sizeof(in)) == 0, "Roundtrip mismatch");
+    TEST_ASSERT(pointcloud_aos_to_soa(in, HPS3D_MAX_PIXEL_NUMBER + 1, &cloud) == -1, "Overflow accepted");
+    TEST_SUCCESS();
+}
+
+int test_soa_decode_matches_aos(void) {
+    int len = pb_full_depth(packet, 1500, 9);
+    TEST_ASSERT(packet_parse(packet, len, &result, HPS3D_FULL_DEPTH_EVEN) == len, "AoS parse failed");
+
+    static uint16_t distance[HPS3D_MAX_PIXEL_NUMBER];
+    HPS3D_DepthData_t depth;
+    memset(&depth, 0, sizeof(depth));
+    depth.distance = distance;
+
+    TEST_ASSERT(packet_parse_full_depth_soa(packet, len, &depth, &cloud) == len, "SoA parse failed");
+    TEST_ASSERT(cloud.count == HPS3D_MAX_PIXEL_NUMBER, "count wrong");
+    TEST_ASSERT(cloud.width == 160 && cloud.height == 60, "organized size wrong");
+    TEST_ASSERT(depth.frame_cnt == 9, "frame_cnt wrong");
+    TEST_ASSERT(memcmp(distance, result.full_depth_data.distance, sizeof(distance)) == 0, "distance mismatch");
+
+    const HPS3D_PerPointCloudData_t *p = result.full_depth_data.point_cloud_data.point_data;
+    for (int i = 0; i < HPS3D_MAX_PIXEL_NUMBER; i++) {
+        TEST_ASSERT(cloud.x[i] == p[i].x && cloud.y[i] == p[i].y && cloud.z[i] == p[i].z, "point mismatch");
+    }
+
+    TEST_ASSERT(packet_parse_full_depth_soa(packet, len - 1, &depth, &cloud) == -1, "Truncated packet accepted");
+
+    pointcloud_soa_t small;
+    TEST_ASSERT(pointcloud_soa_init(&small, 100) == 0, "small init failed");
+    TEST_ASSERT(packet_parse_full_depth_soa(packet, len, &depth, &small) == -1, "Capacity overflow accepted");
+    pointcloud_soa_free(&small);
+    TEST_SUCCESS();
+}
+
+int test_transform(void) {
+    HPS3D_PerPointCloudData_t in[3] = {{1.0f, 0.0f, 10.0f}, {0.0f, 2.0f, 20.0f}, {5.0f, 5.0f, 0.0f}};
+    pointcloud_aos_to_soa(in, 3, &cloud);
+
+    // 90° um z, dann +100 in x
+    const float m[12] = {0, -1, 0, 100,
+                         1,  0, 0,   0,
+                         0,  0, 1,   0};
+    TEST_ASSERT(cloud_transform(&cloud, m, &cloud) == 0, "transform failed");
+    TEST_ASSERT(cloud.x[0] == 100.0f && cloud.y[0] == 1.0f && cloud.z[0] == 10.0f, "point 0 wrong");
+    TEST_ASSERT(cloud.x[1] == 98.0f && cloud.y[1] == 0.0f, "point 1 wrong");
+    TEST_ASSERT(cloud.x[2] == 5.0f && cloud.y[2] == 5.0f, "invalid point modified");
+    TEST_SUCCESS();
+}
+
+int test_voxel_downsample(void) {
+    // 4x4 Gitter mit Abstand 10 auf z=100 plus ein ungültiger Punkt
+    HPS3D_PerPointCloudData_t in[17];
+    for (int i = 0; i < 16; i++) {
+        in[i].x = (float)(i % 4) * 10.0f + 1.0f;
+        in[i].y = (float)(i / 4) * 10.0f + 1.0f;
+        in[i].z = 101.0f;
+    }
+    in[16].x = 0.0f; in[16].y = 0.0f; in[16].z = 0.0f;
+    pointcloud_aos_to_soa(in, 17, &cloud);
+
+    cloud_voxel_workspace_t ws;
+    pointcloud_soa_t out;
+    TEST_ASSERT(cloud_voxel_workspace_init(&ws, HPS3D_MAX_PIXEL_NUMBER) == 0, "workspace init failed");
+    TEST_ASSERT(pointcloud_soa_init(&out, HPS3D_MAX_PIXEL_NUMBER) == 0, "out init failed");
+
+    TEST_ASSERT(cloud_voxel_downsample(&cloud, 20.0f, &ws, &out) == 4, "voxel count (20) wrong");
+    TEST_ASSERT(out.x[0] == 6.0f && out.y[0] == 6.0f && out.z[0] == 101.0f, "centroid wrong");
+    TEST_ASSERT(cloud_voxel_downsample(&cloud, 5.0f, &ws, &out) == 16, "voxel count (5) wrong");
+    // Workspace muss nach jedem Lauf wieder leer sein
+    TEST_ASSERT(cloud_voxel_downsample(&cloud, 100.0f, &ws, &out) == 1, "voxel count (100) wrong");
+    TEST_ASSERT(out.width == 0 && out.height == 0, "output should be unorganized");
+
+    pointcloud_soa_free(&out);
+    cloud_voxel_workspace_free(&ws);
+    TEST_SUCCESS();
+}
+
+int test_voxel_workspace_limit(void) {
+    // Slots werden auf eine Zweierpotenz aufgerundet, touched hat nur max_points Einträge
+    cloud_voxel_workspace_t ws;
+    pointcloud_soa_t in, out;
+    const uint32_t max_points = 100;
+    TEST_ASSERT(cloud_voxel_workspace_init(&ws, max_points) == 0, "workspace init failed");
+    TEST_ASSERT(ws.slots / 2 > max_points, "test needs slack between max_points and slots/2");
+    TEST_ASSERT(pointcloud_soa_init(&in, max_points + 1) == 0 && pointcloud_soa_init(&out, max_points + 1) == 0,
+                "cloud init failed");
+
+    // Jeder Punkt in einem eigenen Voxel
+    for (uint32_t i = 0; i <= max_points; i++) {
+        in.x[i] = (float)i * 10.0f;
+        in.y[i] = 0.0f;
+        in.z[i] = 100.0f;
+    }
+    in.count = max_points + 1;
+    TEST_ASSERT(cloud_voxel_downsample(&in, 1.0f, &ws, &out) == -1, "count above max_points accepted");
+    in.count = max_points;
+    TEST_ASSERT(cloud_voxel_downsample(&in, 1.0f, &ws, &out) == (int)max_points, "count == max_points rejected");
+
+    pointcloud_soa_free(&in);
+    pointcloud_soa_free(&out);
+    cloud_voxel_workspace_free(&ws);
+    TEST_SUCCESS();
+}
+
+int test_ransac_plane(void) {
+    // Ebene z = 0.1*x + 500 mit 20% Ausreißern und ungültigen Pixeln
+    uint32_t state = 42;
+    HPS3D_PerPointCloudData_t *in = malloc(HPS3D_MAX_PIXEL_NUMBER * sizeof(*in));
+    TEST_ASSERT(in != NULL, "alloc failed");
+    int plane_points = 0;
+    for (int i = 0; i < HPS3D_MAX_PIXEL_NUMBER; i++) {
+        state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+        in[i].x = (float)(i % 160) - 80.0f;
+        in[i].y = (float)(i / 160) - 30.0f;
+        if (i % 10 == 0) {
+            in[i].z = 0.0f;
+        } else if (state % 5 == 0) {
+            in[i].z = 200.0f + (float)(state % 1000);
+        } else {
+            in[i].z = 0.1f * in[i].x + 500.0f;
+            plane_points++;
+        }
+    }
+    pointcloud_aos_to_soa(in, HPS3D_MAX_PIXEL_NUMBER, &cloud);
+    free(in);
+
+    cloud_plane_t plane;
+    int inliers = cloud_ransac_plane(&cloud, 100, 1.0f, 7, &plane);
+    TEST_ASSERT(inliers >= plane_points, "too few inliers");
+    TEST_ASSERT(inliers < plane_points + plane_points / 20, "too many inliers");
+
+    // Normale proportional zu (0.1, 0, -1), d entsprechend 500
+    float scale = -plane.c;
+    TEST_ASSERT(fabsf(scale) > 0.9f, "normal not along z");
+    TEST_ASSERT(fabsf(plane.a / scale - 0.1f) < 0.01f, "slope wrong");
+    TEST_ASSERT(fabsf(plane.d / scale - 500.0f) < 1.0f, "offset wrong");
+
+    memset(cloud.z, 0, cloud.capacity * sizeof(float));
+    TEST_ASSERT(cloud_ransac_plane(&cloud, 10, 1.0f, 7, &plane) == -1, "plane found in empty cloud");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Point Cloud Tests ===\n");
+
+    if (pb_measure_data_alloc(&result) != 0 || pointcloud_soa_init(&cloud, HPS3D_MAX_PIXEL_NUMBER) != 0) {
+        printf("FAIL: allocation\n");
+        return 1;
+    }
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_soa_alignment();
+    total_tests++; passed_tests += test_aos_soa_roundtrip();
+    total_tests++; passed_tests += test_soa_decode_matches_aos();
+    total_tests++; passed_tests += test_transform();
+    total_tests++; passed_tests += test_voxel_downsample();
+    total_tests++; passed_tests += test_voxel_workspace_limit();
+    total_tests++; passed_tests += test_ransac_plane();
+
+    pointcloud_soa_free(&cloud);
+    pb_measure_data_free(&result);
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
@@ -0,0 +1,171 @@
+/*
+ * Unit tests for the PointCloud2-compatible binary layout
+ *
+ * Checks the fixed header and field descriptors a ROS bridge relies on, the
+ * conversion of the SoA cloud into organized float32 points, and the
+ * shared-memory seqlock.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "pointcloud2.h"
+#include "region.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static pc2_frame_t frame;
+static pc2_frame_t copy;
+static HPS3D_PerPointCloudData_t points[SENSOR_PIXELS];
+static pointcloud_soa_t cloud;
+static uint16_t distance[SENSOR_PIXELS];
+
+static void make_scene(void) {
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        points[i].x = (float)((i % SENSOR_WIDTH) - 80) * 10.0f;
+        points[i].y = (float)((i / SENSOR_WIDTH) - 30) * 10.0f;
+        points[i].z = 1500.0f + (float)(i % 7);
+        distance[i] = (uint16_t)(1500 + i % 7);
+    }
+    distance[5] = 0;                        // Kein Echo
+    distance[6] = 65300;                    // LOW_AMPLITUDE
+    distance[SENSOR_PIXELS - 1] = 65530;    // INVALID_DATA
+    pointcloud_aos_to_soa(points, SENSOR_PIXELS, &cloud);
+}
+
+int test_header_layout(void) {
+    pointcloud2_init(&frame, "hps3d_front");
+    const pc2_header_t *h = &frame.header;
+    TEST_ASSERT(memcmp(h->magic, PC2_MAGIC, 8) == 0 && h->version == PC2_VERSION, "magic/version wrong");
+    TEST_ASSERT(h->header_size == sizeof(pc2_header_t) && h->header_size % 16 == 0, "header size wrong");
+    TEST_ASSERT(h->width == 160 && h->height == 60, "not organized 160x60");
+    TEST_ASSERT(h->point_step == 16 && h->row_step == 160 * 16, "steps wrong");
+    TEST_ASSERT(h->data_size == h->row_step * h->height && sizeof(frame) == h->header_size + h->data_size,
+                "data size does not match the frame");
+    TEST_ASSERT(h->is_dense == 0 && h->field_count == 4, "density/field count wrong");
+    TEST_ASSERT(strcmp(h->frame_id, "hps3d_front") == 0, "frame_id wrong");
+
+    static const struct { const char *name; uint32_t offset; uint8_t type; } expect[4] = {
+        {"x", 0, PC2_FLOAT32}, {"y", 4, PC2_FLOAT32}, {"z", 8, PC2_FLOAT32}, {"distance", 12, PC2_UINT16},
+    };
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT(strcmp(h->fields[i].name, expect[i].name) == 0 && h->fields[i].offset == expect[i].offset &&
+                    h->fields[i].datatype == expect[i].type && h->fields[i].count == 1, "field descriptor wrong");
+    }
+    TEST_SUCCESS();
+}
+
+int test_fill(void) {
+    make_scene();
+    pointcloud2_init(&frame, NULL);
+    pointcloud2_fill(&frame, &cloud, distance, 42, 1700000000123456789LL);
+    TEST_ASSERT(frame.header.seq == 42 && frame.header.stamp_ns == 1700000000123456789LL, "seq/stamp wrong");
+    TEST_ASSERT(frame.header.frame_id[0] == '\0', "frame_id not empty");
+
+    // Pixel (x=3, y=2): mm -> m
+    int i = 2 * SENSOR_WIDTH + 3;
+    const pc2_point_t *p = &frame.points[i];
+    TEST_ASSERT(fabsf(p->x - points[i].x * 0.001f) < 1e-6f && fabsf(p->y - points[i].y * 0.001f) < 1e-6f &&
+                fabsf(p->z - points[i].z * 0.001f) < 1e-6f, "coordinates not converted to metres");
+    TEST_ASSERT(p->distance == distance[i] && p->pad == 0, "distance field wrong");
+
+    // Ungültige Pixel: NaN, Sentinel bleibt in distance
+    int invalid[3] = {5, 6, SENSOR_PIXELS - 1};
+    for (int k = 0; k < 3; k++) {
+        p = &frame.points[invalid[k]];
+        TEST_ASSERT(isnan(p->x) && isnan(p->y) && isnan(p->z), "invalid pixel not NaN");
+        TEST_ASSERT(p->distance == distance[invalid[k]], "sentinel lost");
+    }
+    int nan_count = 0;
+    for (int k = 0; k < SENSOR_PIXELS; k++) {
+        nan_count += isnan(frame.points[k].z);
+    }
+    TEST_ASSERT(nan_count == 3, "wrong number of NaN points");
+
+    // Rohbytes wie in der Nachricht: distance als uint16 an Offset 12 des Punkts
+    const uint8_t *raw = (const uint8_t *)&frame + frame.header.header_size + (size_t)i * frame.header.point_step;
+    uint16_t d;
+    memcpy(&d, raw + frame.header.fields[3].offset, sizeof(d));
+    TEST_ASSERT(d == distance[i], "raw layout wrong");
+    TEST_SUCCESS();
+}
+
+int test_shm_roundtrip(void) {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_pc2_%d", (int)getpid());
+    pc2_shm_t *shm = pointcloud2_shm_open(path);
+    TEST_ASSERT(shm != NULL, "shm open failed");
+    TEST_ASSERT(shm->size == sizeof(pc2_frame_t) && atomic_load(&shm->seq) % 2 == 0, "shm header wrong");
+
+    make_scene();
+    pointcloud2_init(&frame, "hps3d");
+    pointcloud2_fill(&frame, &cloud, distance, 1, 1000);
+    pointcloud2_shm_publish(shm, &frame);
+    pointcloud2_fill(&frame, &cloud, distance, 2, 2000);
+    pointcloud2_shm_publish(shm, &frame);
+    TEST_ASSERT(pointcloud2_shm_read(shm, &copy, 4) == 4, "sequence not advanced by 2 per frame");
+    TEST_ASSERT(memcmp(&copy, &frame, sizeof(frame)) == 0, "copy differs");
+
+    // Zweite Abbildung (wie die Bridge) sieht denselben Frame
+    pc2_shm_t *reader = pointcloud2_shm_open(path);
+    TEST_ASSERT(reader != NULL, "second mapping failed");
+    TEST_ASSERT(pointcloud2_shm_read(reader, &copy, 4) == 4 && copy.header.seq == 2, "reader mapping wrong");
+
+    // Schreiben läuft (ungerade Sequenz): kein Frame
+    atomic_store(&shm->seq, 5);
+    TEST_ASSERT(pointcloud2_shm_read(reader, &copy, 4) == -1, "torn frame returned");
+    pointcloud2_shm_close(reader);
+
+    // Abgebrochener Schreiber: neues Öffnen macht die Sequenz wieder gerade
+    pointcloud2_shm_close(shm);
+    shm = pointcloud2_shm_open(path);
+    TEST_ASSERT(shm != NULL && atomic_load(&shm->seq) == 6, "stale writer not recovered");
+    TEST_ASSERT(pointcloud2_shm_read(shm, &copy, 4) == 6, "read after recovery failed");
+    pointcloud2_shm_close(shm);
+    unlink(path);
+
+    TEST_ASSERT(pointcloud2_shm_open("/nonexistent/dir/pc2") == NULL, "bad path accepted");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== PointCloud2 Layout Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    if (pointcloud_soa_init(&cloud, SENSOR_PIXELS) != 0) {
+        printf("FAIL: cloud allocation failed\n");
+        return 1;
+    }
+
+    total_tests++; passed_tests += test_header_layout();
+    total_tests++; passed_tests += test_fill();
+    total_tests++; passed_tests += test_shm_roundtrip();
+    pointcloud_soa_free(&cloud);
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
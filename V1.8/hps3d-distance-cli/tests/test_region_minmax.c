@@ -0,0 +1,135 @@
+/*
+ * Unit tests for the min/max sparse table
+ *
+ * Compares O(1) rectangle queries against the brute-force region_stats()
+ * scan for every rectangle size, random positions, invalid pixels and
+ * fully invalid regions.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "region.h"
+#include "region_minmax.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static region_minmax_t table;
+static uint16_t distance[SENSOR_PIXELS];
+
+// Zufällige Szene mit ca. 10 % Sentinel- und 2 % Null-Pixeln
+static void make_scene(unsigned seed) {
+    srand(seed);
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        int r = rand() % 100;
+        distance[i] = r < 10 ? (uint16_t)(65000 + rand() % 536) : r < 12 ? 0 : (uint16_t)(1 + rand() % 64999);
+    }
+}
+
+static int check_rect(int x0, int y0, int w, int h) {
+    region_stats_t ref;
+    uint16_t min, max;
+    region_stats(distance, SENSOR_WIDTH, x0, y0, w, h, &ref);
+    int any = region_minmax_query(&table, x0, y0, w, h, &min, &max);
+    return min == ref.min && max == ref.max && any == (ref.count > 0);
+}
+
+int test_log2(void) {
+    TEST_ASSERT(region_minmax_log2(1) == 0 && region_minmax_log2(2) == 1 && region_minmax_log2(3) == 1, "small values");
+    TEST_ASSERT(region_minmax_log2(127) == 6 && region_minmax_log2(128) == 7 && region_minmax_log2(160) == 7,
+                "large values");
+    TEST_ASSERT(region_minmax_log2(SENSOR_WIDTH) < REGION_MINMAX_LEVELS_X &&
+                region_minmax_log2(SENSOR_HEIGHT) < REGION_MINMAX_LEVELS_Y, "levels do not cover the sensor");
+    TEST_SUCCESS();
+}
+
+int test_all_sizes(void) {
+    make_scene(1);
+    region_minmax_build(&table, distance);
+    // Jede Größe an den vier Ecken und an einer zufälligen Stelle
+    for (int h = 1; h <= SENSOR_HEIGHT; h++) {
+        for (int w = 1; w <= SENSOR_WIDTH; w++) {
+            int xr = SENSOR_WIDTH - w, yr = SENSOR_HEIGHT - h;
+            TEST_ASSERT(check_rect(0, 0, w, h) && check_rect(xr, 0, w, h) && check_rect(0, yr, w, h) &&
+                        check_rect(xr, yr, w, h), "corner rectangle differs from region_stats");
+            TEST_ASSERT(check_rect(rand() % (xr + 1), rand() % (yr + 1), w, h), "random rectangle differs");
+        }
+    }
+    TEST_SUCCESS();
+}
+
+int test_random_rects(void) {
+    for (unsigned seed = 2; seed < 6; seed++) {
+        make_scene(seed);
+        region_minmax_build(&table, distance);
+        for (int i = 0; i < 20000; i++) {
+            int w = 1 + rand() % SENSOR_WIDTH, h = 1 + rand() % SENSOR_HEIGHT;
+            int x0 = rand() % (SENSOR_WIDTH - w + 1), y0 = rand() % (SENSOR_HEIGHT - h + 1);
+            TEST_ASSERT(check_rect(x0, y0, w, h), "random rectangle differs from region_stats");
+        }
+    }
+    TEST_SUCCESS();
+}
+
+int test_invalid_regions(void) {
+    // Alles gültig bis auf einen 20x10-Block aus Sentinels und Nullen
+    for (int i = 0; i < SENSOR_PIXELS; i++) {
+        distance[i] = (uint16_t)(2000 + i % 97);
+    }
+    for (int y = 20; y < 30; y++) {
+        for (int x = 50; x < 70; x++) {
+            distance[y * SENSOR_WIDTH + x] = (x + y) & 1 ? 65500 : 0;
+        }
+    }
+    distance[0] = 65000;        // Grenze: erster Sentinel
+    distance[1] = 64999;        // Grenze: größter gültiger Wert
+    distance[2] = 1;            // Grenze: kleinster gültiger Wert
+    region_minmax_build(&table, distance);
+
+    uint16_t min, max;
+    TEST_ASSERT(region_minmax_query(&table, 50, 20, 20, 10, &min, &max) == 0, "invalid block reported valid");
+    TEST_ASSERT(min == REGION_INVALID_MIN && max == 0, "invalid block not neutral");
+    TEST_ASSERT(region_minmax_query(&table, 49, 20, 21, 10, &min, &max) == 1 && check_rect(49, 20, 21, 10),
+                "block plus one column wrong");
+    TEST_ASSERT(region_minmax_query(&table, 0, 0, 3, 1, &min, &max) == 1 && min == 1 && max == 64999,
+                "validity boundaries wrong");
+    TEST_ASSERT(check_rect(0, 0, SENSOR_WIDTH, SENSOR_HEIGHT), "full frame differs");
+
+    // Neuer Frame überschreibt alle abgefragten Werte
+    memset(distance, 0, sizeof(distance));
+    region_minmax_build(&table, distance);
+    TEST_ASSERT(region_minmax_query(&table, 0, 0, SENSOR_WIDTH, SENSOR_HEIGHT, &min, &max) == 0,
+                "stale values after rebuild");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Region Min/Max Sparse Table Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_log2();
+    total_tests++; passed_tests += test_all_sizes();
+    total_tests++; passed_tests += test_random_rects();
+    total_tests++; passed_tests += test_invalid_regions();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
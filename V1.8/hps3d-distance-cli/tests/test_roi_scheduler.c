@@ -0,0 +1,149 @@
+/*
+ * Unit tests for the ROI group scheduler
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "roi_scheduler.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+int test_add_merges_groups(void) {
+    roi_scheduler_t s;
+    roi_sched_init(&s, ROI_SCHED_ROUND_ROBIN);
+
+    TEST_ASSERT(roi_sched_add(&s, 3, 1) == 0, "first add failed");
+    TEST_ASSERT(roi_sched_add(&s, 7, 2) == 1, "second add failed");
+    TEST_ASSERT(roi_sched_add(&s, 3, 5) == 0, "duplicate not merged");
+    TEST_ASSERT(s.count == 2, "count wrong");
+    TEST_ASSERT(s.groups[0].priority == 5, "priority not raised to maximum");
+    TEST_ASSERT(roi_sched_add(&s, 3, 0) == 0 && s.groups[0].priority == 5, "priority lowered");
+    TEST_ASSERT(roi_sched_add(&s, 16, 1) == -1, "group 16 accepted");
+    TEST_ASSERT(roi_sched_add(&s, -1, 1) == -1, "negative group accepted");
+    TEST_ASSERT(s.current == -1, "current should be unknown");
+    TEST_SUCCESS();
+}
+
+int test_round_robin_order(void) {
+    roi_scheduler_t s;
+    roi_sched_init(&s, ROI_SCHED_ROUND_ROBIN);
+    TEST_ASSERT(roi_sched_next(&s, 0) == -1, "empty schedule returned a group");
+
+    roi_sched_add(&s, 2, 1);
+    roi_sched_add(&s, 0, 9);
+    roi_sched_add(&s, 5, 1);
+
+    // Gewichte und Alter spielen keine Rolle
+    const int expected[7] = {2, 0, 5, 2, 0, 5, 2};
+    for (int i = 0; i < 7; i++) {
+        TEST_ASSERT(roi_sched_next(&s, 1000 + i) == expected[i], "wrong round-robin order");
+        roi_sched_mark(&s, expected[i], 1000 + i);
+    }
+    TEST_SUCCESS();
+}
+
+int test_priority_unvisited_first(void) {
+    roi_scheduler_t s;
+    roi_sched_init(&s, ROI_SCHED_PRIORITY);
+    roi_sched_add(&s, 1, 1);
+    roi_sched_add(&s, 4, 1);
+    roi_sched_add(&s, 9, 1);
+
+    // Solange die vorherige Wahl noch kein Paket geliefert hat, bleibt sie vorn
+    TEST_ASSERT(roi_sched_next(&s, 100) == 1, "first unvisited not chosen");
+    roi_sched_mark(&s, 1, 100);
+    TEST_ASSERT(roi_sched_next(&s, 200) == 4, "second unvisited not chosen");
+    roi_sched_mark(&s, 4, 200);
+    TEST_ASSERT(roi_sched_next(&s, 300) == 9, "third unvisited not chosen");
+    roi_sched_mark(&s, 9, 300);
+    TEST_ASSERT(roi_sched_next(&s, 400) == 1, "oldest group not chosen");
+    TEST_SUCCESS();
+}
+
+int test_priority_weighting(void) {
+    roi_scheduler_t s;
+    roi_sched_init(&s, ROI_SCHED_PRIORITY);
+    roi_sched_add(&s, 0, 4);
+    roi_sched_add(&s, 1, 1);
+    roi_sched_add(&s, 2, 1);
+
+    // Simulierter Betrieb: jede gewählte Gruppe liefert sofort ein Paket
+    uint64_t now = 1;
+    for (int step = 0; step < 600; step++, now += 10) {
+        int group = roi_sched_next(&s, now);
+        TEST_ASSERT(group >= 0, "no group chosen");
+        roi_sched_mark(&s, group, now);
+    }
+
+    // Gewicht 4 gegen 1 + 1: Gruppe 0 bekommt klar die meisten Aktualisierungen
+    uint32_t high = s.groups[0].updates;
+    uint32_t low = s.groups[1].updates + s.groups[2].updates;
+    TEST_ASSERT(high + low == 600, "updates lost");
+    TEST_ASSERT(high > low, "high priority group not preferred");
+    TEST_ASSERT(s.groups[1].updates > 50 && s.groups[2].updates > 50, "low priority group starved");
+    TEST_SUCCESS();
+}
+
+int test_limit_and_mark(void) {
+    roi_scheduler_t s;
+    roi_sched_init(&s, ROI_SCHED_ROUND_ROBIN);
+    roi_sched_add(&s, 1, 1);
+    roi_sched_add(&s, 12, 1);
+    roi_sched_add(&s, 3, 1);
+    roi_sched_add(&s, 15, 1);
+
+    TEST_ASSERT(roi_sched_next(&s, 0) == 1, "first group wrong");
+    TEST_ASSERT(roi_sched_next(&s, 0) == 12, "second group wrong");
+    TEST_ASSERT(roi_sched_next(&s, 0) == 3, "third group wrong");
+    TEST_ASSERT(roi_sched_next(&s, 0) == 15, "fourth group wrong");
+    TEST_ASSERT(roi_sched_limit(&s, 8) == 2, "wrong number removed");
+    TEST_ASSERT(s.count == 2, "count after limit wrong");
+    TEST_ASSERT(roi_sched_next(&s, 0) == 1 && roi_sched_next(&s, 0) == 3, "order after limit wrong");
+
+    // Pakete unbekannter Gruppen ändern nichts; Zeitpunkt 0 zählt trotzdem als besucht
+    roi_sched_mark(&s, 12, 50);
+    TEST_ASSERT(s.groups[0].updates == 0 && s.groups[1].updates == 0, "unknown group marked");
+    roi_sched_mark(&s, 3, 0);
+    TEST_ASSERT(s.groups[1].updates == 1 && s.groups[1].last_ms != 0, "mark at time 0 lost");
+
+    roi_sched_policy_t policy;
+    TEST_ASSERT(roi_sched_parse_policy("priority", 8, &policy) == 0 && policy == ROI_SCHED_PRIORITY,
+                "priority not parsed");
+    TEST_ASSERT(roi_sched_parse_policy("round_robin", 11, &policy) == 0 && policy == ROI_SCHED_ROUND_ROBIN,
+                "round_robin not parsed");
+    TEST_ASSERT(roi_sched_parse_policy("fifo", 4, &policy) == -1, "unknown policy accepted");
+    TEST_ASSERT(strcmp(roi_sched_policy_name(ROI_SCHED_PRIORITY), "priority") == 0, "name wrong");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== ROI Scheduler Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_add_merges_groups();
+    total_tests++; passed_tests += test_round_robin_order();
+    total_tests++; passed_tests += test_priority_unvisited_first();
+    total_tests++; passed_tests += test_priority_weighting();
+    total_tests++; passed_tests += test_limit_and_mark();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
@@ -0,0 +1,132 @@
+/*
+ * Unit tests for robust ROI statistics (median / MAD outlier rejection)
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "HPS3DUser_IF.h"
+#include "roi_stats.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static uint16_t scratch[HPS3D_MAX_PIXEL_NUMBER];
+
+int test_median_odd_even(void) {
+    const uint16_t odd[5] = {1005, 1001, 1003, 1002, 1004};
+    const uint16_t even[4] = {1004, 1001, 1003, 1002};
+    roi_robust_t st;
+
+    TEST_ASSERT(roi_robust_stats(odd, 5, 3.0f, scratch, &st) == 5, "Inlier count wrong");
+    TEST_ASSERT(st.median == 1003.0f, "Odd median wrong");
+    TEST_ASSERT(st.mad == 1.0f, "MAD wrong");
+    TEST_ASSERT(st.mean == 1003.0f, "Mean wrong");
+
+    roi_robust_stats(even, 4, 3.0f, scratch, &st);
+    TEST_ASSERT(st.median == 1002.5f, "Even median wrong");
+    TEST_SUCCESS();
+}
+
+int test_outliers_rejected(void) {
+    // 100 Pixel um 2000 mm, 10 Ausreißer (Vordergrund/Mehrwege) und Sentinels
+    uint16_t px[120];
+    for (int i = 0; i < 100; i++) px[i] = (uint16_t)(1995 + i % 11);
+    for (int i = 100; i < 110; i++) px[i] = (uint16_t)(600 + i);
+    for (int i = 110; i < 120; i++) px[i] = HPS3D_LOW_AMPLITUDE;
+
+    roi_robust_t st;
+    int inliers = roi_robust_stats(px, 120, 3.0f, scratch, &st);
+    TEST_ASSERT(st.valid == 110, "Sentinels counted as valid");
+    TEST_ASSERT(inliers == 100, "Outliers not rejected");
+    TEST_ASSERT(fabsf(st.mean - 2000.0f) < 0.5f, "Robust mean wrong");
+    TEST_ASSERT(st.min == 1995 && st.max == 2005, "Inlier range wrong");
+
+    // Mit großem k bleiben die Ausreißer drin
+    inliers = roi_robust_stats(px, 120, 1000.0f, scratch, &st);
+    TEST_ASSERT(inliers == 110, "Large k rejected pixels");
+    TEST_SUCCESS();
+}
+
+int test_constant_and_empty(void) {
+    uint16_t px[9] = {1500, 1500, 1500, 1500, 1500, 1500, 1500, 1500, 1501};
+    roi_robust_t st;
+    // MAD = 0: Untergrenze für sigma verhindert, dass 1501 verworfen wird
+    TEST_ASSERT(roi_robust_stats(px, 9, 3.0f, scratch, &st) == 9, "MAD=0 rejected close pixel");
+
+    uint16_t none[3] = {HPS3D_SATURATION, HPS3D_INVALID_DATA, 0};
+    TEST_ASSERT(roi_robust_stats(none, 3, 3.0f, scratch, &st) == 0, "Invalid ROI produced inliers");
+    TEST_ASSERT(st.valid == 0 && st.min == 0, "Empty stats not zeroed");
+    TEST_SUCCESS();
+}
+
+int test_roi_contains(void) {
+    HPS3D_FullRoiData_t roi;
+    memset(&roi, 0, sizeof(roi));
+    roi.left_top_x = 10;
+    roi.left_top_y = 5;
+    roi.right_bottom_x = 20;
+    roi.right_bottom_y = 15;
+    TEST_ASSERT(roi_contains(&roi, 10, 5) && roi_contains(&roi, 20, 15), "Corners not inside");
+    TEST_ASSERT(!roi_contains(&roi, 9, 10) && !roi_contains(&roi, 15, 16), "Outside point inside");
+    TEST_SUCCESS();
+}
+
+int test_large_roi(void) {
+    // Ganze Bildgröße, zufällige Reihenfolge - Quickselect muss stimmen
+    static uint16_t px[HPS3D_MAX_PIXEL_NUMBER];
+    uint32_t state = 1;
+    for (int i = 0; i < HPS3D_MAX_PIXEL_NUMBER; i++) {
+        state = state * 1103515245u + 12345u;
+        px[i] = (uint16_t)(1000 + (i % 2001));
+        int j = (int)((state >> 8) % (uint32_t)(i + 1));
+        uint16_t t = px[i]; px[i] = px[j]; px[j] = t;
+    }
+    roi_robust_t st;
+    roi_robust_stats(px, HPS3D_MAX_PIXEL_NUMBER, 3.0f, scratch, &st);
+    // Werte 1000..3000, gleichmäßig (Rest 9600 % 2001 = 1596 doppelt)
+    uint16_t sorted[HPS3D_MAX_PIXEL_NUMBER];
+    memcpy(sorted, px, sizeof(sorted));
+    for (int i = 1; i < HPS3D_MAX_PIXEL_NUMBER; i++) {
+        uint16_t v = sorted[i];
+        int j = i;
+        while (j > 0 && sorted[j - 1] > v) { sorted[j] = sorted[j - 1]; j--; }
+        sorted[j] = v;
+    }
+    float expected = 0.5f * ((float)sorted[4799] + (float)sorted[4800]);
+    TEST_ASSERT(st.median == expected, "Median of full frame wrong");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== ROI Statistics Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_median_odd_even();
+    total_tests++; passed_tests += test_outliers_rejected();
+    total_tests++; passed_tests += test_constant_and_empty();
+    total_tests++; passed_tests += test_roi_contains();
+    total_tests++; passed_tests += test_large_roi();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
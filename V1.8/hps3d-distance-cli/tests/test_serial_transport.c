@@ -0,0 +1,321 @@
+/*
+ * Unit tests for the open serial transport (HPS3DAPI_* over a pseudo-terminal)
+ *
+ * A small device thread on the pty master answers commands and streams
+ * synthetic full-depth packets; the service-side API runs on the slave.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "HPS3DUser_IF.h"
+#include "packet_builder.h"
+#include "serial_transport.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+#define STREAM_FRAMES 20
+
+typedef struct {
+    int master;
+    char slave[64];
+    pthread_t tid;
+    _Atomic int stop;
+    _Atomic int commands;
+    uint8_t last_cmd;
+    uint8_t last_payload[8];
+    int garbage_before_single;      // Störbytes vor der nächsten Antwort
+} fake_device_t;
+
+static fake_device_t dev;
+static uint8_t packet[PACKET_FULL_DEPTH_SIZE];
+
+static _Atomic int stream_frames;
+static _Atomic int stream_errors;
+static _Atomic int disconnects;
+static uint32_t last_frame_cnt;
+
+static void reply(uint8_t cmd, uint8_t status, const void *payload, uint32_t len) {
+    wire_write_frame(dev.master, &WIRE_FRAMING_DEFAULT, cmd, status, payload, len, 1000);
+}
+
+static void handle_command(frame_buf_t *buf) {
+    const wire_framing_t *f = &WIRE_FRAMING_DEFAULT;
+    uint8_t cmd = wire_frame_cmd(f, buf);
+    int len = wire_frame_payload_len(f, buf);
+    dev.last_cmd = cmd;
+    memcpy(dev.last_payload, wire_frame_payload(f, buf), len < 8 ? (size_t)len : 8);
+    atomic_fetch_add(&dev.commands, 1);
+
+    switch (cmd) {
+        case WIRE_CMD_HELLO:
+            reply(cmd, WIRE_STATUS_OK, "HPS3D160-EMU 1.8", 16);
+            break;
+        case WIRE_CMD_SERIAL:
+            reply(cmd, WIRE_STATUS_OK, "SN-4711", 7);
+            break;
+        case WIRE_CMD_SINGLE: {
+            if (dev.garbage_before_single) {
+                static const uint8_t junk[] = {0xF5, 0x00, 0x13, 0x37, 0xF5};
+                write(dev.master, junk, sizeof(junk));
+                dev.garbage_before_single = 0;
+            }
+            int n = pb_full_depth(packet, 1500, 77);
+            reply(cmd, HPS3D_FULL_DEPTH_EVEN, packet, (uint32_t)n);
+            break;
+        }
+        case WIRE_CMD_START:
+            reply(cmd, WIRE_STATUS_OK, NULL, 0);
+            for (int i = 0; i < STREAM_FRAMES; i++) {
+                int n = pb_full_depth(packet, 1000, (uint32_t)i);
+                reply(WIRE_CMD_DATA, HPS3D_FULL_DEPTH_EVEN, packet, (uint32_t)n);
+            }
+            break;
+        case WIRE_CMD_EXPORT: {
+            uint8_t s[16 * 4] = {0};
+            pb_put32(s + 4, 160);
+            pb_put32(s + 8, 60);
+            pb_put32(s + 12, 16);
+            pb_put32(s + 16, 8);
+            pb_put32(s + 20, 3);
+            float k = 0.25f;
+            uint32_t bits;
+            memcpy(&bits, &k, sizeof(bits));
+            pb_put32(s + 32, bits);
+            reply(cmd, WIRE_STATUS_OK, s, sizeof(s));
+            break;
+        }
+        case WIRE_CMD_SAVE:
+            reply(cmd, WIRE_STATUS_ERROR, NULL, 0);   // Abgelehnt
+            break;
+        default:
+            reply(cmd, WIRE_STATUS_OK, NULL, 0);
+            break;
+    }
+}
+
+static void *device_thread(void *arg) {
+    (void)arg;
+    frame_pool_t pool;
+    wire_reader_t reader;
+    frame_pool_init(&pool, 2, 256);
+    wire_reader_init(&reader, dev.master, &WIRE_FRAMING_DEFAULT, &pool);
+    struct pollfd pfd = {.fd = dev.master, .events = POLLIN};
+    while (!atomic_load(&dev.stop)) {
+        poll(&pfd, 1, 20);
+        frame_buf_t *buf;
+        int ret;
+        while ((ret = wire_reader_poll(&reader, &buf)) == 1) {
+            handle_command(buf);
+            frame_pool_release(&pool, buf);
+        }
+        if (ret < 0 && errno != EIO) {
+            break;
+        }
+    }
+    wire_reader_reset(&reader);
+    frame_pool_destroy(&pool);
+    return NULL;
+}
+
+static int device_start(void) {
+    memset(&dev, 0, sizeof(dev));
+    dev.master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (dev.master < 0 || grantpt(dev.master) != 0 || unlockpt(dev.master) != 0 ||
+        ptsname_r(dev.master, dev.slave, sizeof(dev.slave)) != 0) {
+        return -1;
+    }
+    fcntl(dev.master, F_SETFL, O_NONBLOCK);
+    return pthread_create(&dev.tid, NULL, device_thread, NULL);
+}
+
+static void device_stop(void) {
+    atomic_store(&dev.stop, 1);
+    pthread_join(dev.tid, NULL);
+    close(dev.master);
+}
+
+static uint32_t get32(const uint8_t *p) {
+    return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static void on_event(int handle, int type, uint8_t *data, int len, void *user) {
+    (void)handle;
+    (void)user;
+    if (type == HPS3D_DISCONNECT_EVEN) {
+        atomic_fetch_add(&disconnects, 1);
+        return;
+    }
+    if (type != HPS3D_FULL_DEPTH_EVEN || packet_validate(data, len, HPS3D_FULL_DEPTH_EVEN) != len) {
+        atomic_fetch_add(&stream_errors, 1);
+        return;
+    }
+    uint32_t frame_cnt = get32(data + 6);
+    if (atomic_load(&stream_frames) > 0 && frame_cnt != last_frame_cnt + 1) {
+        atomic_fetch_add(&stream_errors, 1);
+    }
+    last_frame_cnt = frame_cnt;
+    atomic_fetch_add(&stream_frames, 1);
+}
+
+int test_reader_resync(void) {
+    int fds[2];
+    TEST_ASSERT(pipe(fds) == 0, "pipe failed");
+    fcntl(fds[0], F_SETFL, O_NONBLOCK);
+    frame_pool_t pool;
+    wire_reader_t reader;
+    TEST_ASSERT(frame_pool_init(&pool, 2, 64) == 0, "pool init failed");
+    wire_reader_init(&reader, fds[0], &WIRE_FRAMING_DEFAULT, &pool);
+
+    // Störbytes, ein gültiger Frame, einer mit falschem Endbyte, einer zu groß, wieder ein gültiger
+    static const uint8_t junk[] = {0x00, 0xF5, 0xF5, 0x3D};
+    write(fds[1], junk, sizeof(junk));
+    wire_write_frame(fds[1], &WIRE_FRAMING_DEFAULT, WIRE_CMD_DATA, 3, "abc", 3, 100);
+    static const uint8_t bad_trailer[] = {0xF5, 0x3D, 0x80, 0x03, 0, 0, 0, 1, 'x', 0x00};
+    write(fds[1], bad_trailer, sizeof(bad_trailer));
+    static const uint8_t too_big[] = {0xF5, 0x3D, 0x80, 0x03, 0, 0, 1, 0};
+    write(fds[1], too_big, sizeof(too_big));
+    wire_write_frame(fds[1], &WIRE_FRAMING_DEFAULT, WIRE_CMD_HELLO, 0, "defg", 4, 100);
+
+    frame_buf_t *buf;
+    TEST_ASSERT(wire_reader_poll(&reader, &buf) == 1, "first frame not found");
+    TEST_ASSERT(wire_frame_cmd(&WIRE_FRAMING_DEFAULT, buf) == WIRE_CMD_DATA && buf->event_type == 3 &&
+                wire_frame_payload_len(&WIRE_FRAMING_DEFAULT, buf) == 3 &&
+                memcmp(wire_frame_payload(&WIRE_FRAMING_DEFAULT, buf), "abc", 3) == 0, "first frame wrong");
+    frame_pool_release(&pool, buf);
+    TEST_ASSERT(wire_reader_poll(&reader, &buf) == 1, "second frame not found");
+    TEST_ASSERT(wire_frame_cmd(&WIRE_FRAMING_DEFAULT, buf) == WIRE_CMD_HELLO &&
+                memcmp(wire_frame_payload(&WIRE_FRAMING_DEFAULT, buf), "defg", 4) == 0, "second frame wrong");
+    frame_pool_release(&pool, buf);
+    TEST_ASSERT(reader.frames == 2 && reader.resyncs > 0, "resync not counted");
+    TEST_ASSERT(wire_reader_poll(&reader, &buf) == 0, "phantom frame");
+
+    close(fds[1]);
+    TEST_ASSERT(wire_reader_poll(&reader, &buf) == -1, "end of stream not reported");
+    wire_reader_reset(&reader);
+    frame_pool_destroy(&pool);
+    close(fds[0]);
+    TEST_SUCCESS();
+}
+
+int test_connect_and_commands(void) {
+    TEST_ASSERT(device_start() == 0, "pty setup failed");
+    int handle = -1;
+    TEST_ASSERT(HPS3D_USBConnectDevice(dev.slave, &handle) == HPS3D_RET_OK && handle >= 0, "connect failed");
+    TEST_ASSERT(HPS3D_IsConnect(handle), "not connected");
+    TEST_ASSERT(strcmp((const char *)HPS3D_GetDeviceVersion(handle), "HPS3D160-EMU 1.8") == 0, "version wrong");
+    TEST_ASSERT(strcmp((const char *)HPS3D_GetSerialNumber(handle), "SN-4711") == 0, "serial wrong");
+
+    TEST_ASSERT(HPS3D_SetDistanceOffset(handle, -300) == HPS3D_RET_OK, "offset failed");
+    TEST_ASSERT(dev.last_cmd == WIRE_CMD_DISTANCE_OFFSET && dev.last_payload[0] == 0xFE &&
+                dev.last_payload[1] == 0xD4, "offset payload wrong");
+    TEST_ASSERT(HPS3D_SetOpticalPathCalibration(handle, true) == HPS3D_RET_OK &&
+                dev.last_cmd == WIRE_CMD_OPTICAL_PATH && dev.last_payload[0] == 1, "optical path wrong");
+    TEST_ASSERT(HPS3D_SaveSettings(handle) == HPS3D_RET_ERROR, "device error not reported");
+
+    HPS3D_DeviceSettings_t settings;
+    TEST_ASSERT(HPS3D_ExportSettings(handle, &settings) == HPS3D_RET_OK, "export failed");
+    TEST_ASSERT(settings.max_resolution_X == 160 && settings.max_roi_number == 8 &&
+                settings.max_threshold_number == 3 && settings.dist_filter_K == 0.25f, "settings wrong");
+
+    TEST_ASSERT(HPS3D_CloseDevice(handle) == HPS3D_RET_OK, "close failed");
+    TEST_ASSERT(!HPS3D_IsConnect(handle), "still connected after close");
+    device_stop();
+
+    // Kein Gerät hinter dem Pfad
+    TEST_ASSERT(HPS3D_USBConnectDevice("/nonexistent/ttyACM9", &handle) == HPS3D_RET_CONNECT_FAILED,
+                "missing device accepted");
+    TEST_SUCCESS();
+}
+
+int test_single_capture(void) {
+    static HPS3D_MeasureData_t data;
+    TEST_ASSERT(HPS3D_MeasureDataInit(&data) == HPS3D_RET_OK, "measure data init failed");
+    TEST_ASSERT(device_start() == 0, "pty setup failed");
+    int handle = -1;
+    TEST_ASSERT(HPS3D_USBConnectDevice(dev.slave, &handle) == HPS3D_RET_OK, "connect failed");
+
+    HPS3D_EventType_t type;
+    for (int i = 0; i < 3; i++) {
+        dev.garbage_before_single = (i == 1);
+        TEST_ASSERT(HPS3D_SingleCapture(handle, &type, &data) == HPS3D_RET_OK, "single capture failed");
+        TEST_ASSERT(type == HPS3D_FULL_DEPTH_EVEN && data.full_depth_data.frame_cnt == 77 &&
+                    data.full_depth_data.distance[0] == 1500, "single capture decoded wrong");
+    }
+    HPS3D_CloseDevice(handle);
+    device_stop();
+    HPS3D_MeasureDataFree(&data);
+    TEST_SUCCESS();
+}
+
+int test_stream_and_disconnect(void) {
+    TEST_ASSERT(device_start() == 0, "pty setup failed");
+    HPS3D_RegisterEventCallback(on_event, NULL);
+    int handle = -1;
+    TEST_ASSERT(HPS3D_USBConnectDevice(dev.slave, &handle) == HPS3D_RET_OK, "connect failed");
+    TEST_ASSERT(HPS3D_StartCapture(handle) == HPS3D_RET_OK && HPS3D_IsStart(handle), "start failed");
+
+    for (int i = 0; i < 200 && atomic_load(&stream_frames) < STREAM_FRAMES; i++) {
+        usleep(10000);
+    }
+    TEST_ASSERT(atomic_load(&stream_frames) == STREAM_FRAMES, "stream frames missing");
+    TEST_ASSERT(atomic_load(&stream_errors) == 0, "stream frames corrupt or out of order");
+
+    HPS3D_EventType_t type;
+    static HPS3D_MeasureData_t data;
+    TEST_ASSERT(HPS3D_SingleCapture(handle, &type, &data) == HPS3D_RET_BUSY, "single capture while streaming");
+    TEST_ASSERT(HPS3D_StopCapture(handle) == HPS3D_RET_OK && !HPS3D_IsStart(handle), "stop failed");
+
+    // Gerät verschwindet: Callback meldet die Trennung, Befehle scheitern
+    device_stop();
+    for (int i = 0; i < 100 && !atomic_load(&disconnects); i++) {
+        usleep(10000);
+    }
+    TEST_ASSERT(atomic_load(&disconnects) == 1, "disconnect not reported");
+    TEST_ASSERT(!HPS3D_IsConnect(handle), "still connected");
+    TEST_ASSERT(HPS3D_StartCapture(handle) == HPS3D_RET_CONNECT_FAILED, "command on dead device");
+    HPS3D_CloseDevice(handle);
+    HPS3D_UnregisterEventCallback();
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Serial Transport Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_reader_resync();
+    total_tests++; passed_tests += test_connect_and_commands();
+    total_tests++; passed_tests += test_single_capture();
+    total_tests++; passed_tests += test_stream_and_disconnect();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+/*
+ * Unit tests for the named output profiles
+ *
+ * Checks the profile line parser, field projection and precision in the
+ * JSON and CSV encodings, the byte layout of the binary encoding and the
+ * behaviour when the output buffer is too small.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "serialize.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static const out_point_t sample[2] = {
+    {.name = "front", .distance_mm = 1234.56f, .min_mm = 1200.0f, .max_mm = 1260.25f, .range_mm = 1300.0f,
+     .valid_pixels = 9, .valid = 1, .age_ms = 40, .x = 80, .y = 30, .group = 2},
+    {.name = "rear", .distance_mm = 0.0f, .min_mm = 0.0f, .max_mm = 0.0f, .range_mm = 0.0f,
+     .valid_pixels = 0, .valid = 0, .age_ms = -1, .x = 10, .y = 5, .group = 0},
+};
+
+static uint32_t le32(const unsigned char *p) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+int test_profile_parse(void) {
+    output_profile_t p;
+    TEST_ASSERT(output_profile_parse(&p, "short\n", "hps3d/measurements") == 0, "minimal profile rejected");
+    TEST_ASSERT(strcmp(p.name, "short") == 0 && strcmp(p.topic, "hps3d/measurements/short") == 0, "default topic wrong");
+    TEST_ASSERT(p.fields == OUT_FIELD_ALL && p.decimals == 1 && p.encoding == OUT_ENCODING_JSON, "defaults wrong");
+
+    TEST_ASSERT(output_profile_parse(&p, "plc  fields=distance_mm,valid decimals=0 encoding=binary topic=plant/hps3d\r\n",
+                                     "hps3d/measurements") == 0, "full profile rejected");
+    TEST_ASSERT(p.fields == (OUT_FIELD_DISTANCE_MM | OUT_FIELD_VALID), "field list wrong");
+    TEST_ASSERT(p.decimals == 0 && p.encoding == OUT_ENCODING_BINARY && strcmp(p.topic, "plant/hps3d") == 0,
+                "options wrong");
+
+    TEST_ASSERT(output_profile_parse(&p, "http topic=- encoding=csv", "x") == 0 && p.topic[0] == '\0',
+                "topic=- should disable MQTT");
+
+    TEST_ASSERT(output_profile_parse(&p, "bad fields=distance_mm,foo", "x") == -1, "unknown field accepted");
+    TEST_ASSERT(output_profile_parse(&p, "bad decimals=4", "x") == -1, "decimals out of range accepted");
+    TEST_ASSERT(output_profile_parse(&p, "bad encoding=xml", "x") == -1, "unknown encoding accepted");
+    TEST_ASSERT(output_profile_parse(&p, "bad colour=red", "x") == -1, "unknown key accepted");
+    TEST_ASSERT(output_profile_parse(&p, "bad fields=", "x") == -1, "empty field list accepted");
+    TEST_ASSERT(output_profile_parse(&p, "   \n", "x") == -1, "missing name accepted");
+    TEST_ASSERT(output_profile_parse(&p, "a_name_that_is_too_long", "x") == -1, "overlong name accepted");
+    TEST_SUCCESS();
+}
+
+int test_json_projection(void) {
+    output_profile_t p;
+    char out[512];
+    output_profile_parse(&p, "j fields=distance_mm,distance_m,valid,coordinates decimals=2", NULL);
+    int len = serialize_points(&p, sample, 2, 1700000000123LL, out, sizeof(out));
+    const char *expect =
+        "{\"ts\":1700000000123,\"points\":{"
+        "\"front\":{\"distance_mm\":1234.56,\"distance_m\":1.23456,\"valid\":true,\"coordinates\":{\"x\":80,\"y\":30}},"
+        "\"rear\":{\"distance_mm\":0.00,\"distance_m\":0.00000,\"valid\":false,\"coordinates\":{\"x\":10,\"y\":5}}}}";
+    TEST_ASSERT(len == (int)strlen(expect) && strcmp(out, expect) == 0, "JSON output wrong");
+
+    // Ohne Projektion: alle Felder, keine ausgelassenen Schlüssel
+    output_profile_parse(&p, "all decimals=0", NULL);
+    len = serialize_points(&p, sample, 1, 0, out, sizeof(out));
+    TEST_ASSERT(len > 0 && strstr(out, "\"max_distance_mm\":1260") && strstr(out, "\"range_mm\":1300") &&
+                strstr(out, "\"roi_group\":2") && strstr(out, "\"age_ms\":40"), "full JSON incomplete");
+
+    len = serialize_points(&p, sample, 0, 5, out, sizeof(out));
+    TEST_ASSERT(len > 0 && strcmp(out, "{\"ts\":5,\"points\":{}}") == 0, "empty snapshot wrong");
+    TEST_SUCCESS();
+}
+
+int test_csv(void) {
+    output_profile_t p;
+    char out[512];
+    output_profile_parse(&p, "c fields=coordinates,valid,distance_mm decimals=0 encoding=csv", NULL);
+    int len = serialize_points(&p, sample, 2, 42, out, sizeof(out));
+    // Spalten in Bit-Reihenfolge, nicht in der Reihenfolge der Konfiguration
+    const char *expect = "ts,name,distance_mm,valid,x,y\n42,front,1235,1,80,30\n42,rear,0,0,10,5\n";
+    TEST_ASSERT(len == (int)strlen(expect) && strcmp(out, expect) == 0, "CSV output wrong");
+    TEST_SUCCESS();
+}
+
+int test_binary_layout(void) {
+    output_profile_t p;
+    unsigned char out[128];
+    output_profile_parse(&p, "b fields=distance_mm,valid,coordinates encoding=binary", NULL);
+    int len = serialize_points(&p, sample, 2, 0x0102030405060708LL, (char *)out, sizeof(out));
+    // 14 Byte Kopf + je Punkt float32 + uint8 + 2x int32
+    TEST_ASSERT(len == 14 + 2 * (4 + 1 + 8), "binary length wrong");
+    TEST_ASSERT(le32(out) == 0x05060708u && le32(out + 4) == 0x01020304u, "timestamp not little-endian int64");
+    TEST_ASSERT(le32(out + 8) == p.fields && out[12] == 2 && out[13] == 0, "field mask / count wrong");
+
+    const unsigned char *pt = out + 14;
+    float d;
+    uint32_t bits = le32(pt);
+    memcpy(&d, &bits, sizeof(d));
+    TEST_ASSERT(d == sample[0].distance_mm, "distance float32 wrong");
+    TEST_ASSERT(pt[4] == 1 && le32(pt + 5) == 80 && le32(pt + 9) == 30, "valid/coordinates wrong");
+    pt += 13;
+    TEST_ASSERT(le32(pt) == 0 && pt[4] == 0 && le32(pt + 5) == 10 && le32(pt + 9) == 5, "second point wrong");
+    TEST_SUCCESS();
+}
+
+int test_buffer_too_small(void) {
+    output_profile_t p;
+    char out[512];
+    for (int e = 0; e < 3; e++) {
+        static const char *const spec[3] = {"s", "s encoding=csv", "s encoding=binary"};
+        output_profile_parse(&p, spec[e], NULL);
+        int full = serialize_points(&p, sample, 2, 1, out, sizeof(out));
+        TEST_ASSERT(full > 0, "reference output failed");
+        // Text braucht Platz für '\0', binär genau die Länge
+        size_t exact = e == 2 ? (size_t)full : (size_t)full + 1;
+        TEST_ASSERT(serialize_points(&p, sample, 2, 1, out, exact) == full, "exact buffer rejected");
+        TEST_ASSERT(serialize_points(&p, sample, 2, 1, out, exact - 1) == -1, "short buffer accepted");
+    }
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Output Profile Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_profile_parse();
+    total_tests++; passed_tests += test_json_projection();
+    total_tests++; passed_tests += test_csv();
+    total_tests++; passed_tests += test_binary_layout();
+    total_tests++; passed_tests += test_buffer_too_small();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
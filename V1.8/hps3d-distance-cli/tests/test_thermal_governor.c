@@ -0,0 +1,171 @@
+/*
+ * Unit tests for the thermal workload governor
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "thermal_governor.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+static int write_file(const char *path, const char *text) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        return -1;
+    }
+    fputs(text, fp);
+    fclose(fp);
+    return 0;
+}
+
+int test_steps_up_in_order(void) {
+    thermal_config_t config;
+    thermal_config_defaults(&config);
+    thermal_governor_t gov;
+    thermal_governor_init(&gov, &config);
+
+    TEST_ASSERT(thermal_governor_update(&gov, 50000) == THERMAL_NORMAL, "cold CPU throttled");
+    TEST_ASSERT(thermal_governor_update(&gov, 65000) == THERMAL_REDUCED_RATE, "rate not reduced at 65C");
+    TEST_ASSERT(thermal_governor_update(&gov, 71000) == THERMAL_NO_ANALYTICS, "analytics not disabled at 71C");
+    TEST_ASSERT(thermal_governor_update(&gov, 75500) == THERMAL_NO_POINTCLOUD, "pointcloud not dropped at 75C");
+    TEST_ASSERT(gov.transitions == 3, "transition count wrong");
+
+    // Sprung über mehrere Schwellen geht sofort auf die höchste Stufe
+    thermal_governor_init(&gov, &config);
+    TEST_ASSERT(thermal_governor_update(&gov, 90000) == THERMAL_NO_POINTCLOUD, "jump not immediate");
+    TEST_ASSERT(gov.temp_mc == 90000, "temperature not stored");
+    TEST_SUCCESS();
+}
+
+int test_restores_with_hysteresis(void) {
+    thermal_config_t config;
+    thermal_config_defaults(&config);
+    thermal_governor_t gov;
+    thermal_governor_init(&gov, &config);
+    thermal_governor_update(&gov, 80000);
+
+    // Knapp unter der Schwelle bleibt die Stufe
+    TEST_ASSERT(thermal_governor_update(&gov, 74000) == THERMAL_NO_POINTCLOUD, "restored inside hysteresis");
+    TEST_ASSERT(thermal_governor_update(&gov, 72500) == THERMAL_NO_POINTCLOUD, "restored inside hysteresis");
+
+    // Weit unter allen Schwellen: nur eine Stufe pro Prüfung zurück
+    TEST_ASSERT(thermal_governor_update(&gov, 40000) == THERMAL_NO_ANALYTICS, "first restore step wrong");
+    TEST_ASSERT(thermal_governor_update(&gov, 40000) == THERMAL_REDUCED_RATE, "second restore step wrong");
+    TEST_ASSERT(thermal_governor_update(&gov, 40000) == THERMAL_NORMAL, "third restore step wrong");
+    TEST_ASSERT(thermal_governor_update(&gov, 40000) == THERMAL_NORMAL, "went below normal");
+
+    // Pendeln um eine Schwelle schaltet nicht bei jeder Prüfung
+    thermal_governor_init(&gov, &config);
+    uint32_t before = gov.transitions;
+    for (int i = 0; i < 10; i++) {
+        thermal_governor_update(&gov, (i & 1) ? 65500 : 64500);
+    }
+    TEST_ASSERT(gov.transitions - before == 1, "oscillation around threshold");
+    TEST_SUCCESS();
+}
+
+int test_config_from_tuning_file(void) {
+    char path[] = "/tmp/test_thermal_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0, "mkstemp failed");
+    close(fd);
+    write_file(path,
+        "# Pi4 tuning\n"
+        "thermal_throttling=1           # Enable thermal throttling\n"
+        "cpu_temp_warning=72           # Warn at 72°C\n"
+        "power_save_temp=60            # Enter power save at 60°C\n"
+        "temp_check_interval=2        # Check temperature every 2 seconds\n"
+        "thermal_throttle_temp=78     # Start throttling at 78°C\n"
+        "thermal_shutdown_temp=85\n");
+
+    thermal_config_t config;
+    thermal_config_defaults(&config);
+    int applied = thermal_config_load(&config, path);
+    unlink(path);
+
+    TEST_ASSERT(applied == 4, "wrong number of keys applied");
+    TEST_ASSERT(config.limit_mc[THERMAL_REDUCED_RATE] == 60000, "power_save_temp wrong");
+    TEST_ASSERT(config.limit_mc[THERMAL_NO_ANALYTICS] == 72000, "cpu_temp_warning wrong");
+    TEST_ASSERT(config.limit_mc[THERMAL_NO_POINTCLOUD] == 78000, "thermal_throttle_temp wrong");
+    TEST_ASSERT(config.interval_s == 2, "temp_check_interval wrong");
+    TEST_ASSERT(thermal_config_validate(&config) == 0, "valid config rejected");
+
+    config.limit_mc[THERMAL_NO_ANALYTICS] = 80000;
+    TEST_ASSERT(thermal_config_validate(&config) == -1, "unordered thresholds accepted");
+    TEST_ASSERT(thermal_config_load(&config, "/nonexistent/pi4-tuning.conf") == -1, "missing file accepted");
+    TEST_SUCCESS();
+}
+
+int test_find_and_read_zone(void) {
+    char base[] = "/tmp/test_thermal_zones_XXXXXX";
+    TEST_ASSERT(mkdtemp(base) != NULL, "mkdtemp failed");
+
+    char dir[256], file[300];
+    const char *types[3] = {"acpitz", "cpu-thermal", "gpu"};
+    const char *temps[3] = {"41000\n", "52345\n", "38000\n"};
+    for (int i = 0; i < 3; i++) {
+        snprintf(dir, sizeof(dir), "%s/thermal_zone%d", base, i);
+        mkdir(dir, 0755);
+        snprintf(file, sizeof(file), "%s/type", dir);
+        write_file(file, types[i]);
+        snprintf(file, sizeof(file), "%s/temp", dir);
+        write_file(file, temps[i]);
+    }
+
+    char path[256];
+    int32_t temp = 0;
+    int found = thermal_find_zone(base, path, sizeof(path));
+    int read = found == 0 ? thermal_read_mc(path, &temp) : -1;
+
+    for (int i = 0; i < 3; i++) {
+        snprintf(dir, sizeof(dir), "%s/thermal_zone%d", base, i);
+        snprintf(file, sizeof(file), "%s/type", dir);
+        unlink(file);
+        snprintf(file, sizeof(file), "%s/temp", dir);
+        unlink(file);
+        rmdir(dir);
+    }
+    rmdir(base);
+
+    TEST_ASSERT(found == 0, "zone not found");
+    TEST_ASSERT(strstr(path, "thermal_zone1/temp") != NULL, "CPU zone not preferred");
+    TEST_ASSERT(read == 0 && temp == 52345, "temperature not read");
+    TEST_ASSERT(thermal_find_zone(base, path, sizeof(path)) == -1, "missing directory accepted");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Thermal Governor Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_steps_up_in_order();
+    total_tests++; passed_tests += test_restores_with_hysteresis();
+    total_tests++; passed_tests += test_config_from_tuning_file();
+    total_tests++; passed_tests += test_find_and_read_zone();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
@@ -0,0 +1,179 @@
+/*
+ * Unit tests for threshold alarm edge detection on raw ROI packets
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include "packet_builder.h"
+#include "packet_parser.h"
+#include "threshold_alarm.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+#define MAX_EVENTS 32
+
+static threshold_alarm_t events[MAX_EVENTS];
+static int event_count;
+static uint8_t packet[PACKET_FULL_ROI_MAX_SIZE];
+static threshold_tracker_t tracker;
+
+static void collect(const threshold_alarm_t *alarm, void *user) {
+    (void)user;
+    if (event_count < MAX_EVENTS) {
+        events[event_count] = *alarm;
+    }
+    event_count++;
+}
+
+// Simple-ROI-Paket mit einheitlicher Gruppe und einstellbaren Alarm-Bits
+static int simple_packet(int num, uint8_t group, const uint8_t *states) {
+    int len = pb_simple_roi(packet, num);
+    for (int i = 0; i < num; i++) {
+        packet[i * PACKET_SIMPLE_ROI_SIZE + 1] = group;
+        packet[i * PACKET_SIMPLE_ROI_SIZE + 3] = states[i];
+    }
+    return len;
+}
+
+int test_rising_and_falling_edges(void) {
+    threshold_tracker_init(&tracker, THRESHOLD_ALARM_DEFAULT_COUNT);
+    const uint8_t quiet[3] = {0, 0, 0};
+    const uint8_t hit[3] = {0, 0x02, 0};
+
+    event_count = 0;
+    int len = simple_packet(3, 4, quiet);
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_SIMPLE_ROI_EVEN, packet, len, collect, NULL) == 0,
+                "edge on quiet packet");
+
+    len = simple_packet(3, 4, hit);
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_SIMPLE_ROI_EVEN, packet, len, collect, NULL) == 1,
+                "rising edge missing");
+    TEST_ASSERT(event_count == 1, "callback count wrong");
+    TEST_ASSERT(events[0].group == 4 && events[0].roi_id == 1, "wrong ROI");
+    TEST_ASSERT(events[0].threshold == 1 && events[0].active == 1, "wrong threshold/state");
+    TEST_ASSERT(events[0].distance_average == 1001 && events[0].distance_min == 901, "head values wrong");
+    TEST_ASSERT(events[0].frame_cnt == 42, "frame_cnt wrong");
+
+    // Gleicher Zustand erneut: keine Flanke
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_SIMPLE_ROI_EVEN, packet, len, collect, NULL) == 0,
+                "level reported as edge");
+
+    len = simple_packet(3, 4, quiet);
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_SIMPLE_ROI_EVEN, packet, len, collect, NULL) == 1,
+                "falling edge missing");
+    TEST_ASSERT(event_count == 2 && events[1].active == 0 && events[1].threshold == 1, "falling edge wrong");
+    TEST_ASSERT(atomic_load(&tracker.edges) == 2, "edge counter wrong");
+    TEST_SUCCESS();
+}
+
+int test_multiple_bits_and_mask(void) {
+    threshold_tracker_init(&tracker, 2);
+    const uint8_t states[1] = {0xFF};
+
+    event_count = 0;
+    int len = simple_packet(1, 0, states);
+    // Nur Schwelle 0 und 1 existieren, höhere Bits sind Rauschen
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_SIMPLE_ROI_EVEN, packet, len, collect, NULL) == 2,
+                "mask not applied");
+    TEST_ASSERT(events[0].threshold == 0 && events[1].threshold == 1, "threshold order wrong");
+    TEST_ASSERT(events[0].active && events[1].active, "edges not rising");
+
+    threshold_tracker_reset(&tracker);
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_SIMPLE_ROI_EVEN, packet, len, collect, NULL) == 2,
+                "reset did not forget state");
+    TEST_SUCCESS();
+}
+
+int test_groups_are_independent(void) {
+    threshold_tracker_init(&tracker, THRESHOLD_ALARM_DEFAULT_COUNT);
+    const uint8_t hit[2] = {0x01, 0};
+
+    event_count = 0;
+    int len = simple_packet(2, 1, hit);
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_SIMPLE_ROI_EVEN, packet, len, collect, NULL) == 1,
+                "group 1 edge missing");
+    // Gleiche ROI-ID in einer anderen Gruppe hat eigenen Zustand
+    len = simple_packet(2, 2, hit);
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_SIMPLE_ROI_EVEN, packet, len, collect, NULL) == 1,
+                "group 2 edge missing");
+    TEST_ASSERT(events[1].group == 2 && events[1].roi_id == 0, "wrong group in event");
+
+    // Ungültige Gruppe wird übersprungen statt außerhalb der Tabelle zu schreiben
+    len = simple_packet(2, 200, hit);
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_SIMPLE_ROI_EVEN, packet, len, collect, NULL) == 0,
+                "out-of-range group reported");
+    TEST_SUCCESS();
+}
+
+int test_full_roi_packet(void) {
+    threshold_tracker_init(&tracker, THRESHOLD_ALARM_DEFAULT_COUNT);
+    const uint32_t pixels[3] = {11, 0, 37};
+    int len = pb_full_roi(packet, 3, pixels);
+
+    // Zustand im Kopf der dritten ROI setzen (Offset über die Pixel der ersten beiden)
+    int third = 2 * PACKET_FULL_ROI_HEADER + 2 * (int)(pixels[0] + pixels[1]);
+    packet[third + 3] = 0x04;
+
+    event_count = 0;
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_FULL_ROI_EVEN, packet, len, collect, NULL) == 1,
+                "full ROI edge missing");
+    TEST_ASSERT(events[0].roi_id == 2 && events[0].threshold == 2, "wrong ROI/threshold");
+    TEST_ASSERT(events[0].distance_average == 1502 && events[0].distance_min == 1402, "head values wrong");
+    TEST_ASSERT(events[0].frame_cnt == 7, "frame_cnt wrong");
+    TEST_SUCCESS();
+}
+
+int test_ignores_other_and_malformed(void) {
+    threshold_tracker_init(&tracker, THRESHOLD_ALARM_DEFAULT_COUNT);
+    event_count = 0;
+
+    int len = pb_simple_depth(packet, 1000, 1);
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_SIMPLE_DEPTH_EVEN, packet, len, collect, NULL) == 0,
+                "depth packet scanned");
+    TEST_ASSERT(atomic_load(&tracker.packets) == 0, "depth packet counted");
+
+    const uint32_t pixels[2] = {100, 100};
+    len = pb_full_roi(packet, 2, pixels);
+    packet[3] = 0x01;
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_FULL_ROI_EVEN, packet, len - 1, collect, NULL) == -1,
+                "truncated packet accepted");
+    TEST_ASSERT(event_count == 0, "edge from truncated packet");
+    TEST_ASSERT(atomic_load(&tracker.malformed) == 1, "malformed not counted");
+
+    TEST_ASSERT(threshold_tracker_scan(&tracker, HPS3D_FULL_ROI_EVEN, packet, len, NULL, NULL) == 1,
+                "NULL callback not tolerated");
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Threshold Alarm Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_rising_and_falling_edges();
+    total_tests++; passed_tests += test_multiple_bits_and_mask();
+    total_tests++; passed_tests += test_groups_are_independent();
+    total_tests++; passed_tests += test_full_roi_packet();
+    total_tests++; passed_tests += test_ignores_other_and_malformed();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}
@@ -0,0 +1,211 @@
+/*
+ * Unit tests for the pre/post-trigger frame recorder
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "trigger_capture.h"
+
+#define TEST_ASSERT(condition, message) \
+    do { \
+        if (!(condition)) { \
+            printf("FAIL: %s - %s\n", __func__, message); \
+            return 0; \
+        } \
+    } while(0)
+
+#define TEST_SUCCESS() \
+    do { \
+        printf("PASS: %s\n", __func__); \
+        return 1; \
+    } while(0)
+
+#define PACKET_SIZE 512
+#define SOURCE_BUFFERS 16
+
+// Quelle wie die Callback-Verteilung: fester Pool, Rückgabe zählt mit
+static frame_pool_t source;
+static int released;
+static uint32_t next_seq;
+
+static void release_to_source(frame_buf_t *buf, void *user) {
+    (void)user;
+    released++;
+    frame_pool_release(&source, buf);
+}
+
+static frame_buf_t *next_frame(void) {
+    frame_buf_t *buf = frame_pool_acquire(&source);
+    if (!buf) {
+        return NULL;
+    }
+    buf->seq = next_seq++;
+    buf->event_type = 3;
+    buf->len = 100 + (int)(buf->seq % 50);
+    memset(buf->data, (int)(buf->seq & 0xff), (size_t)buf->len);
+    clock_gettime(CLOCK_MONOTONIC, &buf->received);
+    return buf;
+}
+
+static int setup(trigger_capture_t *tc, uint32_t pre, uint32_t post, const char *dir) {
+    released = 0;
+    next_seq = 0;
+    if (frame_pool_init(&source, SOURCE_BUFFERS, PACKET_SIZE) != 0) {
+        return -1;
+    }
+    return trigger_capture_init(tc, pre, post, PACKET_SIZE, dir, release_to_source, NULL);
+}
+
+static void teardown(trigger_capture_t *tc) {
+    trigger_capture_destroy(tc);
+    frame_pool_destroy(&source);
+}
+
+int test_ring_holds_last_frames(void) {
+    trigger_capture_t tc;
+    TEST_ASSERT(setup(&tc, 4, 2, "/tmp") == 0, "init failed");
+
+    for (int i = 0; i < 10; i++) {
+        frame_buf_t *buf = next_frame();
+        TEST_ASSERT(buf != NULL, "source pool exhausted");
+        trigger_capture_push(&tc, buf);
+    }
+    // Nie mehr als pre_frames gehalten, das älteste geht zurück
+    TEST_ASSERT(tc.count == 4 && released == 6, "ring did not evict oldest");
+    TEST_ASSERT(frame_pool_available(&source) == SOURCE_BUFFERS - 4, "buffers leaked");
+    TEST_ASSERT(tc.ring[tc.head]->seq == 6, "oldest held frame wrong");
+
+    trigger_capture_drop_all(&tc);
+    TEST_ASSERT(frame_pool_available(&source) == SOURCE_BUFFERS && tc.count == 0, "drop_all kept buffers");
+    TEST_ASSERT(atomic_load(&tc.writer.submitted) == 0, "steady state touched the writer");
+    teardown(&tc);
+    TEST_SUCCESS();
+}
+
+int test_bundle_roundtrip(void) {
+    char dir[64];
+    snprintf(dir, sizeof(dir), "/tmp/test_trigger_%d", (int)getpid());
+    char cmd[128];
+    snprintf(cmd, sizeof(cmd), "mkdir -p %s", dir);
+    TEST_ASSERT(system(cmd) == 0, "mkdir failed");
+
+    trigger_capture_t tc;
+    TEST_ASSERT(setup(&tc, 3, 2, dir) == 0, "init failed");
+    for (int i = 0; i < 5; i++) {
+        trigger_capture_push(&tc, next_frame());
+    }
+    TEST_ASSERT(trigger_capture_request(&tc, TRIGGER_SOURCE_ALARM, 7) == 0, "request rejected");
+    TEST_ASSERT(trigger_capture_request(&tc, TRIGGER_SOURCE_HTTP, 0) == -1, "second request accepted");
+
+    // Erstes Paket nach dem Auslöser friert den Vorlauf (seq 2..4) ein
+    for (int i = 0; i < 4; i++) {
+        trigger_capture_push(&tc, next_frame());
+    }
+    TEST_ASSERT(atomic_load(&tc.collecting) == 0 && atomic_load(&tc.bundles) == 1, "bundle not finished");
+    TEST_ASSERT(tc.count == 3 && frame_pool_available(&source) == SOURCE_BUFFERS - 3,
+                "ring not refilled after trigger");
+    TEST_ASSERT(async_writer_flush(&tc.writer, 2000) == 0, "writer did not drain");
+    trigger_capture_poll(&tc);
+    TEST_ASSERT(tc.file == -1, "finished file not closed");
+
+    trigger_reader_t reader;
+    TEST_ASSERT(trigger_reader_open(&reader, tc.path) == 0, "bundle not readable");
+    TEST_ASSERT(reader.header.source == TRIGGER_SOURCE_ALARM && reader.header.detail == 7, "header source wrong");
+    TEST_ASSERT(reader.header.pre_frames == 3 && reader.header.post_frames == 2, "header counts wrong");
+    TEST_ASSERT(strstr(tc.path, "-alarm" TRIGGER_FILE_SUFFIX) != NULL, "file name lacks source");
+
+    static const uint32_t expected_seq[] = {2, 3, 4, 5, 6};
+    trigger_record_t record;
+    uint8_t data[PACKET_SIZE];
+    int n, frames = 0;
+    while ((n = trigger_reader_next(&reader, &record, data, sizeof(data))) > 0) {
+        TEST_ASSERT(frames < 5, "too many records");
+        TEST_ASSERT(record.seq == expected_seq[frames], "record order wrong");
+        TEST_ASSERT(n == 100 + (int)(record.seq % 50) && data[n - 1] == (uint8_t)record.seq, "payload wrong");
+        TEST_ASSERT(((record.flags & TRIGGER_RECORD_POST) != 0) == (frames >= 3), "post flag wrong");
+        TEST_ASSERT(frames >= 3 || record.rel_us <= 0, "pre frame after trigger");
+        frames++;
+    }
+    TEST_ASSERT(n == 0 && frames == 5, "bundle incomplete");
+    trigger_reader_close(&reader);
+
+    // Nach dem Nachlauf ist ein neuer Auslöser möglich und hat wieder Vorlauf
+    TEST_ASSERT(trigger_capture_request(&tc, TRIGGER_SOURCE_MQTT, 0) == 0, "re-arm failed");
+    trigger_capture_push(&tc, next_frame());
+    TEST_ASSERT(tc.post_left == 1 && atomic_load(&tc.writer.submitted) == 1 + 5 + 1 + 3 + 1,
+                "second bundle lacks pre frames");
+    char second[sizeof(tc.path)];
+    memcpy(second, tc.path, sizeof(second));
+
+    // Abbruch (Gerät getrennt): Datei endet mit den bisherigen Paketen
+    trigger_capture_drop_all(&tc);
+    TEST_ASSERT(frame_pool_available(&source) == SOURCE_BUFFERS, "drop_all kept buffers");
+    teardown(&tc);
+
+    TEST_ASSERT(trigger_reader_open(&reader, second) == 0, "truncated bundle not readable");
+    frames = 0;
+    while ((n = trigger_reader_next(&reader, &record, data, sizeof(data))) > 0) {
+        frames++;
+    }
+    trigger_reader_close(&reader);
+    TEST_ASSERT(n == 0 && frames == 4, "truncated bundle wrong");
+
+    unlink(second);
+    snprintf(cmd, sizeof(cmd), "rm -rf %s", dir);
+    TEST_ASSERT(system(cmd) == 0, "cleanup failed");
+    TEST_SUCCESS();
+}
+
+int test_reader_rejects_foreign_files(void) {
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_trigger_%d.bin", (int)getpid());
+    FILE *fp = fopen(path, "wb");
+    TEST_ASSERT(fp != NULL, "cannot create file");
+    fputs("not a trigger bundle, just some text padding it out", fp);
+    fclose(fp);
+
+    trigger_reader_t reader;
+    TEST_ASSERT(trigger_reader_open(&reader, path) == -1, "foreign file accepted");
+    TEST_ASSERT(trigger_reader_open(&reader, "/nonexistent/x.h3t") == -1, "missing file accepted");
+    unlink(path);
+
+    trigger_capture_t tc;
+    TEST_ASSERT(trigger_capture_init(&tc, 0, 5, PACKET_SIZE, "/tmp", release_to_source, NULL) == -1,
+                "zero pre window accepted");
+    TEST_ASSERT(trigger_capture_request(&tc, TRIGGER_SOURCE_HTTP, 0) == -1, "request on disabled recorder");
+    TEST_SUCCESS();
+}
+
+int test_unwritable_dir_counts_failure(void) {
+    trigger_capture_t tc;
+    TEST_ASSERT(setup(&tc, 2, 2, "/nonexistent/triggers") == 0, "init failed");
+    trigger_capture_push(&tc, next_frame());
+    TEST_ASSERT(trigger_capture_request(&tc, TRIGGER_SOURCE_HTTP, 0) == 0, "request rejected");
+    trigger_capture_push(&tc, next_frame());
+    TEST_ASSERT(atomic_load(&tc.failed) == 1 && atomic_load(&tc.collecting) == 0, "failure not reported");
+    TEST_ASSERT(tc.count == 2, "ring lost frames on failure");
+    TEST_ASSERT(trigger_capture_request(&tc, TRIGGER_SOURCE_HTTP, 0) == 0, "not re-armed after failure");
+    teardown(&tc);
+    TEST_SUCCESS();
+}
+
+int main(void) {
+    printf("=== Trigger Capture Tests ===\n");
+
+    int total_tests = 0;
+    int passed_tests = 0;
+
+    total_tests++; passed_tests += test_ring_holds_last_frames();
+    total_tests++; passed_tests += test_bundle_roundtrip();
+    total_tests++; passed_tests += test_reader_rejects_foreign_files();
+    total_tests++; passed_tests += test_unwritable_dir_counts_failure();
+
+    printf("\n=== Test Results ===\n");
+    printf("Total tests: %d\n", total_tests);
+    printf("Passed: %d\n", passed_tests);
+    printf("Failed: %d\n", total_tests - passed_tests);
+
+    return (passed_tests == total_tests) ? 0 : 1;
+}